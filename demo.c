@@ -32,17 +32,46 @@
 #include <stdio.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <sys/time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 #if defined(_OPENMP)
 #include <omp.h>
 #endif
 
 #include "jar_sim.h"
+#include "jar_norm.h"
+#include "jar_rnn.h"
+#include "jar_embed.h"
+#include "jar_train.h"
+#include "jar_scale.h"
+#include "jar_file.h"
+#include "jar_ooc.h"
+#include "jar_pool.h"
+#include "jar_async.h"
+#include "jar_graph.h"
+#include "jar_server.h"
+#include "jar_mem.h"
+#include "jar_numa.h"
+#include "jar_trace.h"
+#include "jar_numstat.h"
+#include "jar_tune.h"
+#include "jar_valid.h"
+#include "jar_sparse.h"
+#include "jar_nm.h"
+#include "jar_acc.h"
+#include "jar_shard.h"
 
 #define VAL_lo  -2.0
 #define VAL_hi   2.0
+#define SHARD_ULP  2.0
 
 inline double time_in_sec(struct timeval start, struct timeval end) {
   return ((double)(((end.tv_sec * 1000000 + end.tv_usec) - (start.tv_sec * 1000000 + start.tv_usec)))) / 1.0e6;
@@ -89,6 +118,144 @@ void float_matmul( const int M, const int N, const int K, float* A, float* B, fl
   }   
 }
 
+void float_rmsnorm( const int M, const int N, float* X, float* gamma, const float eps, float* Y ) {
+  int m, n;
+
+  for ( n=0; n<N; ++n ) {
+    float ms = 0.0f;
+    for ( m=0; m<M; ++m ) {
+      ms += X[(n*M)+m] * X[(n*M)+m];
+    }
+    ms = 1.0f / sqrtf( ms/(float)M + eps );
+    for ( m=0; m<M; ++m ) {
+      Y[(n*M)+m] = X[(n*M)+m] * ms * gamma[m];
+    }
+  }
+}
+
+void float_layernorm( const int M, const int N, float* X, float* gamma, float* beta, const float eps, float* Y ) {
+  int m, n;
+
+  for ( n=0; n<N; ++n ) {
+    float mean = 0.0f;
+    float var = 0.0f;
+    for ( m=0; m<M; ++m ) {
+      mean += X[(n*M)+m];
+    }
+    mean /= (float)M;
+    for ( m=0; m<M; ++m ) {
+      var += (X[(n*M)+m] - mean) * (X[(n*M)+m] - mean);
+    }
+    var = 1.0f / sqrtf( var/(float)M + eps );
+    for ( m=0; m<M; ++m ) {
+      Y[(n*M)+m] = (X[(n*M)+m] - mean) * var * gamma[m] + beta[m];
+    }
+  }
+}
+
+float float_sigmoid( const float x ) {
+  return 1.0f / (1.0f + expf( -x ));
+}
+
+void float_lstm_seq( const int I, const int H, const int T, float* W, float* bias, float* X, float* h, float* c, float* Y ) {
+  float* xh = (float*) malloc( (I+H)*sizeof(float) );
+  float* z = (float*) malloc( 4*H*sizeof(float) );
+  int j, k, t;
+
+  for ( k=0; k<H; ++k ) xh[I+k] = h[k];
+  for ( t=0; t<T; ++t ) {
+    for ( k=0; k<I; ++k ) xh[k] = X[(t*I)+k];
+    for ( j=0; j<4*H; ++j ) z[j] = bias[j];
+    for ( k=0; k<I+H; ++k ) {
+      for ( j=0; j<4*H; ++j ) {
+        z[j] += W[(k*4*H)+j] * xh[k];
+      }
+    }
+    for ( j=0; j<H; ++j ) {
+      c[j] = float_sigmoid( z[H+j] ) * c[j] + float_sigmoid( z[j] ) * tanhf( z[(2*H)+j] );
+      xh[I+j] = float_sigmoid( z[(3*H)+j] ) * tanhf( c[j] );
+      Y[(t*H)+j] = xh[I+j];
+    }
+  }
+  for ( k=0; k<H; ++k ) h[k] = xh[I+k];
+
+  free( z );
+  free( xh );
+}
+
+void float_gru_seq( const int I, const int H, const int T, float* W, float* bias, float* X, float* h, float* Y ) {
+  float* xh = (float*) malloc( (I+H)*sizeof(float) );
+  float* z = (float*) malloc( 4*H*sizeof(float) );
+  int j, k, t;
+
+  for ( k=0; k<H; ++k ) xh[I+k] = h[k];
+  for ( t=0; t<T; ++t ) {
+    for ( k=0; k<I; ++k ) xh[k] = X[(t*I)+k];
+    for ( j=0; j<4*H; ++j ) z[j] = bias[j];
+    for ( k=0; k<I+H; ++k ) {
+      for ( j=0; j<2*H; ++j ) {
+        z[j] += W[(k*3*H)+j] * xh[k];
+      }
+      for ( j=0; j<H; ++j ) {
+        z[((k<I) ? 2*H : 3*H)+j] += W[(k*3*H)+(2*H)+j] * xh[k];
+      }
+    }
+    for ( j=0; j<H; ++j ) {
+      float u = float_sigmoid( z[H+j] );
+      float n = tanhf( z[(2*H)+j] + float_sigmoid( z[j] ) * z[(3*H)+j] );
+      xh[I+j] = (1.0f - u) * n + u * xh[I+j];
+      Y[(t*H)+j] = xh[I+j];
+    }
+  }
+  for ( k=0; k<H; ++k ) h[k] = xh[I+k];
+
+  free( z );
+  free( xh );
+}
+
+void float_embedding_bag( const int D, const int B, float* table, int* indices, int* offsets, float* weights, float* out ) {
+  int b, j, d;
+
+  for ( b=0; b<B; ++b ) {
+    for ( d=0; d<D; ++d ) {
+      out[(b*D)+d] = 0.0f;
+    }
+    for ( j=offsets[b]; j<offsets[b+1]; ++j ) {
+      for ( d=0; d<D; ++d ) {
+        out[(b*D)+d] += ((weights != NULL) ? weights[j] : 1.0f) * table[(indices[j]*D)+d];
+      }
+    }
+  }
+}
+
+void float_matmul_bwd_data( const int M, const int N, const int K, float* A, float* dC, float* dB ) {
+  int m, n, k;
+
+  for ( n=0; n<N; ++n ) {
+    for ( k=0; k<K; ++k ) {
+      double s = 0.0;
+      for ( m=0; m<M; ++m ) {
+        s += (double)A[(k*M)+m] * (double)dC[(n*M)+m];
+      }
+      dB[(n*K)+k] = (float)s;
+    }
+  }
+}
+
+void float_matmul_bwd_weight( const int M, const int N, const int K, float* dC, float* B, float* dA ) {
+  int m, n, k;
+
+  for ( k=0; k<K; ++k ) {
+    for ( m=0; m<M; ++m ) {
+      double s = 0.0;
+      for ( n=0; n<N; ++n ) {
+        s += (double)dC[(n*M)+m] * (double)B[(n*K)+k];
+      }
+      dA[(k*M)+m] = (float)s;
+    }
+  }
+}
+
 void init_float( float* f, const int size, const float val_lo, const float width ) {
   int i;
 
@@ -108,7 +275,7 @@ void init_JAR_update_float( UniJAR* j, float* f, const int size ) {
   for ( i=0; i<size; ++i ) {
     x.F  = f[i];
     j[i] = LinFP32_2_LogPS80( x );
-    x.F  = LogPS80_2_Lin_val( j[i] );
+    x.F  = LogPS80_2_Lin_val_tbl( j[i] );
     f[i] = x.F;
   }
 }
@@ -121,7 +288,7 @@ void compute_norms( const int size, UniJAR* j, float* f, float* l1_jar, float* l
   *lmax = 0.0f;
 
   for ( m=0 ; m<size; ++m ) {
-    float j_f = LogPS80_2_Lin_val( j[m] );
+    float j_f = LogPS80_2_Lin_val_tbl( j[m] );
     *l1_jar += j_f;
     *l1_f   += f[m];
     *lmax = ( *lmax > fabs( j_f - f[m] ) ) ? *lmax : fabs( j_f - f[m] );
@@ -361,6 +528,1970 @@ void test_matmul( const int M, const int N, const int K ) {
   free( A );
 }
 
+void test_norm( const int M, const int N ) {
+  UniJAR* X = (UniJAR*) malloc( M*N*sizeof(UniJAR) );
+  UniJAR* g = (UniJAR*) malloc( M*sizeof(UniJAR) );
+  UniJAR* b = (UniJAR*) malloc( M*sizeof(UniJAR) );
+  UniJAR* Y1 = (UniJAR*) malloc( M*N*sizeof(UniJAR) );
+  UniJAR* Y2 = (UniJAR*) malloc( M*N*sizeof(UniJAR) );
+  float* f_X = (float*) malloc( M*N*sizeof(float) );
+  float* f_g = (float*) malloc( M*sizeof(float) );
+  float* f_b = (float*) malloc( M*sizeof(float) );
+  float* f_Y = (float*) malloc( M*N*sizeof(float) );
+  float width = (float)VAL_hi - (float)VAL_lo;
+  float eps = 1.0e-5f;
+  float lmax = 0.0f;
+  float l1_f = 0.0f;
+  float l1_jar = 0.0f;
+
+  printf("Test: we perform RMSNorm and LayerNorm using JAR and compare it with  \n");
+  printf("   the normalization of the accurate linear domain value of the input data \n");
+
+  init_float( f_X, M*N, (float)VAL_lo, width );
+  init_float( f_g, M, (float)VAL_lo, width );
+  init_float( f_b, M, (float)VAL_lo, width );
+
+  init_JAR_update_float( X, f_X, M*N );
+  init_JAR_update_float( g, f_g, M );
+  init_JAR_update_float( b, f_b, M );
+
+  /* RMSNorm */
+  jar_rmsnorm( M, N, X, g, eps, Y1 );
+  jar_rmsnorm_avx512( M, N, X, g, eps, Y2 );
+  float_rmsnorm( M, N, f_X, f_g, eps, f_Y );
+
+  compute_norms( M*N, Y1, f_Y, &l1_jar, &l1_f, &lmax );
+  printf("scalar code\n");
+  printf("Accurate LinFP32 of the resulting logarithmic domain 1-norm in JAR rmsnorm is %10.6e\n", l1_jar);
+  printf("rmsnorm in FP32 arithmetic 1-norm                                          is %10.6e\n", l1_f);
+  printf("Max norm of error                                                          is %10.6e\n", lmax);
+
+  compute_norms( M*N, Y2, f_Y, &l1_jar, &l1_f, &lmax );
+  printf("vector code\n");
+  printf("Accurate LinFP32 of the resulting logarithmic domain 1-norm in JAR rmsnorm is %10.6e\n", l1_jar);
+  printf("rmsnorm in FP32 arithmetic 1-norm                                          is %10.6e\n", l1_f);
+  printf("Max norm of error                                                          is %10.6e\n", lmax);
+
+  /* LayerNorm */
+  jar_layernorm( M, N, X, g, b, eps, Y1 );
+  jar_layernorm_avx512( M, N, X, g, b, eps, Y2 );
+  float_layernorm( M, N, f_X, f_g, f_b, eps, f_Y );
+
+  compute_norms( M*N, Y1, f_Y, &l1_jar, &l1_f, &lmax );
+  printf("scalar code\n");
+  printf("Accurate LinFP32 of the resulting logarithmic domain 1-norm in JAR layernorm is %10.6e\n", l1_jar);
+  printf("layernorm in FP32 arithmetic 1-norm                                          is %10.6e\n", l1_f);
+  printf("Max norm of error                                                            is %10.6e\n", lmax);
+
+  compute_norms( M*N, Y2, f_Y, &l1_jar, &l1_f, &lmax );
+  printf("vector code\n");
+  printf("Accurate LinFP32 of the resulting logarithmic domain 1-norm in JAR layernorm is %10.6e\n", l1_jar);
+  printf("layernorm in FP32 arithmetic 1-norm                                          is %10.6e\n", l1_f);
+  printf("Max norm of error                                                            is %10.6e\n", lmax);
+
+  free( f_Y );
+  free( f_b );
+  free( f_g );
+  free( f_X );
+  free( Y2 );
+  free( Y1 );
+  free( b );
+  free( g );
+  free( X );
+}
+
+void test_rnn( const int I, const int H, const int T ) {
+  UniJAR* W = (UniJAR*) malloc( 4*H*(I+H)*sizeof(UniJAR) );
+  UniJAR* bias = (UniJAR*) malloc( 4*H*sizeof(UniJAR) );
+  UniJAR* X = (UniJAR*) malloc( I*T*sizeof(UniJAR) );
+  UniJAR* h = (UniJAR*) malloc( H*sizeof(UniJAR) );
+  UniJAR* c = (UniJAR*) malloc( H*sizeof(UniJAR) );
+  UniJAR* Y1 = (UniJAR*) malloc( H*T*sizeof(UniJAR) );
+  UniJAR* Y2 = (UniJAR*) malloc( H*T*sizeof(UniJAR) );
+  float* f_W = (float*) malloc( 4*H*(I+H)*sizeof(float) );
+  float* f_bias = (float*) malloc( 4*H*sizeof(float) );
+  float* f_X = (float*) malloc( I*T*sizeof(float) );
+  float* f_h = (float*) malloc( H*sizeof(float) );
+  float* f_c = (float*) malloc( H*sizeof(float) );
+  float* f_Y = (float*) malloc( H*T*sizeof(float) );
+  float width = (float)VAL_hi - (float)VAL_lo;
+  float w_scale = 1.0f / sqrtf( (float)(I+H) );
+  float lmax = 0.0f;
+  float l1_f = 0.0f;
+  float l1_jar = 0.0f;
+  int pass, k;
+
+  printf("Test: we run LSTM and GRU sequences using JAR and compare them with  \n");
+  printf("   the sequences computed from the accurate linear domain value of the input data \n");
+
+  init_float( f_W, 4*H*(I+H), -w_scale, 2.0f*w_scale );
+  init_float( f_bias, 4*H, -0.5f, 1.0f );
+  init_float( f_X, I*T, (float)VAL_lo, width );
+  init_JAR_update_float( W, f_W, 4*H*(I+H) );
+  init_JAR_update_float( bias, f_bias, 4*H );
+  init_JAR_update_float( X, f_X, I*T );
+
+  for ( pass=0; pass<2; ++pass ) {
+    /* LSTM uses the 4*H x (I+H) weights; GRU the first 3*H x (I+H) of the same buffer */
+    for ( k=0; k<H; ++k ) {
+      h[k].I = JAR_ZERO; c[k].I = JAR_ZERO; f_h[k] = 0.0f; f_c[k] = 0.0f;
+    }
+    if ( pass == 0 ) {
+      jar_lstm_seq( I, H, T, W, bias, X, h, c, Y1 );
+      for ( k=0; k<H; ++k ) {
+        h[k].I = JAR_ZERO; c[k].I = JAR_ZERO;
+      }
+      jar_lstm_seq_avx512( I, H, T, W, bias, X, h, c, Y2 );
+      float_lstm_seq( I, H, T, f_W, f_bias, f_X, f_h, f_c, f_Y );
+    } else {
+      jar_gru_seq( I, H, T, W, bias, X, h, Y1 );
+      for ( k=0; k<H; ++k ) {
+        h[k].I = JAR_ZERO;
+      }
+      jar_gru_seq_avx512( I, H, T, W, bias, X, h, Y2 );
+      float_gru_seq( I, H, T, f_W, f_bias, f_X, f_h, f_Y );
+    }
+
+    compute_norms( H*T, Y1, f_Y, &l1_jar, &l1_f, &lmax );
+    printf("scalar code\n");
+    printf("Accurate LinFP32 of the resulting logarithmic domain 1-norm in JAR %s is %10.6e\n", (pass == 0) ? "lstm" : "gru ", l1_jar);
+    printf("%s in FP32 arithmetic 1-norm                                          is %10.6e\n", (pass == 0) ? "lstm" : "gru ", l1_f);
+    printf("Max norm of error                                                         is %10.6e\n", lmax);
+
+    compute_norms( H*T, Y2, f_Y, &l1_jar, &l1_f, &lmax );
+    printf("vector code\n");
+    printf("Accurate LinFP32 of the resulting logarithmic domain 1-norm in JAR %s is %10.6e\n", (pass == 0) ? "lstm" : "gru ", l1_jar);
+    printf("%s in FP32 arithmetic 1-norm                                          is %10.6e\n", (pass == 0) ? "lstm" : "gru ", l1_f);
+    printf("Max norm of error                                                         is %10.6e\n", lmax);
+  }
+
+  free( f_Y );
+  free( f_c );
+  free( f_h );
+  free( f_X );
+  free( f_bias );
+  free( f_W );
+  free( Y2 );
+  free( Y1 );
+  free( c );
+  free( h );
+  free( X );
+  free( bias );
+  free( W );
+}
+
+void test_embedding_bag( const int D, const int E, const int B ) {
+  UniJAR* T = (UniJAR*) malloc( D*E*sizeof(UniJAR) );
+  unsigned char* T8 = (unsigned char*) malloc( D*E*sizeof(unsigned char) );
+  int* offsets = (int*) malloc( (B+1)*sizeof(int) );
+  int* indices;
+  UniJAR* w;
+  UniJAR* out1 = (UniJAR*) malloc( D*B*sizeof(UniJAR) );
+  UniJAR* out2 = (UniJAR*) malloc( D*B*sizeof(UniJAR) );
+  float* f_T = (float*) malloc( D*E*sizeof(float) );
+  float* f_w;
+  float* f_out = (float*) malloc( D*B*sizeof(float) );
+  float width = (float)VAL_hi - (float)VAL_lo;
+  float lmax = 0.0f;
+  float l1_f = 0.0f;
+  float l1_jar = 0.0f;
+  int b, j, pass;
+
+  printf("Test: we perform embedding bags using JAR on 32-bit and 8-bit tables and compare them with  \n");
+  printf("   the embedding bags of the accurate linear domain value of the input data \n");
+
+  /* bags of 0 to 15 lookups */
+  offsets[0] = 0;
+  for ( b=0; b<B; ++b ) {
+    offsets[b+1] = offsets[b] + rand() % 16;
+  }
+  indices = (int*) malloc( (offsets[B]+1)*sizeof(int) );
+  w = (UniJAR*) malloc( (offsets[B]+1)*sizeof(UniJAR) );
+  f_w = (float*) malloc( (offsets[B]+1)*sizeof(float) );
+  for ( j=0; j<offsets[B]; ++j ) {
+    indices[j] = rand() % E;
+  }
+
+  init_float( f_T, D*E, (float)VAL_lo, width );
+  init_float( f_w, offsets[B], -1.0f, 2.0f );
+  init_JAR_update_float( T, f_T, D*E );
+  init_JAR_update_float( w, f_w, offsets[B] );
+  jar_pack_PS8( (size_t)D*E, T, T8 );
+
+  for ( pass=0; pass<2; ++pass ) {
+    UniJAR* weights = (pass == 0) ? NULL : w;
+    float_embedding_bag( D, B, f_T, indices, offsets, (pass == 0) ? NULL : f_w, f_out );
+    printf("%s\n", (pass == 0) ? "sum" : "weighted sum");
+
+    jar_embedding_bag( D, B, T, indices, offsets, weights, out1 );
+    jar_embedding_bag_avx512( D, B, T, indices, offsets, weights, out2 );
+    compute_norms( D*B, out1, f_out, &l1_jar, &l1_f, &lmax );
+    printf("scalar code, 32-bit table\n");
+    printf("Accurate LinFP32 of the resulting logarithmic domain 1-norm in JAR embedding bag is %10.6e\n", l1_jar);
+    printf("embedding bag in FP32 arithmetic 1-norm                                          is %10.6e\n", l1_f);
+    printf("Max norm of error                                                                is %10.6e\n", lmax);
+    compute_norms( D*B, out2, f_out, &l1_jar, &l1_f, &lmax );
+    printf("vector code, 32-bit table\n");
+    printf("Accurate LinFP32 of the resulting logarithmic domain 1-norm in JAR embedding bag is %10.6e\n", l1_jar);
+    printf("embedding bag in FP32 arithmetic 1-norm                                          is %10.6e\n", l1_f);
+    printf("Max norm of error                                                                is %10.6e\n", lmax);
+
+    jar_embedding_bag_PS8( D, B, T8, indices, offsets, weights, out1 );
+    jar_embedding_bag_PS8_avx512( D, B, T8, indices, offsets, weights, out2 );
+    compute_norms( D*B, out1, f_out, &l1_jar, &l1_f, &lmax );
+    printf("scalar code, 8-bit table\n");
+    printf("Accurate LinFP32 of the resulting logarithmic domain 1-norm in JAR embedding bag is %10.6e\n", l1_jar);
+    printf("embedding bag in FP32 arithmetic 1-norm                                          is %10.6e\n", l1_f);
+    printf("Max norm of error                                                                is %10.6e\n", lmax);
+    compute_norms( D*B, out2, f_out, &l1_jar, &l1_f, &lmax );
+    printf("vector code, 8-bit table\n");
+    printf("Accurate LinFP32 of the resulting logarithmic domain 1-norm in JAR embedding bag is %10.6e\n", l1_jar);
+    printf("embedding bag in FP32 arithmetic 1-norm                                          is %10.6e\n", l1_f);
+    printf("Max norm of error                                                                is %10.6e\n", lmax);
+  }
+
+  free( f_out );
+  free( f_w );
+  free( f_T );
+  free( out2 );
+  free( out1 );
+  free( w );
+  free( indices );
+  free( offsets );
+  free( T8 );
+  free( T );
+}
+
+void test_backward( const int M, const int N, const int K ) {
+  UniJAR* A = (UniJAR*) malloc( M*K*sizeof(UniJAR) );
+  UniJAR* B = (UniJAR*) malloc( K*N*sizeof(UniJAR) );
+  UniJAR* dC = (UniJAR*) malloc( M*N*sizeof(UniJAR) );
+  UniJAR* dB1 = (UniJAR*) malloc( K*N*sizeof(UniJAR) );
+  UniJAR* dB2 = (UniJAR*) malloc( K*N*sizeof(UniJAR) );
+  UniJAR* dA1 = (UniJAR*) malloc( M*K*sizeof(UniJAR) );
+  UniJAR* dA2 = (UniJAR*) malloc( M*K*sizeof(UniJAR) );
+  double* acc = (double*) malloc( M*K*sizeof(double) );
+  float* f_A = (float*) malloc( M*K*sizeof(float) );
+  float* f_B = (float*) malloc( K*N*sizeof(float) );
+  float* f_dC = (float*) malloc( M*N*sizeof(float) );
+  float* f_dB = (float*) malloc( K*N*sizeof(float) );
+  float* f_dA = (float*) malloc( M*K*sizeof(float) );
+  float width = (float)VAL_hi - (float)VAL_lo;
+  float lmax = 0.0f;
+  float l1_f = 0.0f;
+  float l1_jar = 0.0f;
+  int i, N1 = N/2;
+
+  printf("Test: we compute the gradients dB = A^T*dC and dA = dC*B^T using JAR and compare them with  \n");
+  printf("   the gradients computed from the accurate linear domain value of the input data \n");
+  printf("   dA is accumulated over two micro-batches of %i and %i samples \n", N1, N-N1);
+
+  init_float( f_A, M*K, (float)VAL_lo, width );
+  init_float( f_B, K*N, (float)VAL_lo, width );
+  init_float( f_dC, M*N, (float)VAL_lo, width );
+  init_JAR_update_float( A, f_A, M*K );
+  init_JAR_update_float( B, f_B, K*N );
+  init_JAR_update_float( dC, f_dC, M*N );
+
+  jar_matmul_bwd_data( M, N, K, A, dC, dB1 );
+  jar_matmul_bwd_data_avx512( M, N, K, A, dC, dB2 );
+  float_matmul_bwd_data( M, N, K, f_A, f_dC, f_dB );
+
+  for ( i=0; i<M*K; ++i ) acc[i] = 0.0;
+  jar_matmul_bwd_weight( M, N1, K, dC, B, acc );
+  jar_matmul_bwd_weight( M, N-N1, K, dC+(N1*M), B+(N1*K), acc );
+  jar_acc_2_LogPS80( (size_t)M*K, acc, dA1, NULL );
+  for ( i=0; i<M*K; ++i ) acc[i] = 0.0;
+  jar_matmul_bwd_weight_avx512( M, N1, K, dC, B, acc );
+  jar_matmul_bwd_weight_avx512( M, N-N1, K, dC+(N1*M), B+(N1*K), acc );
+  jar_acc_2_LogPS80( (size_t)M*K, acc, dA2, NULL );
+  float_matmul_bwd_weight( M, N, K, f_dC, f_B, f_dA );
+
+  compute_norms( K*N, dB1, f_dB, &l1_jar, &l1_f, &lmax );
+  printf("scalar code\n");
+  printf("Accurate LinFP32 of the resulting logarithmic domain 1-norm in JAR dB is %10.6e\n", l1_jar);
+  printf("dB in FP64 arithmetic 1-norm                                          is %10.6e\n", l1_f);
+  printf("Max norm of error                                                     is %10.6e\n", lmax);
+  compute_norms( K*N, dB2, f_dB, &l1_jar, &l1_f, &lmax );
+  printf("vector code\n");
+  printf("Accurate LinFP32 of the resulting logarithmic domain 1-norm in JAR dB is %10.6e\n", l1_jar);
+  printf("dB in FP64 arithmetic 1-norm                                          is %10.6e\n", l1_f);
+  printf("Max norm of error                                                     is %10.6e\n", lmax);
+
+  compute_norms( M*K, dA1, f_dA, &l1_jar, &l1_f, &lmax );
+  printf("scalar code\n");
+  printf("Accurate LinFP32 of the resulting logarithmic domain 1-norm in JAR dA is %10.6e\n", l1_jar);
+  printf("dA in FP64 arithmetic 1-norm                                          is %10.6e\n", l1_f);
+  printf("Max norm of error                                                     is %10.6e\n", lmax);
+  compute_norms( M*K, dA2, f_dA, &l1_jar, &l1_f, &lmax );
+  printf("vector code\n");
+  printf("Accurate LinFP32 of the resulting logarithmic domain 1-norm in JAR dA is %10.6e\n", l1_jar);
+  printf("dA in FP64 arithmetic 1-norm                                          is %10.6e\n", l1_f);
+  printf("Max norm of error                                                     is %10.6e\n", lmax);
+
+  free( f_dA );
+  free( f_dB );
+  free( f_dC );
+  free( f_B );
+  free( f_A );
+  free( acc );
+  free( dA2 );
+  free( dA1 );
+  free( dB2 );
+  free( dB1 );
+  free( dC );
+  free( B );
+  free( A );
+}
+
+void test_stochastic_rounding( const int size ) {
+  UniJAR* x = (UniJAR*) malloc( size*sizeof(UniJAR) );
+  UniJAR* y1 = (UniJAR*) malloc( size*sizeof(UniJAR) );
+  UniJAR* y2 = (UniJAR*) malloc( size*sizeof(UniJAR) );
+  double* mean = (double*) malloc( size*sizeof(double) );
+  float* f_x = (float*) malloc( size*sizeof(float) );
+  float width = (float)VAL_hi - (float)VAL_lo;
+  double err_rn = 0.0;
+  double err_sr = 0.0;
+  RndJAR rnd;
+  int i, r, mismatch = 0;
+  const int reps = 1024;
+
+  printf("Test: convert LinFP32 values to LogPS80 with stochastic rounding, %i times with different \n", reps);
+  printf("   random streams. The average of the linear domain values should approach the input, \n");
+  printf("   unlike round-to-nearest whose error is systematic \n");
+
+  init_float( f_x, size, (float)VAL_lo, width );
+  for ( i=0; i<size; ++i ) {
+    x[i].F = f_x[i];
+    mean[i] = 0.0;
+  }
+
+  rnd.mode = JAR_RND_STOCHASTIC;
+  rnd.key[0] = 0x12345678; rnd.key[1] = 0x9abcdef0;
+  rnd.ctr[1] = 0;
+  for ( r=0; r<reps; ++r ) {
+    rnd.ctr[0] = r;
+    for ( i=0; i<size; ++i ) {
+      y1[i] = LinFP32_2_LogPS80_rnd( x[i], &rnd, i );
+    }
+    jar_convert_LinFP32_2_LogPS80( size, x, y2, &rnd );
+    for ( i=0; i<size; ++i ) {
+      mismatch += ( y1[i].I != y2[i].I );
+      mean[i] += LogPS80_2_Lin_val( y1[i] );
+    }
+  }
+
+  for ( i=0; i<size; ++i ) {
+    double rn = LogPS80_2_Lin_val( LinFP32_2_LogPS80( x[i] ) );
+    mean[i] /= (double)reps;
+    err_rn += fabs( rn - (double)f_x[i] )/fabs( (double)f_x[i] );
+    err_sr += fabs( mean[i] - (double)f_x[i] )/fabs( (double)f_x[i] );
+  }
+  printf("average relative error of round-to-nearest                    is %10.6e\n", err_rn/(double)size);
+  printf("average relative error of the mean of stochastic roundings    is %10.6e\n", err_sr/(double)size);
+  printf("number of scalar / vector code mismatches                     is %i\n", mismatch);
+
+  free( f_x );
+  free( mean );
+  free( y2 );
+  free( y1 );
+  free( x );
+}
+
+float rel_error_scaled( const int M, const int N, UniJAR* C, const int* kc, float* f_C ) {
+  double err = 0.0, nrm = 0.0;
+  int m, n;
+
+  for ( n=0; n<N; ++n ) {
+    for ( m=0; m<M; ++m ) {
+      UniJAR c = ( kc == NULL ) ? C[(n*M)+m] : jar_shift_LogPS80( C[(n*M)+m], -kc[m] );
+      err += fabs( (double)LogPS80_2_Lin_val( c ) - (double)f_C[(n*M)+m] );
+      nrm += fabs( (double)f_C[(n*M)+m] );
+    }
+  }
+  return (float)(err/nrm);
+}
+
+void test_scaling( const int M, const int N, const int K ) {
+  UniJAR* X = (UniJAR*) malloc( ((M*K > K*N) ? M*K : K*N)*sizeof(UniJAR) );
+  UniJAR* A = (UniJAR*) malloc( M*K*sizeof(UniJAR) );
+  UniJAR* B = (UniJAR*) malloc( K*N*sizeof(UniJAR) );
+  UniJAR* C0 = (UniJAR*) malloc( M*N*sizeof(UniJAR) );
+  UniJAR* C1 = (UniJAR*) malloc( M*N*sizeof(UniJAR) );
+  UniJAR* C2 = (UniJAR*) malloc( M*N*sizeof(UniJAR) );
+  unsigned long long* hist = (unsigned long long*) calloc( M*JAR_CALIB_BINS, sizeof(unsigned long long) );
+  int* ka = (int*) malloc( M*sizeof(int) );
+  int* kc = (int*) malloc( M*sizeof(int) );
+  int* shift = (int*) malloc( M*sizeof(int) );
+  float* f_A = (float*) malloc( M*K*sizeof(float) );
+  float* f_B = (float*) malloc( K*N*sizeof(float) );
+  float* f_C = (float*) malloc( M*N*sizeof(float) );
+  int i, m, kb, mismatch = 0;
+
+  printf("Test: matrix matrix product of weights whose rows span 2^-6 ... 2^9 and small activations, \n");
+  printf("   once quantized as is and once with per-row (A, C) and per-tensor (B) power-of-two \n");
+  printf("   scales picked from exponent histograms and folded into the kernel \n");
+
+  init_float( f_A, M*K, -1.0f, 2.0f );
+  init_float( f_B, K*N, -1.0f, 2.0f );
+  for ( i=0; i<M*K; ++i ) f_A[i] = ldexpf( f_A[i], ((i%M)%16) - 6 );
+  for ( i=0; i<K*N; ++i ) f_B[i] = ldexpf( f_B[i], -5 );
+  float_matmul( M, N, K, f_A, f_B, f_C );
+
+  /* unscaled */
+  for ( i=0; i<M*K; ++i ) { X[i].F = f_A[i]; A[i] = LinFP32_2_LogPS80( X[i] ); }
+  for ( i=0; i<K*N; ++i ) { X[i].F = f_B[i]; B[i] = LinFP32_2_LogPS80( X[i] ); }
+  jar_matmul( M, N, K, A, B, C0 );
+
+  /* calibration: A per row, B per tensor, C per row from the reference output */
+  for ( i=0; i<M*K; ++i ) X[i].F = f_A[i];
+  jar_calib_hist_rows( M, K, X, hist );
+  for ( m=0; m<M; ++m ) ka[m] = jar_calib_shift( hist+(m*JAR_CALIB_BINS) );
+  jar_quantize_scaled_rows( M, K, X, ka, A );
+
+  for ( i=0; i<JAR_CALIB_BINS; ++i ) hist[i] = 0;
+  for ( i=0; i<K*N; ++i ) X[i].F = f_B[i];
+  jar_calib_hist( K*N, X, hist );
+  kb = jar_calib_shift( hist );
+  jar_quantize_scaled( K*N, X, kb, B );
+
+  for ( i=0; i<M*JAR_CALIB_BINS; ++i ) hist[i] = 0;
+  for ( i=0; i<M*N; ++i ) C2[i].F = f_C[i];
+  jar_calib_hist_rows( M, N, C2, hist );
+  for ( m=0; m<M; ++m ) {
+    kc[m] = jar_calib_shift( hist+(m*JAR_CALIB_BINS) );
+    shift[m] = kc[m] - ka[m] - kb;
+  }
+
+  jar_matmul_scaled( M, N, K, A, B, C1, shift );
+  jar_matmul_scaled_avx512( M, N, K, A, B, C2, shift );
+  for ( i=0; i<M*N; ++i ) mismatch += ( C1[i].I != C2[i].I );
+
+  printf("shift of B is %i, shifts of the first rows of A are", kb);
+  for ( m=0; m<M && m<8; ++m ) printf(" %i", ka[m]);
+  printf("\n");
+  printf("relative 1-norm error of the unscaled JAR matmul             is %10.6e\n", rel_error_scaled( M, N, C0, NULL, f_C ));
+  printf("relative 1-norm error of the scaled JAR matmul, scalar code  is %10.6e\n", rel_error_scaled( M, N, C1, kc, f_C ));
+  printf("relative 1-norm error of the scaled JAR matmul, vector code  is %10.6e\n", rel_error_scaled( M, N, C2, kc, f_C ));
+  printf("number of scalar / vector code mismatches                    is %i\n", mismatch);
+
+  /* zero inputs (ReLU outputs, pruned weights) with negative shifts: B, A and B, A zero */
+  mismatch = 0;
+  for ( m=0; m<M; ++m ) shift[m] = -4 - (m%8);
+  for ( i=0; i<3; ++i ) {
+    int j;
+    if ( i == 0 ) for ( j=0; j<K*N; ++j ) B[j].I = JAR_ZERO;
+    if ( i == 1 ) for ( j=0; j<M*K; ++j ) A[j].I = JAR_ZERO | ((j%3) ? 0 : SIGN_MASK);
+    if ( i == 2 ) jar_quantize_scaled( K*N, X, kb, B );
+    jar_matmul_scaled( M, N, K, A, B, C1, shift );
+    jar_matmul_scaled_avx512( M, N, K, A, B, C2, shift );
+    for ( j=0; j<M*N; ++j ) {
+      mismatch += ( (C1[j].I & CLEAR_SIGN) > JAR_ZERO ) + ( (C2[j].I & CLEAR_SIGN) > JAR_ZERO );
+    }
+  }
+  printf("number of nonzero results of zero inputs, negative shifts    is %i\n", mismatch);
+
+  free( f_C );
+  free( f_B );
+  free( f_A );
+  free( shift );
+  free( kc );
+  free( ka );
+  free( hist );
+  free( C2 );
+  free( C1 );
+  free( C0 );
+  free( B );
+  free( A );
+  free( X );
+}
+
+void test_file( const int M, const int K ) {
+  const int N = 8, B = 16;
+  const char* path = "demo_test.jar";
+  UniJAR* A = (UniJAR*) malloc( M*K*sizeof(UniJAR) );
+  UniJAR* X = (UniJAR*) malloc( K*N*sizeof(UniJAR) );
+  UniJAR* C1 = (UniJAR*) malloc( M*N*sizeof(UniJAR) );
+  UniJAR* C2 = (UniJAR*) malloc( M*N*sizeof(UniJAR) );
+  UniJAR* E1 = (UniJAR*) malloc( M*B*sizeof(UniJAR) );
+  UniJAR* E2 = (UniJAR*) malloc( M*B*sizeof(UniJAR) );
+  unsigned char* A8 = (unsigned char*) malloc( M*K );
+  int* indices = (int*) malloc( 4*B*sizeof(int) );
+  int* offsets = (int*) malloc( (B+1)*sizeof(int) );
+  float* f_A = (float*) malloc( M*K*sizeof(float) );
+  float* f_X = (float*) malloc( K*N*sizeof(float) );
+  float width = (float)VAL_hi - (float)VAL_lo;
+  TensorJAR t[2];
+  const TensorJAR* ta;
+  const TensorJAR* ta8;
+  FileJAR* f;
+  struct timeval start;
+  struct timeval stop;
+  int i, mismatch = 0;
+
+  printf("Test: write a 32-bit and an 8-bit LogPS80 tensor to %s, map it and run the GEMM and \n", path);
+  printf("   embedding bag kernels on the mapped pages, comparing with the in-memory tensors \n");
+
+  init_float( f_A, M*K, (float)VAL_lo, width );
+  init_float( f_X, K*N, (float)VAL_lo, width );
+  init_JAR_update_float( A, f_A, M*K );
+  init_JAR_update_float( X, f_X, K*N );
+  jar_pack_PS8( (size_t)M*K, A, A8 );
+  for ( i=0; i<4*B; ++i ) indices[i] = rand() % K;
+  for ( i=0; i<=B; ++i ) offsets[i] = 4*i;
+
+  t[0].name = "A";  t[0].rows = M; t[0].cols = K; t[0].ld = M; t[0].layout = JAR_LAYOUT_COLMAJOR;
+  t[0].encoding = JAR_ENC_LOGPS80; t[0].shift = 0; t[0].data = A;
+  t[1] = t[0];
+  t[1].name = "A8"; t[1].encoding = JAR_ENC_PS8; t[1].data = A8;
+  if ( jar_file_write( path, 2, t ) != 0 ) {
+    printf("cannot write %s\n", path);
+    return;
+  }
+
+  gettimeofday(&start, NULL);
+  f = jar_file_open( path );
+  gettimeofday(&stop, NULL);
+  if ( f == NULL ) {
+    printf("cannot open %s\n", path);
+    return;
+  }
+  ta  = jar_file_find( f, "A" );
+  ta8 = jar_file_find( f, "A8" );
+  printf("opened %s with %i tensors in %f seconds\n", path, f->ntensors, time_in_sec( start, stop ));
+
+  jar_matmul_avx512( M, N, K, A, X, C1 );
+  jar_matmul_avx512( ta->rows, N, ta->cols, (const UniJAR*)ta->data, X, C2 );
+  for ( i=0; i<M*N; ++i ) mismatch += ( C1[i].I != C2[i].I );
+  printf("number of GEMM mismatches between the in-memory and mapped tensor         is %i\n", mismatch);
+
+  mismatch = 0;
+  jar_embedding_bag_PS8_avx512( M, B, A8, indices, offsets, NULL, E1 );
+  jar_embedding_bag_PS8_avx512( ta8->rows, B, (const unsigned char*)ta8->data, indices, offsets, NULL, E2 );
+  for ( i=0; i<M*B; ++i ) mismatch += ( E1[i].I != E2[i].I );
+  printf("number of embedding bag mismatches between the in-memory and mapped table is %i\n", mismatch);
+
+  jar_file_close( f );
+  remove( path );
+
+  free( f_X );
+  free( f_A );
+  free( offsets );
+  free( indices );
+  free( A8 );
+  free( E2 );
+  free( E1 );
+  free( C2 );
+  free( C1 );
+  free( X );
+  free( A );
+}
+
+void test_ooc( const int M, const int N, const int K ) {
+  const char* path_in  = "demo_ooc_in.jar";
+  const char* path_out = "demo_ooc_out.jar";
+  UniJAR* A = (UniJAR*) malloc( (size_t)M*K*sizeof(UniJAR) );
+  UniJAR* B = (UniJAR*) malloc( (size_t)K*N*sizeof(UniJAR) );
+  UniJAR* C = (UniJAR*) malloc( (size_t)M*N*sizeof(UniJAR) );
+  float* f_A = (float*) malloc( (size_t)M*K*sizeof(float) );
+  float* f_B = (float*) malloc( (size_t)K*N*sizeof(float) );
+  float width = (float)VAL_hi - (float)VAL_lo;
+  TensorJAR t[2];
+  FileJAR* fin;
+  FileJAR* fout;
+  FILE* fp;
+  struct timeval start;
+  struct timeval stop;
+  double time_mem, time_ooc;
+  size_t i, mismatch = 0;
+  int rc;
+
+  printf("Test: multiply A and B from a memory-mapped .jar file out of core with a 1 MB budget, \n");
+  printf("   write C to a second .jar file and compare it with the in-memory JAR matmul \n");
+
+  init_float( f_A, M*K, (float)VAL_lo, width );
+  init_float( f_B, K*N, (float)VAL_lo, width );
+  init_JAR_update_float( A, f_A, M*K );
+  init_JAR_update_float( B, f_B, K*N );
+
+  t[0].name = "A"; t[0].rows = M; t[0].cols = K; t[0].ld = M; t[0].layout = JAR_LAYOUT_COLMAJOR;
+  t[0].encoding = JAR_ENC_LOGPS80; t[0].shift = 0; t[0].data = A;
+  t[1] = t[0];
+  t[1].name = "B"; t[1].rows = K; t[1].cols = N; t[1].ld = K; t[1].data = B;
+  if ( jar_file_write( path_in, 2, t ) != 0 ) {
+    printf("cannot write %s\n", path_in);
+    return;
+  }
+  t[0].name = "C"; t[0].rows = M; t[0].cols = N; t[0].ld = M; t[0].data = NULL;
+  fp = fopen( path_out, "w+b" );
+  if ( fp == NULL || jar_file_write_header( fp, 1, t ) != 0 || fflush( fp ) != 0 ||
+       ftruncate( fileno( fp ), (off_t)jar_file_payload_offset( 1, t, 1 ) ) != 0 ) {
+    printf("cannot write %s\n", path_out);
+    return;
+  }
+
+  gettimeofday(&start, NULL);
+  jar_matmul_avx512( M, N, K, A, B, C );
+  gettimeofday(&stop, NULL);
+  time_mem = time_in_sec( start, stop );
+
+  fin = jar_file_open( path_in );
+  gettimeofday(&start, NULL);
+  rc = jar_matmul_ooc( jar_file_find( fin, "A" ), jar_file_find( fin, "B" ), fileno( fp ),
+                       jar_file_payload_offset( 1, t, 0 ), JAR_OOC_MIN_MEM );
+  gettimeofday(&stop, NULL);
+  time_ooc = time_in_sec( start, stop );
+  fclose( fp );
+  jar_file_close( fin );
+
+  fout = jar_file_open( path_out );
+  if ( rc != 0 || fout == NULL ) {
+    printf("out-of-core matmul failed\n");
+    return;
+  }
+  for ( i=0; i<(size_t)M*N; ++i ) {
+    mismatch += ( C[i].I != ((const UniJAR*)fout->tensors[0].data)[i].I );
+  }
+  jar_file_close( fout );
+  remove( path_in );
+  remove( path_out );
+
+  printf("number of mismatches between the in-memory and out-of-core matmul is %lu\n", (unsigned long)mismatch);
+  printf("time for the in-memory (single thread) GEMM M=%i, N=%i, K=%i is %f seconds\n", M, N, K, time_mem);
+  printf("time for the out-of-core GEMM M=%i, N=%i, K=%i             is %f seconds\n", M, N, K, time_ooc);
+
+  free( f_B );
+  free( f_A );
+  free( C );
+  free( B );
+  free( A );
+}
+
+void test_mem( const int H, const int T ) {
+  const int I = H, reps = 100;
+  const size_t nw = (size_t)(4*H)*(I+H);
+  UniJAR* W = (UniJAR*) jar_malloc_huge( nw*sizeof(UniJAR) );
+  UniJAR* bias = (UniJAR*) jar_malloc( 4*H*sizeof(UniJAR) );
+  UniJAR* X = (UniJAR*) jar_malloc( (size_t)I*T*sizeof(UniJAR) );
+  UniJAR* h = (UniJAR*) jar_malloc( H*sizeof(UniJAR) );
+  UniJAR* c = (UniJAR*) jar_malloc( H*sizeof(UniJAR) );
+  float* f = (float*) malloc( nw*sizeof(float) );
+  float width = (float)VAL_hi - (float)VAL_lo;
+  MemStatsJAR s0, s1, s2;
+  ArenaJAR a;
+  size_t mark;
+  char* p1;
+  char* p2;
+  int i;
+
+  printf("Test: JAR memory: aligned and huge-page allocation, arenas, and the allocation count of \n");
+  printf("   repeated LSTM sequences whose workspace comes from the per-thread arena \n");
+
+  init_float( f, nw, -0.5f, 1.0f );
+  init_JAR_update_float( W, f, nw );
+  init_float( f, 4*H, -0.5f, 1.0f );
+  init_JAR_update_float( bias, f, 4*H );
+  init_float( f, I*T, (float)VAL_lo, width );
+  init_JAR_update_float( X, f, I*T );
+  for ( i=0; i<H; ++i ) { h[i].I = JAR_ZERO; c[i].I = JAR_ZERO; }
+
+  printf("weights (%lu bytes) at %p, bias at %p: %s\n", (unsigned long)(nw*sizeof(UniJAR)), (void*)W, (void*)bias,
+         ( ((size_t)W | (size_t)bias | (size_t)X) % JAR_ALIGN == 0 ) ? "aligned" : "NOT aligned");
+
+  jar_arena_init( &a, 256 );
+  mark = jar_arena_mark( &a );
+  p1 = (char*) jar_arena_alloc( &a, 100 );
+  p2 = (char*) jar_arena_alloc( &a, 1000 );
+  jar_arena_release( &a, mark );
+  p1 = (char*) jar_arena_alloc( &a, 100 );
+  p2 = (char*) jar_arena_alloc( &a, 1000 );
+  printf("arena capacity after a 1100 byte cycle is %lu bytes, second cycle %s\n", (unsigned long)a.size,
+         ( a.overflow == NULL && p2 == p1 + 128 ) ? "without allocation" : "allocates");
+  jar_arena_release( &a, 0 );
+  jar_arena_destroy( &a );
+
+  jar_lstm_seq_avx512( I, H, T, W, bias, X, h, c, NULL );
+  jar_mem_stats( &s0 );
+  for ( i=0; i<reps; ++i ) {
+    jar_lstm_seq_avx512( I, H, T, W, bias, X, h, c, NULL );
+  }
+  jar_mem_stats( &s1 );
+  printf("allocations in %i LSTM sequences after the first one is %lu\n", reps, (unsigned long)(s1.nalloc - s0.nalloc));
+  printf("live bytes %lu, peak bytes %lu, allocations %lu, huge-page allocations %lu\n",
+         (unsigned long)s1.live, (unsigned long)s1.peak, (unsigned long)s1.nalloc, (unsigned long)s1.nhuge);
+
+  jar_workspace_destroy();
+  free( f );
+  jar_free( c );
+  jar_free( h );
+  jar_free( X );
+  jar_free( bias );
+  jar_free( W );
+  jar_mem_stats( &s2 );
+  printf("live bytes after freeing everything is %lu\n", (unsigned long)s2.live);
+}
+
+void test_numa( const int M, const int K ) {
+  const int N = 24, reps = 100;
+  UniJAR* A = (UniJAR*) jar_malloc( (size_t)M*K*sizeof(UniJAR) );
+  UniJAR* B = (UniJAR*) jar_malloc( (size_t)K*N*sizeof(UniJAR) );
+  UniJAR* C1 = (UniJAR*) jar_malloc( (size_t)M*N*sizeof(UniJAR) );
+  UniJAR* C2 = (UniJAR*) jar_malloc( (size_t)M*N*sizeof(UniJAR) );
+  float* f = (float*) malloc( (size_t)M*K*sizeof(float) );
+  float width = (float)VAL_hi - (float)VAL_lo;
+  NumaJAR numa;
+  PartMatJAR* P;
+  ReplJAR* R;
+  struct timeval start;
+  struct timeval stop;
+  double time_1, time_p;
+  int i, mismatch = 0;
+
+  printf("Test: matrix vector and matrix matrix products with the rows of A partitioned over the \n");
+  printf("   pinned threads and first-touched on their NUMA nodes, compared with jar_matvecmul_avx512 \n");
+  printf("   and jar_matmul_avx512 \n");
+
+  init_float( f, M*K, (float)VAL_lo, width );
+  init_JAR_update_float( A, f, M*K );
+  init_float( f, K*N, (float)VAL_lo, width );
+  init_JAR_update_float( B, f, K*N );
+
+  jar_numa_init( &numa );
+  printf("%i NUMA node(s), %i cpu(s)\n", numa.nnodes, numa.ncpus);
+  jar_numa_pin_threads( &numa );
+  P = jar_numa_partition( M, K, A, M );
+  R = jar_numa_replicate( &numa, K*N, B );
+
+  jar_matvecmul_avx512( M, K, A, B, C1 );
+  jar_numa_matvecmul( P, jar_numa_local( &numa, R ), C2 );
+  for ( i=0; i<M; ++i ) mismatch += ( C1[i].I != C2[i].I );
+  jar_matmul_avx512( M, N, K, A, B, C1 );
+  jar_numa_matmul( P, N, jar_numa_local( &numa, R ), C2 );
+  for ( i=0; i<M*N; ++i ) mismatch += ( C1[i].I != C2[i].I );
+  printf("number of mismatches                                   is %i\n", mismatch);
+
+  gettimeofday(&start, NULL);
+  for ( i=0; i<reps; ++i ) jar_matvecmul_avx512( M, K, A, B, C1 );
+  gettimeofday(&stop, NULL);
+  time_1 = time_in_sec( start, stop )/(double)reps;
+  gettimeofday(&start, NULL);
+  for ( i=0; i<reps; ++i ) jar_numa_matvecmul( P, B, C2 );
+  gettimeofday(&stop, NULL);
+  time_p = time_in_sec( start, stop )/(double)reps;
+  printf("matvec M=%i, K=%i: jar_matvecmul_avx512 %f seconds, %i partitions %f seconds, %f GB/s\n",
+         M, K, time_1, P->nparts, time_p, ((double)M*K*sizeof(UniJAR)/time_p)/1.0e9);
+
+  jar_numa_replicate_free( R );
+  jar_numa_partition_free( P );
+  jar_numa_destroy( &numa );
+  free( f );
+  jar_free( C2 );
+  jar_free( C1 );
+  jar_free( B );
+  jar_free( A );
+}
+
+typedef struct{
+  PoolJAR*  pool;
+  int*      hits;
+  int       n;
+  int       nouter;
+} PoolTestArg;
+
+static void pool_count_task( void* arg, const int t ) {
+  PoolTestArg* a = (PoolTestArg*)arg;
+  a->hits[t]++;
+}
+
+static void pool_nested_task( void* arg, const int t ) {
+  PoolTestArg* a = (PoolTestArg*)arg;
+  PoolTestArg inner = *a;
+  const int lo = (int)(((long)a->n*t)/a->nouter);
+  const int hi = (int)(((long)a->n*(t+1))/a->nouter);
+
+  inner.hits = a->hits + lo;
+  jar_pool_parallel_for( a->pool, hi-lo, pool_count_task, &inner );
+}
+
+static void* pool_attach_thread( void* p ) {
+  jar_pool_attach( (PoolJAR*)p );
+  return NULL;
+}
+
+static int pool_check_hits( int* hits, const int n, const int expect ) {
+  int i, bad = 0;
+
+  for ( i=0; i<n; ++i ) {
+    bad += ( hits[i] != expect );
+    hits[i] = 0;
+  }
+  return bad;
+}
+
+void test_pool( const int size ) {
+  const int reps = 20, nworkers = 3;
+  UniJAR* x = (UniJAR*) malloc( size*sizeof(UniJAR) );
+  UniJAR* y1 = (UniJAR*) malloc( size*sizeof(UniJAR) );
+  UniJAR* y2 = (UniJAR*) malloc( size*sizeof(UniJAR) );
+  int* hits = (int*) calloc( size, sizeof(int) );
+  float* f_x = (float*) malloc( size*sizeof(float) );
+  float width = (float)VAL_hi - (float)VAL_lo;
+  PoolJAR* pool = jar_pool_create( nworkers, JAR_POOL_SPIN );
+  PoolJAR* serial = jar_pool_create( 0, JAR_POOL_SPIN );
+  PoolJAR* dflt = jar_pool_default();
+  PoolTestArg a;
+  pthread_t helper;
+  struct timeval start;
+  struct timeval stop;
+  double time_1, time_p;
+  int i, bad = 0, mismatch = 0;
+
+  printf("Test: work-stealing thread pool: every task of a loop runs exactly once, also for nested \n");
+  printf("   loops and with an attached application thread, and pooled conversion LinFP32 --> LogPS80 \n");
+  printf("   is identical to serial conversion \n");
+
+  a.pool = pool; a.hits = hits; a.n = size; a.nouter = 7;
+  for ( i=0; i<reps; ++i ) {
+    jar_pool_parallel_for( pool, size, pool_count_task, &a );
+  }
+  bad += pool_check_hits( hits, size, reps );
+  jar_pool_parallel_for( pool, a.nouter, pool_nested_task, &a );
+  bad += pool_check_hits( hits, size, 1 );
+  pthread_create( &helper, NULL, pool_attach_thread, pool );
+  while ( jar_pool_attached( pool ) == 0 ) sched_yield();
+  for ( i=0; i<reps; ++i ) {
+    jar_pool_parallel_for( pool, size, pool_count_task, &a );
+  }
+  jar_pool_detach( pool );
+  pthread_join( helper, NULL );
+  bad += pool_check_hits( hits, size, reps );
+  printf("pool of %i threads, tasks not run exactly once         is %i\n", jar_pool_size( pool ), bad);
+
+  init_float( f_x, size, (float)VAL_lo, width );
+  for ( i=0; i<size; ++i ) x[i].F = f_x[i];
+
+  jar_pool_set_default( serial );
+  gettimeofday(&start, NULL);
+  for ( i=0; i<reps; ++i ) jar_convert_LinFP32_2_LogPS80( size, x, y1, NULL );
+  gettimeofday(&stop, NULL);
+  time_1 = time_in_sec( start, stop )/(double)reps;
+  jar_pool_set_default( pool );
+  gettimeofday(&start, NULL);
+  for ( i=0; i<reps; ++i ) jar_convert_LinFP32_2_LogPS80( size, x, y2, NULL );
+  gettimeofday(&stop, NULL);
+  time_p = time_in_sec( start, stop )/(double)reps;
+  jar_pool_set_default( dflt );
+  for ( i=0; i<size; ++i ) mismatch += ( y1[i].I != y2[i].I );
+  printf("number of mismatches pooled vs serial conversion       is %i\n", mismatch);
+  printf("conversion of %i values: serial %f seconds, pool of %i threads %f seconds\n",
+         size, time_1, jar_pool_size( pool ), time_p);
+
+  jar_pool_destroy( serial );
+  jar_pool_destroy( pool );
+  free( f_x );
+  free( hits );
+  free( y2 );
+  free( y1 );
+  free( x );
+}
+
+static void async_count( void* arg ) {
+  __atomic_add_fetch( (int*)arg, 1, __ATOMIC_ACQ_REL );
+}
+
+void test_async( const int M, const int N, const int K ) {
+  const int H = 4;
+  UniJAR* A = (UniJAR*) malloc( (size_t)H*M*K*sizeof(UniJAR) );
+  UniJAR* X = (UniJAR*) malloc( (size_t)K*N*sizeof(UniJAR) );
+  UniJAR* Xc = (UniJAR*) malloc( (size_t)K*N*sizeof(UniJAR) );
+  UniJAR* C1 = (UniJAR*) malloc( (size_t)H*M*N*sizeof(UniJAR) );
+  UniJAR* C2 = (UniJAR*) malloc( (size_t)H*M*N*sizeof(UniJAR) );
+  UniJAR* y1 = (UniJAR*) malloc( (size_t)M*sizeof(UniJAR) );
+  UniJAR* y2 = (UniJAR*) malloc( (size_t)M*sizeof(UniJAR) );
+  float* f = (float*) malloc( (size_t)H*M*K*sizeof(float) );
+  float width = (float)VAL_hi - (float)VAL_lo;
+  EventJAR* ev[6];
+  QueueJAR* q;
+  UniJAR z1, z2;
+  struct timeval start;
+  struct timeval stop;
+  double time_s, time_a;
+  int i, h, l, nq, ncb = 0, mismatch = 0;
+
+  printf("Test: asynchronous submission of %i independent heads C_h = A_h * X behind the conversion\n", H);
+  printf("   of X, with a matrix vector and a dot product depending on them, compared with the \n");
+  printf("   synchronous calls, on a queue without executors and one with an executor per cpu \n");
+
+  init_float( f, H*M*K, (float)VAL_lo, width );
+  init_JAR_update_float( A, f, H*M*K );
+  init_float( f, K*N, (float)VAL_lo, width );
+  for ( i=0; i<K*N; ++i ) X[i].F = f[i];
+
+  gettimeofday(&start, NULL);
+  jar_convert_LinFP32_2_LogPS80( (size_t)K*N, X, Xc, NULL );
+  for ( h=0; h<H; ++h ) {
+    jar_matmul_avx512( M, N, K, A+(size_t)h*M*K, Xc, C1+(size_t)h*M*N );
+  }
+  gettimeofday(&stop, NULL);
+  time_s = time_in_sec( start, stop );
+  jar_matvecmul_avx512( M, K, A, Xc, y1 );
+  z1 = jar_dotprod( M*N, C1, C1+(size_t)M*N );
+
+  for ( l=0; l<2; ++l ) {
+    q = jar_queue_create( (l == 0) ? 0 : -1 );
+    nq = (l == 0) ? 0 : (int)sysconf( _SC_NPROCESSORS_ONLN );
+    memset( C2, 0, (size_t)H*M*N*sizeof(UniJAR) );
+    memset( Xc, 0, (size_t)K*N*sizeof(UniJAR) );
+    z2.I = 0;
+
+    gettimeofday(&start, NULL);
+    ev[0] = jar_convert_async( q, (size_t)K*N, X, Xc, NULL, 0, NULL );
+    for ( h=0; h<H; ++h ) {
+      ev[1+h] = jar_matmul_async( q, M, N, K, A+(size_t)h*M*K, Xc, C2+(size_t)h*M*N, 1, ev );
+      jar_event_then( ev[1+h], async_count, &ncb );
+    }
+    for ( h=0; h<H; ++h ) {
+      jar_event_wait( ev[1+h] );
+    }
+    gettimeofday(&stop, NULL);
+    time_a = time_in_sec( start, stop );
+
+    jar_event_release( jar_matvecmul_async( q, M, K, A, Xc, y2, 1, ev ) );
+    ev[5] = jar_dotprod_async( q, M*N, C2, C2+(size_t)M*N, &z2, 2, ev+1 );
+    printf("%i executor(s): dot product complete before waiting: %s\n", nq, jar_event_test( ev[5] ) ? "yes" : "no");
+    jar_queue_wait_all( q );
+    for ( i=0; i<6; ++i ) jar_event_release( ev[i] );
+    jar_queue_destroy( q );
+
+    for ( i=0; i<H*M*N; ++i ) mismatch += ( C1[i].I != C2[i].I );
+    for ( i=0; i<M; ++i ) mismatch += ( y1[i].I != y2[i].I );
+    mismatch += ( z1.I != z2.I );
+    printf("%i executor(s): %i heads synchronous %f seconds, asynchronous %f seconds\n", nq, H, time_s, time_a);
+  }
+  printf("number of completion callbacks (expected %i)                is %i\n", 2*H, ncb);
+  printf("number of mismatches                                    is %i\n", mismatch);
+
+  free( f );
+  free( y2 );
+  free( y1 );
+  free( C2 );
+  free( C1 );
+  free( Xc );
+  free( X );
+  free( A );
+}
+
+static void ref_bias_relu( const int M, const int N, UniJAR* Y, const UniJAR* b ) {
+  int m, n;
+
+  for ( n=0; n<N; ++n ) {
+    for ( m=0; m<M; ++m ) {
+      UniJAR v = LogPS80_2_LinFP32( Y[n*M+m] );
+      v.F += LogPS80_2_LinFP32( b[m] ).F;
+      Y[n*M+m] = LinFP32_2_LogPS80( v );
+      if ( Y[n*M+m].I & SIGN_MASK ) Y[n*M+m].I = JAR_ZERO;
+    }
+  }
+}
+
+void test_graph( const int D, const int L, const int N ) {
+  const int reps = 10;
+  UniJAR* W = (UniJAR*) jar_malloc( (size_t)(L+4)*D*D*sizeof(UniJAR) );
+  UniJAR* b = (UniJAR*) jar_malloc( (size_t)(L+3)*D*sizeof(UniJAR) );
+  UniJAR* X = (UniJAR*) jar_malloc( (size_t)D*N*sizeof(UniJAR) );
+  UniJAR* Y1 = (UniJAR*) jar_malloc( (size_t)D*N*sizeof(UniJAR) );
+  UniJAR* Y2 = (UniJAR*) jar_malloc( (size_t)D*N*sizeof(UniJAR) );
+  UniJAR* Y3 = (UniJAR*) jar_malloc( (size_t)D*N*sizeof(UniJAR) );
+  UniJAR* T1 = (UniJAR*) jar_malloc( (size_t)2*D*N*sizeof(UniJAR) );
+  UniJAR* T2 = (UniJAR*) jar_malloc( (size_t)2*D*N*sizeof(UniJAR) );
+  float* f = (float*) malloc( (size_t)(L+4)*D*D*sizeof(float) );
+  UniJAR* Wup = W + (size_t)L*D*D;
+  UniJAR* Wdn = Wup + (size_t)2*D*D;
+  GraphJAR g;
+  MemStatsJAR s0, s1;
+  struct timeval start;
+  struct timeval stop;
+  double time_r, time_u, time_f, err = 0.0, norm = 0.0;
+  int i, l, v, r, mismatch = 0;
+
+  printf("Test: graph executor on %i GEMM + bias + ReLU layers followed by an RMSNorm / up / ReLU / \n", L);
+  printf("   down / residual block, unfused against the kernels called one by one, and fused \n");
+
+  init_float( f, (L+4)*D*D, -0.1f, 0.2f );
+  init_JAR_update_float( W, f, (L+4)*D*D );
+  init_float( f, (L+3)*D, -0.5f, 1.0f );
+  init_JAR_update_float( b, f, (L+3)*D );
+  init_float( f, D*N, (float)VAL_lo, (float)VAL_hi - (float)VAL_lo );
+  init_JAR_update_float( X, f, D*N );
+  for ( i=0; i<D; ++i ) b[(L+2)*D+i] = two_2_k( 0 );
+
+  jar_graph_init( &g, D, N );
+  v = 0;
+  for ( l=0; l<L; ++l ) {
+    v = jar_graph_act( &g, jar_graph_bias( &g, jar_graph_gemm( &g, v, D, W+(size_t)l*D*D ), b+l*D ), JAR_OP_RELU );
+  }
+  i = jar_graph_rmsnorm( &g, v, b+(L+2)*D, 1.0e-5f );
+  i = jar_graph_act( &g, jar_graph_bias( &g, jar_graph_gemm( &g, i, 2*D, Wup ), b+L*D ), JAR_OP_RELU );
+  jar_graph_add( &g, jar_graph_gemm( &g, i, D, Wdn ), v );
+
+  /* the kernels one by one */
+  gettimeofday(&start, NULL);
+  for ( r=0; r<reps; ++r ) {
+    memcpy( T1, X, (size_t)D*N*sizeof(UniJAR) );
+    for ( l=0; l<L; ++l ) {
+      jar_matmul_avx512( D, N, D, W+(size_t)l*D*D, T1, T2 );
+      ref_bias_relu( D, N, T2, b+l*D );
+      memcpy( T1, T2, (size_t)D*N*sizeof(UniJAR) );
+    }
+    jar_rmsnorm_avx512( D, N, T1, b+(L+2)*D, 1.0e-5f, Y3 );
+    jar_matmul_avx512( 2*D, N, D, Wup, Y3, T2 );
+    ref_bias_relu( 2*D, N, T2, b+L*D );
+    jar_matmul_avx512( D, N, 2*D, Wdn, T2, Y1 );
+    for ( i=0; i<D*N; ++i ) {
+      UniJAR a = LogPS80_2_LinFP32( Y1[i] );
+      a.F += LogPS80_2_LinFP32( T1[i] ).F;
+      Y1[i] = LinFP32_2_LogPS80( a );
+    }
+  }
+  gettimeofday(&stop, NULL);
+  time_r = time_in_sec( start, stop )/(double)reps;
+
+  jar_graph_plan( &g, 0 );
+  printf("unfused: %i groups, arena %lu bytes\n", g.ngroups, (unsigned long)g.arena_size);
+  jar_graph_run( &g, X, Y2 );
+  jar_mem_stats( &s0 );
+  gettimeofday(&start, NULL);
+  for ( r=0; r<reps; ++r ) jar_graph_run( &g, X, Y2 );
+  gettimeofday(&stop, NULL);
+  jar_mem_stats( &s1 );
+  time_u = time_in_sec( start, stop )/(double)reps;
+  for ( i=0; i<D*N; ++i ) mismatch += ( Y1[i].I != Y2[i].I );
+  printf("number of mismatches unfused graph vs kernels         is %i\n", mismatch);
+  printf("allocations in %i unfused runs                        is %lu\n", reps, (unsigned long)(s1.nalloc - s0.nalloc));
+
+  jar_graph_plan( &g, 1 );
+  printf("fused:   %i groups, arena %lu bytes\n", g.ngroups, (unsigned long)g.arena_size);
+  jar_graph_run( &g, X, Y3 );
+  jar_mem_stats( &s0 );
+  gettimeofday(&start, NULL);
+  for ( r=0; r<reps; ++r ) jar_graph_run( &g, X, Y3 );
+  gettimeofday(&stop, NULL);
+  jar_mem_stats( &s1 );
+  time_f = time_in_sec( start, stop )/(double)reps;
+  for ( i=0; i<D*N; ++i ) {
+    double d = LogPS80_2_Lin_val( Y3[i] ) - LogPS80_2_Lin_val( Y2[i] );
+    err  = ( fabs(d) > err ) ? fabs(d) : err;
+    norm += fabs( LogPS80_2_Lin_val( Y2[i] ) );
+  }
+  printf("allocations in %i fused runs                          is %lu\n", reps, (unsigned long)(s1.nalloc - s0.nalloc));
+  printf("1-norm of the unfused result is %e, max difference of the fused result is %e\n", norm, err);
+  printf("D=%i, L=%i, N=%i: kernels %f seconds, unfused graph %f seconds, fused graph %f seconds\n",
+         D, L, N, time_r, time_u, time_f);
+
+  jar_graph_destroy( &g );
+  free( f );
+  jar_free( T2 );
+  jar_free( T1 );
+  jar_free( Y3 );
+  jar_free( Y2 );
+  jar_free( Y1 );
+  jar_free( X );
+  jar_free( b );
+  jar_free( W );
+}
+
+typedef struct{
+  const char*    path;
+  int            K;
+  int            M;
+  int            R;
+  const UniJAR*  X;
+  UniJAR*        Y;
+  int            failed;
+} ServeTestArg;
+
+static void* serve_client( void* p ) {
+  ServeTestArg* a = (ServeTestArg*)p;
+  ClientJAR c;
+  int r;
+
+  if ( jar_client_connect( &c, a->path, 1 ) != 0 ) {
+    a->failed = a->R;
+    return NULL;
+  }
+  for ( r=0; r<a->R; ++r ) {
+    memcpy( c.in, a->X + (size_t)r*a->K, a->K*sizeof(UniJAR) );
+    if ( jar_client_infer( &c, 1 ) != 0 ) {
+      a->failed++;
+      continue;
+    }
+    memcpy( a->Y + (size_t)r*a->M, c.out, a->M*sizeof(UniJAR) );
+  }
+  jar_client_close( &c );
+  return NULL;
+}
+
+static int serve_raw_connect( const char* path ) {
+/* a connection that has received the HELLO of the server, or -1 */
+  struct sockaddr_un addr;
+  MsgJAR m;
+  int fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+
+  memset( &addr, 0, sizeof(addr) );
+  addr.sun_family = AF_UNIX;
+  strncpy( addr.sun_path, path, sizeof(addr.sun_path)-1 );
+  if ( fd < 0 || connect( fd, (struct sockaddr*)&addr, sizeof(addr) ) != 0 ||
+       recv( fd, &m, sizeof(m), MSG_WAITALL ) != (ssize_t)sizeof(m) ) {
+    if ( fd >= 0 ) close( fd );
+    return -1;
+  }
+  return fd;
+}
+
+static int serve_short_segment( const char* path ) {
+/* passes an empty file as the segment for 4 vectors, returns 1 if the server refuses it */
+  char ctl[CMSG_SPACE(sizeof(int))];
+  struct msghdr h;
+  struct cmsghdr* cm;
+  struct iovec io;
+  MsgJAR m;
+  FILE* fp = tmpfile();
+  const int fd = serve_raw_connect( path );
+  int mfd, refused = 0;
+
+  if ( fp == NULL || fd < 0 ) {
+    if ( fp != NULL ) fclose( fp );
+    if ( fd >= 0 ) close( fd );
+    return 0;
+  }
+  mfd = fileno( fp );
+  memset( &m, 0, sizeof(m) );
+  m.type = JAR_MSG_HELLO;
+  m.n    = 4;
+  memset( &h, 0, sizeof(h) );
+  io.iov_base = &m;
+  io.iov_len  = sizeof(m);
+  h.msg_iov        = &io;
+  h.msg_iovlen     = 1;
+  h.msg_control    = ctl;
+  h.msg_controllen = sizeof(ctl);
+  cm = CMSG_FIRSTHDR( &h );
+  cm->cmsg_level = SOL_SOCKET;
+  cm->cmsg_type  = SCM_RIGHTS;
+  cm->cmsg_len   = CMSG_LEN(sizeof(int));
+  memcpy( CMSG_DATA( cm ), &mfd, sizeof(int) );
+  if ( sendmsg( fd, &h, 0 ) == (ssize_t)sizeof(m) ) {
+    const ssize_t r = recv( fd, &m, sizeof(m), MSG_WAITALL );
+    refused = ( r != (ssize_t)sizeof(m) || m.status != 0 );
+  }
+  close( fd );
+  fclose( fp );
+  return refused;
+}
+
+void test_serve( const int M, const int K, const int C ) {
+  const int R = 200, nl = 2;
+  UniJAR* W1 = (UniJAR*) jar_malloc( (size_t)M*K*sizeof(UniJAR) );
+  UniJAR* W2 = (UniJAR*) jar_malloc( (size_t)M*M*sizeof(UniJAR) );
+  UniJAR* X = (UniJAR*) jar_malloc( (size_t)K*C*R*sizeof(UniJAR) );
+  UniJAR* Y = (UniJAR*) jar_malloc( (size_t)M*C*R*sizeof(UniJAR) );
+  UniJAR* Yref = (UniJAR*) jar_malloc( (size_t)M*C*R*sizeof(UniJAR) );
+  float* f = (float*) malloc( (size_t)K*C*R*sizeof(float) );
+  const UniJAR* W[2];
+  int rows[2], cols[2];
+  ServeTestArg* a = (ServeTestArg*) malloc( C*sizeof(ServeTestArg) );
+  pthread_t* th = (pthread_t*) malloc( C*sizeof(pthread_t) );
+  ServerConfJAR conf;
+  ClientJAR ctl, half;
+  MsgJAR st;
+  GraphJAR g;
+  char path[64];
+  struct timeval start;
+  struct timeval stop;
+  double t;
+  int i, b, failed = 0, mismatch = 0, refused = 0, stall;
+  pid_t pid;
+
+  printf("Test: inference server with dynamic batching, %i clients sending %i single-vector requests \n", C, R);
+  printf("   each to a %i x %i / ReLU / %i x %i model, with batches of at most 1 and 32 vectors, \n", M, K, M, M);
+  printf("   while another client has sent half a message; a segment shorter than claimed is refused \n");
+
+  init_float( f, M*K, -0.1f, 0.2f );
+  init_JAR_update_float( W1, f, M*K );
+  init_float( f, M*M, -0.1f, 0.2f );
+  init_JAR_update_float( W2, f, M*M );
+  init_float( f, K*C*R, (float)VAL_lo, (float)VAL_hi - (float)VAL_lo );
+  init_JAR_update_float( X, f, K*C*R );
+  W[0] = W1; rows[0] = M; cols[0] = K;
+  W[1] = W2; rows[1] = M; cols[1] = M;
+  snprintf( path, sizeof(path), "/tmp/jar_demo_%i.sock", (int)getpid() );
+
+  /* the servers are forked before this process uses the thread pool */
+  for ( b=1; b<=32; b*=32 ) {
+    conf.path = path; conf.max_batch = b; conf.max_wait_us = 500; conf.relu = 1;
+    fflush( stdout );
+    pid = fork();
+    if ( pid == 0 ) {
+      _exit( jar_server_run( &conf, nl, W, rows, cols ) == 0 ? 0 : 1 );
+    }
+    for ( i=0; i<200 && jar_client_connect( &ctl, path, 1 ) != 0; ++i ) usleep( 10000 );
+    refused += serve_short_segment( path );
+    stall = jar_client_connect( &half, path, 1 );
+    if ( stall == 0 ) {
+      memset( &st, 0, sizeof(st) );
+      st.type = JAR_MSG_INFER;
+      st.n    = 1;
+      send( half.fd, &st, sizeof(st)/2, 0 );
+    }
+
+    gettimeofday(&start, NULL);
+    for ( i=0; i<C; ++i ) {
+      a[i].path = path; a[i].K = K; a[i].M = M; a[i].R = R; a[i].failed = 0;
+      a[i].X = X + (size_t)i*R*K;
+      a[i].Y = Y + (size_t)i*R*M;
+      pthread_create( th+i, NULL, serve_client, a+i );
+    }
+    for ( i=0; i<C; ++i ) {
+      pthread_join( th[i], NULL );
+      failed += a[i].failed;
+    }
+    gettimeofday(&stop, NULL);
+    t = time_in_sec( start, stop );
+
+    jar_client_stats( &ctl, &st );
+    printf("max batch %2i: %.0f requests/s, %.2f vectors per batch, latency p50 %.1f us, p99 %.1f us\n",
+           b, (double)C*R/t, (st.batches > 0) ? (double)st.count/(double)st.batches : 0.0, st.lat[0], st.lat[2]);
+    jar_client_shutdown( &ctl );
+    jar_client_close( &ctl );
+    if ( stall == 0 ) jar_client_close( &half );
+    waitpid( pid, NULL, 0 );
+  }
+
+  jar_graph_init( &g, K, C*R );
+  jar_graph_gemm( &g, jar_graph_act( &g, jar_graph_gemm( &g, 0, M, W1 ), JAR_OP_RELU ), M, W2 );
+  jar_graph_plan( &g, 1 );
+  jar_graph_run( &g, X, Yref );
+  for ( i=0; i<M*C*R; ++i ) mismatch += ( Y[i].I != Yref[i].I );
+  printf("number of failed requests                             is %i\n", failed);
+  printf("number of short segments accepted                     is %i\n", 2 - refused);
+  printf("number of mismatches against one local batch          is %i\n", mismatch);
+
+  jar_graph_destroy( &g );
+  free( th );
+  free( a );
+  free( f );
+  jar_free( Yref );
+  jar_free( Y );
+  jar_free( X );
+  jar_free( W2 );
+  jar_free( W1 );
+}
+
+void test_trace( const int M, const int N, const int K ) {
+  UniJAR* A = (UniJAR*) malloc( (size_t)M*K*sizeof(UniJAR) );
+  UniJAR* B = (UniJAR*) malloc( (size_t)K*N*sizeof(UniJAR) );
+  UniJAR* C0 = (UniJAR*) malloc( (size_t)M*N*sizeof(UniJAR) );
+  UniJAR* C = (UniJAR*) malloc( (size_t)M*N*sizeof(UniJAR) );
+  unsigned char* p = (unsigned char*) malloc( (size_t)M*K );
+  float* f = (float*) malloc( (size_t)M*K*sizeof(float) );
+  float width = (float)VAL_hi - (float)VAL_lo;
+  const char* mode[3] = { "off", "counters", "counters+events" };
+  const int flags[3] = { 0, JAR_TRACE_COUNT, JAR_TRACE_COUNT | JAR_TRACE_EVENTS };
+  struct timeval start;
+  struct timeval stop;
+  double time[3];
+  TraceJAR s;
+  int i, l, r, reps, mismatch = 0;
+
+  printf("Test: instrumentation of the JAR kernels, %i x %i x %i products with instrumentation off,\n", M, N, K);
+  printf("   with counters and with counters and events, a per-kernel / per-phase summary and a \n");
+  printf("   Chrome trace of the events in jar_trace.json \n");
+
+  init_float( f, M*K, (float)VAL_lo, width );
+  init_JAR_update_float( A, f, M*K );
+  init_float( f, K*N, (float)VAL_lo, width );
+  init_JAR_update_float( B, f, K*N );
+
+  gettimeofday(&start, NULL);
+  jar_matmul_avx512( M, N, K, A, B, C0 );
+  gettimeofday(&stop, NULL);
+  reps = (int)(0.1/(time_in_sec( start, stop ) + 1.0e-7)) + 1;
+  for ( r=0; r<reps; ++r ) {
+    jar_matmul_avx512( M, N, K, A, B, C );
+  }
+
+  for ( l=0; l<3; ++l ) {
+    jar_trace_enable( flags[l] );
+    jar_trace_reset();
+    gettimeofday(&start, NULL);
+    for ( r=0; r<reps; ++r ) {
+      jar_matmul_avx512( M, N, K, A, B, C );
+    }
+    gettimeofday(&stop, NULL);
+    time[l] = time_in_sec( start, stop );
+    for ( i=0; i<M*N; ++i ) mismatch += ( C[i].I != C0[i].I );
+    jar_trace_snapshot( &s );
+    mismatch += ( (int)s.stat[JAR_TK_MATMUL][JAR_TP_COMPUTE].calls != ((l > 0) ? reps : 0) );
+    printf("instrumentation %-16s %i products in %f seconds, overhead %6.2f%%\n", mode[l], reps, time[l],
+           100.0*(time[l] - time[0])/time[0]);
+  }
+
+  jar_matvecmul_avx512( M, K, A, B, C );
+  jar_convert_LinFP32_2_LogPS80( (size_t)M*K, A, A, NULL );
+  jar_pack_PS8( (size_t)M*K, A, p );
+  jar_unpack_PS8( (size_t)M*K, p, A );
+  jar_trace_snapshot( &s );
+  jar_trace_print( stdout, &s );
+  if ( jar_trace_export( "jar_trace.json" ) != 0 ) {
+    printf("cannot write jar_trace.json\n");
+    ++mismatch;
+  }
+  jar_trace_enable( 0 );
+  printf("number of mismatches                                    is %i\n", mismatch);
+
+  free( f );
+  free( p );
+  free( C );
+  free( C0 );
+  free( B );
+  free( A );
+}
+
+static void ref_numstat( NumStatJAR* r, const size_t n, const UniJAR* x ) {
+/* classifies the LinFP32 values x as jar_numstat documents it */
+  UniJAR y;
+  size_t i;
+  int m;
+
+  for ( i=0; i<n; ++i ) {
+    r->values++;
+    if ( (x[i].I & CLEAR_SIGN) <= JAR_ZERO ) {
+      r->zero++;
+      continue;
+    }
+    y = rnd_2_L_frac( x[i], LOG2_IND_BITS );
+    m = (int)((y.I & BEXP_MASK) >> 23) - 127;
+    r->flush += ( m <= -7 );
+    r->saturate += ( m >= 6 );
+    m = (int)((x[i].I & BEXP_MASK) >> 23) - 127;
+    if ( m > r->max_exp ) r->max_exp = m;
+  }
+}
+
+static int numstat_differ( const NumStatJAR* s, const NumStatJAR* r ) {
+  return ( s->values != r->values || s->zero != r->zero || s->flush != r->flush ||
+           s->saturate != r->saturate || s->max_exp != r->max_exp );
+}
+
+void test_numstat( const int M, const int N, const int K ) {
+  UniJAR* A = (UniJAR*) malloc( (size_t)M*K*sizeof(UniJAR) );
+  UniJAR* B = (UniJAR*) malloc( (size_t)K*N*sizeof(UniJAR) );
+  UniJAR* C = (UniJAR*) malloc( (size_t)M*N*sizeof(UniJAR) );
+  UniJAR* X = (UniJAR*) malloc( (size_t)M*K*sizeof(UniJAR) );
+  float* f = (float*) malloc( (size_t)M*K*sizeof(float) );
+  float width = (float)VAL_hi - (float)VAL_lo;
+  const float scale[3] = { 1.0f, 32.0f, 1.0f/256.0f };
+  NumStatJAR s[JAR_NUMSTAT_TAGS];
+  NumStatJAR r;
+  struct timeval start;
+  struct timeval stop;
+  double time_off, time_on;
+  int i, l, prev, reps, mismatch = 0;
+
+  printf("Test: numerical event counters of the conversions of %i x %i x %i products with inputs\n", M, N, K);
+  printf("   scaled by 1, 32 and 1/256 (jar_matmul_avx512 under tags 1-3, jar_matmul under tags 11-13),\n");
+  printf("   against a reference classification of the accumulators, and of a pooled conversion of \n");
+  printf("   data with zeros (tag 4) \n");
+
+  init_float( f, K*N, (float)VAL_lo, width );
+  init_JAR_update_float( B, f, K*N );
+  jar_numstat_enable( 1 );
+  jar_numstat_reset();
+  for ( l=0; l<3; ++l ) {
+    init_float( f, M*K, (float)VAL_lo*scale[l], width*scale[l] );
+    init_JAR_update_float( A, f, M*K );
+    for ( i=0; i<M*N; ++i ) C[i].I = JAR_ZERO;
+    jar_matmulacc( M, N, K, A, M, B, K, C, M );
+    jar_numstat_init( &r );
+    ref_numstat( &r, (size_t)M*N, C );
+    r.calls = 1;
+
+    prev = jar_numstat_tag( 1+l );
+    jar_matmul_avx512( M, N, K, A, B, C );
+    jar_numstat_tag( 11+l );
+    jar_matmul( M, N, K, A, B, C );
+    jar_numstat_tag( prev );
+    jar_numstat_snapshot( s );
+    mismatch += numstat_differ( s+1+l, &r ) + numstat_differ( s+11+l, &r );
+    printf("scale %9.6f: reference zero %llu, flush %llu, saturate %llu, max exp %lli\n", scale[l],
+           (unsigned long long)r.zero, (unsigned long long)r.flush, (unsigned long long)r.saturate, (long long)r.max_exp);
+  }
+
+  init_float( f, M*K, (float)VAL_lo, width );
+  for ( i=0; i<M*K; ++i ) X[i].F = ( i % 4 == 0 ) ? 0.0f : f[i];
+  jar_numstat_init( &r );
+  ref_numstat( &r, (size_t)M*K, X );
+  prev = jar_numstat_tag( 4 );
+  jar_convert_LinFP32_2_LogPS80( (size_t)M*K, X, A, NULL );
+  jar_numstat_tag( prev );
+  jar_numstat_snapshot( s );
+  mismatch += ( s[4].values != r.values || s[4].zero != r.zero || s[4].flush != r.flush || s[4].saturate != r.saturate );
+  jar_numstat_print( stdout, s );
+
+  /* alternate, best of three each */
+  reps = (int)(3.0e7/(2.0*M*N*K + 1.0)) + 1;
+  time_off = time_on = 1.0e30;
+  for ( l=0; l<6; ++l ) {
+    jar_numstat_enable( l % 2 );
+    gettimeofday(&start, NULL);
+    for ( i=0; i<reps; ++i ) jar_matmul_avx512( M, N, K, A, B, C );
+    gettimeofday(&stop, NULL);
+    if ( l % 2 == 0 ) time_off = fmin( time_off, time_in_sec( start, stop ) );
+    else time_on = fmin( time_on, time_in_sec( start, stop ) );
+  }
+  jar_numstat_enable( 0 );
+  printf("%i products, counting off %f seconds, on %f seconds, overhead %6.2f%%\n", reps, time_off, time_on,
+         100.0*(time_on - time_off)/time_off);
+  printf("number of mismatches                                    is %i\n", mismatch);
+
+  free( f );
+  free( X );
+  free( C );
+  free( B );
+  free( A );
+}
+
+void test_tune( const int M, const int N, const int K ) {
+  UniJAR* A = (UniJAR*) malloc( (size_t)M*K*sizeof(UniJAR) );
+  UniJAR* B = (UniJAR*) malloc( (size_t)K*N*sizeof(UniJAR) );
+  UniJAR* C0 = (UniJAR*) malloc( (size_t)M*N*sizeof(UniJAR) );
+  UniJAR* C = (UniJAR*) malloc( (size_t)M*N*sizeof(UniJAR) );
+  float* f = (float*) malloc( (size_t)M*K*sizeof(float) );
+  float width = (float)VAL_hi - (float)VAL_lo;
+  const BlockJAR cand[6] = { { 1, 8, 128, 0, 64, JAR_SPLIT_NONE }, { 2, 12, 32, 7, 3, JAR_SPLIT_MN },
+                             { 1, 4, 16, 64, 5, JAR_SPLIT_N }, { 2, 1, 48, 1, 1, JAR_SPLIT_M },
+                             { 1, 12, 512, 256, 256, JAR_SPLIT_MN }, { 2, 8, 64, 100, 16, JAR_SPLIT_N } };
+  const int cls = jar_tune_class( M, N, K );
+  const char* file = "jar_tune_demo.txt";
+  BlockJAR best, vbest;
+  double gops, vgops;
+  struct timeval start;
+  struct timeval stop;
+  double time_d, time_t;
+  int i, l, r, reps, mismatch = 0;
+
+  printf("Test: blocked GEMM and GEMV with %i parameter sets against jar_matmul_avx512 and \n", 6);
+  printf("   jar_matvecmul_avx512, tuning of the class of %i x %i x %i and of the GEMV %i x %i, \n", M, N, K, M, K);
+  printf("   saving the winners to %s and loading them back \n", file);
+
+  init_float( f, M*K, (float)VAL_lo, width );
+  init_JAR_update_float( A, f, M*K );
+  init_float( f, K*N, (float)VAL_lo, width );
+  init_JAR_update_float( B, f, K*N );
+
+  jar_matmul_avx512( M, N, K, A, B, C0 );
+  for ( l=0; l<6; ++l ) {
+    BlockJAR v = cand[l];
+    memset( C, 0, (size_t)M*N*sizeof(UniJAR) );
+    jar_matmul_blocked_avx512( M, N, K, A, B, C, cand+l );
+    for ( i=0; i<M*N; ++i ) mismatch += ( C[i].I != C0[i].I );
+    v.mv = 1 + (l % 3) + (l % 3 == 2);
+    memset( C, 0, (size_t)M*sizeof(UniJAR) );
+    jar_matvecmul_blocked_avx512( M, K, A, B, C, &v );
+    jar_matvecmul_avx512( M, K, A, B, C0+M );
+    for ( i=0; i<M; ++i ) mismatch += ( C[i].I != C0[M+i].I );
+    jar_matmul_avx512( M, N, K, A, B, C0 );
+  }
+  printf("parameter sets checked, mismatches so far %i\n", mismatch);
+
+  gops = jar_tune_run( cls, M, N, K, 0.02, &best, NULL );
+  vgops = jar_tune_run( JAR_SHAPE_GEMV, M, 1, K, 0.02, &vbest, NULL );
+  printf("%-6s best mv %i nr %i mc %i kc %i nc %i split %i: %.3f GOP/s\n", jar_tune_class_name( cls ),
+         best.mv, best.nr, best.mc, best.kc, best.nc, best.split, gops);
+  printf("%-6s best mv %i mc %i split %i: %.3f GOP/s\n", "gemv", vbest.mv, vbest.mc, vbest.split, vgops);
+
+  jar_tune_set( cls, &best, gops );
+  jar_tune_set( JAR_SHAPE_GEMV, &vbest, vgops );
+  remove( file );
+  mismatch += ( jar_tune_save( file ) != 0 );
+  jar_tune_default( cls, &best );
+  jar_tune_set( cls, &best, 0.0 );
+  mismatch += ( jar_tune_load( file ) != 2 );
+  mismatch += ( memcmp( jar_tune_params( JAR_SHAPE_GEMV ), &vbest, sizeof(BlockJAR) ) != 0 );
+  printf("cpu \"%s\", isa %s, cache %s reloaded\n", jar_tune_cpu(), jar_tune_isa(), file);
+
+  reps = (int)(3.0e7/(2.0*M*N*K + 1.0)) + 1;
+  gettimeofday(&start, NULL);
+  for ( r=0; r<reps; ++r ) jar_matmul_avx512( M, N, K, A, B, C0 );
+  gettimeofday(&stop, NULL);
+  time_d = time_in_sec( start, stop );
+  gettimeofday(&start, NULL);
+  for ( r=0; r<reps; ++r ) jar_matmul_tuned( M, N, K, A, B, C );
+  gettimeofday(&stop, NULL);
+  time_t = time_in_sec( start, stop );
+  for ( i=0; i<M*N; ++i ) mismatch += ( C[i].I != C0[i].I );
+  printf("%i products, jar_matmul_avx512 %f seconds, jar_matmul_tuned %f seconds\n", reps, time_d, time_t);
+  printf("number of mismatches                                    is %i\n", mismatch);
+  remove( file );
+
+  free( f );
+  free( C );
+  free( C0 );
+  free( B );
+  free( A );
+}
+
+void test_valid( const int M, const int N, const int K ) {
+  const int nx = 1 << (1+8+LOG2_IND_BITS), nr = 1 << 20;
+  const int nm = (M*K > K*N) ? M*K : K*N;
+  const int n = (nm > nx+nr) ? nm : nx+nr;
+  UniJAR* x = (UniJAR*) malloc( (size_t)n*sizeof(UniJAR) );
+  float* f = (float*) malloc( (size_t)n*sizeof(float) );
+  float* g = (float*) malloc( (size_t)n*sizeof(float) );
+  UniJAR* A = (UniJAR*) malloc( (size_t)M*K*sizeof(UniJAR) );
+  UniJAR* B = (UniJAR*) malloc( (size_t)K*N*sizeof(UniJAR) );
+  UniJAR* C = (UniJAR*) malloc( (size_t)M*N*sizeof(UniJAR) );
+  double* R = (double*) malloc( (size_t)M*N*sizeof(double) );
+  float width = (float)VAL_hi - (float)VAL_lo;
+  struct timeval start;
+  struct timeval stop;
+  double time_e, time_t, time_v;
+  ValidJAR v;
+  UniJAR y, z;
+  unsigned int seed = 1;
+  int i, mismatch = 0;
+
+  printf("Test: LogPS80 --> exact linear value through exp2_val_tbl against LogPS80_2_Lin_val \n");
+  printf("   for all %i LogPS80 bit patterns and %i random words, and validation of the \n", nx, nr);
+  printf("   %i x %i x %i jar_matmul_avx512 against the FP64 reference \n", M, N, K);
+
+  /* every sign, exponent and LOG2_IND_BITS fraction, then arbitrary words */
+  for ( i=0; i<nx; ++i ) x[i].I = (unsigned int)i << LOG2_IND_SHIFT;
+  for ( i=nx; i<nx+nr; ++i ) {
+    seed = seed*1664525u + 1013904223u;
+    x[i].I = seed;
+  }
+  jar_convert_LogPS80_2_Lin_val( nx+nr, x, f );
+  for ( i=0; i<nx+nr; ++i ) {
+    UniJAR a, b, c;
+    a.F = LogPS80_2_Lin_val( x[i] );
+    b.F = LogPS80_2_Lin_val_tbl( x[i] );
+    c.F = f[i];
+    mismatch += ( a.I != b.I ) + ( a.I != c.I );
+  }
+  printf("decoder mismatches %i\n", mismatch);
+
+  init_float( f, M*K, (float)VAL_lo, width );
+  init_JAR_update_float( A, f, M*K );
+  init_float( f, K*N, (float)VAL_lo, width );
+  init_JAR_update_float( B, f, K*N );
+
+  gettimeofday(&start, NULL);
+  for ( i=0; i<M*K; ++i ) f[i] = LogPS80_2_Lin_val( A[i] );
+  gettimeofday(&stop, NULL);
+  time_e = time_in_sec( start, stop );
+  gettimeofday(&start, NULL);
+  jar_convert_LogPS80_2_Lin_val( M*K, A, g );
+  gettimeofday(&stop, NULL);
+  time_t = time_in_sec( start, stop );
+  for ( i=0; i<M*K; ++i ) {
+    y.F = g[i];
+    z.F = f[i];
+    mismatch += ( y.I != z.I );
+  }
+  printf("decoding %i values: exp2 %f seconds, table %f seconds\n", M*K, time_e, time_t);
+
+  jar_matmul_avx512( M, N, K, A, B, C );
+  gettimeofday(&start, NULL);
+  jar_valid_matmul_ref( M, N, K, A, B, R );
+  jar_valid_compare( (size_t)M*N, C, R, &v );
+  gettimeofday(&stop, NULL);
+  time_v = time_in_sec( start, stop );
+  printf("FP64 reference and comparison %f seconds\n", time_v);
+  jar_valid_print( stdout, &v );
+  mismatch += ( v.n != (uint64_t)M*N ) + ( v.nonfinite > 0 );
+  printf("number of mismatches                                    is %i\n", mismatch);
+
+  free( R );
+  free( C );
+  free( B );
+  free( A );
+  free( g );
+  free( f );
+  free( x );
+}
+
+int same_value( const UniJAR x, const UniJAR y ) {
+  /* equal LogPS80 values, zeros (|x| <= 2^-63) of either sign are the same */
+  return x.I == y.I || ((x.I & CLEAR_SIGN) <= JAR_ZERO && (y.I & CLEAR_SIGN) <= JAR_ZERO);
+}
+
+void sparsify( const int M, const int K, UniJAR* A, const int bm, const int bk, const float keep ) {
+  /* sets the bm x bk blocks of A to JAR_ZERO with probability 1 - keep */
+  int i, j, m, k;
+
+  for ( j=0; j<K; j+=bk ) {
+    for ( i=0; i<M; i+=bm ) {
+      if ( (float)rand()/((float) RAND_MAX) < keep ) continue;
+      for ( k=j; k<j+bk && k<K; ++k ) {
+        for ( m=i; m<i+bm && m<M; ++m ) A[(size_t)k*M+m].I = JAR_ZERO;
+      }
+    }
+  }
+}
+
+void test_sparse( const int M, const int N, const int K ) {
+  UniJAR* A = (UniJAR*) malloc( (size_t)M*K*sizeof(UniJAR) );
+  UniJAR* D = (UniJAR*) malloc( (size_t)M*K*sizeof(UniJAR) );
+  UniJAR* B = (UniJAR*) malloc( (size_t)K*N*sizeof(UniJAR) );
+  UniJAR* C0 = (UniJAR*) malloc( (size_t)M*N*sizeof(UniJAR) );
+  UniJAR* C1 = (UniJAR*) malloc( (size_t)M*N*sizeof(UniJAR) );
+  UniJAR* C2 = (UniJAR*) malloc( (size_t)M*N*sizeof(UniJAR) );
+  float* f = (float*) malloc( (size_t)((M > N) ? M : N)*K*sizeof(float) );
+  float width = (float)VAL_hi - (float)VAL_lo;
+  const int bms[3] = { 1, 16, 3 }, bks[3] = { 1, 4, 2 };
+  struct timeval start;
+  struct timeval stop;
+  double time_d, time_s;
+  SparseJAR S;
+  int l, i, r, reps, mismatch = 0;
+
+  printf("Test: CSR, 16 x 4 and 3 x 2 BSR JAR SpMV and SpMM of a %i x %i matrix with 90%% of \n", M, K);
+  printf("   its elements or blocks zero, N = %i, against the dense jar_matvecmul_avx512 and \n", N);
+  printf("   jar_matmul_avx512 \n");
+
+  init_float( f, K*N, (float)VAL_lo, width );
+  init_JAR_update_float( B, f, K*N );
+  for ( l=0; l<3; ++l ) {
+    init_float( f, M*K, (float)VAL_lo, width );
+    init_JAR_update_float( A, f, M*K );
+    sparsify( M, K, A, bms[l], bks[l], 0.1f );
+    if ( jar_sparse_from_dense( M, K, A, bms[l], bks[l], &S ) != 0 ) {
+      printf("out of memory\n");
+      break;
+    }
+    jar_sparse_to_dense( &S, D );
+    for ( i=0; i<M*K; ++i ) mismatch += !same_value( D[i], A[i] );
+
+    jar_matvecmul_avx512( M, K, A, B, C0 );
+    jar_spmv( &S, B, C1 );
+    jar_spmv_avx512( &S, B, C2 );
+    for ( i=0; i<M; ++i ) mismatch += !same_value( C1[i], C0[i] ) + !same_value( C2[i], C0[i] );
+
+    reps = (int)(3.0e7/(2.0*M*N*K + 1.0)) + 1;
+    gettimeofday(&start, NULL);
+    for ( r=0; r<reps; ++r ) jar_matmul_avx512( M, N, K, A, B, C0 );
+    gettimeofday(&stop, NULL);
+    time_d = time_in_sec( start, stop );
+    gettimeofday(&start, NULL);
+    for ( r=0; r<reps; ++r ) jar_spmm_avx512( &S, N, B, C2 );
+    gettimeofday(&stop, NULL);
+    time_s = time_in_sec( start, stop );
+    jar_spmm( &S, N, B, C1 );
+    for ( i=0; i<M*N; ++i ) mismatch += !same_value( C1[i], C0[i] ) + !same_value( C2[i], C0[i] );
+
+    printf("%i x %i blocks, %zu stored (%.1f%% of the values): %i products dense %f seconds, sparse %f seconds\n",
+           bms[l], bks[l], S.nb, 100.0*(double)S.nb*bms[l]*bks[l]/((double)M*K), reps, time_d, time_s);
+    jar_sparse_free( &S );
+  }
+  printf("number of mismatches                                    is %i\n", mismatch);
+
+  free( f );
+  free( C2 );
+  free( C1 );
+  free( C0 );
+  free( B );
+  free( D );
+  free( A );
+}
+
+void test_nm( const int M, const int N, const int K ) {
+  UniJAR* A = (UniJAR*) malloc( (size_t)M*K*sizeof(UniJAR) );
+  UniJAR* D = (UniJAR*) malloc( (size_t)M*K*sizeof(UniJAR) );
+  UniJAR* B = (UniJAR*) malloc( (size_t)K*N*sizeof(UniJAR) );
+  UniJAR* C0 = (UniJAR*) malloc( (size_t)M*N*sizeof(UniJAR) );
+  UniJAR* C1 = (UniJAR*) malloc( (size_t)M*N*sizeof(UniJAR) );
+  UniJAR* C2 = (UniJAR*) malloc( (size_t)M*N*sizeof(UniJAR) );
+  float* f = (float*) malloc( (size_t)((M > N) ? M : N)*K*sizeof(float) );
+  float width = (float)VAL_hi - (float)VAL_lo;
+  const int keeps[4] = { 2, 2, 1, 4 }, groups[4] = { 4, 4, 4, 16 }, ps8s[4] = { 0, 1, 0, 0 };
+  struct timeval start;
+  struct timeval stop;
+  double time_d, time_s;
+  NMSparseJAR S;
+  int l, i, r, reps, mismatch = 0;
+
+  printf("Test: 2:4, 2:4 with 8-bit values, 1:4 and 4:16 sparse JAR GEMM (N = %i) and GEMV of a \n", N);
+  printf("   pruned %i x %i matrix against jar_matmul_avx512 and jar_matvecmul_avx512 \n", M, K);
+
+  init_float( f, K*N, (float)VAL_lo, width );
+  init_JAR_update_float( B, f, K*N );
+  for ( l=0; l<4; ++l ) {
+    init_float( f, M*K, (float)VAL_lo, width );
+    init_JAR_update_float( A, f, M*K );
+    if ( jar_nm_compress( M, K, A, keeps[l], groups[l], ps8s[l], &S ) != 0 ) {
+      printf("out of memory\n");
+      break;
+    }
+    jar_nm_prune( M, K, A, keeps[l], groups[l] );
+    jar_nm_decompress( &S, D );
+    for ( i=0; i<M*K; ++i ) mismatch += !same_value( D[i], A[i] );
+
+    jar_matvecmul_avx512( M, K, A, B, C0 );
+    jar_nm_matvecmul( &S, B, C1 );
+    jar_nm_matvecmul_avx512( &S, B, C2 );
+    for ( i=0; i<M; ++i ) mismatch += !same_value( C1[i], C0[i] ) + !same_value( C2[i], C0[i] );
+
+    reps = (int)(3.0e7/(2.0*M*N*K + 1.0)) + 1;
+    gettimeofday(&start, NULL);
+    for ( r=0; r<reps; ++r ) jar_matmul_avx512( M, N, K, A, B, C0 );
+    gettimeofday(&stop, NULL);
+    time_d = time_in_sec( start, stop );
+    gettimeofday(&start, NULL);
+    for ( r=0; r<reps; ++r ) jar_nm_matmul_avx512( &S, N, B, C2 );
+    gettimeofday(&stop, NULL);
+    time_s = time_in_sec( start, stop );
+    jar_nm_matmul( &S, N, B, C1 );
+    for ( i=0; i<M*N; ++i ) mismatch += !same_value( C1[i], C0[i] ) + !same_value( C2[i], C0[i] );
+
+    printf("%i:%i%s: %i products dense %f seconds, sparse %f seconds, speedup %.2f\n", keeps[l], groups[l],
+           ps8s[l] ? " 8-bit" : "", reps, time_d, time_s, time_d/time_s);
+    jar_nm_free( &S );
+  }
+  printf("number of mismatches                                    is %i\n", mismatch);
+
+  free( f );
+  free( C2 );
+  free( C1 );
+  free( C0 );
+  free( B );
+  free( D );
+  free( A );
+}
+
+void test_acc( const int M, const int N, const int K ) {
+  const int kc = (K + 3)/4;
+  UniJAR* A = (UniJAR*) malloc( (size_t)M*K*sizeof(UniJAR) );
+  UniJAR* B = (UniJAR*) malloc( (size_t)K*N*sizeof(UniJAR) );
+  UniJAR* C0 = (UniJAR*) malloc( (size_t)M*N*sizeof(UniJAR) );
+  UniJAR* C1 = (UniJAR*) malloc( (size_t)M*N*sizeof(UniJAR) );
+  UniJAR* C2 = (UniJAR*) malloc( (size_t)M*N*sizeof(UniJAR) );
+  double* R = (double*) malloc( (size_t)M*N*sizeof(double) );
+  float* f = (float*) malloc( (size_t)((M > N) ? M : N)*K*sizeof(float) );
+  float width = (float)VAL_hi - (float)VAL_lo;
+  struct timeval start;
+  struct timeval stop;
+  double time_l, time_e;
+  AccJAR L, E, E0, E1;
+  ValidJAR vl, ve;
+  UniJAR cx[1026], cy[1026], d;
+  int i, k, mismatch = 0;
+
+  printf("Test: streaming LogPS80 dot product, GEMV and %i x %i x %i GEMM over chunks of %i of K \n", M, N, K, kc);
+  printf("   with linear (FP32) and exact (fixed-point) accumulators, merged partial sums \n");
+  printf("   and validation against the FP64 reference \n");
+
+  init_float( f, M*K, (float)VAL_lo, width );
+  init_JAR_update_float( A, f, M*K );
+  init_float( f, K*N, (float)VAL_lo, width );
+  init_JAR_update_float( B, f, K*N );
+
+  if ( jar_acc_init( &L, 1, 1, JAR_ACC_LINEAR ) != 0 || jar_acc_init( &E, 1, 1, JAR_ACC_EXACT ) != 0 ||
+       jar_acc_init( &E0, 1, 1, JAR_ACC_EXACT ) != 0 ) {
+    printf("out of memory\n");
+    return;
+  }
+  /* linear dot product over chunks equals jar_dotprod, the exact one does not depend on the variant */
+  for ( k=0; k<K; k+=kc ) {
+    i = (K-k < kc) ? K-k : kc;
+    jar_acc_dotprod_avx512( &L, i, B+k, B+(N-1)*K+k );
+    jar_acc_dotprod_avx512( &E, i, B+k, B+(N-1)*K+k );
+  }
+  jar_acc_dotprod( &E0, K, B, B+(N-1)*K );
+  jar_acc_finalize( &L, C0, NULL );
+  d = jar_dotprod( K, B, B+(N-1)*K );
+  mismatch += ( C0[0].I != d.I ) + ( E.fix[0] != E0.fix[0] );
+
+  /* 64*64 + 1024 products 2^-12 - 64*64: FP32 loses the small products against 2^12 */
+  for ( i=0; i<1026; ++i ) {
+    cx[i].F = ( i == 0 || i == 1025 ) ? 64.0f : 0.015625f;
+    cy[i].F = ( i == 1025 ) ? -64.0f : cx[i].F;
+    cx[i] = LinFP32_2_LogPS80( cx[i] );
+    cy[i] = LinFP32_2_LogPS80( cy[i] );
+  }
+  jar_acc_zero( &L );
+  jar_acc_zero( &E );
+  jar_acc_dotprod_avx512( &L, 1026, cx, cy );
+  jar_acc_dotprod_avx512( &E, 1026, cx, cy );
+  jar_acc_finalize( &L, C0, NULL );
+  jar_acc_finalize( &E, C1, NULL );
+  printf("cancellation 64*64 + 1024 * 2^-12 - 64*64: linear %g, exact %g\n", LogPS80_2_Lin_val( C0[0] ), LogPS80_2_Lin_val( C1[0] ));
+  jar_acc_free( &E0 );
+  jar_acc_free( &E );
+  jar_acc_free( &L );
+
+  /* GEMV: linear over chunks equals jar_matvecmul, exact scalar and _avx512 agree */
+  if ( jar_acc_init( &L, M, 1, JAR_ACC_LINEAR ) != 0 || jar_acc_init( &E, M, 1, JAR_ACC_EXACT ) != 0 ||
+       jar_acc_init( &E0, M, 1, JAR_ACC_EXACT ) != 0 ) {
+    printf("out of memory\n");
+    return;
+  }
+  for ( k=0; k<K; k+=kc ) {
+    i = (K-k < kc) ? K-k : kc;
+    jar_acc_matvec_avx512( &L, i, A+(size_t)k*M, M, B+k );
+    jar_acc_matvec_avx512( &E, i, A+(size_t)k*M, M, B+k );
+    jar_acc_matvec( &E0, i, A+(size_t)k*M, M, B+k );
+  }
+  jar_acc_finalize( &L, C0, NULL );
+  jar_matvecmul_avx512( M, K, A, B, C1 );
+  for ( i=0; i<M; ++i ) mismatch += ( C0[i].I != C1[i].I ) + ( E.fix[i] != E0.fix[i] );
+  jar_acc_free( &E0 );
+  jar_acc_free( &E );
+  jar_acc_free( &L );
+
+  /* GEMM: linear over chunks equals jar_matmul_avx512; exact over chunks equals two partial */
+  /* accumulators of the even and the odd chunks merged, and the scalar variant in one chunk */
+  if ( jar_acc_init( &L, M, N, JAR_ACC_LINEAR ) != 0 || jar_acc_init( &E, M, N, JAR_ACC_EXACT ) != 0 ||
+       jar_acc_init( &E0, M, N, JAR_ACC_EXACT ) != 0 || jar_acc_init( &E1, M, N, JAR_ACC_EXACT ) != 0 ) {
+    printf("out of memory\n");
+    return;
+  }
+  gettimeofday(&start, NULL);
+  for ( k=0; k<K; k+=kc ) {
+    jar_acc_matmul_avx512( &L, (K-k < kc) ? K-k : kc, A+(size_t)k*M, M, B+k, K );
+  }
+  jar_acc_finalize( &L, C0, NULL );
+  gettimeofday(&stop, NULL);
+  time_l = time_in_sec( start, stop );
+  gettimeofday(&start, NULL);
+  for ( k=0; k<K; k+=kc ) {
+    jar_acc_matmul_avx512( &E, (K-k < kc) ? K-k : kc, A+(size_t)k*M, M, B+k, K );
+  }
+  jar_acc_finalize( &E, C1, NULL );
+  gettimeofday(&stop, NULL);
+  time_e = time_in_sec( start, stop );
+  for ( k=0; k<K; k+=kc ) {
+    jar_acc_matmul_avx512( ((k/kc) % 2) ? &E1 : &E0, (K-k < kc) ? K-k : kc, A+(size_t)k*M, M, B+k, K );
+  }
+  jar_acc_merge( &E1, &E0 );
+  for ( i=0; i<M*N; ++i ) mismatch += ( E.fix[i] != E1.fix[i] );
+  jar_acc_zero( &E0 );
+  jar_acc_matmul( &E0, K, A, M, B, K );
+  for ( i=0; i<M*N; ++i ) mismatch += ( E.fix[i] != E0.fix[i] );
+  jar_matmul_avx512( M, N, K, A, B, C2 );
+  for ( i=0; i<M*N; ++i ) mismatch += !same_value( C0[i], C2[i] );
+  printf("streamed GEMM: linear %f seconds, exact %f seconds\n", time_l, time_e);
+
+  jar_valid_matmul_ref( M, N, K, A, B, R );
+  jar_valid_init( &vl );
+  jar_valid_compare( (size_t)M*N, C0, R, &vl );
+  jar_valid_init( &ve );
+  jar_valid_compare( (size_t)M*N, C1, R, &ve );
+  printf("mean ulp error: linear %f, exact %f; max ulp error: linear %f, exact %f\n",
+         jar_valid_mean_ulp( &vl ), jar_valid_mean_ulp( &ve ), vl.max_ulp, ve.max_ulp );
+  printf("number of mismatches                                    is %i\n", mismatch);
+
+  jar_acc_free( &E1 );
+  jar_acc_free( &E0 );
+  jar_acc_free( &E );
+  jar_acc_free( &L );
+  free( f );
+  free( R );
+  free( C2 );
+  free( C1 );
+  free( C0 );
+  free( B );
+  free( A );
+}
+
+void test_shard( const int M, const int N, const int K ) {
+  const int splits[3] = { JAR_SHARD_M, JAR_SHARD_K, JAR_SHARD_K }, accs[3] = { JAR_ACC_LINEAR, JAR_ACC_LINEAR, JAR_ACC_EXACT };
+  const char* names[3] = { "rows of A", "columns of A, linear", "columns of A, exact" };
+  UniJAR* A = (UniJAR*) malloc( (size_t)M*K*sizeof(UniJAR) );
+  UniJAR* B = (UniJAR*) malloc( (size_t)K*N*sizeof(UniJAR) );
+  UniJAR* C0 = (UniJAR*) malloc( (size_t)M*N*sizeof(UniJAR) );
+  UniJAR* C1 = (UniJAR*) malloc( (size_t)M*N*sizeof(UniJAR) );
+  UniJAR* C2 = (UniJAR*) malloc( (size_t)M*N*sizeof(UniJAR) );
+  float* f = (float*) malloc( (size_t)((M > N) ? M : N)*K*sizeof(float) );
+  float width = (float)VAL_hi - (float)VAL_lo;
+  struct timeval start;
+  struct timeval stop;
+  double t, t1 = 0.0, tmax, tsum;
+  ShardJAR s;
+  AccJAR E;
+  ValidJAR v;
+  double* R = (double*) malloc( (size_t)M*N*sizeof(double) );
+  int l, P, i, b, r, reps, differ, beyond, mismatch = 0;
+
+  printf("Test: %i x %i x %i GEMM sharded over 1, 2 and 4 worker processes (shared memory), split by rows \n", M, N, K);
+  printf("   of A, and by columns of A with linear and exact reduction of the partial products \n");
+
+  init_float( f, M*K, (float)VAL_lo, width );
+  init_JAR_update_float( A, f, M*K );
+  init_float( f, K*N, (float)VAL_lo, width );
+  init_JAR_update_float( B, f, K*N );
+  jar_matmul_avx512( M, N, K, A, B, C0 );
+  jar_valid_decode( (size_t)M*N, C0, R );
+  if ( jar_acc_init( &E, M, N, JAR_ACC_EXACT ) != 0 ) {
+    printf("out of memory\n");
+    return;
+  }
+  jar_acc_matmul_avx512( &E, K, A, M, B, K );
+  jar_acc_finalize( &E, C2, NULL );
+  jar_acc_free( &E );
+
+  reps = (int)(3.0e8/(2.0*M*N*K + 1.0)) + 1;
+  for ( l=0; l<3; ++l ) {
+    for ( P=1; P<=4; P*=2 ) {
+      if ( jar_shard_create( &s, &jar_shard_shm, P, 1, splits[l], accs[l], M, K, N, A ) != 0 ) {
+        printf("could not start %i workers\n", P);
+        mismatch++;
+        continue;
+      }
+      mismatch += ( jar_shard_matmul( &s, N, B, C1 ) != 0 );
+      gettimeofday(&start, NULL);
+      for ( r=0; r<reps; ++r ) mismatch += ( jar_shard_matmul( &s, N, B, C1 ) != 0 );
+      gettimeofday(&stop, NULL);
+      t = time_in_sec( start, stop )/reps;
+      if ( P == 1 ) t1 = t;
+      tmax = 0.0; tsum = 0.0;
+      for ( i=0; i<P; ++i ) {
+        tmax = ( s.seconds[i] > tmax ) ? s.seconds[i] : tmax;
+        tsum += s.seconds[i];
+      }
+      /* rows and exact columns are bit-identical to their single process results, linear columns round  */
+      /* each partial product and are held to SHARD_ULP ulp of the single process result                   */
+      differ = 0;
+      for ( i=0; i<M*N; ++i ) differ += ( C1[i].I != ((accs[l] == JAR_ACC_EXACT) ? C2[i].I : C0[i].I) );
+      beyond = 0;
+      if ( splits[l] == JAR_SHARD_M || accs[l] == JAR_ACC_EXACT ) {
+        beyond = differ;
+      } else {
+        jar_valid_init( &v );
+        jar_valid_compare( (size_t)M*N, C1, R, &v );
+        for ( b=0; b<JAR_VALID_ULP_BINS; ++b ) beyond += ( jar_valid_ulp_bound( b-1 ) >= SHARD_ULP ) ? (int)v.ulp[b] : 0;
+        beyond += (int)v.nonfinite;
+        printf("%-22s %i workers: ulp mean %.4f max %.4f\n", names[l], P, jar_valid_mean_ulp( &v ), v.max_ulp);
+      }
+      mismatch += beyond;
+      printf("%-22s %i workers: %f seconds per GEMM, speedup %.2f, efficiency %.2f, imbalance %.2f, %i results differ, %i beyond bound\n",
+             names[l], P, t, t1/t, t1/(P*t), (tsum > 0.0) ? tmax*P/tsum : 1.0, differ, beyond);
+      jar_shard_destroy( &s );
+    }
+  }
+  printf("online cpus %li\n", sysconf( _SC_NPROCESSORS_ONLN ));
+  printf("number of mismatches                                    is %i\n", mismatch);
+
+  free( R );
+  free( f );
+  free( C2 );
+  free( C1 );
+  free( C0 );
+  free( B );
+  free( A );
+}
+
 void print_help() {
   printf("\n");
   printf("This tester can run multiple tests, which one is determined by the first integer arugments\n");
@@ -369,11 +2500,48 @@ void print_help() {
   printf("  2 : inner product using LogPS80\n");
   printf("  3 : matrix vector multiplication using LogPS80\n");
   printf("  4 : matrix matrix multiplication using LogPS80\n");
+  printf("  5 : RMSNorm and LayerNorm using LogPS80\n");
+  printf("  6 : LSTM and GRU sequences using LogPS80\n");
+  printf("  7 : embedding bags over 32-bit and 8-bit LogPS80 tables\n");
+  printf("  8 : backward (data and weight gradient) matrix multiplications using LogPS80\n");
+  printf("  9 : LinFP32 --> LogPS80 with stochastic rounding\n");
+  printf(" 10 : matrix matrix multiplication with calibrated power-of-two scaling\n");
+  printf(" 11 : write and memory-map a .jar tensor file\n");
+  printf(" 12 : out-of-core matrix matrix multiplication of memory-mapped .jar tensors\n");
+  printf(" 13 : aligned, huge-page and arena allocation of JAR tensors and workspaces\n");
+  printf(" 14 : NUMA-partitioned matrix vector and matrix matrix multiplication\n");
+  printf(" 15 : work-stealing thread pool\n");
+  printf(" 16 : asynchronous kernel submission with dependencies and completion events\n");
+  printf(" 17 : graph executor with buffer planning and layer fusion\n");
+  printf(" 18 : inference server with dynamic batching over a Unix socket\n");
+  printf(" 19 : kernel instrumentation counters and Chrome trace export\n");
+  printf(" 20 : numerical event counters (saturation, flush to zero) of the conversions\n");
+  printf(" 21 : blocked GEMM / GEMV and autotuning of the blocking with a cache file\n");
+  printf(" 22 : table decoder of the exact linear values and FP64 validation of a GEMM\n");
+  printf(" 23 : CSR and BSR sparse matrix vector and matrix matrix multiplication\n");
+  printf(" 24 : N:M structured sparse matrix matrix and matrix vector multiplication\n");
+  printf(" 25 : streaming linear and exact accumulators over chunks of K\n");
+  printf(" 26 : matrix matrix multiplication sharded over worker processes in shared memory\n");
   printf("\n");
   printf("each of them require additional integer paramters:\n");
   printf("  0,1,2 : one additional integer specifying N (length of array to test)\n");
   printf("  3     : two additional integers specifying M, K\n");
   printf("  4     : three additional integers specifying M, N, K\n");
+  printf("  5     : two additional integers specifying M (vector length), N (number of vectors)\n");
+  printf("  6     : three additional integers specifying I (input size), H (hidden size), T (steps)\n");
+  printf("  7     : three additional integers specifying D (vector length), E (table size), B (bags)\n");
+  printf("  8     : three additional integers specifying M, N, K of the forward product\n");
+  printf("  9     : one additional integer specifying N (length of array to test)\n");
+  printf("  10    : three additional integers specifying M, N, K\n");
+  printf("  11    : two additional integers specifying M, K of the stored tensor\n");
+  printf("  12    : three additional integers specifying M, N, K\n");
+  printf("  13    : two additional integers specifying H (LSTM hidden and input size), T (steps)\n");
+  printf("  14    : two additional integers specifying M, K\n");
+  printf("  15    : one additional integer specifying N (length of array to test)\n");
+  printf("  16    : three additional integers specifying M, N, K\n");
+  printf("  17    : three additional integers specifying D (width), L (layers), N (batch)\n");
+  printf("  18    : three additional integers specifying M, K of the model and C (clients)\n");
+  printf("  19-26 : three additional integers specifying M, N, K\n");
   printf("\n");
   printf("Examples:\n");
   printf("   ./demo 0 20\n");
@@ -381,6 +2549,28 @@ void print_help() {
   printf("   ./demo 2 50\n");
   printf("   ./demo 3 16 50\n");
   printf("   ./demo 4 16 24 50\n");
+  printf("   ./demo 5 64 8\n");
+  printf("   ./demo 6 40 48 10\n");
+  printf("   ./demo 7 40 1000 64\n");
+  printf("   ./demo 8 40 300 36\n");
+  printf("   ./demo 9 100\n");
+  printf("   ./demo 10 40 24 64\n");
+  printf("   ./demo 11 64 1000\n");
+  printf("   ./demo 12 1000 500 2000\n");
+  printf("   ./demo 13 256 20\n");
+  printf("   ./demo 14 4000 2000\n");
+  printf("   ./demo 15 1000000\n");
+  printf("   ./demo 16 256 64 512\n");
+  printf("   ./demo 17 256 10 16\n");
+  printf("   ./demo 18 1024 1024 8\n");
+  printf("   ./demo 19 64 64 64\n");
+  printf("   ./demo 20 100 40 256\n");
+  printf("   ./demo 21 200 100 300\n");
+  printf("   ./demo 22 512 256 384\n");
+  printf("   ./demo 23 1000 64 1500\n");
+  printf("   ./demo 24 1024 64 1024\n");
+  printf("   ./demo 25 256 32 1000\n");
+  printf("   ./demo 26 1024 64 1024\n");
   printf("\n");
 }
 
@@ -395,6 +2585,10 @@ int main(int argc, char* argv[]) {
       test_LogPS80_to_LinFP32( size );
     } else if ( test == 2 ) {
       test_dotprod( size );
+    } else if ( test == 9 ) {
+      test_stochastic_rounding( size );
+    } else if ( test == 15 ) {
+      test_pool( size );
     } else {
       print_help();
     }
@@ -405,6 +2599,14 @@ int main(int argc, char* argv[]) {
 
     if ( test == 3 ) {
       test_matvecmul( M, K );
+    } else if ( test == 5 ) {
+      test_norm( M, K );
+    } else if ( test == 11 ) {
+      test_file( M, K );
+    } else if ( test == 13 ) {
+      test_mem( M, K );
+    } else if ( test == 14 ) {
+      test_numa( M, K );
     } else {
       print_help();
     }
@@ -416,6 +2618,38 @@ int main(int argc, char* argv[]) {
 
     if ( test == 4 ) {
       test_matmul( M, N, K );
+    } else if ( test == 6 ) {
+      test_rnn( M, N, K );
+    } else if ( test == 7 ) {
+      test_embedding_bag( M, N, K );
+    } else if ( test == 8 ) {
+      test_backward( M, N, K );
+    } else if ( test == 10 ) {
+      test_scaling( M, N, K );
+    } else if ( test == 12 ) {
+      test_ooc( M, N, K );
+    } else if ( test == 16 ) {
+      test_async( M, N, K );
+    } else if ( test == 17 ) {
+      test_graph( M, N, K );
+    } else if ( test == 18 ) {
+      test_serve( M, N, K );
+    } else if ( test == 19 ) {
+      test_trace( M, N, K );
+    } else if ( test == 20 ) {
+      test_numstat( M, N, K );
+    } else if ( test == 21 ) {
+      test_tune( M, N, K );
+    } else if ( test == 22 ) {
+      test_valid( M, N, K );
+    } else if ( test == 23 ) {
+      test_sparse( M, N, K );
+    } else if ( test == 24 ) {
+      test_nm( M, N, K );
+    } else if ( test == 25 ) {
+      test_acc( M, N, K );
+    } else if ( test == 26 ) {
+      test_shard( M, N, K );
     } else {
       print_help();
     }
@@ -0,0 +1,356 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "jar_acc.h"
+#include "jar_mem.h"
+#include "jar_trace.h"
+
+/* columns of B per register block of jar_acc_matmul_avx512 */
+#define JAR_ACC_NR     4
+#define JAR_ACC_SCALE  ((float)(1 << JAR_ACC_FRAC_BITS))
+
+int jar_acc_init( AccJAR* acc, const int M, const int N, const int mode ) {
+/*
+allocates the M x N accumulators of mode JAR_ACC_LINEAR or JAR_ACC_EXACT and zeroes
+them. Returns 0, or -1 if out of memory (acc is then empty and may be freed).
+*/
+  const size_t n = (size_t)M*N;
+
+  assert (M >= 0 && N >= 0);
+  assert (mode == JAR_ACC_LINEAR || mode == JAR_ACC_EXACT);
+
+  acc->mode = mode;
+  acc->M = M;
+  acc->N = N;
+  acc->lin = NULL;
+  acc->fix = NULL;
+  if (mode == JAR_ACC_LINEAR) {
+    acc->lin = (UniJAR*) jar_malloc( (n > 0 ? n : 1)*sizeof(UniJAR) );
+    if (acc->lin == NULL) return -1;
+  } else {
+    acc->fix = (long long*) jar_malloc( (n > 0 ? n : 1)*sizeof(long long) );
+    if (acc->fix == NULL) return -1;
+  }
+  jar_acc_zero( acc );
+
+  return 0;
+}
+
+void jar_acc_zero( AccJAR* acc ) {
+/* restarts the accumulation, the linear accumulators start from JAR_ZERO as in the kernels */
+  const size_t n = (size_t)acc->M*acc->N;
+  size_t i;
+
+  if (acc->mode == JAR_ACC_LINEAR) {
+    for (i=0; i<n; ++i) acc->lin[i].I = JAR_ZERO;
+  } else {
+    memset( acc->fix, 0, n*sizeof(long long) );
+  }
+}
+
+void jar_acc_free( AccJAR* acc ) {
+  jar_free( acc->lin );
+  jar_free( acc->fix );
+  acc->lin = NULL;
+  acc->fix = NULL;
+}
+
+static long long jar_acc_fix( const UniJAR a, const UniJAR b ) {
+/* the product a*b of the jar_fma pipeline in units of 2^-JAR_ACC_FRAC_BITS, 0 for a zero operand */
+  UniJAR w;
+
+  w = LogPS80_2_LinFP32( sum2_LogPS80( a, b ) );
+
+  return (long long)( w.F * JAR_ACC_SCALE );
+}
+
+#if defined(__AVX512F__)
+static inline __m512i jar_acc_fix_avx512( const __m512i a, const __m512i b ) {
+/* 16-wide jar_acc_fix, the products are below 2^29 units and fit 32-bit integers */
+  const __m512i y = jar_prod_avx512( a, b, _mm512_set1_epi32( 0X40800000 ) );
+
+  return _mm512_cvttps_epi32( _mm512_mul_ps( _mm512_castsi512_ps( y ), _mm512_set1_ps( JAR_ACC_SCALE ) ) );
+}
+
+/* adds the 16 32-bit products q to the 64-bit accumulators lo (lanes 0-7) and hi (lanes 8-15) */
+#define JAR_ACC_ADD_AVX512( lo, hi, q ) \
+  lo = _mm512_add_epi64( lo, _mm512_cvtepi32_epi64( _mm512_castsi512_si256( q ) ) ); \
+  hi = _mm512_add_epi64( hi, _mm512_cvtepi32_epi64( _mm512_extracti64x4_epi64( q, 1 ) ) )
+#endif
+
+void jar_acc_dotprod( AccJAR* acc, const int n, const UniJAR* x, const UniJAR* y ) {
+/* adds the dot product of the chunks x[0..n-1] and y[0..n-1] to the 1 x 1 acc */
+  long long s = 0;
+  int i;
+
+  assert (n >= 0);
+  assert (acc->M == 1 && acc->N == 1);
+  JAR_TRACE_BEGIN( t );
+
+  if (acc->mode == JAR_ACC_LINEAR) {
+    for (i=0; i<n; ++i) {
+      jar_fma( x+i, y+i, acc->lin );
+    }
+  } else {
+    for (i=0; i<n; ++i) {
+      s += jar_acc_fix( x[i], y[i] );
+    }
+    acc->fix[0] += s;
+  }
+  JAR_TRACE_END( t, JAR_TK_ACC, JAR_TP_COMPUTE, 8*(size_t)n, 2*(size_t)n );
+}
+
+void jar_acc_dotprod_avx512( AccJAR* acc, const int n, const UniJAR* x, const UniJAR* y ) {
+/* 
+adds the dot product of the chunks to acc, see jar_acc_dotprod. The linear mode keeps
+the sequential order of jar_dotprod, the exact mode sums 16 products per vector.
+*/
+  long long s = 0;
+  int i = 0;
+
+  assert (n >= 0);
+  assert (acc->M == 1 && acc->N == 1);
+
+  if (acc->mode == JAR_ACC_LINEAR) {
+    jar_acc_dotprod( acc, n, x, y );
+    return;
+  }
+  JAR_TRACE_BEGIN( t );
+#if defined(__AVX512F__)
+  {
+    __m512i lo = _mm512_setzero_si512();
+    __m512i hi = _mm512_setzero_si512();
+    for ( ; i<(n/16)*16; i+=16) {
+      __m512i q = jar_acc_fix_avx512( _mm512_loadu_epi32( x+i ), _mm512_loadu_epi32( y+i ) );
+      JAR_ACC_ADD_AVX512( lo, hi, q );
+    }
+    s = _mm512_reduce_add_epi64( _mm512_add_epi64( lo, hi ) );
+  }
+#endif
+  for ( ; i<n; ++i) {
+    s += jar_acc_fix( x[i], y[i] );
+  }
+  acc->fix[0] += s;
+  JAR_TRACE_END( t, JAR_TK_ACC, JAR_TP_COMPUTE, 8*(size_t)n, 2*(size_t)n );
+}
+
+void jar_acc_matvec( AccJAR* acc, const int K, const UniJAR* A, const int lda, const UniJAR* b ) {
+/* 
+adds A*b for the M x K chunk A (col-major, lda >= M) and the K chunk b to the M x 1 acc.
+The linear mode is jar_matvecacc on the accumulators.
+*/
+  const int M = acc->M;
+  int m, k;
+
+  assert (K >= 0);
+  assert (acc->N == 1);
+  assert (lda >= M);
+
+  if (acc->mode == JAR_ACC_LINEAR) {
+    jar_matvecacc( M, K, A, lda, b, acc->lin );
+    return;
+  }
+  JAR_TRACE_BEGIN( t );
+  for (k=0; k<K; ++k) {
+    for (m=0; m<M; ++m) {
+      acc->fix[m] += jar_acc_fix( A[(size_t)k*lda+m], b[k] );
+    }
+  }
+  JAR_TRACE_END( t, JAR_TK_ACC, JAR_TP_COMPUTE, 4*((size_t)M*K + K) + 16*(size_t)M, 2*(size_t)M*K );
+}
+
+void jar_acc_matvec_avx512( AccJAR* acc, const int K, const UniJAR* A, const int lda, const UniJAR* b ) {
+/* 
+adds A*b to acc, see jar_acc_matvec. The linear mode is jar_matvecacc_avx512, the exact
+mode runs 16 rows per vector.
+*/
+  const int M = acc->M;
+  int m = 0, k;
+
+  assert (K >= 0);
+  assert (acc->N == 1);
+  assert (lda >= M);
+
+  if (acc->mode == JAR_ACC_LINEAR) {
+    jar_matvecacc_avx512( M, K, A, lda, b, acc->lin );
+    return;
+  }
+  JAR_TRACE_BEGIN( t );
+#if defined(__AVX512F__)
+  for ( ; m<(M/16)*16; m+=16) {
+    __m512i lo = _mm512_loadu_si512( acc->fix+m );
+    __m512i hi = _mm512_loadu_si512( acc->fix+m+8 );
+    for (k=0; k<K; ++k) {
+      __m512i q = jar_acc_fix_avx512( _mm512_loadu_epi32( A+(size_t)k*lda+m ), _mm512_set1_epi32( b[k].I ) );
+      JAR_ACC_ADD_AVX512( lo, hi, q );
+    }
+    _mm512_storeu_si512( acc->fix+m, lo );
+    _mm512_storeu_si512( acc->fix+m+8, hi );
+  }
+#endif
+  for ( ; m<M; ++m) {
+    for (k=0; k<K; ++k) {
+      acc->fix[m] += jar_acc_fix( A[(size_t)k*lda+m], b[k] );
+    }
+  }
+  JAR_TRACE_END( t, JAR_TK_ACC, JAR_TP_COMPUTE, 4*((size_t)M*K + K) + 16*(size_t)M, 2*(size_t)M*K );
+}
+
+void jar_acc_matmul( AccJAR* acc, const int K, const UniJAR* A, const int lda, const UniJAR* B, const int ldb ) {
+/* 
+adds A*B for the M x K chunk A (col-major, lda >= M) and the K x N chunk B (col-major,
+ldb >= K) to the M x N acc. The linear mode is jar_matmulacc on the accumulators.
+*/
+  const int M = acc->M;
+  const int N = acc->N;
+  int m, n, k;
+
+  assert (K >= 0);
+  assert (lda >= M && ldb >= K);
+
+  if (acc->mode == JAR_ACC_LINEAR) {
+    jar_matmulacc( M, N, K, A, lda, B, ldb, acc->lin, M );
+    return;
+  }
+  JAR_TRACE_BEGIN( t );
+  for (n=0; n<N; ++n) {
+    for (k=0; k<K; ++k) {
+      for (m=0; m<M; ++m) {
+        acc->fix[(size_t)n*M+m] += jar_acc_fix( A[(size_t)k*lda+m], B[(size_t)n*ldb+k] );
+      }
+    }
+  }
+  JAR_TRACE_END( t, JAR_TK_ACC, JAR_TP_COMPUTE, 4*((size_t)M*K + (size_t)K*N) + 16*(size_t)M*N, 2*(size_t)M*N*K );
+}
+
+void jar_acc_matmul_avx512( AccJAR* acc, const int K, const UniJAR* A, const int lda, const UniJAR* B, const int ldb ) {
+/* 
+adds A*B to acc, see jar_acc_matmul. The linear mode is jar_matmulacc_avx512, the exact
+mode runs register blocks of 16 rows by JAR_ACC_NR columns.
+*/
+  const int M = acc->M;
+  const int N = acc->N;
+  int m = 0, n, k, j;
+
+  assert (K >= 0);
+  assert (lda >= M && ldb >= K);
+
+  if (acc->mode == JAR_ACC_LINEAR) {
+    jar_matmulacc_avx512( M, N, K, A, lda, B, ldb, acc->lin, M );
+    return;
+  }
+  JAR_TRACE_BEGIN( t );
+#if defined(__AVX512F__)
+  for ( ; m<(M/16)*16; m+=16) {
+    for (n=0; n<N; n+=JAR_ACC_NR) {
+      const int nr = (N-n < JAR_ACC_NR) ? N-n : JAR_ACC_NR;
+      __m512i lo[JAR_ACC_NR], hi[JAR_ACC_NR];
+      for (j=0; j<nr; ++j) {
+        lo[j] = _mm512_loadu_si512( acc->fix+(size_t)(n+j)*M+m );
+        hi[j] = _mm512_loadu_si512( acc->fix+(size_t)(n+j)*M+m+8 );
+      }
+      if (nr == JAR_ACC_NR) {
+        for (k=0; k<K; ++k) {
+          __m512i va = _mm512_loadu_epi32( A+(size_t)k*lda+m );
+          for (j=0; j<JAR_ACC_NR; ++j) {
+            __m512i q = jar_acc_fix_avx512( va, _mm512_set1_epi32( B[(size_t)(n+j)*ldb+k].I ) );
+            JAR_ACC_ADD_AVX512( lo[j], hi[j], q );
+          }
+        }
+      } else {
+        for (k=0; k<K; ++k) {
+          __m512i va = _mm512_loadu_epi32( A+(size_t)k*lda+m );
+          for (j=0; j<nr; ++j) {
+            __m512i q = jar_acc_fix_avx512( va, _mm512_set1_epi32( B[(size_t)(n+j)*ldb+k].I ) );
+            JAR_ACC_ADD_AVX512( lo[j], hi[j], q );
+          }
+        }
+      }
+      for (j=0; j<nr; ++j) {
+        _mm512_storeu_si512( acc->fix+(size_t)(n+j)*M+m, lo[j] );
+        _mm512_storeu_si512( acc->fix+(size_t)(n+j)*M+m+8, hi[j] );
+      }
+    }
+  }
+#endif
+
+  /* remaining rows (all rows without AVX512) */
+  for (n=0; n<N; ++n) {
+    for (k=0; k<K; ++k) {
+      for (j=m; j<M; ++j) {
+        acc->fix[(size_t)n*M+j] += jar_acc_fix( A[(size_t)k*lda+j], B[(size_t)n*ldb+k] );
+      }
+    }
+  }
+  JAR_TRACE_END( t, JAR_TK_ACC, JAR_TP_COMPUTE, 4*((size_t)M*K + (size_t)K*N) + 16*(size_t)M*N, 2*(size_t)M*N*K );
+}
+
+void jar_acc_merge( AccJAR* acc, const AccJAR* src ) {
+/* adds the accumulators of src to those of acc, both of the same mode and shape */
+  const size_t n = (size_t)acc->M*acc->N;
+  size_t i;
+
+  assert (acc->mode == src->mode);
+  assert (acc->M == src->M && acc->N == src->N);
+
+  if (acc->mode == JAR_ACC_LINEAR) {
+    for (i=0; i<n; ++i) acc->lin[i].F += src->lin[i].F;
+  } else {
+    for (i=0; i<n; ++i) acc->fix[i] += src->fix[i];
+  }
+}
+
+void jar_acc_finalize( const AccJAR* acc, UniJAR* C, const RndJAR* rnd ) {
+/*
+converts the accumulators to the M x N LogPS80 results C (col-major) with rounding mode
+rnd, see jar_convert_LinFP32_2_LogPS80. The exact accumulators are first rounded to 
+FP32; those without nonzero products give JAR_ZERO. acc is left unchanged, so the 
+accumulation may continue afterwards.
+*/
+  const size_t n = (size_t)acc->M*acc->N;
+  size_t i;
+
+  if (acc->mode == JAR_ACC_LINEAR) {
+    jar_convert_LinFP32_2_LogPS80( n, acc->lin, C, rnd );
+  } else {
+    for (i=0; i<n; ++i) {
+      if (acc->fix[i] == 0) {
+        C[i].I = JAR_ZERO;
+      } else {
+        C[i].F = (float)acc->fix[i] * (1.0f/JAR_ACC_SCALE);
+      }
+    }
+    jar_convert_LinFP32_2_LogPS80( n, C, C, rnd );
+  }
+}
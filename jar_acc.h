@@ -0,0 +1,98 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Streaming accumulators for JAR products whose K dimension arrives in chunks.
+ *
+ *  jar_dotprod, jar_matvecmul and jar_matmul start every element from JAR_ZERO and
+ *  convert it to LogPS80 at the end, so a reduction cannot be continued across calls
+ *  without rounding to LogPS80 in between. An AccJAR holds the M x N (col-major) 
+ *  accumulators of such a product outside of the logarithmic domain between calls:
+ *
+ *    jar_acc_init          allocates and zeroes the accumulators in one of two modes
+ *    jar_acc_dotprod       adds a chunk x*y of a dot product (M = N = 1)
+ *    jar_acc_matvec        adds the M x K chunk A (leading dimension lda) times b (N = 1)
+ *    jar_acc_matmul        adds A times the K x N chunk B (leading dimension ldb)
+ *    jar_acc_merge         adds the accumulators of another AccJAR of the same mode and 
+ *                          shape, e.g. partial sums over K of different threads
+ *    jar_acc_finalize      converts once to LogPS80 with rounding mode rnd (NULL for 
+ *                          round-to-nearest), counting the numerical events
+ *
+ *  JAR_ACC_LINEAR accumulates in FP32 exactly like the kernels (jar_fma in ascending k 
+ *  per chunk, through jar_matvecacc and jar_matmulacc), so a single chunk gives the
+ *  results of jar_dotprod, jar_matvecmul and jar_matmul. Every FP32 add rounds, so 
+ *  results depend on the chunking and on the order of merges.
+ *
+ *  JAR_ACC_EXACT accumulates in 64-bit fixed point with JAR_ACC_FRAC_BITS fraction 
+ *  bits. The product of two LogPS80 values through the exp2 table has 5 fraction bits
+ *  and a magnitude in [2^-12, 2^12], so it is an integer multiple of 2^-17 of at most
+ *  2^29 units and the sums are exact for up to 2^34 products per element; products 
+ *  with a zero operand are dropped. The result is rounded once, to FP32 and then to LogPS80, and
+ *  does not depend on the chunking, the order of merges or the kernel variant. 
+ *  The inputs must be LogPS80 values as produced by the conversions.
+ *
+ *  The update calls run on the calling thread; different threads update their own
+ *  AccJAR and merge them at the end.
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_ACC
+
+#define JAR_ACC
+#include "jar_sim.h"
+
+#define JAR_ACC_LINEAR     0
+#define JAR_ACC_EXACT      1
+
+/* fixed-point fraction bits of JAR_ACC_EXACT, the unit is the smallest product 2^-12 * 2^-5 */
+#define JAR_ACC_FRAC_BITS  17
+
+typedef struct{
+   int            mode;
+   int            M;
+   int            N;
+   UniJAR*        lin;      /* M*N FP32 accumulators, JAR_ACC_LINEAR */
+   long long*     fix;      /* M*N fixed-point accumulators, JAR_ACC_EXACT */
+} AccJAR;
+
+int  jar_acc_init( AccJAR* acc, const int M, const int N, const int mode );
+void jar_acc_zero( AccJAR* acc );
+void jar_acc_free( AccJAR* acc );
+void jar_acc_dotprod( AccJAR* acc, const int n, const UniJAR* x, const UniJAR* y );
+void jar_acc_dotprod_avx512( AccJAR* acc, const int n, const UniJAR* x, const UniJAR* y );
+void jar_acc_matvec( AccJAR* acc, const int K, const UniJAR* A, const int lda, const UniJAR* b );
+void jar_acc_matvec_avx512( AccJAR* acc, const int K, const UniJAR* A, const int lda, const UniJAR* b );
+void jar_acc_matmul( AccJAR* acc, const int K, const UniJAR* A, const int lda, const UniJAR* B, const int ldb );
+void jar_acc_matmul_avx512( AccJAR* acc, const int K, const UniJAR* A, const int lda, const UniJAR* B, const int ldb );
+void jar_acc_merge( AccJAR* acc, const AccJAR* src );
+void jar_acc_finalize( const AccJAR* acc, UniJAR* C, const RndJAR* rnd );
+
+#endif
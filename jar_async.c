@@ -0,0 +1,455 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <assert.h>
+#include "jar_async.h"
+
+typedef struct JarAsyncJob{
+   EventJAR*            ev;
+   TaskJAR              fn;
+   void*                arg;
+   int                  nparts;
+   int                  next;       /* next part to hand out */
+   int                  left;       /* parts not finished */
+   int                  ndeps;      /* events not complete */
+   struct JarAsyncJob*  qnext;
+   union{
+     char               c[JAR_ASYNC_ARG];
+     double             d;
+     void*              p;
+   } buf;
+} JarAsyncJob;
+
+typedef struct{
+   CallbackJAR          fn;
+   void*                arg;
+} JarCallback;
+
+struct EventJAR{
+   QueueJAR*            q;
+   int                  refs;
+   int                  done;
+   JarAsyncJob**        succ;       /* jobs waiting for this event */
+   int                  nsucc;
+   int                  capsucc;
+   JarCallback*         cb;
+   int                  ncb;
+   int                  capcb;
+   EventJAR*            fnext;      /* list of completed events whose callbacks are due */
+};
+
+struct QueueJAR{
+   int                  nthreads;
+   pthread_t*           threads;
+   pthread_mutex_t      lock;
+   pthread_cond_t       work;
+   pthread_cond_t       done;
+   JarAsyncJob*         head;       /* ready jobs with parts to hand out */
+   JarAsyncJob*         tail;
+   EventJAR*            fin;
+   int                  nlive;      /* jobs not complete */
+   int                  stop;
+};
+
+static void jar_async_complete( QueueJAR* q, JarAsyncJob* job );
+
+static void jar_async_ready( QueueJAR* q, JarAsyncJob* job ) {
+/* a job whose dependencies are complete, lock held */
+  if (job->nparts == 0) {
+    jar_async_complete( q, job );
+    return;
+  }
+  job->qnext = NULL;
+  if (q->tail != NULL) {
+    q->tail->qnext = job;
+  } else {
+    q->head = job;
+  }
+  q->tail = job;
+  pthread_cond_broadcast( &q->work );
+}
+
+static void jar_async_complete( QueueJAR* q, JarAsyncJob* job ) {
+/* marks the event of job complete and releases its successors, lock held */
+  EventJAR* ev = job->ev;
+  int i;
+
+  ev->done = 1;
+  for (i=0; i<ev->nsucc; ++i) {
+    if (--ev->succ[i]->ndeps == 0) {
+      jar_async_ready( q, ev->succ[i] );
+    }
+  }
+  ev->nsucc = 0;
+  ev->fnext = q->fin;
+  q->fin = ev;
+  q->nlive--;
+  pthread_cond_broadcast( &q->done );
+  if (job->arg != (void*)job->buf.c) {
+    free( job->arg );
+  }
+  free( job );
+}
+
+static void jar_async_finish( QueueJAR* q ) {
+/* runs the callbacks of completed events and drops the reference of the queue, lock held */
+  while (q->fin != NULL) {
+    EventJAR* ev = q->fin;
+    int i;
+
+    q->fin = ev->fnext;
+    pthread_mutex_unlock( &q->lock );
+    for (i=0; i<ev->ncb; ++i) {
+      ev->cb[i].fn( ev->cb[i].arg );
+    }
+    jar_event_release( ev );
+    pthread_mutex_lock( &q->lock );
+  }
+}
+
+static int jar_async_step( QueueJAR* q ) {
+/* runs one ready part on the calling thread, returns 0 if there is none; lock held */
+  JarAsyncJob* job = q->head;
+  int part, serial;
+
+  if (job == NULL) {
+    return 0;
+  }
+  part = job->next++;
+  if (job->next == job->nparts) {
+    q->head = job->qnext;
+    if (q->head == NULL) {
+      q->tail = NULL;
+    }
+  }
+  pthread_mutex_unlock( &q->lock );
+
+  serial = jar_pool_serial( 1 );
+  job->fn( job->arg, part );
+  jar_pool_serial( serial );
+
+  pthread_mutex_lock( &q->lock );
+  if (--job->left == 0) {
+    jar_async_complete( q, job );
+  }
+  jar_async_finish( q );
+  return 1;
+}
+
+static void* jar_async_executor( void* p ) {
+  QueueJAR* q = (QueueJAR*)p;
+
+  pthread_mutex_lock( &q->lock );
+  while (1) {
+    while (q->head == NULL && !q->stop) {
+      pthread_cond_wait( &q->work, &q->lock );
+    }
+    if (q->head == NULL) {
+      break;
+    }
+    jar_async_step( q );
+  }
+  pthread_mutex_unlock( &q->lock );
+  return NULL;
+}
+
+QueueJAR* jar_queue_create( const int nthreads ) {
+/* a queue with nthreads executors, the number of online cpus for nthreads < 0 */
+  QueueJAR* q = (QueueJAR*) calloc( 1, sizeof(QueueJAR) );
+  const int n = (nthreads >= 0) ? nthreads : (int)sysconf( _SC_NPROCESSORS_ONLN );
+  int t;
+
+  pthread_mutex_init( &q->lock, NULL );
+  pthread_cond_init( &q->work, NULL );
+  pthread_cond_init( &q->done, NULL );
+  q->threads = (pthread_t*) malloc( (n > 0 ? n : 1)*sizeof(pthread_t) );
+  for (t=0; t<n; ++t) {
+    if (pthread_create( q->threads+t, NULL, jar_async_executor, q ) != 0) {
+      break;
+    }
+  }
+  q->nthreads = t;
+
+  return q;
+}
+
+void jar_queue_wait_all( QueueJAR* q ) {
+/* waits until all submitted jobs are complete, running ready parts meanwhile */
+  pthread_mutex_lock( &q->lock );
+  while (q->nlive > 0) {
+    if (!jar_async_step( q )) {
+      pthread_cond_wait( &q->done, &q->lock );
+    }
+  }
+  pthread_mutex_unlock( &q->lock );
+}
+
+void jar_queue_destroy( QueueJAR* q ) {
+/* completes all submitted jobs and joins the executors */
+  int t;
+
+  if (q == NULL) {
+    return;
+  }
+  jar_queue_wait_all( q );
+  pthread_mutex_lock( &q->lock );
+  q->stop = 1;
+  pthread_cond_broadcast( &q->work );
+  pthread_mutex_unlock( &q->lock );
+  for (t=0; t<q->nthreads; ++t) {
+    pthread_join( q->threads[t], NULL );
+  }
+  pthread_cond_destroy( &q->done );
+  pthread_cond_destroy( &q->work );
+  pthread_mutex_destroy( &q->lock );
+  free( q->threads );
+  free( q );
+}
+
+EventJAR* jar_submit( QueueJAR* q, const int nparts, TaskJAR fn, const void* arg, const size_t argsize,
+                      const int ndeps, EventJAR* const* deps ) {
+/* 
+enqueues fn( arg', part ) for part = 0, ..., nparts-1, where arg' is a copy of the argsize 
+bytes at arg, to start when the events deps[0], ..., deps[ndeps-1] (NULL entries are 
+ignored) are complete. Returns the event of the job, owned by the caller.
+*/
+  JarAsyncJob* job = (JarAsyncJob*) malloc( sizeof(JarAsyncJob) );
+  EventJAR* ev = (EventJAR*) calloc( 1, sizeof(EventJAR) );
+  int i;
+
+  assert (nparts >= 0);
+  assert (ndeps >= 0);
+
+  ev->q     = q;
+  ev->refs  = 2;          /* the caller and the queue */
+  job->ev     = ev;
+  job->fn     = fn;
+  job->nparts = nparts;
+  job->next   = 0;
+  job->left   = nparts;
+  job->ndeps  = 0;
+  job->arg    = (argsize <= JAR_ASYNC_ARG) ? (void*)job->buf.c : malloc( argsize );
+  if (argsize > 0) {
+    memcpy( job->arg, arg, argsize );
+  }
+
+  pthread_mutex_lock( &q->lock );
+  q->nlive++;
+  for (i=0; i<ndeps; ++i) {
+    EventJAR* d = deps[i];
+    if (d == NULL || d->done) {
+      continue;
+    }
+    assert (d->q == q);
+    if (d->nsucc == d->capsucc) {
+      d->capsucc = (d->capsucc > 0) ? 2*d->capsucc : 4;
+      d->succ = (JarAsyncJob**) realloc( d->succ, d->capsucc*sizeof(JarAsyncJob*) );
+    }
+    d->succ[d->nsucc++] = job;
+    job->ndeps++;
+  }
+  if (job->ndeps == 0) {
+    jar_async_ready( q, job );
+  }
+  jar_async_finish( q );
+  pthread_mutex_unlock( &q->lock );
+
+  return ev;
+}
+
+int jar_event_test( EventJAR* ev ) {
+/* returns 1 if the job of ev is complete, without blocking */
+  int done;
+
+  pthread_mutex_lock( &ev->q->lock );
+  done = ev->done;
+  pthread_mutex_unlock( &ev->q->lock );
+  return done;
+}
+
+void jar_event_wait( EventJAR* ev ) {
+/* waits until the job of ev is complete, running ready parts of the queue meanwhile */
+  QueueJAR* q = ev->q;
+
+  pthread_mutex_lock( &q->lock );
+  while (!ev->done) {
+    if (!jar_async_step( q )) {
+      pthread_cond_wait( &q->done, &q->lock );
+    }
+  }
+  pthread_mutex_unlock( &q->lock );
+}
+
+void jar_event_then( EventJAR* ev, CallbackJAR fn, void* arg ) {
+/* 
+runs fn( arg ) once the job of ev is complete: on the thread that completes it, or right 
+away on the calling thread if it already is 
+*/
+  QueueJAR* q = ev->q;
+
+  pthread_mutex_lock( &q->lock );
+  if (ev->done) {
+    pthread_mutex_unlock( &q->lock );
+    fn( arg );
+    return;
+  }
+  if (ev->ncb == ev->capcb) {
+    ev->capcb = (ev->capcb > 0) ? 2*ev->capcb : 2;
+    ev->cb = (JarCallback*) realloc( ev->cb, ev->capcb*sizeof(JarCallback) );
+  }
+  ev->cb[ev->ncb].fn  = fn;
+  ev->cb[ev->ncb].arg = arg;
+  ev->ncb++;
+  pthread_mutex_unlock( &q->lock );
+}
+
+void jar_event_retain( EventJAR* ev ) {
+  __atomic_add_fetch( &ev->refs, 1, __ATOMIC_ACQ_REL );
+}
+
+void jar_event_release( EventJAR* ev ) {
+  if (ev != NULL && __atomic_sub_fetch( &ev->refs, 1, __ATOMIC_ACQ_REL ) == 0) {
+    free( ev->cb );
+    free( ev->succ );
+    free( ev );
+  }
+}
+
+typedef struct{
+   int            M;
+   int            N;
+   int            K;
+   const UniJAR*  A;
+   const UniJAR*  B;
+   UniJAR*        C;
+} JarAsyncMatArg;
+
+static void jar_matmul_part( void* arg, const int part ) {
+/* columns part*JAR_ASYNC_NB ... of C */
+  const JarAsyncMatArg* a = (const JarAsyncMatArg*)arg;
+  const int n0 = part*JAR_ASYNC_NB;
+  const int nb = (a->N-n0 < JAR_ASYNC_NB) ? a->N-n0 : JAR_ASYNC_NB;
+
+  jar_matmul_avx512( a->M, nb, a->K, a->A, a->B+(size_t)n0*a->K, a->C+(size_t)n0*a->M );
+}
+
+static void jar_matvecmul_part( void* arg, const int part ) {
+/* rows part*JAR_ASYNC_MB ... of c, accumulated and converted as in jar_matvecmul_avx512 */
+  const JarAsyncMatArg* a = (const JarAsyncMatArg*)arg;
+  const int m0 = part*JAR_ASYNC_MB;
+  const int mb = (a->M-m0 < JAR_ASYNC_MB) ? a->M-m0 : JAR_ASYNC_MB;
+  int m;
+
+  for (m=m0; m<m0+mb; ++m) {
+    a->C[m].I = JAR_ZERO;
+  }
+  jar_matvecacc_avx512( mb, a->K, a->A+m0, a->M, a->B, a->C+m0 );
+  for (m=m0; m<m0+mb; ++m) {
+    a->C[m] = LinFP32_2_LogPS80( a->C[m] );
+  }
+}
+
+static void jar_dotprod_part( void* arg, const int part ) {
+  const JarAsyncMatArg* a = (const JarAsyncMatArg*)arg;
+
+  (void)part;
+  *a->C = jar_dotprod( a->K, a->A, a->B );
+}
+
+EventJAR* jar_matmul_async( QueueJAR* q, const int M, const int N, const int K, const UniJAR* A, const UniJAR* B, UniJAR* C,
+                            const int ndeps, EventJAR* const* deps ) {
+/* enqueues C = A*B, see jar_matmul_avx512 */
+  JarAsyncMatArg a;
+
+  assert (M >= 0);
+  assert (N >= 0);
+  assert (K >= 0);
+
+  a.M = M; a.N = N; a.K = K; a.A = A; a.B = B; a.C = C;
+  return jar_submit( q, (N + JAR_ASYNC_NB - 1)/JAR_ASYNC_NB, jar_matmul_part, &a, sizeof(a), ndeps, deps );
+}
+
+EventJAR* jar_matvecmul_async( QueueJAR* q, const int M, const int K, const UniJAR* A, const UniJAR* b, UniJAR* c,
+                               const int ndeps, EventJAR* const* deps ) {
+/* enqueues c = A*b, see jar_matvecmul_avx512 */
+  JarAsyncMatArg a;
+
+  assert (M >= 0);
+  assert (K >= 0);
+
+  a.M = M; a.N = 1; a.K = K; a.A = A; a.B = b; a.C = c;
+  return jar_submit( q, (M + JAR_ASYNC_MB - 1)/JAR_ASYNC_MB, jar_matvecmul_part, &a, sizeof(a), ndeps, deps );
+}
+
+EventJAR* jar_dotprod_async( QueueJAR* q, const int n, const UniJAR* x, const UniJAR* y, UniJAR* z,
+                             const int ndeps, EventJAR* const* deps ) {
+/* enqueues *z = jar_dotprod( n, x, y ) */
+  JarAsyncMatArg a;
+
+  assert (n >= 0);
+
+  a.M = 1; a.N = 1; a.K = n; a.A = x; a.B = y; a.C = z;
+  return jar_submit( q, 1, jar_dotprod_part, &a, sizeof(a), ndeps, deps );
+}
+
+typedef struct{
+   size_t         n;
+   const UniJAR*  x;
+   UniJAR*        y;
+   RndJAR         rnd;
+   int            has_rnd;
+} JarAsyncConvertArg;
+
+static void jar_convert_part( void* arg, const int part ) {
+  const JarAsyncConvertArg* a = (const JarAsyncConvertArg*)arg;
+
+  (void)part;
+  jar_convert_LinFP32_2_LogPS80( a->n, a->x, a->y, a->has_rnd ? &a->rnd : NULL );
+}
+
+EventJAR* jar_convert_async( QueueJAR* q, const size_t n, const UniJAR* x, UniJAR* y, const RndJAR* rnd,
+                             const int ndeps, EventJAR* const* deps ) {
+/* enqueues jar_convert_LinFP32_2_LogPS80( n, x, y, rnd ), rnd is copied */
+  JarAsyncConvertArg a;
+
+  memset( &a, 0, sizeof(a) );
+  a.n = n; a.x = x; a.y = y;
+  if (rnd != NULL) {
+    a.rnd = *rnd;
+    a.has_rnd = 1;
+  }
+  return jar_submit( q, 1, jar_convert_part, &a, sizeof(a), ndeps, deps );
+}
@@ -0,0 +1,95 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Asynchronous submission of JAR kernels with completion events.
+ *
+ *  A queue (QueueJAR) owns a set of executor threads. jar_submit enqueues a job of 
+ *  nparts independent parts, fn( arg, part ) for part = 0, ..., nparts-1, which starts 
+ *  once all events it depends on are complete, and returns the event of the job. Parts
+ *  of ready jobs are handed out to idle executors in submission order, so independent 
+ *  jobs (the heads of an attention layer, the experts of an MoE layer, the conversion of
+ *  the next input) run side by side and large products are split over all executors.
+ *
+ *  jar_matmul_async, jar_matvecmul_async, jar_dotprod_async and jar_convert_async enqueue
+ *  the JAR kernels; products are split into blocks of JAR_ASYNC_NB columns and 
+ *  JAR_ASYNC_MB rows, their results are identical to the synchronous calls. The inputs 
+ *  have to stay valid and the outputs untouched until the event is complete.
+ *
+ *  An event is waited for with jar_event_wait, which runs ready parts on the calling 
+ *  thread in the meantime (a queue without executors runs everything this way), or 
+ *  polled with jar_event_test. jar_event_then registers a callback that runs on 
+ *  completion; jar_async.hpp builds the C++20 awaitable of an event on jar_event_test 
+ *  and jar_event_then. Events are reference counted, the caller owns one reference of 
+ *  every event returned and drops it with jar_event_release. Kernels run by executors 
+ *  submit their own parallel loops serially, see jar_pool_serial.
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_ASYNC
+
+#define JAR_ASYNC
+#include <stddef.h>
+#include "jar_sim.h"
+#include "jar_pool.h"
+
+/* columns per part of jar_matmul_async */
+#define JAR_ASYNC_NB  32
+/* rows per part of jar_matvecmul_async */
+#define JAR_ASYNC_MB  256
+/* bytes of job arguments stored without allocation */
+#define JAR_ASYNC_ARG 128
+
+typedef struct QueueJAR QueueJAR;
+typedef struct EventJAR EventJAR;
+
+typedef void (*CallbackJAR)( void* arg );
+
+QueueJAR* jar_queue_create( const int nthreads );
+void jar_queue_destroy( QueueJAR* q );
+void jar_queue_wait_all( QueueJAR* q );
+EventJAR* jar_submit( QueueJAR* q, const int nparts, TaskJAR fn, const void* arg, const size_t argsize,
+                      const int ndeps, EventJAR* const* deps );
+int jar_event_test( EventJAR* ev );
+void jar_event_wait( EventJAR* ev );
+void jar_event_then( EventJAR* ev, CallbackJAR fn, void* arg );
+void jar_event_retain( EventJAR* ev );
+void jar_event_release( EventJAR* ev );
+EventJAR* jar_matmul_async( QueueJAR* q, const int M, const int N, const int K, const UniJAR* A, const UniJAR* B, UniJAR* C,
+                            const int ndeps, EventJAR* const* deps );
+EventJAR* jar_matvecmul_async( QueueJAR* q, const int M, const int K, const UniJAR* A, const UniJAR* b, UniJAR* c,
+                               const int ndeps, EventJAR* const* deps );
+EventJAR* jar_dotprod_async( QueueJAR* q, const int n, const UniJAR* x, const UniJAR* y, UniJAR* z,
+                             const int ndeps, EventJAR* const* deps );
+EventJAR* jar_convert_async( QueueJAR* q, const size_t n, const UniJAR* x, UniJAR* y, const RndJAR* rnd,
+                             const int ndeps, EventJAR* const* deps );
+
+#endif
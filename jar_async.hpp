@@ -0,0 +1,82 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  C++20 coroutine support for JAR events (see jar_async.h).
+ *
+ *  co_await jar_await( ev ) suspends the calling coroutine until the job of ev is 
+ *  complete. await_ready polls the event with jar_event_test and await_suspend registers
+ *  the resumption with jar_event_then, so the coroutine continues on the executor that 
+ *  completes the job, or right away on the awaiting thread if it is already complete. 
+ *  The awaiter does not take a reference, the caller keeps ev alive until the co_await
+ *  returns and releases it with jar_event_release as usual.
+ *
+ *  The library itself is C; this header only needs a C++20 compiler (make check_hpp).
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_ASYNC_HPP
+
+#define JAR_ASYNC_HPP
+#include <coroutine>
+
+extern "C" {
+#include "jar_async.h"
+}
+
+class EventAwaiterJAR {
+public:
+  explicit EventAwaiterJAR( EventJAR* ev ) : ev_( ev ) {}
+
+  bool await_ready() const {
+    return jar_event_test( ev_ ) != 0;
+  }
+
+  void await_suspend( std::coroutine_handle<> h ) const {
+    /* nothing of the awaiter is touched after this, h may already be resumed */
+    jar_event_then( ev_, jar_await_resume, h.address() );
+  }
+
+  void await_resume() const {}
+
+private:
+  static void jar_await_resume( void* h ) {
+    std::coroutine_handle<>::from_address( h ).resume();
+  }
+
+  EventJAR* ev_;
+};
+
+inline EventAwaiterJAR jar_await( EventJAR* ev ) {
+  return EventAwaiterJAR( ev );
+}
+
+#endif
@@ -0,0 +1,606 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  jar_bench: benchmark suite of the JAR kernels over sweeps of shapes.
+ *
+ *    jar_bench [-set s1,s2,...] [-kernel k1,k2,...] [-time sec] [-scalar-max n] [-json out.json] [-list]
+ *              [-perf] [-perf-event name=rUUEE ...] [-roofline] [-tune] [-tune-file path]
+ *
+ *  Sets are square, skinny, deepbench (the DeepBench inference GEMMs that fit one 
+ *  socket), transformer (the layers of a BERT-base block at 1 and 128 tokens and its 
+ *  batched attention products) and convert. Kernels are dot, gemv, gemm, bgemm (batched
+ *  GEMM of B independent products), lin2log, log2lin, decode (the exact linear values,
+ *  jar_convert_LogPS80_2_Lin_val), pack_ps8 and unpack_ps8.
+ *
+ *  Every case runs the JAR entry point (variant jar, the _avx512 kernel where there is 
+ *  one), the scalar reference (jar_scalar, skipped above -scalar-max multiply-adds) and
+ *  a plain FP32 loop (fp32) for the products; see jar_timer.h for warm-up, repetitions
+ *  and statistics. GEMV and GEMM also run jar_matmul_tuned / jar_matvecmul_tuned 
+ *  (jar_tuned) with the blocking of the tuning cache (see jar_tune.h). The table on 
+ *  stdout and the JSON file give median and p99 time per call, throughput, and the 
+ *  speedup of jar over jar_scalar and fp32.
+ *
+ *  -perf counts hardware events (see jar_perf.h) over 3 samples' worth of calls after the
+ *  timing and reports them per call, with IPC; -perf-event adds raw events. -roofline
+ *  measures the JAR and FP32 compute ceilings and the STREAM triad bandwidth, places 
+ *  every product on the roofline by its arithmetic intensity (ops per byte of A, B and C,
+ *  and, with -perf, ops per byte of last level cache misses), reports the attainable 
+ *  throughput and the fraction reached, and plots it on a log-log chart.
+ *
+ *  -tune first tunes the blocking of every shape class on a representative shape and
+ *  saves the winners to the cache, -tune-file path (default jar_tune_path()) is the 
+ *  cache that is loaded and saved.
+ *
+ ****************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include "jar_sim.h"
+#include "jar_mem.h"
+#include "jar_pool.h"
+#include "jar_timer.h"
+#include "jar_tool.h"
+#include "jar_perf.h"
+#include "jar_tune.h"
+
+#define JAR_BENCH_VARIANTS  4
+/* bytes per array of the STREAM triad of -roofline */
+#define JAR_BENCH_STREAM    (64u << 20)
+/* size of the roofline chart */
+#define JAR_BENCH_PLOT_W    64
+#define JAR_BENCH_PLOT_H    20
+
+typedef struct{
+   const char*    set;
+   const char*    kernel;
+   int            M;
+   int            N;
+   int            K;
+   int            B;
+} JarCase;
+
+static const JarCase jar_cases[] = {
+  { "square",      "dot",        1, 1,    1024,    1 },
+  { "square",      "dot",        1, 1,   65536,    1 },
+  { "square",      "dot",        1, 1, 1048576,    1 },
+  { "square",      "gemv",     256, 1,     256,    1 },
+  { "square",      "gemv",    1024, 1,    1024,    1 },
+  { "square",      "gemv",    4096, 1,    4096,    1 },
+  { "square",      "gemm",      64, 64,     64,    1 },
+  { "square",      "gemm",     128, 128,   128,    1 },
+  { "square",      "gemm",     256, 256,   256,    1 },
+  { "square",      "gemm",     512, 512,   512,    1 },
+  { "square",      "gemm",    1024, 1024, 1024,    1 },
+  { "skinny",      "gemv",   16384, 1,     256,    1 },
+  { "skinny",      "gemv",     256, 1,   16384,    1 },
+  { "skinny",      "gemm",    4096, 16,   1024,    1 },
+  { "skinny",      "gemm",    1024, 16,   4096,    1 },
+  { "skinny",      "gemm",      16, 1024, 1024,    1 },
+  { "skinny",      "gemm",    1024, 1024,   16,    1 },
+  { "deepbench",   "gemm",    1760, 16,   1760,    1 },
+  { "deepbench",   "gemm",    1760, 32,   1760,    1 },
+  { "deepbench",   "gemm",    2048, 16,   2048,    1 },
+  { "deepbench",   "gemm",    2560, 32,   2560,    1 },
+  { "deepbench",   "gemm",    4096, 16,   4096,    1 },
+  { "deepbench",   "gemm",    5124, 9,    2048,    1 },
+  { "deepbench",   "gemm",    7680, 1,    2560,    1 },
+  { "transformer", "gemv",    2304, 1,     768,    1 },
+  { "transformer", "gemv",     768, 1,     768,    1 },
+  { "transformer", "gemv",    3072, 1,     768,    1 },
+  { "transformer", "gemv",     768, 1,    3072,    1 },
+  { "transformer", "gemm",    2304, 128,   768,    1 },
+  { "transformer", "gemm",     768, 128,   768,    1 },
+  { "transformer", "gemm",    3072, 128,   768,    1 },
+  { "transformer", "gemm",     768, 128,  3072,    1 },
+  { "transformer", "bgemm",    128, 128,    64,   12 },
+  { "transformer", "bgemm",     64, 128,   128,   12 },
+  { "convert",     "lin2log",    1, 1,   65536,    1 },
+  { "convert",     "lin2log",    1, 1, 4194304,    1 },
+  { "convert",     "log2lin",    1, 1,   65536,    1 },
+  { "convert",     "log2lin",    1, 1, 4194304,    1 },
+  { "convert",     "decode",     1, 1,   65536,    1 },
+  { "convert",     "decode",     1, 1, 4194304,    1 },
+  { "convert",     "pack_ps8",   1, 1, 4194304,    1 },
+  { "convert",     "unpack_ps8", 1, 1, 4194304,    1 }
+};
+
+static const char* jar_variants[JAR_BENCH_VARIANTS] = { "jar", "jar_scalar", "fp32", "jar_tuned" };
+
+/* the shapes -tune tunes the classes on, in the order of JAR_SHAPE_* */
+static const int jar_tune_shapes[JAR_SHAPE_CLASSES][3] = {
+  { 4096, 1, 4096 }, { 128, 128, 128 }, { 2048, 16, 2048 }, { 512, 512, 512 }
+};
+
+typedef struct{
+   const JarCase* c;
+   int            variant;
+   UniJAR*        A;
+   UniJAR*        B;
+   UniJAR*        C;
+   float*         fA;
+   float*         fB;
+   float*         fC;
+   unsigned char* p;
+} JarBenchArg;
+
+typedef struct{
+   const JarCase* c;
+   int            variant;
+   TimingJAR      t;
+   double         ops;
+   double         bytes;
+   double         count[JAR_PERF_MAX_EVENTS];   /* per call, with -perf */
+} JarResult;
+
+static void jar_sgemm( const int M, const int N, const int K, const float* A, const float* B, float* C ) {
+/* FP32 baseline, col-major as the JAR kernels */
+  int m, n, k;
+
+  for (n=0; n<N; ++n) {
+    float* c = C + (size_t)n*M;
+    for (m=0; m<M; ++m) c[m] = 0.0f;
+    for (k=0; k<K; ++k) {
+      const float  b = B[(size_t)n*K+k];
+      const float* a = A + (size_t)k*M;
+      for (m=0; m<M; ++m) c[m] += a[m]*b;
+    }
+  }
+}
+
+static void jar_bgemm_task( void* arg, const int t ) {
+  const JarBenchArg* a = (const JarBenchArg*)arg;
+  const JarCase* c = a->c;
+
+  jar_matmul_avx512( c->M, c->N, c->K, a->A + (size_t)t*c->M*c->K, a->B + (size_t)t*c->K*c->N, a->C + (size_t)t*c->M*c->N );
+}
+
+static void jar_bench_call( void* arg ) {
+  JarBenchArg* a = (JarBenchArg*)arg;
+  const JarCase* c = a->c;
+  const size_t n = (size_t)c->K;
+  volatile float sink;
+  size_t i;
+  int    b;
+
+  if (strcmp( c->kernel, "dot" ) == 0) {
+    if (a->variant == 2) {
+      float s = 0.0f;
+      for (i=0; i<n; ++i) s += a->fA[i]*a->fB[i];
+      sink = s;
+    } else {
+      sink = jar_dotprod( (int)n, a->A, a->B ).F;
+    }
+    (void)sink;
+  } else if (strcmp( c->kernel, "gemv" ) == 0 || strcmp( c->kernel, "gemm" ) == 0) {
+    if (a->variant == 3) {
+      if (c->N == 1) jar_matvecmul_tuned( c->M, c->K, a->A, a->B, a->C );
+      else jar_matmul_tuned( c->M, c->N, c->K, a->A, a->B, a->C );
+    } else if (a->variant == 0) {
+      if (c->N == 1) jar_matvecmul_avx512( c->M, c->K, a->A, a->B, a->C );
+      else jar_matmul_avx512( c->M, c->N, c->K, a->A, a->B, a->C );
+    } else if (a->variant == 1) {
+      if (c->N == 1) jar_matvecmul( c->M, c->K, a->A, a->B, a->C );
+      else jar_matmul( c->M, c->N, c->K, a->A, a->B, a->C );
+    } else {
+      jar_sgemm( c->M, c->N, c->K, a->fA, a->fB, a->fC );
+    }
+  } else if (strcmp( c->kernel, "bgemm" ) == 0) {
+    if (a->variant == 0) {
+      jar_parallel_for( c->B, jar_bgemm_task, a );
+    }
+    for (b=0; b<c->B && a->variant > 0; ++b) {
+      if (a->variant == 1) {
+        jar_matmul( c->M, c->N, c->K, a->A + (size_t)b*c->M*c->K, a->B + (size_t)b*c->K*c->N, a->C + (size_t)b*c->M*c->N );
+      } else {
+        jar_sgemm( c->M, c->N, c->K, a->fA + (size_t)b*c->M*c->K, a->fB + (size_t)b*c->K*c->N, a->fC + (size_t)b*c->M*c->N );
+      }
+    }
+  } else if (strcmp( c->kernel, "lin2log" ) == 0) {
+    if (a->variant == 0) {
+      jar_convert_LinFP32_2_LogPS80( n, a->B, a->C, NULL );
+    } else {
+      for (i=0; i<n; ++i) a->C[i] = LinFP32_2_LogPS80( a->B[i] );
+    }
+  } else if (strcmp( c->kernel, "log2lin" ) == 0) {
+    i = 0;
+#if defined(__AVX512F__)
+    for ( ; a->variant == 0 && i+16<=n; i+=16) {
+      _mm512_storeu_epi32( a->C+i, LogPS80_2_LinFP32_avx512( _mm512_loadu_epi32( a->A+i ) ) );
+    }
+#endif
+    for ( ; i<n; ++i) a->C[i] = LogPS80_2_LinFP32( a->A[i] );
+  } else if (strcmp( c->kernel, "decode" ) == 0) {
+    if (a->variant == 0) {
+      jar_convert_LogPS80_2_Lin_val( n, a->A, a->fC );
+    } else {
+      for (i=0; i<n; ++i) a->fC[i] = LogPS80_2_Lin_val( a->A[i] );
+    }
+  } else if (strcmp( c->kernel, "pack_ps8" ) == 0) {
+    jar_pack_PS8( n, a->A, a->p );
+  } else if (strcmp( c->kernel, "unpack_ps8" ) == 0) {
+    jar_unpack_PS8( n, a->p, a->C );
+  }
+}
+
+static int jar_bench_has( const JarCase* c, const int variant ) {
+  const int product = (strcmp( c->kernel, "dot" ) == 0 || strcmp( c->kernel, "gemv" ) == 0 ||
+                       strcmp( c->kernel, "gemm" ) == 0 || strcmp( c->kernel, "bgemm" ) == 0);
+
+  if (variant == 3) return strcmp( c->kernel, "gemv" ) == 0 || strcmp( c->kernel, "gemm" ) == 0;
+  if (variant == 2) return product;
+  if (variant == 1) return strcmp( c->kernel, "dot" ) != 0 && strncmp( c->kernel, "pack", 4 ) != 0 && strncmp( c->kernel, "unpack", 6 ) != 0;
+  return 1;
+}
+
+static int jar_bench_product( const JarCase* c ) {
+  return strcmp( c->kernel, "dot" ) == 0 || strcmp( c->kernel, "gemv" ) == 0 ||
+         strcmp( c->kernel, "gemm" ) == 0 || strcmp( c->kernel, "bgemm" ) == 0;
+}
+
+static void jar_bench_case( const JarCase* c, const int variant, const double min_time, PerfJAR* perf, JarResult* r ) {
+  const size_t na = (size_t)c->M*c->K*c->B, nb = (size_t)c->K*c->N*c->B, nc = (size_t)c->M*c->N*c->B;
+  const size_t nx = (na > nb) ? na : nb;
+  unsigned int seed = 12345;
+  JarBenchArg a;
+  long i, n;
+  int  e;
+
+  a.c  = c;
+  a.variant = variant;
+  a.A  = (UniJAR*) jar_malloc( nx*sizeof(UniJAR) );
+  a.B  = (UniJAR*) jar_malloc( nx*sizeof(UniJAR) );
+  a.C  = (UniJAR*) jar_malloc( ((nc > nx) ? nc : nx)*sizeof(UniJAR) );
+  a.fA = (float*) jar_malloc( nx*sizeof(float) );
+  a.fB = (float*) jar_malloc( nx*sizeof(float) );
+  a.fC = (float*) jar_malloc( ((nc > nx) ? nc : nx)*sizeof(float) );
+  a.p  = (unsigned char*) jar_malloc( nx );
+  jar_fill_uniform( na, a.A, a.fA, &seed );
+  jar_fill_uniform( nb, a.B, a.fB, &seed );
+  if (strcmp( c->kernel, "lin2log" ) == 0) {
+    memcpy( a.B, a.fB, nb*sizeof(float) );
+  }
+  jar_pack_PS8( na, a.A, a.p );
+
+  r->c = c;
+  r->variant = variant;
+  if (jar_bench_product( c )) {
+    r->ops   = 2.0*c->M*c->N*c->K*c->B;
+    r->bytes = (c->M == 1 && c->N == 1) ? 8.0*c->K : 4.0*(double)(na + nb + nc);
+  } else {
+    r->ops   = (double)c->K;
+    r->bytes = (strstr( c->kernel, "ps8" ) != NULL) ? 5.0*c->K : 8.0*c->K;
+  }
+  jar_timer_measure( jar_bench_call, &a, min_time, &r->t );
+  if (perf != NULL) {
+    n = 3*r->t.reps;
+    jar_perf_start( perf );
+    for (i=0; i<n; ++i) {
+      jar_bench_call( &a );
+    }
+    jar_perf_stop( perf );
+    for (e=0; e<perf->nevents; ++e) {
+      r->count[e] = perf->count[e]/(double)n;
+    }
+  }
+
+  jar_free( a.p ); jar_free( a.fC ); jar_free( a.fB ); jar_free( a.fA );
+  jar_free( a.C ); jar_free( a.B ); jar_free( a.A );
+}
+
+static const JarResult* jar_bench_find( const JarResult* r, const int nr, const JarCase* c, const int variant ) {
+  int i;
+
+  for (i=0; i<nr; ++i) {
+    if (r[i].c == c && r[i].variant == variant) return r+i;
+  }
+  return NULL;
+}
+
+static double jar_bench_ipc( const PerfJAR* p, const JarResult* r ) {
+/* instructions per cycle, 0 if either is not counted */
+  const int c = jar_perf_find( p, "cycles" ), i = jar_perf_find( p, "instructions" );
+
+  return (c >= 0 && i >= 0 && r->count[c] > 0.0) ? r->count[i]/r->count[c] : 0.0;
+}
+
+static double jar_bench_roof( const JarResult* r, const double peak_jar, const double peak_fp32, const double bw, const double ai ) {
+/* attainable ops per second at arithmetic intensity ai */
+  const double peak = (r->variant == 2) ? peak_fp32 : peak_jar;
+
+  return (ai*bw < peak) ? ai*bw : peak;
+}
+
+static void jar_bench_plot( const JarResult* res, const int nr, const double peak_jar, const double peak_fp32, const double bw ) {
+/* log-log roofline, intensity 1/16 .. 256 ops per byte on x, one decade per 4 rows on y */
+  const double xmin = -4.0, xmax = 8.0;
+  const double ymax = log10( 2.0*((peak_jar > peak_fp32) ? peak_jar : peak_fp32) ), ymin = ymax - 0.25*JAR_BENCH_PLOT_H;
+  char   plot[JAR_BENCH_PLOT_H][JAR_BENCH_PLOT_W+1];
+  int    x, y, i, k = 0;
+
+  memset( plot, ' ', sizeof(plot) );
+  for (x=0; x<JAR_BENCH_PLOT_W; ++x) {
+    const double ai = pow( 2.0, xmin + (xmax - xmin)*(x + 0.5)/JAR_BENCH_PLOT_W );
+    const double roof[2] = { (ai*bw < peak_jar) ? ai*bw : peak_jar, (ai*bw < peak_fp32) ? ai*bw : peak_fp32 };
+    for (i=0; i<2; ++i) {
+      y = (int)((ymax - log10( roof[i] ))/(ymax - ymin)*JAR_BENCH_PLOT_H);
+      if (y >= 0 && y < JAR_BENCH_PLOT_H) plot[y][x] = (roof[i] < ((i == 0) ? peak_jar : peak_fp32)) ? '/' : ((i == 0) ? '=' : '-');
+    }
+  }
+  for (i=0; i<nr; ++i) {
+    const JarResult* r = res+i;
+    if (!jar_bench_product( r->c )) continue;
+    x = (int)((log2( r->ops/r->bytes ) - xmin)/(xmax - xmin)*JAR_BENCH_PLOT_W);
+    y = (int)((ymax - log10( r->ops/r->t.median ))/(ymax - ymin)*JAR_BENCH_PLOT_H);
+    x = (x < 0) ? 0 : ((x >= JAR_BENCH_PLOT_W) ? JAR_BENCH_PLOT_W-1 : x);
+    y = (y < 0) ? 0 : ((y >= JAR_BENCH_PLOT_H) ? JAR_BENCH_PLOT_H-1 : y);
+    plot[y][x] = (k < 26) ? (char)('a' + k) : '*';
+    ++k;
+  }
+  printf("\nGOP/s  (= JAR peak, - FP32 peak, / bandwidth)\n");
+  for (y=0; y<JAR_BENCH_PLOT_H; ++y) {
+    plot[y][JAR_BENCH_PLOT_W] = '\0';
+    if (y % 4 == 0) printf("%8.3g |%s\n", 1.0e-9*pow( 10.0, ymax - (ymax - ymin)*y/JAR_BENCH_PLOT_H ), plot[y]);
+    else printf("%8s |%s\n", "", plot[y]);
+  }
+  printf("%8s +", "");
+  for (x=0; x<JAR_BENCH_PLOT_W; ++x) printf("%c", (x % (JAR_BENCH_PLOT_W/6) == 0) ? '+' : '-');
+  printf("\n%8s ", "");
+  for (x=0; x<6; ++x) printf("%-*g", JAR_BENCH_PLOT_W/6, pow( 2.0, xmin + (xmax - xmin)*x/6.0 ));
+  printf("ops/byte\n");
+}
+
+static void print_usage( ) {
+  printf("usage: jar_bench [-set s1,s2,...] [-kernel k1,k2,...] [-time sec] [-scalar-max n] [-json out.json] [-list]\n");
+  printf("                 [-perf] [-perf-event name=rUUEE ...] [-roofline] [-tune] [-tune-file path]\n");
+  printf("       sets: square skinny deepbench transformer convert\n");
+  printf("       kernels: dot gemv gemm bgemm lin2log log2lin decode pack_ps8 unpack_ps8\n");
+}
+
+int main( int argc, char* argv[] ) {
+  const int ncases = (int)(sizeof(jar_cases)/sizeof(JarCase));
+  const char* sets = NULL;
+  const char* kernels = NULL;
+  const char* json = NULL;
+  const char* tune_file = NULL;
+  double min_time = 0.2, scalar_max = 268435456.0;
+  JarResult* res = (JarResult*) calloc( ncases*JAR_BENCH_VARIANTS, sizeof(JarResult) );
+  int a = 1, i, v, e, nr = 0, list = 0, perf = 0, roofline = 0, tune = 0, llc;
+  double peak_jar = 0.0, peak_fp32 = 0.0, bw = 0.0;
+  PerfJAR counters;
+  FILE* fp;
+
+  jar_perf_init( &counters );
+
+  while (a < argc) {
+    if (strcmp( argv[a], "-set" ) == 0 && a+1 < argc) {
+      sets = argv[++a];
+    } else if (strcmp( argv[a], "-kernel" ) == 0 && a+1 < argc) {
+      kernels = argv[++a];
+    } else if (strcmp( argv[a], "-time" ) == 0 && a+1 < argc) {
+      min_time = atof( argv[++a] );
+    } else if (strcmp( argv[a], "-scalar-max" ) == 0 && a+1 < argc) {
+      scalar_max = atof( argv[++a] );
+    } else if (strcmp( argv[a], "-json" ) == 0 && a+1 < argc) {
+      json = argv[++a];
+    } else if (strcmp( argv[a], "-list" ) == 0) {
+      list = 1;
+    } else if (strcmp( argv[a], "-perf" ) == 0) {
+      perf = 1;
+    } else if (strcmp( argv[a], "-perf-event" ) == 0 && a+1 < argc) {
+      if (jar_perf_add( &counters, argv[++a] ) != 0) {
+        fprintf( stderr, "jar_bench: bad event %s\n", argv[a] );
+        return 1;
+      }
+      perf = 1;
+    } else if (strcmp( argv[a], "-roofline" ) == 0) {
+      roofline = 1;
+    } else if (strcmp( argv[a], "-tune" ) == 0) {
+      tune = 1;
+    } else if (strcmp( argv[a], "-tune-file" ) == 0 && a+1 < argc) {
+      tune_file = argv[++a];
+    } else {
+      print_usage();
+      return 1;
+    }
+    ++a;
+  }
+
+  if (tune_file == NULL) {
+    tune_file = jar_tune_path();
+  } else if (!list) {
+    jar_tune_load( tune_file );
+  }
+  if (tune && !list) {
+    for (i=0; i<JAR_SHAPE_CLASSES; ++i) {
+      const int* t = jar_tune_shapes[i];
+      BlockJAR p;
+      const double g = jar_tune_run( i, t[0], t[1], t[2], 0.05, &p, NULL );
+      jar_tune_set( i, &p, g );
+      printf("tuned %-6s on %i x %i x %i: mv %i nr %i mc %i kc %i nc %i split %i, %.3f GOP/s\n", jar_tune_class_name( i ),
+             t[0], t[1], t[2], p.mv, p.nr, p.mc, p.kc, p.nc, p.split, g);
+    }
+    if (tune_file[0] == '\0' || jar_tune_save( tune_file ) != 0) {
+      fprintf( stderr, "jar_bench: cannot write the tuning cache %s\n", tune_file );
+    } else {
+      printf("tuning cache %s updated for %s (%s)\n", tune_file, jar_tune_cpu(), jar_tune_isa());
+    }
+  }
+  if (perf && !list) {
+    /* the pool threads must exist to be counted */
+    jar_pool_default();
+    jar_perf_open( &counters );
+    printf("events:");
+    for (e=0; e<counters.nevents; ++e) {
+      printf(" %s%s", counters.name[e], counters.avail[e] ? "" : "(n/a)");
+    }
+    printf("\n");
+  }
+  llc = perf ? jar_perf_find( &counters, "llc_miss" ) : -1;
+  if (roofline && !list) {
+    peak_jar  = jar_perf_peak_jar();
+    peak_fp32 = jar_perf_peak_fp32();
+    bw        = jar_perf_stream( JAR_BENCH_STREAM );
+    printf("peak JAR %.3f GOP/s, peak FP32 %.3f GFLOP/s, STREAM triad %.3f GB/s, ridge %.2f / %.2f ops/byte\n",
+           1.0e-9*peak_jar, 1.0e-9*peak_fp32, 1.0e-9*bw, peak_jar/bw, peak_fp32/bw);
+  }
+
+  printf("%-12s %-10s %-10s %6s %6s %8s %3s %12s %12s %9s %8s %8s %8s\n", "set", "kernel", "variant", "M", "N", "K", "B",
+         "median us", "p99 us", "GOP/s", "GB/s", "x scalar", "x fp32");
+  for (i=0; i<ncases; ++i) {
+    const JarCase* c = jar_cases+i;
+    if ((sets != NULL && !jar_list_has( sets, c->set )) || (kernels != NULL && !jar_list_has( kernels, c->kernel ))) {
+      continue;
+    }
+    for (v=0; v<JAR_BENCH_VARIANTS; ++v) {
+      JarResult* r = res+nr;
+      if (!jar_bench_has( c, v ) || (v == 1 && (double)c->M*c->N*c->K*c->B > scalar_max)) {
+        continue;
+      }
+      if (list) {
+        printf("%-12s %-10s %-10s %6i %6i %8i %3i\n", c->set, c->kernel, jar_variants[v], c->M, c->N, c->K, c->B);
+        continue;
+      }
+      jar_bench_case( c, v, min_time, perf ? &counters : NULL, r );
+      ++nr;
+      printf("%-12s %-10s %-10s %6i %6i %8i %3i %12.3f %12.3f %9.3f %8.3f", c->set, c->kernel, jar_variants[v],
+             c->M, c->N, c->K, c->B, 1.0e6*r->t.median, 1.0e6*r->t.p99, 1.0e-9*r->ops/r->t.median, 1.0e-9*r->bytes/r->t.median);
+      if (v == 2) {
+        const JarResult* j = jar_bench_find( res, nr, c, 0 );
+        const JarResult* s = jar_bench_find( res, nr, c, 1 );
+        if (s != NULL) printf(" %8.2f", s->t.median/j->t.median); else printf(" %8s", "-");
+        printf(" %8.2f", r->t.median/j->t.median);
+      }
+      printf("\n");
+      if (perf) {
+        printf("%12s", "");
+        for (e=0; e<counters.nevents; ++e) {
+          if (counters.avail[e]) printf(" %s %.4g", counters.name[e], r->count[e]);
+        }
+        if (jar_bench_ipc( &counters, r ) > 0.0) printf(" ipc %.2f", jar_bench_ipc( &counters, r ));
+        printf("\n");
+      }
+      if (roofline && jar_bench_product( c )) {
+        const double ai = r->ops/r->bytes, roof = jar_bench_roof( r, peak_jar, peak_fp32, bw, ai );
+        printf("%12s ai %.3f ops/byte, attainable %.3f GOP/s, %.1f%% of roof, %s bound", "", ai, 1.0e-9*roof,
+               100.0*r->ops/r->t.median/roof, (ai*bw < ((v == 2) ? peak_fp32 : peak_jar)) ? "memory" : "compute");
+        if (llc >= 0 && r->count[llc] > 0.0) printf(", measured ai %.3f", r->ops/(64.0*r->count[llc]));
+        printf("\n");
+      }
+      fflush( stdout );
+    }
+  }
+  if (roofline && !list && nr > 0) {
+    jar_bench_plot( res, nr, peak_jar, peak_fp32, bw );
+    for (i=0, v=0; i<nr; ++i) {
+      if (!jar_bench_product( res[i].c )) continue;
+      printf("  %c %s %s %s %ix%ix%i", (v < 26) ? 'a' + v : '*', res[i].c->set, res[i].c->kernel, jar_variants[res[i].variant],
+             res[i].c->M, res[i].c->N, res[i].c->K);
+      if (res[i].c->B > 1) printf("x%i", res[i].c->B);
+      printf("\n");
+      ++v;
+    }
+  }
+  if (perf && !list) {
+    jar_perf_close( &counters );
+  }
+  if (list || json == NULL) {
+    free( res );
+    return 0;
+  }
+
+  fp = fopen( json, "w" );
+  if (fp == NULL) {
+    fprintf( stderr, "jar_bench: cannot write %s\n", json );
+    return 1;
+  }
+  fprintf( fp, "{\n  \"suite\": \"jar_bench\",\n  \"version\": 1,\n" );
+  fprintf( fp, "  \"host\": { \"cpus\": %li, \"pool_threads\": %i, \"avx512\": %s },\n",
+           sysconf( _SC_NPROCESSORS_ONLN ), jar_pool_size( jar_pool_default() ),
+#if defined(__AVX512F__)
+           "true"
+#else
+           "false"
+#endif
+           );
+  fprintf( fp, "  \"timer\": { \"min_time\": %g, \"warmup\": %g, \"sample\": %g },\n", min_time, JAR_TIMER_WARMUP, JAR_TIMER_SAMPLE );
+  if (perf) {
+    fprintf( fp, "  \"events\": [" );
+    for (e=0; e<counters.nevents; ++e) {
+      fprintf( fp, "%s{ \"name\": \"%s\", \"type\": %u, \"config\": \"0x%llx\", \"available\": %s }", (e > 0) ? ", " : " ",
+               counters.name[e], counters.type[e], (unsigned long long)counters.config[e], counters.avail[e] ? "true" : "false" );
+    }
+    fprintf( fp, " ],\n" );
+  }
+  if (roofline) {
+    fprintf( fp, "  \"roofline\": { \"peak_jar_gops\": %.6f, \"peak_fp32_gflops\": %.6f, \"stream_triad_gbs\": %.6f,"
+             " \"stream_bytes\": %u },\n", 1.0e-9*peak_jar, 1.0e-9*peak_fp32, 1.0e-9*bw, JAR_BENCH_STREAM );
+  }
+  fprintf( fp, "  \"results\": [\n" );
+  for (i=0; i<nr; ++i) {
+    const JarResult* r = res+i;
+    const JarResult* j = jar_bench_find( res, nr, r->c, 0 );
+    const JarResult* s = jar_bench_find( res, nr, r->c, 1 );
+    const JarResult* f = jar_bench_find( res, nr, r->c, 2 );
+    fprintf( fp, "    { \"set\": \"%s\", \"kernel\": \"%s\", \"variant\": \"%s\", \"M\": %i, \"N\": %i, \"K\": %i, \"B\": %i,\n",
+             r->c->set, r->c->kernel, jar_variants[r->variant], r->c->M, r->c->N, r->c->K, r->c->B );
+    fprintf( fp, "      \"reps\": %li, \"samples\": %i, \"median_s\": %.9e, \"p99_s\": %.9e, \"min_s\": %.9e, \"max_s\": %.9e,"
+             " \"mean_s\": %.9e, \"stddev_s\": %.9e,\n", r->t.reps, r->t.samples, r->t.median, r->t.p99, r->t.min, r->t.max,
+             r->t.mean, r->t.stddev );
+    fprintf( fp, "      \"gops\": %.6f, \"gbs\": %.6f", 1.0e-9*r->ops/r->t.median, 1.0e-9*r->bytes/r->t.median );
+    if (r->variant == 0 && s != NULL) fprintf( fp, ", \"speedup_vs_scalar\": %.4f", s->t.median/j->t.median );
+    if (r->variant == 0 && f != NULL) fprintf( fp, ", \"speedup_vs_fp32\": %.4f", f->t.median/j->t.median );
+    if (r->variant == 3) fprintf( fp, ", \"speedup_vs_jar\": %.4f", j->t.median/r->t.median );
+    if (perf) {
+      fprintf( fp, ",\n      \"counters\": {" );
+      for (e=0, v=0; e<counters.nevents; ++e) {
+        if (counters.avail[e]) fprintf( fp, "%s\"%s\": %.6g", (v++ > 0) ? ", " : " ", counters.name[e], r->count[e] );
+      }
+      if (jar_bench_ipc( &counters, r ) > 0.0) fprintf( fp, "%s\"ipc\": %.4f", (v > 0) ? ", " : " ", jar_bench_ipc( &counters, r ) );
+      fprintf( fp, " }" );
+    }
+    if (roofline && jar_bench_product( r->c )) {
+      const double ai = r->ops/r->bytes, roof = jar_bench_roof( r, peak_jar, peak_fp32, bw, ai );
+      fprintf( fp, ",\n      \"roofline\": { \"ai\": %.6f, \"attainable_gops\": %.6f, \"fraction\": %.6f, \"bound\": \"%s\"",
+               ai, 1.0e-9*roof, r->ops/r->t.median/roof, (ai*bw < ((r->variant == 2) ? peak_fp32 : peak_jar)) ? "memory" : "compute" );
+      if (llc >= 0 && r->count[llc] > 0.0) fprintf( fp, ", \"measured_ai\": %.6f", r->ops/(64.0*r->count[llc]) );
+      fprintf( fp, " }" );
+    }
+    fprintf( fp, " }%s\n", (i+1 < nr) ? "," : "" );
+  }
+  fprintf( fp, "  ]\n}\n" );
+  fclose( fp );
+  free( res );
+  return 0;
+}
@@ -0,0 +1,223 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  jar_check: accuracy check of the JAR kernels against an FP64 reference (see 
+ *  jar_valid.h), e.g. for nightly runs.
+ *
+ *    jar_check [-kernel k1,k2,...] [-shape MxNxK ...] [-seed s] [-max-ulp u] [-max-mean-ulp u]
+ *              [-json out.json] [-tune-file path]
+ *
+ *  Kernels are dot (jar_dotprod), gemv (jar_matvecmul_avx512), gemv_scalar 
+ *  (jar_matvecmul), gemv_tuned (jar_matvecmul_tuned), gemm (jar_matmul_avx512), 
+ *  gemm_scalar (jar_matmul), gemm_tuned (jar_matmul_tuned) and gemm_sr 
+ *  (jar_matmul_rnd_avx512 with stochastic rounding); the default is all but the scalar
+ *  ones. Each runs on every shape (default 512x512x512; N is 1 for gemv, M and N are 1
+ *  for dot) with inputs uniform in [-2, 2) rounded to LogPS80. The time of the kernel,
+ *  of the FP64 reference and of the comparison are reported with the ulp and relative
+ *  error histograms. The exit status is 1 if a result is not finite, off by more than 
+ *  the -max-ulp bound or if the mean error is above the -max-mean-ulp bound (both 
+ *  unbounded by default).
+ *
+ ****************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "jar_sim.h"
+#include "jar_mem.h"
+#include "jar_timer.h"
+#include "jar_tool.h"
+#include "jar_tune.h"
+#include "jar_valid.h"
+
+#define JAR_CHECK_MAX_SHAPES 64
+
+static const char* jar_check_kernels[] = { "dot", "gemv", "gemv_scalar", "gemv_tuned", "gemm", "gemm_scalar",
+                                            "gemm_tuned", "gemm_sr" };
+
+static int jar_check_selected( const char* list, const char* name ) {
+/* name is in the comma separated list, or the list is NULL and name is not a scalar kernel */
+  return (list == NULL) ? strstr( name, "_scalar" ) == NULL : jar_list_has( list, name );
+}
+
+static void jar_check_run( const char* k, const int M, const int N, const int K, const UniJAR* A, const UniJAR* B, UniJAR* C ) {
+  if (strcmp( k, "dot" ) == 0) {
+    C[0] = jar_dotprod( K, A, B );
+  } else if (strcmp( k, "gemv" ) == 0) {
+    jar_matvecmul_avx512( M, K, A, B, C );
+  } else if (strcmp( k, "gemv_scalar" ) == 0) {
+    jar_matvecmul( M, K, A, B, C );
+  } else if (strcmp( k, "gemv_tuned" ) == 0) {
+    jar_matvecmul_tuned( M, K, A, B, C );
+  } else if (strcmp( k, "gemm" ) == 0) {
+    jar_matmul_avx512( M, N, K, A, B, C );
+  } else if (strcmp( k, "gemm_scalar" ) == 0) {
+    jar_matmul( M, N, K, A, B, C );
+  } else if (strcmp( k, "gemm_tuned" ) == 0) {
+    jar_matmul_tuned( M, N, K, A, B, C );
+  } else if (strcmp( k, "gemm_sr" ) == 0) {
+    RndJAR rnd;
+    rnd.mode = JAR_RND_STOCHASTIC;
+    rnd.key[0] = 0x5eed; rnd.key[1] = 0;
+    rnd.ctr[0] = 0; rnd.ctr[1] = 0;
+    jar_matmul_rnd_avx512( M, N, K, A, B, C, &rnd );
+  }
+}
+
+static void jar_check_json( FILE* fp, const char* k, const int M, const int N, const int K, const double t[3],
+                            const ValidJAR* v, const int failed ) {
+/* one element of the results array, without the separator */
+  int b;
+
+  fprintf( fp, "    { \"kernel\": \"%s\", \"M\": %i, \"N\": %i, \"K\": %i, \"kernel_s\": %.6e, \"reference_s\": %.6e,"
+           " \"compare_s\": %.6e,\n", k, M, N, K, t[0], t[1], t[2] );
+  fprintf( fp, "      \"values\": %llu, \"range\": %llu, \"sign\": %llu, \"nonfinite\": %llu, \"mean_ulp\": %.6f,"
+           " \"max_ulp\": %.6f, \"worst\": %zu, \"max_rel\": %.6e, \"max_abs\": %.6e, \"failed\": %s,\n",
+           (unsigned long long)v->n, (unsigned long long)v->range, (unsigned long long)v->sign,
+           (unsigned long long)v->nonfinite, jar_valid_mean_ulp( v ), v->max_ulp, v->worst, v->max_rel, v->max_abs,
+           failed ? "true" : "false" );
+  fprintf( fp, "      \"ulp_hist\": [" );
+  for (b=0; b<JAR_VALID_ULP_BINS; ++b) fprintf( fp, "%s%llu", b ? ", " : "", (unsigned long long)v->ulp[b] );
+  fprintf( fp, "], \"rel_hist\": [" );
+  for (b=0; b<JAR_VALID_REL_BINS; ++b) fprintf( fp, "%s%llu", b ? ", " : "", (unsigned long long)v->rel[b] );
+  fprintf( fp, "] }" );
+}
+
+static void print_usage( ) {
+  printf("usage: jar_check [-kernel k1,k2,...] [-shape MxNxK ...] [-seed s] [-max-ulp u] [-max-mean-ulp u]\n");
+  printf("                 [-json out.json] [-tune-file path]\n");
+  printf("       kernels: dot gemv gemv_scalar gemv_tuned gemm gemm_scalar gemm_tuned gemm_sr\n");
+}
+
+int main( int argc, char* argv[] ) {
+  const int nkernels = (int)(sizeof(jar_check_kernels)/sizeof(const char*));
+  const char* kernels = NULL;
+  const char* json = NULL;
+  int shapes[JAR_CHECK_MAX_SHAPES][3];
+  int a = 1, s, k, nshapes = 0, failed = 0, first = 1;
+  unsigned int seed0 = 12345;
+  double max_ulp = HUGE_VAL, max_mean_ulp = HUGE_VAL;
+  FILE* fp = NULL;
+
+  while (a < argc) {
+    if (strcmp( argv[a], "-kernel" ) == 0 && a+1 < argc) {
+      kernels = argv[++a];
+    } else if (strcmp( argv[a], "-shape" ) == 0 && a+1 < argc && nshapes < JAR_CHECK_MAX_SHAPES) {
+      if (sscanf( argv[++a], "%ix%ix%i", &shapes[nshapes][0], &shapes[nshapes][1], &shapes[nshapes][2] ) != 3 ||
+          shapes[nshapes][0] <= 0 || shapes[nshapes][1] <= 0 || shapes[nshapes][2] <= 0) {
+        fprintf( stderr, "jar_check: bad shape %s\n", argv[a] );
+        return 1;
+      }
+      ++nshapes;
+    } else if (strcmp( argv[a], "-seed" ) == 0 && a+1 < argc) {
+      seed0 = (unsigned int)strtoul( argv[++a], NULL, 0 );
+    } else if (strcmp( argv[a], "-max-ulp" ) == 0 && a+1 < argc) {
+      max_ulp = atof( argv[++a] );
+    } else if (strcmp( argv[a], "-max-mean-ulp" ) == 0 && a+1 < argc) {
+      max_mean_ulp = atof( argv[++a] );
+    } else if (strcmp( argv[a], "-json" ) == 0 && a+1 < argc) {
+      json = argv[++a];
+    } else if (strcmp( argv[a], "-tune-file" ) == 0 && a+1 < argc) {
+      jar_tune_load( argv[++a] );
+    } else {
+      print_usage();
+      return 1;
+    }
+    ++a;
+  }
+  if (nshapes == 0) {
+    shapes[0][0] = shapes[0][1] = shapes[0][2] = 512;
+    nshapes = 1;
+  }
+  if (json != NULL && (fp = fopen( json, "w" )) == NULL) {
+    fprintf( stderr, "jar_check: cannot open %s\n", json );
+    return 1;
+  }
+  if (fp != NULL) {
+    fprintf( fp, "{\n  \"max_ulp\": %.6f,\n  \"max_mean_ulp\": %.6f,\n  \"results\": [\n",
+             isinf( max_ulp ) ? -1.0 : max_ulp, isinf( max_mean_ulp ) ? -1.0 : max_mean_ulp );
+  }
+
+  for (s=0; s<nshapes; ++s) {
+    for (k=0; k<nkernels; ++k) {
+      const char* kn = jar_check_kernels[k];
+      const int dot = (strcmp( kn, "dot" ) == 0), gemv = (strncmp( kn, "gemv", 4 ) == 0);
+      const int M = dot ? 1 : shapes[s][0], N = (dot || gemv) ? 1 : shapes[s][1], K = shapes[s][2];
+      unsigned int seed = seed0;
+      UniJAR *A, *B, *C;
+      double *R, t[3], t0;
+      ValidJAR v;
+      int bad;
+
+      if (!jar_check_selected( kernels, kn )) continue;
+      A = (UniJAR*) jar_malloc( (size_t)M*K*sizeof(UniJAR) );
+      B = (UniJAR*) jar_malloc( (size_t)K*N*sizeof(UniJAR) );
+      C = (UniJAR*) jar_malloc( (size_t)M*N*sizeof(UniJAR) );
+      R = (double*) jar_malloc( (size_t)M*N*sizeof(double) );
+      if (A == NULL || B == NULL || C == NULL || R == NULL) {
+        fprintf( stderr, "jar_check: out of memory for %s %i x %i x %i\n", kn, M, N, K );
+        return 1;
+      }
+      jar_fill_uniform( (size_t)M*K, A, NULL, &seed );
+      jar_fill_uniform( (size_t)K*N, B, NULL, &seed );
+
+      t0 = jar_timer_now();
+      jar_check_run( kn, M, N, K, A, B, C );
+      t[0] = jar_timer_now() - t0;
+      t0 = jar_timer_now();
+      jar_valid_matmul_ref( M, N, K, A, B, R );
+      t[1] = jar_timer_now() - t0;
+      t0 = jar_timer_now();
+      jar_valid_compare( (size_t)M*N, C, R, &v );
+      t[2] = jar_timer_now() - t0;
+
+      bad = jar_valid_failed( &v, max_ulp, max_mean_ulp );
+      failed |= bad;
+      printf("%-12s %6i x %6i x %6i: kernel %.3f s, reference %.3f s, compare %.3f s%s\n", kn, M, N, K,
+             t[0], t[1], t[2], bad ? "  FAILED" : "");
+      jar_valid_print( stdout, &v );
+      if (fp != NULL) {
+        fprintf( fp, "%s", first ? "" : ",\n" );
+        jar_check_json( fp, kn, M, N, K, t, &v, bad );
+        first = 0;
+      }
+      jar_free( R ); jar_free( C ); jar_free( B ); jar_free( A );
+    }
+  }
+
+  if (fp != NULL) {
+    fprintf( fp, "\n  ],\n  \"failed\": %s\n}\n", failed ? "true" : "false" );
+    fclose( fp );
+  }
+  return failed;
+}
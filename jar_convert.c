@@ -0,0 +1,377 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  jar_convert: converts raw FP32 or BF16 weight files (col-major, no header) to a
+ *  .jar tensor file (see jar_file.h).
+ *
+ *    jar_convert [options] out.jar name rows cols in.raw [name rows cols in.raw ...]
+ *
+ *      -bf16       inputs are BF16 instead of FP32
+ *      -ps8        store 8-bit Posit(8,0) codes instead of 32-bit LogPS80
+ *      -shift k    store x * 2^k
+ *      -calib      pick the shift of each tensor with jar_calib_shift (one extra read)
+ *      -chunk n    chunk size in units of 2^20 elements (default 16)
+ *
+ *  Each tensor is streamed in chunks through a read -> convert -> write pipeline: while
+ *  chunk i is converted on the JAR thread pool (jar_pool.h), in slices of JAR_CONV_SLICE
+ *  elements, chunk i+1 is read and chunk i-1 is written by two
+ *  I/O threads. The memory used is two input and two output chunks, independent of the
+ *  size of the tensors. For each tensor the number of zeros, non-finite values, and
+ *  values that saturate (exponent >= 6) or flush (exponent <= -7) after scaling is
+ *  reported.
+ *
+ ****************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include "jar_file.h"
+#include "jar_scale.h"
+#include "jar_pool.h"
+
+/* elements per pool task of jar_convert_chunk and jar_widen_chunk */
+#define JAR_CONV_SLICE 65536
+
+typedef struct{
+   int            fd;
+   void*          buf;
+   size_t         nbytes;
+   off_t          offset;
+   ssize_t        done;
+} JarIO;
+
+typedef struct{
+   unsigned long long zero;
+   unsigned long long nonfinite;
+   unsigned long long saturated;
+   unsigned long long flushed;
+} JarConvStats;
+
+typedef struct{
+   size_t         n;
+   const void*    in;
+   int            bf16;
+   int            ps8;
+   float          scale;
+   UniJAR*        work;
+   void*          out;        /* NULL: widen only */
+   JarConvStats*  s;
+} JarConvArg;
+
+static void* jar_io_read( void* arg ) {
+  JarIO* io = (JarIO*)arg;
+  size_t n = 0;
+  ssize_t r = 1;
+
+  while (n < io->nbytes && r > 0) {
+    r = pread( io->fd, (char*)io->buf + n, io->nbytes - n, io->offset + n );
+    n += (r > 0) ? (size_t)r : 0;
+  }
+  io->done = (n == io->nbytes) ? (ssize_t)n : -1;
+  return NULL;
+}
+
+static void* jar_io_write( void* arg ) {
+  JarIO* io = (JarIO*)arg;
+  size_t n = 0;
+  ssize_t r = 1;
+
+  while (n < io->nbytes && r > 0) {
+    r = pwrite( io->fd, (const char*)io->buf + n, io->nbytes - n, io->offset + n );
+    n += (r > 0) ? (size_t)r : 0;
+  }
+  io->done = (n == io->nbytes) ? (ssize_t)n : -1;
+  return NULL;
+}
+
+static void jar_widen( const size_t n, const void* in, const int bf16, const float scale, UniJAR* x ) {
+/* FP32 or BF16 input to scaled LinFP32 */
+  size_t i;
+
+  if (bf16) {
+    const unsigned short* b = (const unsigned short*)in;
+    for (i=0; i<n; ++i) {
+      UniJAR t;
+      t.I = (unsigned int)b[i] << 16;
+      x[i].F = t.F * scale;
+    }
+  } else {
+    const float* f = (const float*)in;
+    for (i=0; i<n; ++i) {
+      x[i].F = f[i] * scale;
+    }
+  }
+}
+
+static void jar_stats( const size_t n, const UniJAR* x, JarConvStats* s ) {
+/* counts the special cases of the scaled LinFP32 values x */
+  unsigned long long zero = 0, nonfinite = 0, saturated = 0, flushed = 0;
+  size_t i;
+
+  for (i=0; i<n; ++i) {
+    const int e = (int)((x[i].I & BEXP_MASK) >> 23);
+    zero      += ((x[i].I & CLEAR_SIGN) == 0);
+    nonfinite += (e == 255);
+    saturated += (e >= 127+6 && e < 255);
+    flushed   += (e <= 127-7 && (x[i].I & CLEAR_SIGN) != 0);
+  }
+  __atomic_fetch_add( &s->zero,      zero,      __ATOMIC_RELAXED );
+  __atomic_fetch_add( &s->nonfinite, nonfinite, __ATOMIC_RELAXED );
+  __atomic_fetch_add( &s->saturated, saturated, __ATOMIC_RELAXED );
+  __atomic_fetch_add( &s->flushed,   flushed,   __ATOMIC_RELAXED );
+}
+
+static void jar_convert_task( void* arg, const int t ) {
+/* one slice of a pipeline stage: widen, count, convert and optionally pack */
+  const JarConvArg* a = (const JarConvArg*)arg;
+  const size_t i0 = (size_t)t*JAR_CONV_SLICE;
+  const size_t m = (a->n-i0 < JAR_CONV_SLICE) ? a->n-i0 : JAR_CONV_SLICE;
+  UniJAR* w = a->work+i0;
+
+  jar_widen( m, (const char*)a->in + i0*(a->bf16 ? 2 : 4), a->bf16, a->scale, w );
+  if (a->out == NULL) {
+    return;
+  }
+  jar_stats( m, w, a->s );
+  jar_convert_LinFP32_2_LogPS80( m, w, a->ps8 ? w : (UniJAR*)a->out+i0, NULL );
+  if (a->ps8) {
+    jar_pack_PS8( m, w, (unsigned char*)a->out+i0 );
+  }
+}
+
+static void jar_widen_chunk( const size_t n, const void* in, const int bf16, const float scale, UniJAR* work ) {
+/* jar_widen of n elements on the pool */
+  JarConvArg a;
+
+  a.n = n; a.in = in; a.bf16 = bf16; a.ps8 = 0; a.scale = scale; a.work = work; a.out = NULL; a.s = NULL;
+  jar_parallel_for( (int)((n + JAR_CONV_SLICE - 1)/JAR_CONV_SLICE), jar_convert_task, &a );
+}
+
+static void jar_convert_chunk( const size_t n, const void* in, const int bf16, const int ps8, 
+                               const float scale, UniJAR* work, void* out, JarConvStats* s ) {
+/* one pipeline stage: widen, count, convert and optionally pack n elements */
+  JarConvArg a;
+
+  a.n = n; a.in = in; a.bf16 = bf16; a.ps8 = ps8; a.scale = scale; a.work = work; a.out = out; a.s = s;
+  jar_parallel_for( (int)((n + JAR_CONV_SLICE - 1)/JAR_CONV_SLICE), jar_convert_task, &a );
+}
+
+static int jar_calibrate( const int fd, const size_t n, const int bf16, const size_t chunk, void* in, UniJAR* work ) {
+/* streams the input once and returns the calibrated shift, or JAR_SHIFT_MAX+1 on a read error */
+  unsigned long long hist[JAR_CALIB_BINS];
+  const size_t esize = bf16 ? 2 : 4;
+  size_t i;
+  JarIO io;
+
+  memset( hist, 0, sizeof(hist) );
+  for (i=0; i<n; i+=chunk) {
+    const size_t m = (n-i < chunk) ? n-i : chunk;
+    io.fd = fd; io.buf = in; io.nbytes = m*esize; io.offset = (off_t)(i*esize);
+    jar_io_read( &io );
+    if (io.done < 0) {
+      return JAR_SHIFT_MAX+1;
+    }
+    jar_widen_chunk( m, in, bf16, 1.0f, work );
+    jar_calib_hist( m, work, hist );
+  }
+  return jar_calib_shift( hist );
+}
+
+static void print_usage( ) {
+  printf("usage: jar_convert [-bf16] [-ps8] [-shift k | -calib] [-chunk n] out.jar name rows cols in.raw [...]\n");
+}
+
+int main( int argc, char* argv[] ) {
+  int    bf16 = 0, ps8 = 0, calib = 0, shift = 0;
+  size_t chunk = (size_t)16 << 20;
+  int    a = 1, t, nt, b;
+  const char** paths;
+  TensorJAR* tensors;
+  JarConvStats* stats;
+  void*   in[2];
+  void*   out[2];
+  UniJAR* work;
+  FILE*   fp;
+  int     fd_out;
+  struct timeval start, stop;
+  double  bytes = 0.0;
+
+  while (a < argc && argv[a][0] == '-') {
+    if (strcmp( argv[a], "-bf16" ) == 0) {
+      bf16 = 1;
+    } else if (strcmp( argv[a], "-ps8" ) == 0) {
+      ps8 = 1;
+    } else if (strcmp( argv[a], "-calib" ) == 0) {
+      calib = 1;
+    } else if (strcmp( argv[a], "-shift" ) == 0 && a+1 < argc) {
+      shift = atoi( argv[++a] );
+    } else if (strcmp( argv[a], "-chunk" ) == 0 && a+1 < argc) {
+      chunk = (size_t)atoi( argv[++a] ) << 20;
+    } else {
+      print_usage();
+      return 1;
+    }
+    ++a;
+  }
+  if (argc-a < 5 || (argc-a-1) % 4 != 0 || chunk == 0) {
+    print_usage();
+    return 1;
+  }
+
+  nt = (argc-a-1)/4;
+  paths   = (const char**) malloc( nt*sizeof(const char*) );
+  tensors = (TensorJAR*) malloc( nt*sizeof(TensorJAR) );
+  stats   = (JarConvStats*) calloc( nt, sizeof(JarConvStats) );
+  for (t=0; t<nt; ++t) {
+    const char** arg = (const char**)argv + a + 1 + 4*t;
+    tensors[t].name     = arg[0];
+    tensors[t].rows     = atoi( arg[1] );
+    tensors[t].cols     = atoi( arg[2] );
+    tensors[t].ld       = tensors[t].rows;
+    tensors[t].layout   = JAR_LAYOUT_COLMAJOR;
+    tensors[t].encoding = ps8 ? JAR_ENC_PS8 : JAR_ENC_LOGPS80;
+    tensors[t].shift    = shift;
+    tensors[t].data     = NULL;
+    paths[t] = arg[3];
+  }
+
+  for (b=0; b<2; ++b) {
+    in[b]  = malloc( chunk*(bf16 ? 2 : 4) );
+    out[b] = malloc( chunk*(ps8 ? 1 : sizeof(UniJAR)) );
+  }
+  work = (UniJAR*) malloc( chunk*sizeof(UniJAR) );
+
+  gettimeofday( &start, NULL );
+
+  /* the shifts have to be known before the descriptors are written */
+  for (t=0; t<nt && calib; ++t) {
+    const int fd = open( paths[t], O_RDONLY );
+    tensors[t].shift = (fd < 0) ? JAR_SHIFT_MAX+1 :
+      jar_calibrate( fd, (size_t)tensors[t].rows*tensors[t].cols, bf16, chunk, in[0], work );
+    if (fd >= 0) close( fd );
+    if (tensors[t].shift > JAR_SHIFT_MAX) {
+      fprintf( stderr, "jar_convert: cannot read %s\n", paths[t] );
+      return 1;
+    }
+  }
+
+  fp = fopen( argv[a], "wb" );
+  if (fp == NULL || jar_file_write_header( fp, nt, tensors ) != 0 || fflush( fp ) != 0) {
+    fprintf( stderr, "jar_convert: cannot write %s\n", argv[a] );
+    return 1;
+  }
+  fd_out = fileno( fp );
+
+  for (t=0; t<nt; ++t) {
+    const size_t n      = (size_t)tensors[t].rows*tensors[t].cols;
+    const size_t isize  = bf16 ? 2 : 4;
+    const size_t osize  = ps8 ? 1 : sizeof(UniJAR);
+    const size_t base   = jar_file_payload_offset( nt, tensors, t );
+    const size_t nchunk = (n + chunk - 1)/chunk;
+    const float  scale  = ldexpf( 1.0f, tensors[t].shift );
+    const int    fd_in  = open( paths[t], O_RDONLY );
+    JarIO  rd, wr;
+    pthread_t rth, wth;
+    size_t i;
+    int    ok = (fd_in >= 0);
+
+    /* prologue: read chunk 0 */
+    if (ok && nchunk > 0) {
+      rd.fd = fd_in; rd.buf = in[0]; rd.nbytes = ((n < chunk) ? n : chunk)*isize; rd.offset = 0;
+      jar_io_read( &rd );
+      ok = (rd.done >= 0);
+    }
+    for (i=0; ok && i<nchunk; ++i) {
+      const size_t m = (n-i*chunk < chunk) ? n-i*chunk : chunk;
+      int reading = 0, writing = 0;
+
+      if (i+1 < nchunk) {
+        const size_t m1 = (n-(i+1)*chunk < chunk) ? n-(i+1)*chunk : chunk;
+        rd.fd = fd_in; rd.buf = in[(i+1)%2]; rd.nbytes = m1*isize; rd.offset = (off_t)((i+1)*chunk*isize);
+        reading = (pthread_create( &rth, NULL, jar_io_read, &rd ) == 0);
+        if (!reading) jar_io_read( &rd );
+      }
+      if (i > 0) {
+        wr.fd = fd_out; wr.buf = out[(i-1)%2]; wr.nbytes = chunk*osize; wr.offset = (off_t)(base + (i-1)*chunk*osize);
+        writing = (pthread_create( &wth, NULL, jar_io_write, &wr ) == 0);
+        if (!writing) jar_io_write( &wr );
+      }
+
+      jar_convert_chunk( m, in[i%2], bf16, ps8, scale, work, out[i%2], stats+t );
+
+      if (reading) pthread_join( rth, NULL );
+      if (writing) pthread_join( wth, NULL );
+      ok = (i+1 == nchunk || rd.done >= 0) && (i == 0 || wr.done >= 0);
+    }
+    /* epilogue: write the last chunk */
+    if (ok && nchunk > 0) {
+      const size_t m = n - (nchunk-1)*chunk;
+      wr.fd = fd_out; wr.buf = out[(nchunk-1)%2]; wr.nbytes = m*osize; wr.offset = (off_t)(base + (nchunk-1)*chunk*osize);
+      jar_io_write( &wr );
+      ok = (wr.done >= 0);
+    }
+    if (fd_in >= 0) close( fd_in );
+    if (!ok) {
+      fprintf( stderr, "jar_convert: failed to convert %s\n", paths[t] );
+      return 1;
+    }
+
+    bytes += (double)n*isize;
+    printf("%-24s %8i x %-8i shift %3i  zero %llu  non-finite %llu  saturated %llu  flushed %llu\n",
+           tensors[t].name, tensors[t].rows, tensors[t].cols, tensors[t].shift,
+           stats[t].zero, stats[t].nonfinite, stats[t].saturated, stats[t].flushed);
+  }
+
+  /* the file has to extend to the end of the last payload */
+  if (ftruncate( fd_out, (off_t)jar_file_payload_offset( nt, tensors, nt ) ) != 0 || fclose( fp ) != 0) {
+    fprintf( stderr, "jar_convert: cannot write %s\n", argv[a] );
+    return 1;
+  }
+  gettimeofday( &stop, NULL );
+  printf("converted %.1f MB in %.3f seconds\n", bytes/1.0e6,
+         (double)(stop.tv_sec - start.tv_sec) + 1.0e-6*(double)(stop.tv_usec - start.tv_usec));
+
+  for (b=0; b<2; ++b) {
+    free( in[b] );
+    free( out[b] );
+  }
+  free( work );
+  free( stats );
+  free( tensors );
+  free( paths );
+  return 0;
+}
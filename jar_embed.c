@@ -0,0 +1,237 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include <xmmintrin.h>
+#include "jar_embed.h"
+#include "jar_pool.h"
+
+/* LogPS80 encoding of 1.0, sum2_LogPS80 with it is the identity */
+#define JAR_ONE  0X3F800000
+
+typedef struct{
+   int            D;
+   int            B;
+   const void*    table;
+   const int*     indices;
+   const int*     offsets;
+   const UniJAR*  weights;
+   UniJAR*        out;
+} JarEmbedArg;
+
+void jar_embedding_bag( const int D, const int B, const UniJAR* table, const int* indices, const int* offsets, const UniJAR* weights, UniJAR* out ) {
+/*
+embedding bag over a 32-bit LogPS80 table, see jar_embed.h. A missing weight is the LogPS80 
+value 1.0 so that the sum and the weighted sum share the same jar_fma pipeline.
+*/
+  UniJAR one;
+  int    b, j, d;
+
+  assert (D > 0);
+  assert (B >= 0);
+
+  one.I = JAR_ONE;
+  for (b=0; b<B; ++b) {
+    UniJAR* o = out + ((size_t)b*D);
+
+    for (d=0; d<D; ++d) {
+      o[d].I = JAR_ZERO;
+    }
+    for (j=offsets[b]; j<offsets[b+1]; ++j) {
+      const UniJAR* row = table + ((size_t)indices[j]*D);
+      const UniJAR* w   = (weights != NULL) ? weights+j : &one;
+      for (d=0; d<D; ++d) {
+        jar_fma( row+d, w, o+d );
+      }
+    }
+    for (d=0; d<D; ++d) {
+      o[d] = LinFP32_2_LogPS80( o[d] );
+    }
+  }
+}
+
+void jar_embedding_bag_PS8( const int D, const int B, const unsigned char* table, const int* indices, const int* offsets, const UniJAR* weights, UniJAR* out ) {
+/*
+embedding bag over an 8-bit Posit(8,0) table, see jar_embedding_bag.
+*/
+  UniJAR one, x;
+  int    b, j, d;
+
+  assert (D > 0);
+  assert (B >= 0);
+
+  one.I = JAR_ONE;
+  for (b=0; b<B; ++b) {
+    UniJAR* o = out + ((size_t)b*D);
+
+    for (d=0; d<D; ++d) {
+      o[d].I = JAR_ZERO;
+    }
+    for (j=offsets[b]; j<offsets[b+1]; ++j) {
+      const unsigned char* row = table + ((size_t)indices[j]*D);
+      const UniJAR*        w   = (weights != NULL) ? weights+j : &one;
+      for (d=0; d<D; ++d) {
+        x = PS8_2_LogPS80( row[d] );
+        jar_fma( &x, w, o+d );
+      }
+    }
+    for (d=0; d<D; ++d) {
+      o[d] = LinFP32_2_LogPS80( o[d] );
+    }
+  }
+}
+
+static void jar_embed_prefetch( const JarEmbedArg* a, const int j, const size_t row_bytes ) {
+/* the whole row (row_bytes) of lookup j */
+  const char* p = (const char*)a->table + (size_t)a->indices[j]*row_bytes;
+  size_t i;
+
+  for (i=0; i<row_bytes; i+=64) {
+    _mm_prefetch( p+i, _MM_HINT_T0 );
+  }
+}
+
+static void jar_embed_prefetch_head( const JarEmbedArg* a, const int b, const size_t row_bytes ) {
+/* the rows of the first JAR_EMBED_PF_DIST lookups of bag b */
+  int j;
+
+  for (j=a->offsets[b]; j<a->offsets[b]+JAR_EMBED_PF_DIST && j<a->offsets[b+1]; ++j) {
+    jar_embed_prefetch( a, j, row_bytes );
+  }
+}
+
+static void jar_embed_bag_task( void* arg, const int b ) {
+/* bag b of jar_embedding_bag_avx512 */
+  const JarEmbedArg* a = (const JarEmbedArg*)arg;
+  const int D = a->D;
+  const UniJAR* table = (const UniJAR*)a->table;
+  const int* indices = a->indices;
+  const int* offsets = a->offsets;
+  const UniJAR* weights = a->weights;
+  UniJAR* out = a->out;
+  UniJAR* o = out + ((size_t)b*D);
+  UniJAR  one, acc;
+  int     j, d;
+
+  one.I = JAR_ONE;
+  jar_embed_prefetch_head( a, b, (size_t)D*sizeof(UniJAR) );
+  d = 0;
+#if defined(__AVX512F__)
+  for ( ; d<(D/16)*16; d+=16) {
+    __m512i vacc = _mm512_set1_epi32( JAR_ZERO );
+    for (j=offsets[b]; j<offsets[b+1]; ++j) {
+      __m512i vw = _mm512_set1_epi32( (weights != NULL) ? weights[j].I : JAR_ONE );
+      if (d == 0 && j+JAR_EMBED_PF_DIST < offsets[b+1]) jar_embed_prefetch( a, j+JAR_EMBED_PF_DIST, (size_t)D*sizeof(UniJAR) );
+      vacc = jar_fma_avx512( _mm512_loadu_epi32( table + ((size_t)indices[j]*D) + d ), vw, vacc );
+    }
+    _mm512_storeu_epi32( o+d, LinFP32_2_LogPS80_avx512( vacc ) );
+  }
+#endif
+  for ( ; d<D; ++d) {
+    acc.I = JAR_ZERO;
+    for (j=offsets[b]; j<offsets[b+1]; ++j) {
+      if (d == 0 && j+JAR_EMBED_PF_DIST < offsets[b+1]) jar_embed_prefetch( a, j+JAR_EMBED_PF_DIST, (size_t)D*sizeof(UniJAR) );
+      jar_fma( table + ((size_t)indices[j]*D) + d, (weights != NULL) ? weights+j : &one, &acc );
+    }
+    o[d] = LinFP32_2_LogPS80( acc );
+  }
+}
+
+void jar_embedding_bag_avx512( const int D, const int B, const UniJAR* table, const int* indices, const int* offsets, const UniJAR* weights, UniJAR* out ) {
+/*
+vectorized and multithreaded version of jar_embedding_bag. For every block of 
+16 elements the accumulator stays in a register over all vectors of the bag. The first
+block (or the scalar loop when D < 16) prefetches the vector JAR_EMBED_PF_DIST lookups
+ahead within the bag; the first JAR_EMBED_PF_DIST vectors are prefetched at bag start.
+*/
+  JarEmbedArg a;
+
+  assert (D > 0);
+  assert (B >= 0);
+
+  a.D = D; a.B = B; a.table = table; a.indices = indices; a.offsets = offsets; a.weights = weights; a.out = out;
+  jar_parallel_for( B, jar_embed_bag_task, &a );
+}
+
+static void jar_embed_bag_PS8_task( void* arg, const int b ) {
+/* bag b of jar_embedding_bag_PS8_avx512 */
+  const JarEmbedArg* a = (const JarEmbedArg*)arg;
+  const int D = a->D;
+  const unsigned char* table = (const unsigned char*)a->table;
+  const int* indices = a->indices;
+  const int* offsets = a->offsets;
+  const UniJAR* weights = a->weights;
+  UniJAR* out = a->out;
+  UniJAR* o = out + ((size_t)b*D);
+  UniJAR  one, acc, x;
+  int     j, d;
+
+  one.I = JAR_ONE;
+  jar_embed_prefetch_head( a, b, (size_t)D );
+  d = 0;
+#if defined(__AVX512F__)
+  for ( ; d<(D/16)*16; d+=16) {
+    __m512i vacc = _mm512_set1_epi32( JAR_ZERO );
+    for (j=offsets[b]; j<offsets[b+1]; ++j) {
+      __m512i vw = _mm512_set1_epi32( (weights != NULL) ? weights[j].I : JAR_ONE );
+      __m512i vx;
+      if (d == 0 && j+JAR_EMBED_PF_DIST < offsets[b+1]) jar_embed_prefetch( a, j+JAR_EMBED_PF_DIST, (size_t)D );
+      vx = _mm512_cvtepu8_epi32( _mm_loadu_si128( (const __m128i*)(table + ((size_t)indices[j]*D) + d) ) );
+      vacc = jar_fma_avx512( PS8_2_LogPS80_avx512( vx ), vw, vacc );
+    }
+    _mm512_storeu_epi32( o+d, LinFP32_2_LogPS80_avx512( vacc ) );
+  }
+#endif
+  for ( ; d<D; ++d) {
+    acc.I = JAR_ZERO;
+    for (j=offsets[b]; j<offsets[b+1]; ++j) {
+      if (d == 0 && j+JAR_EMBED_PF_DIST < offsets[b+1]) jar_embed_prefetch( a, j+JAR_EMBED_PF_DIST, (size_t)D );
+      x = PS8_2_LogPS80( table[((size_t)indices[j]*D) + d] );
+      jar_fma( &x, (weights != NULL) ? weights+j : &one, &acc );
+    }
+    o[d] = LinFP32_2_LogPS80( acc );
+  }
+}
+
+void jar_embedding_bag_PS8_avx512( const int D, const int B, const unsigned char* table, const int* indices, const int* offsets, const UniJAR* weights, UniJAR* out ) {
+/*
+vectorized and multithreaded version of jar_embedding_bag_PS8. The 8-bit codes
+are widened and decoded with a gather from PS8_tbl.
+*/
+  JarEmbedArg a;
+
+  assert (D > 0);
+  assert (B >= 0);
+
+  a.D = D; a.B = B; a.table = table; a.indices = indices; a.offsets = offsets; a.weights = weights; a.out = out;
+  jar_parallel_for( B, jar_embed_bag_PS8_task, &a );
+}
@@ -0,0 +1,63 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Embedding bags over LogPS80 tables.
+ *
+ *  The table holds E embedding vectors of length D, stored as the columns of a 
+ *  D x E col-major matrix, either as 32-bit UniJAR or as 8-bit Posit(8,0) codes
+ *  (see jar_pack_PS8). Bag b gathers the vectors table[:, indices[j]] for 
+ *  offsets[b] <= j < offsets[b+1] (offsets has B+1 entries) and computes
+ *
+ *      out[:, b] = sum_j  weights[j] * table[:, indices[j]]
+ *
+ *  weights are optional per-sample LogPS80 values (NULL for a plain sum). The products
+ *  are JAR products and everything is accumulated in the linear domain in place in 
+ *  out[:, b], which is converted to LogPS80 once per bag. out is D x B col-major.
+ *  An empty bag yields JAR_ZERO.
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_EMBED
+
+#define JAR_EMBED
+#include "jar_sim.h"
+
+/* number of looked-up vectors ahead to prefetch */
+#define JAR_EMBED_PF_DIST  4
+
+void jar_embedding_bag( const int D, const int B, const UniJAR* table, const int* indices, const int* offsets, const UniJAR* weights, UniJAR* out );
+void jar_embedding_bag_avx512( const int D, const int B, const UniJAR* table, const int* indices, const int* offsets, const UniJAR* weights, UniJAR* out );
+void jar_embedding_bag_PS8( const int D, const int B, const unsigned char* table, const int* indices, const int* offsets, const UniJAR* weights, UniJAR* out );
+void jar_embedding_bag_PS8_avx512( const int D, const int B, const unsigned char* table, const int* indices, const int* offsets, const UniJAR* weights, UniJAR* out );
+
+#endif
+
@@ -0,0 +1,263 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "jar_file.h"
+
+/* on-disk header, 64 bytes */
+typedef struct{
+   char          magic[8];
+   uint32_t      version;
+   uint32_t      ntensors;
+   uint32_t      exp2_ind_bits;
+   uint32_t      log2_ind_bits;
+   uint32_t      ps_nbits;
+   uint32_t      ps_es;
+   uint32_t      zero;
+   uint32_t      reserved[7];
+} JarFileHeader;
+
+/* on-disk tensor descriptor, 128 bytes */
+typedef struct{
+   char          name[JAR_FILE_NAME_LEN];
+   int32_t       rows;
+   int32_t       cols;
+   int32_t       ld;
+   int32_t       layout;
+   int32_t       encoding;
+   int32_t       shift;
+   uint64_t      offset;
+   uint64_t      nbytes;
+   uint32_t      reserved[10];
+} JarFileDesc;
+
+static size_t jar_file_nbytes( const TensorJAR* t ) {
+/* size of the payload of t */
+  return (size_t)t->ld * (size_t)t->cols * ((t->encoding == JAR_ENC_PS8) ? 1 : sizeof(UniJAR));
+}
+
+static size_t jar_file_align( const size_t x ) {
+  return (x + JAR_FILE_ALIGN - 1) & ~(size_t)(JAR_FILE_ALIGN - 1);
+}
+
+static void jar_file_header( JarFileHeader* h, const int ntensors ) {
+/* the header of a file with ntensors tensors written by this build */
+  memset( h, 0, sizeof(JarFileHeader) );
+  memcpy( h->magic, JAR_FILE_MAGIC, sizeof(JAR_FILE_MAGIC) );
+  h->version       = JAR_FILE_VERSION;
+  h->ntensors      = ntensors;
+  h->exp2_ind_bits = EXP2_IND_BITS;
+  h->log2_ind_bits = LOG2_IND_BITS;
+  h->ps_nbits      = 8;
+  h->ps_es         = 0;
+  h->zero          = JAR_ZERO;
+}
+
+size_t jar_file_payload_offset( const int ntensors, const TensorJAR* tensors, const int t ) {
+/*
+returns the file offset of the payload of tensor t in a file with the ntensors tensors,
+t == ntensors gives the size of the file
+*/
+  size_t offset, end;
+  int    i;
+
+  assert (t >= 0 && t <= ntensors);
+
+  offset = jar_file_align( sizeof(JarFileHeader) + (size_t)ntensors*sizeof(JarFileDesc) );
+  end    = sizeof(JarFileHeader) + (size_t)ntensors*sizeof(JarFileDesc);
+  for (i=0; i<t; ++i) {
+    end    = offset + jar_file_nbytes( tensors+i );
+    offset = jar_file_align( end );
+  }
+  return (t == ntensors) ? end : offset;
+}
+
+int jar_file_write_header( FILE* fp, const int ntensors, const TensorJAR* tensors ) {
+/*
+writes the header and the descriptors of the ntensors tensors at the current position
+of fp, which has to be the start of the file. The data of the tensors are not used, 
+the payloads can be written afterwards at jar_file_payload_offset, e.g. in chunks.
+*/
+  JarFileHeader h;
+  JarFileDesc   d;
+  size_t offset;
+  int    t, ok = 1;
+
+  assert (ntensors >= 0);
+  assert (sizeof(JarFileHeader) == 64 && sizeof(JarFileDesc) == 128);
+
+  jar_file_header( &h, ntensors );
+  ok &= (fwrite( &h, sizeof(h), 1, fp ) == 1);
+
+  offset = jar_file_payload_offset( ntensors, tensors, 0 );
+  for (t=0; t<ntensors; ++t) {
+    assert (tensors[t].rows >= 0 && tensors[t].cols >= 0 && tensors[t].ld >= tensors[t].rows);
+    memset( &d, 0, sizeof(d) );
+    strncpy( d.name, tensors[t].name, JAR_FILE_NAME_LEN-1 );
+    d.rows     = tensors[t].rows;
+    d.cols     = tensors[t].cols;
+    d.ld       = tensors[t].ld;
+    d.layout   = tensors[t].layout;
+    d.encoding = tensors[t].encoding;
+    d.shift    = tensors[t].shift;
+    d.offset   = offset;
+    d.nbytes   = jar_file_nbytes( tensors+t );
+    ok &= (fwrite( &d, sizeof(d), 1, fp ) == 1);
+    offset = jar_file_align( offset + d.nbytes );
+  }
+
+  return ok ? 0 : -1;
+}
+
+int jar_file_write( const char* path, const int ntensors, const TensorJAR* tensors ) {
+/*
+writes the ntensors tensors to the .jar file path. The data of a 32-bit tensor are 
+LogPS80 values with leading dimension ld, the data of an 8-bit tensor are PS8 codes 
+with leading dimension ld.
+*/
+  FILE*  fp;
+  size_t pos;
+  int    t, ok = 1;
+  static const unsigned char zeros[JAR_FILE_ALIGN] = { 0 };
+
+  fp = fopen( path, "wb" );
+  if (fp == NULL) {
+    return -1;
+  }
+
+  ok &= (jar_file_write_header( fp, ntensors, tensors ) == 0);
+
+  pos = sizeof(JarFileHeader) + (size_t)ntensors*sizeof(JarFileDesc);
+  for (t=0; t<ntensors; ++t) {
+    const size_t nbytes = jar_file_nbytes( tensors+t );
+    ok &= (fwrite( zeros, 1, jar_file_align( pos ) - pos, fp ) == jar_file_align( pos ) - pos);
+    ok &= (fwrite( tensors[t].data, 1, nbytes, fp ) == nbytes);
+    pos = jar_file_align( pos ) + nbytes;
+  }
+
+  ok &= (fclose( fp ) == 0);
+  return ok ? 0 : -1;
+}
+
+FileJAR* jar_file_open( const char* path ) {
+/*
+maps the .jar file path read-only and returns its tensors, whose data point into the
+mapping. The mapping stays valid until jar_file_close.
+*/
+  JarFileHeader h, ref;
+  const JarFileDesc* d;
+  FileJAR* f;
+  struct stat st;
+  void*  base;
+  int    fd, t;
+
+  fd = open( path, O_RDONLY );
+  if (fd < 0) {
+    return NULL;
+  }
+  if (fstat( fd, &st ) != 0 || (size_t)st.st_size < sizeof(JarFileHeader)) {
+    close( fd );
+    return NULL;
+  }
+  base = mmap( NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+  close( fd );
+  if (base == MAP_FAILED) {
+    return NULL;
+  }
+
+  /* the header has to match the format parameters of this build */
+  memcpy( &h, base, sizeof(h) );
+  jar_file_header( &ref, h.ntensors );
+  if (memcmp( &h, &ref, sizeof(h) ) != 0 ||
+      sizeof(JarFileHeader) + (size_t)h.ntensors*sizeof(JarFileDesc) > (size_t)st.st_size) {
+    fprintf( stderr, "jar_file_open: %s is not a compatible .jar file\n", path );
+    munmap( base, (size_t)st.st_size );
+    return NULL;
+  }
+
+  f = (FileJAR*) malloc( sizeof(FileJAR) );
+  f->base     = base;
+  f->size     = (size_t)st.st_size;
+  f->ntensors = (int)h.ntensors;
+  f->tensors  = (TensorJAR*) malloc( (h.ntensors > 0 ? h.ntensors : 1)*sizeof(TensorJAR) );
+
+  d = (const JarFileDesc*)((const char*)base + sizeof(JarFileHeader));
+  for (t=0; t<f->ntensors; ++t) {
+    TensorJAR* x = f->tensors+t;
+    x->name     = d[t].name;
+    x->rows     = d[t].rows;
+    x->cols     = d[t].cols;
+    x->ld       = d[t].ld;
+    x->layout   = d[t].layout;
+    x->encoding = d[t].encoding;
+    x->shift    = d[t].shift;
+    x->data     = (const char*)base + d[t].offset;
+    if (d[t].name[JAR_FILE_NAME_LEN-1] != '\0' || d[t].rows < 0 || d[t].cols < 0 || d[t].ld < d[t].rows ||
+        (d[t].encoding != JAR_ENC_LOGPS80 && d[t].encoding != JAR_ENC_PS8) ||
+        (d[t].offset % JAR_FILE_ALIGN) != 0 || d[t].nbytes != jar_file_nbytes( x ) ||
+        d[t].offset + d[t].nbytes > f->size) {
+      fprintf( stderr, "jar_file_open: tensor %i of %s is corrupt\n", t, path );
+      jar_file_close( f );
+      return NULL;
+    }
+  }
+
+  return f;
+}
+
+const TensorJAR* jar_file_find( const FileJAR* f, const char* name ) {
+/* returns the tensor called name or NULL */
+  int t;
+
+  for (t=0; t<f->ntensors; ++t) {
+    if (strcmp( f->tensors[t].name, name ) == 0) {
+      return f->tensors+t;
+    }
+  }
+  return NULL;
+}
+
+void jar_file_close( FileJAR* f ) {
+/* unmaps the file, the tensors of f are invalid afterwards */
+  if (f == NULL) {
+    return;
+  }
+  munmap( f->base, f->size );
+  free( f->tensors );
+  free( f );
+}
@@ -0,0 +1,98 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Memory-mapped .jar tensor files. Weights are converted to LogPS80 once, stored in
+ *  the layout the kernels read, and mapped read-only at load time, so the kernels use
+ *  the mapped pages directly: no conversion and no copy at startup, and the page cache
+ *  is shared by all processes that map the same file.
+ *
+ *  A file is a 64-byte header, followed by one 128-byte descriptor per tensor, followed
+ *  by the payloads. Every payload starts at a multiple of JAR_FILE_ALIGN. The header
+ *  records the JAR format parameters (table index bits, Posit(8,0)) and the encoding of
+ *  zero, and a file is rejected when they differ from the ones compiled in. All fields 
+ *  are little-endian.
+ *
+ *  A tensor is a rows x cols col-major matrix with leading dimension ld >= rows, either
+ *  32-bit LogPS80 (UniJAR, padding is JAR_ZERO) or 8-bit Posit(8,0) codes (see 
+ *  jar_pack_PS8, padding is the code of zero). With ld a multiple of 16 every column
+ *  of a 32-bit tensor is 64-byte aligned. layout tells how the matrix was packed, e.g.
+ *  JAR_LAYOUT_RNN for the output of jar_rnn_pack_weights, and shift is the per-tensor
+ *  power-of-two scale of jar_scale.h (the stored values are x * 2^shift).
+ *
+ *  jar_file_write returns 0 on success and -1 on an I/O error; jar_file_open returns
+ *  NULL if the file cannot be mapped or is not a valid .jar file.
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_FILE
+
+#define JAR_FILE
+#include <stdio.h>
+#include "jar_sim.h"
+
+#define JAR_FILE_MAGIC     "JARTNSR"
+#define JAR_FILE_VERSION   1
+#define JAR_FILE_ALIGN     64
+#define JAR_FILE_NAME_LEN  48
+
+#define JAR_ENC_LOGPS80    0
+#define JAR_ENC_PS8        1
+
+#define JAR_LAYOUT_COLMAJOR  0
+#define JAR_LAYOUT_RNN       1
+
+typedef struct{
+   const char*   name;
+   int           rows;
+   int           cols;
+   int           ld;
+   int           layout;
+   int           encoding;
+   int           shift;
+   const void*   data;
+} TensorJAR;
+
+typedef struct{
+   void*         base;
+   size_t        size;
+   int           ntensors;
+   TensorJAR*    tensors;
+} FileJAR;
+
+size_t jar_file_payload_offset( const int ntensors, const TensorJAR* tensors, const int t );
+int jar_file_write_header( FILE* fp, const int ntensors, const TensorJAR* tensors );
+int jar_file_write( const char* path, const int ntensors, const TensorJAR* tensors );
+FileJAR* jar_file_open( const char* path );
+const TensorJAR* jar_file_find( const FileJAR* f, const char* name );
+void jar_file_close( FileJAR* f );
+
+#endif
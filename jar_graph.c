@@ -0,0 +1,395 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "jar_graph.h"
+#include "jar_utils.h"
+#include "jar_norm.h"
+#include "jar_rnn.h"
+#include "jar_pool.h"
+#include "jar_numstat.h"
+
+struct JarGroup{
+   int            first;    /* layers first ... last */
+   int            last;
+};
+
+typedef struct{
+   const GraphJAR*  g;
+   const JarGroup*  gr;
+} JarGraphArg;
+
+void jar_graph_init( GraphJAR* g, const int M, const int N ) {
+/* an empty graph whose input (value 0) is M x N */
+  assert (M > 0);
+  assert (N > 0);
+
+  memset( g, 0, sizeof(GraphJAR) );
+  g->N    = N;
+  g->rows = (int*) malloc( sizeof(int) );
+  g->rows[0] = M;
+}
+
+static int jar_graph_add_layer( GraphJAR* g, const LayerJAR* l ) {
+  if (g->nlayers == g->cap) {
+    g->cap    = (g->cap > 0) ? 2*g->cap : 16;
+    g->layers = (LayerJAR*) realloc( g->layers, g->cap*sizeof(LayerJAR) );
+    g->rows   = (int*) realloc( g->rows, (g->cap+1)*sizeof(int) );
+  }
+  g->layers[g->nlayers] = *l;
+  g->rows[g->nlayers+1] = l->M;
+  return ++g->nlayers;
+}
+
+static LayerJAR jar_graph_layer( const GraphJAR* g, const int op, const int x, const int z ) {
+  LayerJAR l;
+
+  assert (x >= 0 && x <= g->nlayers);
+  assert (z >= -1 && z <= g->nlayers);
+
+  memset( &l, 0, sizeof(LayerJAR) );
+  l.op = op;
+  l.x  = x;
+  l.z  = z;
+  l.M  = g->rows[x];
+  return l;
+}
+
+int jar_graph_gemm( GraphJAR* g, const int x, const int M, const UniJAR* W ) {
+/* y = W * x, W is M x rows(x) in col-major format */
+  LayerJAR l = jar_graph_layer( g, JAR_OP_GEMM, x, -1 );
+
+  assert (M > 0);
+  l.M = M;
+  l.K = g->rows[x];
+  l.W = W;
+  return jar_graph_add_layer( g, &l );
+}
+
+int jar_graph_bias( GraphJAR* g, const int x, const UniJAR* b ) {
+  LayerJAR l = jar_graph_layer( g, JAR_OP_BIAS, x, -1 );
+
+  l.W = b;
+  return jar_graph_add_layer( g, &l );
+}
+
+int jar_graph_add( GraphJAR* g, const int x, const int z ) {
+  LayerJAR l = jar_graph_layer( g, JAR_OP_ADD, x, z );
+
+  assert (g->rows[z] == g->rows[x]);
+  return jar_graph_add_layer( g, &l );
+}
+
+int jar_graph_mul( GraphJAR* g, const int x, const int z ) {
+  LayerJAR l = jar_graph_layer( g, JAR_OP_MUL, x, z );
+
+  assert (g->rows[z] == g->rows[x]);
+  return jar_graph_add_layer( g, &l );
+}
+
+int jar_graph_act( GraphJAR* g, const int x, const int op ) {
+/* op is JAR_OP_RELU, JAR_OP_SIGMOID or JAR_OP_TANH */
+  LayerJAR l = jar_graph_layer( g, op, x, -1 );
+
+  assert (op == JAR_OP_RELU || op == JAR_OP_SIGMOID || op == JAR_OP_TANH);
+  return jar_graph_add_layer( g, &l );
+}
+
+int jar_graph_rmsnorm( GraphJAR* g, const int x, const UniJAR* gamma, const float eps ) {
+  LayerJAR l = jar_graph_layer( g, JAR_OP_RMSNORM, x, -1 );
+
+  l.W   = gamma;
+  l.eps = eps;
+  return jar_graph_add_layer( g, &l );
+}
+
+int jar_graph_layernorm( GraphJAR* g, const int x, const UniJAR* gamma, const UniJAR* beta, const float eps ) {
+  LayerJAR l = jar_graph_layer( g, JAR_OP_LAYERNORM, x, -1 );
+
+  l.W    = gamma;
+  l.beta = beta;
+  l.eps  = eps;
+  return jar_graph_add_layer( g, &l );
+}
+
+static int jar_graph_elementwise( const int op ) {
+  return (op >= JAR_OP_BIAS && op <= JAR_OP_TANH);
+}
+
+static void jar_graph_free_plan( GraphJAR* g ) {
+  if (g->arena_size > 0) {
+    jar_arena_destroy( &g->arena );
+  }
+  free( g->groups );
+  free( g->val );
+  g->groups     = NULL;
+  g->val        = NULL;
+  g->ngroups    = 0;
+  g->arena_size = 0;
+}
+
+int jar_graph_plan( GraphJAR* g, const int fuse ) {
+/* 
+groups the layers, fused if fuse is set, and places the values in the arena. Returns 0,
+or -1 if the arena cannot be allocated. A value is live from the group that produces it 
+to the last group that reads it; values whose lifetimes overlap get disjoint memory, 
+placed largest first at the lowest offset that fits.
+*/
+  const int V = g->nlayers + 1;
+  int* nuse  = (int*) calloc( V, sizeof(int) );
+  int* def   = (int*) malloc( V*sizeof(int) );
+  int* lastu = (int*) malloc( V*sizeof(int) );
+  int* order = (int*) malloc( V*sizeof(int) );
+  size_t* off  = (size_t*) calloc( V, sizeof(size_t) );
+  size_t* size = (size_t*) calloc( V, sizeof(size_t) );
+  size_t total = 0;
+  int l, v, i, j, n, gi;
+
+  assert (g->nlayers > 0);
+
+  jar_graph_free_plan( g );
+  g->groups = (JarGroup*) malloc( g->nlayers*sizeof(JarGroup) );
+  g->val    = (UniJAR**) calloc( V, sizeof(UniJAR*) );
+
+  for (l=0; l<g->nlayers; ++l) {
+    nuse[g->layers[l].x]++;
+    if (g->layers[l].z >= 0) nuse[g->layers[l].z]++;
+  }
+
+  /* a layer joins the group of the previous one if it is elementwise and the only reader of its result */
+  for (l=0; l<g->nlayers; ++l) {
+    const LayerJAR* c = g->layers+l;
+    const int prev = l;      /* value of layer l-1 */
+    if (fuse && l > 0 && jar_graph_elementwise( c->op ) && nuse[prev] == 1 && (c->x == prev || c->z == prev) &&
+        (g->layers[g->groups[g->ngroups-1].first].op == JAR_OP_GEMM || jar_graph_elementwise( g->layers[g->groups[g->ngroups-1].first].op ))) {
+      g->groups[g->ngroups-1].last = l;
+    } else {
+      g->groups[g->ngroups].first = l;
+      g->groups[g->ngroups].last  = l;
+      g->ngroups++;
+    }
+  }
+
+  /* lifetimes of the values that leave their group */
+  for (v=0; v<V; ++v) {
+    def[v] = -1;
+    lastu[v] = -1;
+  }
+  for (gi=0; gi<g->ngroups; ++gi) {
+    const JarGroup* gr = g->groups+gi;
+    def[gr->last+1] = gi;
+    lastu[gr->last+1] = gi;
+    for (l=gr->first; l<=gr->last; ++l) {
+      const int x = g->layers[l].x, z = g->layers[l].z;
+      /* values first+1 ... last stay inside the group */
+      if (x <= gr->first) lastu[x] = gi;
+      if (z >= 0 && z <= gr->first) lastu[z] = gi;
+    }
+  }
+
+  /* values in the arena: all group results except the output of the graph */
+  n = 0;
+  for (v=1; v<V-1; ++v) {
+    if (def[v] >= 0) {
+      size[v] = (((size_t)g->rows[v]*g->N*sizeof(UniJAR) + JAR_ALIGN - 1)/JAR_ALIGN)*JAR_ALIGN;
+      order[n++] = v;
+    }
+  }
+  for (i=1; i<n; ++i) {
+    const int t = order[i];
+    for (j=i; j>0 && size[order[j-1]] < size[t]; --j) order[j] = order[j-1];
+    order[j] = t;
+  }
+  for (i=0; i<n; ++i) {
+    const int a = order[i];
+    size_t o = 0;
+    int moved = 1;
+    while (moved) {
+      moved = 0;
+      for (j=0; j<i; ++j) {
+        const int b = order[j];
+        if (def[a] <= lastu[b] && def[b] <= lastu[a] && o < off[b] + size[b] && off[b] < o + size[a]) {
+          o = off[b] + size[b];
+          moved = 1;
+        }
+      }
+    }
+    off[a] = o;
+    if (o + size[a] > total) total = o + size[a];
+  }
+
+  if (total > 0) {
+    char* base;
+    jar_arena_init( &g->arena, total );
+    base = (char*) jar_arena_alloc( &g->arena, total );
+    if (base == NULL) {
+      jar_arena_destroy( &g->arena );
+      free( size ); free( off ); free( order ); free( lastu ); free( def ); free( nuse );
+      jar_graph_free_plan( g );
+      return -1;
+    }
+    g->arena_size = total;
+    for (i=0; i<n; ++i) {
+      g->val[order[i]] = (UniJAR*)(base + off[order[i]]);
+    }
+  }
+
+  free( size ); free( off ); free( order ); free( lastu ); free( def ); free( nuse );
+  return 0;
+}
+
+static void jar_graph_group_task( void* arg, const int t ) {
+/* 
+rows t*JAR_GRAPH_MB ... of the result of a group: the GEMM accumulates in the linear domain,
+then the elementwise layers run on every element, converting only between the domains where
+a layer needs it
+*/
+  const JarGraphArg* a = (const JarGraphArg*)arg;
+  const GraphJAR* g = a->g;
+  const LayerJAR* head = g->layers + a->gr->first;
+  const int M  = g->rows[a->gr->last+1];
+  const int N  = g->N;
+  const int m0 = t*JAR_GRAPH_MB;
+  const int mb = (M-m0 < JAR_GRAPH_MB) ? M-m0 : JAR_GRAPH_MB;
+  UniJAR* out  = g->val[a->gr->last+1];
+  const UniJAR* src = out;
+  const int ns = JAR_NUMSTAT_ON();
+  NumStatJAR s;
+  int first = a->gr->first, lin = 0;
+  int l, m, n;
+
+  jar_numstat_init( &s );
+
+  if (head->op == JAR_OP_GEMM) {
+    for (n=0; n<N; ++n) {
+      for (m=m0; m<m0+mb; ++m) {
+        out[(size_t)n*M+m].I = JAR_ZERO;
+      }
+    }
+    jar_matmulacc_avx512( mb, N, head->K, head->W+m0, M, g->val[head->x], head->K, out+m0, M );
+    first++;
+    lin = 1;
+  } else {
+    src = g->val[head->x];
+  }
+
+  for (n=0; n<N; ++n) {
+    for (m=m0; m<m0+mb; ++m) {
+      const size_t e = (size_t)n*M+m;
+      UniJAR v = src[e], o;
+      int  d = lin;
+      for (l=first; l<=a->gr->last; ++l) {
+        const LayerJAR* c = g->layers+l;
+        const int chain = (l == a->gr->first) ? c->x : l;
+        switch (c->op) {
+        case JAR_OP_BIAS:
+        case JAR_OP_ADD:
+          o = (c->op == JAR_OP_BIAS) ? c->W[m] : g->val[(c->x == chain) ? c->z : c->x][e];
+          if (!d) { v = LogPS80_2_LinFP32( v ); d = 1; }
+          v.F += LogPS80_2_LinFP32( o ).F;
+          break;
+        case JAR_OP_RELU:
+          /* the sign is the same in both domains */
+          if (v.I & SIGN_MASK) v.I = JAR_ZERO;
+          break;
+        default:
+          if (d) {
+            if (ns) jar_numstat_one( &s, v.I );
+            v = LinFP32_2_LogPS80( v );
+            d = 0;
+          }
+          if (c->op == JAR_OP_MUL) {
+            v = rnd_2_PS80( sum2_LogPS80( v, g->val[(c->x == chain) ? c->z : c->x][e] ) );
+          } else if (c->op == JAR_OP_SIGMOID) {
+            v = sigmoid_LogPS80( v );
+          } else {
+            v = tanh_LogPS80( v );
+          }
+          break;
+        }
+      }
+      if (d && ns) jar_numstat_one( &s, v.I );
+      out[e] = d ? LinFP32_2_LogPS80( v ) : v;
+    }
+  }
+  if (ns) {
+    jar_numstat_add( (a->gr->last+1) % JAR_NUMSTAT_TAGS, &s );
+  }
+}
+
+static void jar_graph_norm_task( void* arg, const int n ) {
+/* column n of a normalization layer */
+  const JarGraphArg* a = (const JarGraphArg*)arg;
+  const GraphJAR* g = a->g;
+  const LayerJAR* c = g->layers + a->gr->first;
+  const UniJAR* x = g->val[c->x] + (size_t)n*c->M;
+  UniJAR* y = g->val[a->gr->first+1] + (size_t)n*c->M;
+
+  if (c->op == JAR_OP_RMSNORM) {
+    jar_rmsnorm_avx512( c->M, 1, x, c->W, c->eps, y );
+  } else {
+    jar_layernorm_avx512( c->M, 1, x, c->W, c->beta, c->eps, y );
+  }
+}
+
+void jar_graph_run( GraphJAR* g, const UniJAR* X, UniJAR* Y ) {
+/* 
+runs the planned graph on the input X (rows(0) x N) and writes the result of the last layer
+to Y; X and Y must not overlap. Nothing is allocated.
+*/
+  JarGraphArg a;
+  int gi;
+
+  assert (g->groups != NULL);
+
+  g->val[0] = (UniJAR*)X;
+  g->val[g->nlayers] = Y;
+  a.g = g;
+  for (gi=0; gi<g->ngroups; ++gi) {
+    const int op = g->layers[g->groups[gi].first].op;
+    a.gr = g->groups+gi;
+    if (op == JAR_OP_RMSNORM || op == JAR_OP_LAYERNORM) {
+      jar_parallel_for( g->N, jar_graph_norm_task, &a );
+    } else {
+      jar_parallel_for( (g->rows[a.gr->last+1] + JAR_GRAPH_MB - 1)/JAR_GRAPH_MB, jar_graph_group_task, &a );
+    }
+  }
+}
+
+void jar_graph_destroy( GraphJAR* g ) {
+  jar_graph_free_plan( g );
+  free( g->layers );
+  free( g->rows );
+  memset( g, 0, sizeof(GraphJAR) );
+}
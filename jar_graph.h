@@ -0,0 +1,118 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Graph executor for feed-forward JAR models (MLPs, the norm / MLP / residual part 
+ *  of transformer blocks) over col-major LogPS80 activations of N columns.
+ *
+ *  A graph is built layer by layer; every jar_graph_* builder returns the id of the
+ *  value it produces, the input of the graph being value 0. Layers are
+ *
+ *    JAR_OP_GEMM       y = W * x with a constant M x K weight W
+ *    JAR_OP_BIAS       y = x + b for a LogPS80 vector b of length M
+ *    JAR_OP_ADD        y = x + z (e.g. a residual connection)
+ *    JAR_OP_MUL        y = x * z (e.g. a gate)
+ *    JAR_OP_RELU, JAR_OP_SIGMOID, JAR_OP_TANH
+ *    JAR_OP_RMSNORM, JAR_OP_LAYERNORM, see jar_norm.h
+ *
+ *  and the last layer is the output of the graph. Standalone, every layer rounds its 
+ *  result to LogPS80. jar_graph_plan with fuse set merges a GEMM, or an elementwise 
+ *  layer, with the chain of elementwise layers that consume only its result into one 
+ *  group: the products are accumulated in the linear domain, bias and additions stay 
+ *  there, and a value is converted to LogPS80 only when a layer needs it (sigmoid, tanh,
+ *  products) and at the end of the group. Without fuse every layer is a group and the 
+ *  results are identical to calling the kernels one by one.
+ *
+ *  The plan then places the values that outlive their group in one arena, reusing the
+ *  memory of values that are dead. jar_graph_run does not allocate; the groups run on 
+ *  the JAR thread pool in blocks of JAR_GRAPH_MB rows.
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_GRAPH
+
+#define JAR_GRAPH
+#include "jar_sim.h"
+#include "jar_mem.h"
+
+#define JAR_OP_GEMM       0
+#define JAR_OP_BIAS       1
+#define JAR_OP_ADD        2
+#define JAR_OP_MUL        3
+#define JAR_OP_RELU       4
+#define JAR_OP_SIGMOID    5
+#define JAR_OP_TANH       6
+#define JAR_OP_RMSNORM    7
+#define JAR_OP_LAYERNORM  8
+
+/* rows per task of a group */
+#define JAR_GRAPH_MB      64
+
+typedef struct{
+   int            op;
+   int            x;        /* input value */
+   int            z;        /* second input of JAR_OP_ADD / JAR_OP_MUL, else -1 */
+   int            M;        /* rows of the result */
+   int            K;        /* rows of x for JAR_OP_GEMM */
+   const UniJAR*  W;        /* weight, bias or gamma */
+   const UniJAR*  beta;
+   float          eps;
+} LayerJAR;
+
+typedef struct JarGroup JarGroup;
+
+typedef struct{
+   int            N;
+   int            nlayers;
+   int            cap;
+   LayerJAR*      layers;   /* layer l produces value l+1 */
+   int*           rows;     /* rows of value v, v = 0 ... nlayers */
+   /* plan */
+   int            ngroups;
+   JarGroup*      groups;
+   UniJAR**       val;      /* memory of the values, NULL inside a group */
+   ArenaJAR       arena;
+   size_t         arena_size;
+} GraphJAR;
+
+void jar_graph_init( GraphJAR* g, const int M, const int N );
+int jar_graph_gemm( GraphJAR* g, const int x, const int M, const UniJAR* W );
+int jar_graph_bias( GraphJAR* g, const int x, const UniJAR* b );
+int jar_graph_add( GraphJAR* g, const int x, const int z );
+int jar_graph_mul( GraphJAR* g, const int x, const int z );
+int jar_graph_act( GraphJAR* g, const int x, const int op );
+int jar_graph_rmsnorm( GraphJAR* g, const int x, const UniJAR* gamma, const float eps );
+int jar_graph_layernorm( GraphJAR* g, const int x, const UniJAR* gamma, const UniJAR* beta, const float eps );
+int jar_graph_plan( GraphJAR* g, const int fuse );
+void jar_graph_run( GraphJAR* g, const UniJAR* X, UniJAR* Y );
+void jar_graph_destroy( GraphJAR* g );
+
+#endif
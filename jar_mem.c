@@ -0,0 +1,217 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <sys/mman.h>
+#include "jar_mem.h"
+
+#define JAR_MEM_HEAP  0
+#define JAR_MEM_HUGE  1
+
+/* header in front of every block, keeps the payload aligned */
+typedef struct{
+   size_t         nbytes;
+   size_t         mapped;
+   int            kind;
+   char           pad[JAR_ALIGN - 2*sizeof(size_t) - sizeof(int)];
+} JarMemHeader;
+
+struct ArenaBlockJAR{
+   ArenaBlockJAR* next;
+};
+
+static size_t jar_mem_live   = 0;
+static size_t jar_mem_peak   = 0;
+static size_t jar_mem_nalloc = 0;
+static size_t jar_mem_nhuge  = 0;
+
+static __thread ArenaJAR jar_ws_arena = { NULL, 0, 0, 0, NULL };
+
+static void jar_mem_count( const size_t nbytes, const int huge ) {
+/* thread-safe update of the statistics for a new block */
+  size_t live = __atomic_add_fetch( &jar_mem_live, nbytes, __ATOMIC_RELAXED );
+  size_t peak = __atomic_load_n( &jar_mem_peak, __ATOMIC_RELAXED );
+
+  while (live > peak && !__atomic_compare_exchange_n( &jar_mem_peak, &peak, live, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED )) {
+  }
+  __atomic_add_fetch( &jar_mem_nalloc, 1, __ATOMIC_RELAXED );
+  if (huge) {
+    __atomic_add_fetch( &jar_mem_nhuge, 1, __ATOMIC_RELAXED );
+  }
+}
+
+void* jar_malloc( const size_t nbytes ) {
+/* returns nbytes of JAR_ALIGN-byte aligned memory */
+  JarMemHeader* h;
+
+  assert (sizeof(JarMemHeader) == JAR_ALIGN);
+
+  if (posix_memalign( (void**)&h, JAR_ALIGN, sizeof(JarMemHeader) + nbytes ) != 0) {
+    return NULL;
+  }
+  h->nbytes = nbytes;
+  h->mapped = 0;
+  h->kind   = JAR_MEM_HEAP;
+  jar_mem_count( nbytes, 0 );
+
+  return h+1;
+}
+
+void* jar_malloc_huge( const size_t nbytes ) {
+/* 
+returns nbytes of JAR_ALIGN-byte aligned memory in an anonymous mapping rounded up to 
+JAR_HUGE_PAGE; explicit huge pages are tried first, then transparent huge pages
+*/
+  const size_t mapped = ((sizeof(JarMemHeader) + nbytes + JAR_HUGE_PAGE - 1)/JAR_HUGE_PAGE)*JAR_HUGE_PAGE;
+  JarMemHeader* h = MAP_FAILED;
+
+#if defined(MAP_HUGETLB)
+  h = (JarMemHeader*) mmap( NULL, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+#endif
+  if (h == MAP_FAILED) {
+    h = (JarMemHeader*) mmap( NULL, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if (h == MAP_FAILED) {
+      return NULL;
+    }
+#if defined(MADV_HUGEPAGE)
+    madvise( h, mapped, MADV_HUGEPAGE );
+#endif
+  }
+  h->nbytes = nbytes;
+  h->mapped = mapped;
+  h->kind   = JAR_MEM_HUGE;
+  jar_mem_count( nbytes, 1 );
+
+  return h+1;
+}
+
+void jar_free( void* p ) {
+/* frees memory of jar_malloc or jar_malloc_huge, p may be NULL */
+  JarMemHeader* h;
+
+  if (p == NULL) {
+    return;
+  }
+  h = (JarMemHeader*)p - 1;
+  __atomic_sub_fetch( &jar_mem_live, h->nbytes, __ATOMIC_RELAXED );
+  if (h->kind == JAR_MEM_HUGE) {
+    munmap( h, h->mapped );
+  } else {
+    free( h );
+  }
+}
+
+void jar_mem_stats( MemStatsJAR* s ) {
+  s->live   = __atomic_load_n( &jar_mem_live, __ATOMIC_RELAXED );
+  s->peak   = __atomic_load_n( &jar_mem_peak, __ATOMIC_RELAXED );
+  s->nalloc = __atomic_load_n( &jar_mem_nalloc, __ATOMIC_RELAXED );
+  s->nhuge  = __atomic_load_n( &jar_mem_nhuge, __ATOMIC_RELAXED );
+}
+
+void jar_mem_reset_peak( ) {
+/* sets the peak to the current live bytes */
+  __atomic_store_n( &jar_mem_peak, __atomic_load_n( &jar_mem_live, __ATOMIC_RELAXED ), __ATOMIC_RELAXED );
+}
+
+void jar_arena_init( ArenaJAR* a, const size_t nbytes ) {
+/* an arena with an initial capacity of nbytes, which may be 0 */
+  a->base     = (nbytes > 0) ? (char*) jar_malloc( nbytes ) : NULL;
+  a->size     = (a->base != NULL) ? nbytes : 0;
+  a->used     = 0;
+  a->high     = 0;
+  a->overflow = NULL;
+}
+
+void* jar_arena_alloc( ArenaJAR* a, const size_t nbytes ) {
+/* returns nbytes of JAR_ALIGN-byte aligned memory that lives until the arena is released */
+  const size_t n = ((nbytes + JAR_ALIGN - 1)/JAR_ALIGN)*JAR_ALIGN;
+  ArenaBlockJAR* b;
+
+  a->used += n;
+  a->high  = (a->used > a->high) ? a->used : a->high;
+  if (a->used <= a->size) {
+    return a->base + (a->used - n);
+  }
+
+  /* does not fit, keep it in an overflow block until the arena is released completely */
+  b = (ArenaBlockJAR*) jar_malloc( JAR_ALIGN + n );
+  if (b == NULL) {
+    a->used -= n;
+    return NULL;
+  }
+  b->next     = a->overflow;
+  a->overflow = b;
+  return (char*)b + JAR_ALIGN;
+}
+
+size_t jar_arena_mark( const ArenaJAR* a ) {
+  return a->used;
+}
+
+void jar_arena_release( ArenaJAR* a, const size_t mark ) {
+/* 
+frees everything allocated after mark was taken; releasing to 0 frees the overflow blocks
+and grows the arena to the high-water mark
+*/
+  assert (mark <= a->used);
+
+  a->used = mark;
+  if (mark == 0 && a->overflow != NULL) {
+    while (a->overflow != NULL) {
+      ArenaBlockJAR* next = a->overflow->next;
+      jar_free( a->overflow );
+      a->overflow = next;
+    }
+    jar_free( a->base );
+    jar_arena_init( a, a->high );
+  }
+}
+
+void jar_arena_destroy( ArenaJAR* a ) {
+  jar_arena_release( a, 0 );
+  jar_free( a->base );
+  a->base = NULL;
+  a->size = 0;
+  a->high = 0;
+}
+
+ArenaJAR* jar_workspace( ) {
+/* the workspace arena of the calling thread, it starts empty and grows on demand */
+  return &jar_ws_arena;
+}
+
+void jar_workspace_destroy( ) {
+/* frees the workspace arena of the calling thread */
+  jar_arena_destroy( &jar_ws_arena );
+}
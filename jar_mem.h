@@ -0,0 +1,91 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Memory for JAR tensors and kernel workspaces.
+ *
+ *    jar_malloc / jar_free     JAR_ALIGN-byte aligned tensor allocation
+ *    jar_malloc_huge           anonymous mapping backed by 2 MB huge pages when the 
+ *                              system has them (MAP_HUGETLB, else madvise(MADV_HUGEPAGE)),
+ *                              for large weights to reduce TLB misses; freed by jar_free
+ *    ArenaJAR                  bump allocator with stack-like release: jar_arena_mark
+ *                              returns a position, jar_arena_release returns to it. A
+ *                              request that does not fit goes to an overflow block; when
+ *                              the arena is released completely the overflow blocks are 
+ *                              freed and the arena grows to the high-water mark, so a
+ *                              repeated call pattern stops allocating after the first call
+ *    jar_workspace             the arena of the calling thread, for kernel workspaces
+ *
+ *  jar_mem_stats returns the live and peak bytes and the number of allocations of 
+ *  jar_malloc and jar_malloc_huge, the arenas included. Allocation failures return NULL.
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_MEM
+
+#define JAR_MEM
+#include <stddef.h>
+
+#define JAR_ALIGN      64
+#define JAR_HUGE_PAGE  (2 << 20)
+
+typedef struct{
+   size_t         live;
+   size_t         peak;
+   size_t         nalloc;
+   size_t         nhuge;
+} MemStatsJAR;
+
+typedef struct ArenaBlockJAR ArenaBlockJAR;
+
+typedef struct{
+   char*          base;
+   size_t         size;
+   size_t         used;
+   size_t         high;
+   ArenaBlockJAR* overflow;
+} ArenaJAR;
+
+void* jar_malloc( const size_t nbytes );
+void* jar_malloc_huge( const size_t nbytes );
+void jar_free( void* p );
+void jar_mem_stats( MemStatsJAR* s );
+void jar_mem_reset_peak( );
+
+void jar_arena_init( ArenaJAR* a, const size_t nbytes );
+void* jar_arena_alloc( ArenaJAR* a, const size_t nbytes );
+size_t jar_arena_mark( const ArenaJAR* a );
+void jar_arena_release( ArenaJAR* a, const size_t mark );
+void jar_arena_destroy( ArenaJAR* a );
+ArenaJAR* jar_workspace( );
+void jar_workspace_destroy( );
+
+#endif
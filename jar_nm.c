@@ -0,0 +1,306 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "jar_nm.h"
+#include "jar_mem.h"
+#include "jar_pool.h"
+#include "jar_trace.h"
+#include "jar_numstat.h"
+
+typedef struct{
+   const NMSparseJAR*  S;
+   int                 N;
+   const UniJAR*       B;
+   UniJAR*             C;
+   int                 mt;       /* row tiles */
+   int                 tag;      /* numerical event tag, -1 when not counting */
+} JarNMArg;
+
+static int jar_nm_select( const int M, const UniJAR* A, const int m, const int k0, const int k1, const int keep, int* cols ) {
+/* columns of the at most keep largest magnitudes other than zero of A[m, k0:k1], ascending; returns their number */
+  int n = 0, k, j, rank;
+
+  for (k=k0; k<k1; ++k) {
+    const unsigned int a = A[(size_t)k*M+m].I & CLEAR_SIGN;
+    if (a <= JAR_ZERO) continue;
+    /* the magnitude order of LogPS80 values is the order of their bits without the sign */
+    for (rank=0, j=k0; j<k1; ++j) {
+      const unsigned int b = A[(size_t)j*M+m].I & CLEAR_SIGN;
+      rank += (b > a || (b == a && j < k));
+    }
+    if (rank < keep) cols[n++] = k;
+  }
+  return n;
+}
+
+void jar_nm_prune( const int M, const int K, UniJAR* A, const int keep, const int group ) {
+/* makes the col-major M x K matrix A keep:group sparse in place, see jar_nm.h */
+  int cols[16];
+  int m, g, k, s, n;
+
+  assert (M >= 0 && K >= 0);
+  assert (keep >= 1 && keep <= group && group <= 16);
+  for (g=0; g<K; g+=group) {
+    const int k1 = (g+group < K) ? g+group : K;
+    for (m=0; m<M; ++m) {
+      n = jar_nm_select( M, A, m, g, k1, keep, cols );
+      for (k=g, s=0; k<k1; ++k) {
+        if (s < n && cols[s] == k) {
+          ++s;
+        } else if ((A[(size_t)k*M+m].I & CLEAR_SIGN) > JAR_ZERO) {
+          A[(size_t)k*M+m].I = JAR_ZERO;
+        }
+      }
+    }
+  }
+}
+
+int jar_nm_compress( const int M, const int K, const UniJAR* A, const int keep, const int group, const int ps8, NMSparseJAR* S ) {
+/*
+stores the keep largest magnitudes of every group of group columns of every row of the
+col-major M x K matrix A as NMSparseJAR, with 8-bit values if ps8. Returns 0, or -1 if 
+the sizes are invalid (keep outside 1 ... group, group above 16) or out of memory.
+*/
+  int cols[16];
+  size_t n, pos;
+  int m, g, s, c;
+
+  memset( S, 0, sizeof(NMSparseJAR) );
+  if (M < 0 || K < 0 || keep < 1 || keep > group || group > 16) {
+    return -1;
+  }
+  S->M = M; S->K = K; S->keep = keep; S->group = group; S->ps8 = ps8;
+  S->ng = (K + group - 1)/group;
+  S->ld = ((M + 15)/16)*16;
+  n = (size_t)S->ng*keep*S->ld;
+  S->val = jar_malloc( (n > 0 ? n : 1)*(ps8 ? 1 : sizeof(UniJAR)) );
+  S->idx = (unsigned char*) jar_malloc( n > 0 ? n : 1 );
+  if (S->val == NULL || S->idx == NULL) {
+    jar_nm_free( S );
+    return -1;
+  }
+
+  for (g=0; g<S->ng; ++g) {
+    const int k0 = g*group, k1 = (k0+group < K) ? k0+group : K;
+    for (m=0; m<S->ld; ++m) {
+      c = (m < M) ? jar_nm_select( M, A, m, k0, k1, keep, cols ) : 0;
+      for (s=0; s<keep; ++s) {
+        UniJAR v;
+        pos = ((size_t)g*keep+s)*S->ld + m;
+        v.I = (s < c) ? A[(size_t)cols[s]*M+m].I : JAR_ZERO;
+        S->idx[pos] = (unsigned char)((s < c) ? cols[s]-k0 : 0);
+        if (ps8) ((unsigned char*)S->val)[pos] = LogPS80_2_PS8( v );
+        else ((UniJAR*)S->val)[pos] = v;
+      }
+    }
+  }
+  return 0;
+}
+
+static UniJAR jar_nm_value( const NMSparseJAR* S, const size_t pos ) {
+  return S->ps8 ? PS8_2_LogPS80( ((const unsigned char*)S->val)[pos] ) : ((const UniJAR*)S->val)[pos];
+}
+
+void jar_nm_decompress( const NMSparseJAR* S, UniJAR* A ) {
+/* expands S to the dense col-major M x K matrix A */
+  size_t i, pos;
+  int m, g, s;
+
+  for (i=0; i<(size_t)S->M*S->K; ++i) {
+    A[i].I = JAR_ZERO;
+  }
+  for (g=0; g<S->ng; ++g) {
+    for (s=0; s<S->keep; ++s) {
+      for (m=0; m<S->M; ++m) {
+        UniJAR v;
+        pos = ((size_t)g*S->keep+s)*S->ld + m;
+        v = jar_nm_value( S, pos );
+        /* padding slots are zero */
+        if ((v.I & CLEAR_SIGN) > JAR_ZERO) A[(size_t)(g*S->group + S->idx[pos])*S->M + m] = v;
+      }
+    }
+  }
+}
+
+void jar_nm_free( NMSparseJAR* S ) {
+  jar_free( S->idx );
+  jar_free( S->val );
+  memset( S, 0, sizeof(NMSparseJAR) );
+}
+
+static void jar_nm_tile( const NMSparseJAR* S, const int m0, const int m1, const int n0, const int n1, const UniJAR* B, UniJAR* C ) {
+/* rows m0 ... m1-1 of columns n0 ... n1-1 of C = A*B in the linear domain */
+  size_t pos;
+  int m, n, g, s;
+
+  for (n=n0; n<n1; ++n) {
+    const UniJAR* b = B + (size_t)n*S->K;
+    for (m=m0; m<m1; ++m) {
+      UniJAR acc;
+      acc.I = JAR_ZERO;
+      for (g=0; g<S->ng; ++g) {
+        for (s=0; s<S->keep; ++s) {
+          UniJAR v;
+          pos = ((size_t)g*S->keep+s)*S->ld + m;
+          v = jar_nm_value( S, pos );
+          jar_fma( &v, b + g*S->group + S->idx[pos], &acc );
+        }
+      }
+      C[(size_t)n*S->M+m] = acc;
+    }
+  }
+}
+
+static void jar_nm_epilogue( const NMSparseJAR* S, const int m0, const int m1, const int n0, const int n1, UniJAR* C, const int tag ) {
+/* converts rows m0 ... m1-1 of columns n0 ... n1-1 of C to LogPS80 */
+  int n, m;
+
+  for (n=n0; n<n1; ++n) {
+    UniJAR* c = C + (size_t)n*S->M;
+    if (tag >= 0) {
+      NumStatJAR s;
+      jar_numstat_init( &s );
+      jar_numstat_scan( &s, m1-m0, c+m0 );
+      jar_numstat_add( tag, &s );
+    }
+    m = m0;
+#if defined(__AVX512F__)
+    for ( ; m+16<=m1; m+=16) {
+      _mm512_storeu_epi32( c+m, LinFP32_2_LogPS80_avx512( _mm512_loadu_epi32( c+m ) ) );
+    }
+#endif
+    for ( ; m<m1; ++m) {
+      c[m] = LinFP32_2_LogPS80( c[m] );
+    }
+  }
+}
+
+void jar_nm_matmul( const NMSparseJAR* S, const int N, const UniJAR* B, UniJAR* C ) {
+/* C = A*B for the keep:group sparse A, see jar_nm.h */
+  const size_t nv = (size_t)S->ng*S->keep*S->M;
+
+  assert (N >= 0);
+  JAR_TRACE_BEGIN( t );
+  jar_nm_tile( S, 0, S->M, 0, N, B, C );
+  JAR_TRACE_END( t, JAR_TK_NM, JAR_TP_COMPUTE, nv*(S->ps8 ? 2 : 5) + 4*((size_t)S->K + S->M)*N, 2*nv*N );
+
+  JAR_TRACE_BEGIN( te );
+  jar_nm_epilogue( S, 0, S->M, 0, N, C, JAR_NUMSTAT_ON() ? jar_numstat_current() : -1 );
+  JAR_TRACE_END( te, JAR_TK_NM, JAR_TP_EPILOGUE, 8*(size_t)S->M*N, 0 );
+}
+
+void jar_nm_matvecmul( const NMSparseJAR* S, const UniJAR* b, UniJAR* c ) {
+/* c = A*b for the keep:group sparse A, see jar_nm.h */
+  jar_nm_matmul( S, 1, b, c );
+}
+
+#if defined(__AVX512F__)
+static void jar_nm_block_avx512( const NMSparseJAR* S, const int r0, const int n0, const int nr, const UniJAR* B, UniJAR* C ) {
+/* rows r0 ... r0+15 (lanes) of columns n0 ... n0+nr-1 of C in the linear domain */
+  const __mmask16 live = (r0+16 <= S->M) ? 0xFFFF : (__mmask16)((1 << (S->M-r0)) - 1);
+  __m512i vc[JAR_NM_NR], vb[JAR_NM_NR];
+  int g, s, n;
+
+  for (n=0; n<nr; ++n) {
+    vc[n] = _mm512_set1_epi32( JAR_ZERO );
+  }
+  for (g=0; g<S->ng; ++g) {
+    const int k0 = g*S->group;
+    const __mmask16 kg = (__mmask16)((1 << ((k0+S->group < S->K) ? S->group : S->K-k0)) - 1);
+    for (n=0; n<nr; ++n) {
+      vb[n] = _mm512_maskz_loadu_epi32( kg, B + (size_t)(n0+n)*S->K + k0 );
+    }
+    for (s=0; s<S->keep; ++s) {
+      const size_t pos = ((size_t)g*S->keep+s)*S->ld + r0;
+      const __m512i vi = _mm512_cvtepu8_epi32( _mm_loadu_si128( (const __m128i*)(S->idx + pos) ) );
+      __m512i va;
+      if (S->ps8) {
+        va = PS8_2_LogPS80_avx512( _mm512_cvtepu8_epi32( _mm_loadu_si128( (const __m128i*)((const unsigned char*)S->val + pos) ) ) );
+      } else {
+        va = _mm512_loadu_epi32( (const UniJAR*)S->val + pos );
+      }
+      for (n=0; n<nr; ++n) {
+        vc[n] = jar_fma_avx512( va, _mm512_permutexvar_epi32( vi, vb[n] ), vc[n] );
+      }
+    }
+  }
+  for (n=0; n<nr; ++n) {
+    _mm512_mask_storeu_epi32( C + (size_t)(n0+n)*S->M + r0, live, vc[n] );
+  }
+}
+#endif
+
+static void jar_nm_task( void* arg, const int task ) {
+/* tile task of JAR_NM_MC x JAR_NM_NC elements of C, then its conversion to LogPS80 */
+  const JarNMArg* a = (const JarNMArg*)arg;
+  const NMSparseJAR* S = a->S;
+  const int m0 = (task % a->mt)*JAR_NM_MC, n0 = (task / a->mt)*JAR_NM_NC;
+  const int m1 = (m0+JAR_NM_MC < S->M) ? m0+JAR_NM_MC : S->M;
+  const int n1 = (n0+JAR_NM_NC < a->N) ? n0+JAR_NM_NC : a->N;
+#if defined(__AVX512F__)
+  int r, n;
+
+  for (n=n0; n<n1; n+=JAR_NM_NR) {
+    for (r=m0; r<m1; r+=16) {
+      jar_nm_block_avx512( S, r, n, (n+JAR_NM_NR < n1) ? JAR_NM_NR : n1-n, a->B, a->C );
+    }
+  }
+#else
+  jar_nm_tile( S, m0, m1, n0, n1, a->B, a->C );
+#endif
+  jar_nm_epilogue( S, m0, m1, n0, n1, a->C, a->tag );
+}
+
+void jar_nm_matmul_avx512( const NMSparseJAR* S, const int N, const UniJAR* B, UniJAR* C ) {
+/* C = A*B for the keep:group sparse A on the JAR thread pool, see jar_nm.h */
+  const size_t nv = (size_t)S->ng*S->keep*S->M;
+  JarNMArg a;
+
+  assert (N >= 0);
+  assert (S->group <= 16);
+  if (N == 0 || S->M == 0) return;
+  JAR_TRACE_BEGIN( t );
+
+  a.S = S; a.N = N; a.B = B; a.C = C;
+  a.mt = (S->M + JAR_NM_MC - 1)/JAR_NM_MC;
+  a.tag = JAR_NUMSTAT_ON() ? jar_numstat_current() : -1;
+  jar_parallel_for( a.mt*((N + JAR_NM_NC - 1)/JAR_NM_NC), jar_nm_task, &a );
+
+  JAR_TRACE_END( t, JAR_TK_NM, JAR_TP_COMPUTE, nv*(S->ps8 ? 2 : 5) + 4*((size_t)S->K + S->M)*N, 2*nv*N );
+}
+
+void jar_nm_matvecmul_avx512( const NMSparseJAR* S, const UniJAR* b, UniJAR* c ) {
+/* c = A*b for the keep:group sparse A on the JAR thread pool, see jar_nm.h */
+  jar_nm_matmul_avx512( S, 1, b, c );
+}
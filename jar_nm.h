@@ -0,0 +1,92 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Structured N:M sparse LogPS80 weights (e.g. 2:4) and their JAR GEMM and GEMV.
+ *
+ *  An M x K matrix is keep:group sparse when every row has at most keep elements other
+ *  than zero (|x| > 2^-63) in each group of group consecutive columns. jar_nm_prune
+ *  makes a dense col-major matrix keep:group sparse in place by keeping the keep 
+ *  largest magnitudes of every group of every row (the first ones on ties) and setting
+ *  the others to JAR_ZERO; jar_nm_compress stores the same selection as NMSparseJAR:
+ *  for group g and slot s < keep, the values of all rows at val[(g*keep+s)*ld + m] as
+ *  UniJAR or, with ps8, as 8-bit Posit(8,0) codes (see jar_pack_PS8), and in idx at the
+ *  same position the column of the value within its group. The slots of a group are in 
+ *  ascending column; groups with fewer kept values are padded with JAR_ZERO. ld is M 
+ *  rounded up to 16 and the rows past M are padding as well. jar_nm_decompress expands
+ *  to the dense pruned matrix.
+ *
+ *  jar_nm_matmul computes C = A*B for the dense K x N B (col-major, C is M x N), 
+ *  jar_nm_matvecmul c = A*b. Products go through the jar_fma pipeline in ascending
+ *  column order per row, so the results equal jar_matmul / jar_matvecmul of the pruned
+ *  dense matrix with the zero products left out (up to the sign of zero results), and 
+ *  the scalar and _avx512 kernels give identical results. The _avx512 kernels run 16 
+ *  rows per vector: the group of B elements of a column is loaded once into a register
+ *  and the elements of the kept columns are picked with a permutation by the indices, 
+ *  so keep/group of the products of the dense kernel are done with regular loads only.
+ *  They run tiles of JAR_NM_MC rows by JAR_NM_NC columns as tasks of the JAR thread pool.
+ *  group is at most 16.
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_NM
+
+#define JAR_NM
+#include "jar_sim.h"
+
+/* rows and columns of C per task of the _avx512 kernels */
+#define JAR_NM_MC    64
+#define JAR_NM_NC    64
+/* columns of B per register block */
+#define JAR_NM_NR    8
+
+typedef struct{
+   int              M;
+   int              K;
+   int              keep;
+   int              group;
+   int              ng;
+   int              ld;
+   int              ps8;
+   void*            val;
+   unsigned char*   idx;
+} NMSparseJAR;
+
+void jar_nm_prune( const int M, const int K, UniJAR* A, const int keep, const int group );
+int  jar_nm_compress( const int M, const int K, const UniJAR* A, const int keep, const int group, const int ps8, NMSparseJAR* S );
+void jar_nm_decompress( const NMSparseJAR* S, UniJAR* A );
+void jar_nm_free( NMSparseJAR* S );
+void jar_nm_matmul( const NMSparseJAR* S, const int N, const UniJAR* B, UniJAR* C );
+void jar_nm_matmul_avx512( const NMSparseJAR* S, const int N, const UniJAR* B, UniJAR* C );
+void jar_nm_matvecmul( const NMSparseJAR* S, const UniJAR* b, UniJAR* c );
+void jar_nm_matvecmul_avx512( const NMSparseJAR* S, const UniJAR* b, UniJAR* c );
+
+#endif
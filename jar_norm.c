@@ -0,0 +1,255 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "jar_norm.h"
+
+UniJAR rsqrt_LinFP32_2_LogPS80( UniJAR x ) {
+/*
+Input is a non-negative linear domain value x = 2^m * (1+f), usually a mean
+of squares or a variance plus eps. The output is the LogPS80 value of 1/sqrt(x), 
+that is, the logarithmic value -(m + log2(1+f))/2.
+
+Steps (1) and (2) of LinFP32_2_LogPS80 give the encoding of (m + g) where g has
+LOG2_FRAC_BITS bits. Read as a fixed-point number with 23 fractional bits, the
+logarithmic value m + g is simply this encoding minus 0X3F800000 (the encoding of
+log value 0). Negating and halving is thus an integer negation and an arithmetic 
+shift. The result is rounded only once, to PS80 precision, at the very end.
+*/
+   UniJAR y, z;
+   int    i, l;
+
+   assert( (x.I & SIGN_MASK) == 0 );
+
+   y = rnd_2_L_frac( x, LOG2_IND_BITS );
+   i = (y.I & FRAC_MASK) >> LOG2_IND_SHIFT;
+   z = log2_tbl[i];
+   y.I &= CLEAR_FRAC; y.I |= z.I;
+
+   /* -(m+g)/2 in fixed point */
+   l = (int)y.I - 0X3F800000;
+   l = (-l) >> 1;
+   y.I = (unsigned int)(l + 0X3F800000);
+
+   return rnd_2_PS80( y );
+}
+
+void jar_rmsnorm( const int M, const int N, const UniJAR* X, const UniJAR* gamma, const float eps, UniJAR* Y ) {
+/*
+RMSNorm of the N vectors of length M stored in the col-major matrix X. The sum of squares
+is accumulated in the linear domain, 1/sqrt(mean + eps) becomes a LogPS80 value r, and
+y = x * r * gamma is formed by two exact sum2_LogPS80 and a single rounding to PS80.
+There is no conversion of x to the linear domain and back. Y may alias X.
+*/
+   UniJAR acc, r;
+   int    m, n;
+
+   assert (M > 0);
+   assert (N >= 0);
+
+   for (n=0; n<N; ++n) {
+     const UniJAR* x = X + (n*M);
+     UniJAR*       y = Y + (n*M);
+
+     acc.I = JAR_ZERO;
+     for (m=0; m<M; ++m) {
+       jar_fma( x+m, x+m, &acc );
+     }
+     acc.F = acc.F / (float)M + eps;
+     r = rsqrt_LinFP32_2_LogPS80( acc );
+
+     for (m=0; m<M; ++m) {
+       y[m] = rnd_2_PS80( sum2_LogPS80( sum2_LogPS80( x[m], r ), gamma[m] ) );
+     }
+   }
+}
+
+void jar_rmsnorm_avx512( const int M, const int N, const UniJAR* X, const UniJAR* gamma, const float eps, UniJAR* Y ) {
+/*
+Vectorized version of jar_rmsnorm: 16 elements of a vector are processed at a time,
+the remainder in scalar code. 
+*/
+   UniJAR acc, r;
+   int    m, n;
+
+   assert (M > 0);
+   assert (N >= 0);
+
+   for (n=0; n<N; ++n) {
+     const UniJAR* x = X + (n*M);
+     UniJAR*       y = Y + (n*M);
+
+     acc.I = JAR_ZERO;
+     m = 0;
+#if defined(__AVX512F__)
+     {
+       __m512i vacc = _mm512_set1_epi32( JAR_ZERO );
+       for ( ; m<(M/16)*16; m+=16) {
+         __m512i vx = _mm512_loadu_epi32( x+m );
+         vacc = jar_fma_avx512( vx, vx, vacc );
+       }
+       acc.F = _mm512_reduce_add_ps( _mm512_castsi512_ps( vacc ) );
+     }
+#endif
+     for ( ; m<M; ++m) {
+       jar_fma( x+m, x+m, &acc );
+     }
+     acc.F = acc.F / (float)M + eps;
+     r = rsqrt_LinFP32_2_LogPS80( acc );
+
+     m = 0;
+#if defined(__AVX512F__)
+     {
+       __m512i vr = _mm512_set1_epi32( r.I );
+       for ( ; m<(M/16)*16; m+=16) {
+         __m512i vx = _mm512_loadu_epi32( x+m );
+         __m512i vg = _mm512_loadu_epi32( gamma+m );
+         vx = sum2_LogPS80_avx512( sum2_LogPS80_avx512( vx, vr ), vg );
+         _mm512_storeu_epi32( y+m, rnd_2_PS80_avx512( vx ) );
+       }
+     }
+#endif
+     for ( ; m<M; ++m) {
+       y[m] = rnd_2_PS80( sum2_LogPS80( sum2_LogPS80( x[m], r ), gamma[m] ) );
+     }
+   }
+}
+
+void jar_layernorm( const int M, const int N, const UniJAR* X, const UniJAR* gamma, const UniJAR* beta, const float eps, UniJAR* Y ) {
+/*
+LayerNorm of the N vectors of length M stored in the col-major matrix X. Sum and sum of
+squares are accumulated in the linear domain in a single pass, var = E[x^2] - E[x]^2.
+The centered value x - mean only exists in the linear domain and is converted once;
+its product with r = 1/sqrt(var + eps) and gamma is then accumulated onto beta
+exactly as in jar_fma, followed by the final conversion to LogPS80. Y may alias X.
+*/
+   UniJAR s1, s2, r, d, t, acc;
+   float  mean, var;
+   int    m, n;
+
+   assert (M > 0);
+   assert (N >= 0);
+
+   for (n=0; n<N; ++n) {
+     const UniJAR* x = X + (n*M);
+     UniJAR*       y = Y + (n*M);
+
+     s1.I = JAR_ZERO;
+     s2.I = JAR_ZERO;
+     for (m=0; m<M; ++m) {
+       s1.F += LogPS80_2_LinFP32( x[m] ).F;
+       jar_fma( x+m, x+m, &s2 );
+     }
+     mean = s1.F / (float)M;
+     var  = s2.F / (float)M - mean*mean;
+     var  = (var > 0.0f) ? var : 0.0f;
+     r.F  = var + eps;
+     r    = rsqrt_LinFP32_2_LogPS80( r );
+
+     for (m=0; m<M; ++m) {
+       d.F = LogPS80_2_LinFP32( x[m] ).F - mean;
+       t   = sum2_LogPS80( LinFP32_2_LogPS80( d ), r );
+       acc = LogPS80_2_LinFP32( beta[m] );
+       jar_fma( &t, gamma+m, &acc );
+       y[m] = LinFP32_2_LogPS80( acc );
+     }
+   }
+}
+
+void jar_layernorm_avx512( const int M, const int N, const UniJAR* X, const UniJAR* gamma, const UniJAR* beta, const float eps, UniJAR* Y ) {
+/*
+Vectorized version of jar_layernorm: 16 elements of a vector are processed at a time,
+the remainder in scalar code. 
+*/
+   UniJAR s1, s2, r, d, t, acc;
+   float  mean, var;
+   int    m, n;
+
+   assert (M > 0);
+   assert (N >= 0);
+
+   for (n=0; n<N; ++n) {
+     const UniJAR* x = X + (n*M);
+     UniJAR*       y = Y + (n*M);
+
+     s1.I = JAR_ZERO;
+     s2.I = JAR_ZERO;
+     m = 0;
+#if defined(__AVX512F__)
+     {
+       __m512i vs1 = _mm512_set1_epi32( JAR_ZERO );
+       __m512i vs2 = _mm512_set1_epi32( JAR_ZERO );
+       for ( ; m<(M/16)*16; m+=16) {
+         __m512i vx = _mm512_loadu_epi32( x+m );
+         vs1 = _mm512_castps_si512( _mm512_add_ps( _mm512_castsi512_ps( vs1 ),
+                 _mm512_castsi512_ps( LogPS80_2_LinFP32_avx512( vx ) ) ) );
+         vs2 = jar_fma_avx512( vx, vx, vs2 );
+       }
+       s1.F = _mm512_reduce_add_ps( _mm512_castsi512_ps( vs1 ) );
+       s2.F = _mm512_reduce_add_ps( _mm512_castsi512_ps( vs2 ) );
+     }
+#endif
+     for ( ; m<M; ++m) {
+       s1.F += LogPS80_2_LinFP32( x[m] ).F;
+       jar_fma( x+m, x+m, &s2 );
+     }
+     mean = s1.F / (float)M;
+     var  = s2.F / (float)M - mean*mean;
+     var  = (var > 0.0f) ? var : 0.0f;
+     r.F  = var + eps;
+     r    = rsqrt_LinFP32_2_LogPS80( r );
+
+     m = 0;
+#if defined(__AVX512F__)
+     {
+       __m512  vmean = _mm512_set1_ps( mean );
+       __m512i vr    = _mm512_set1_epi32( r.I );
+       for ( ; m<(M/16)*16; m+=16) {
+         __m512i vx = _mm512_loadu_epi32( x+m );
+         __m512i vg = _mm512_loadu_epi32( gamma+m );
+         __m512i vacc = LogPS80_2_LinFP32_avx512( _mm512_loadu_epi32( beta+m ) );
+         __m512  vd = _mm512_sub_ps( _mm512_castsi512_ps( LogPS80_2_LinFP32_avx512( vx ) ), vmean );
+         __m512i vt = sum2_LogPS80_avx512( LinFP32_2_LogPS80_avx512( _mm512_castps_si512( vd ) ), vr );
+         vacc = jar_fma_avx512( vt, vg, vacc );
+         _mm512_storeu_epi32( y+m, LinFP32_2_LogPS80_avx512( vacc ) );
+       }
+     }
+#endif
+     for ( ; m<M; ++m) {
+       d.F = LogPS80_2_LinFP32( x[m] ).F - mean;
+       t   = sum2_LogPS80( LinFP32_2_LogPS80( d ), r );
+       acc = LogPS80_2_LinFP32( beta[m] );
+       jar_fma( &t, gamma+m, &acc );
+       y[m] = LinFP32_2_LogPS80( acc );
+     }
+   }
+}
@@ -0,0 +1,60 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Normalization layers on LogPS80 data. Each of the N vectors of length M
+ *  (the columns of a col-major M x N matrix, i.e. one activation vector per
+ *  sample) is normalized independently.
+ *
+ *    RMSNorm:    y = x / sqrt( mean(x^2) + eps ) * gamma
+ *    LayerNorm:  y = (x - mean(x)) / sqrt( var(x) + eps ) * gamma + beta
+ *
+ *  Squaring is a JAR product (sum2_LogPS80 followed by the exp2 lookup) and the
+ *  sums of squares are accumulated in the linear domain, exactly as in jar_dotprod.
+ *  The reciprocal square root of the linear statistic is a shift of its 
+ *  logarithmic value, and the scaling by 1/sqrt(.) and gamma are sum2_LogPS80 
+ *  additions. gamma and beta are LogPS80 vectors of length M.
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_NORM
+
+#define JAR_NORM
+#include "jar_sim.h"
+
+UniJAR rsqrt_LinFP32_2_LogPS80( UniJAR x );
+void jar_rmsnorm( const int M, const int N, const UniJAR* X, const UniJAR* gamma, const float eps, UniJAR* Y );
+void jar_rmsnorm_avx512( const int M, const int N, const UniJAR* X, const UniJAR* gamma, const float eps, UniJAR* Y );
+void jar_layernorm( const int M, const int N, const UniJAR* X, const UniJAR* gamma, const UniJAR* beta, const float eps, UniJAR* Y );
+void jar_layernorm_avx512( const int M, const int N, const UniJAR* X, const UniJAR* gamma, const UniJAR* beta, const float eps, UniJAR* Y );
+
+#endif
+
@@ -0,0 +1,342 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include "jar_numa.h"
+#include "jar_mem.h"
+#include "jar_pool.h"
+
+typedef struct{
+   PartMatJAR*       P;
+   const UniJAR*     A;
+   int               lda;
+   int               N;
+   const UniJAR*     B;
+   UniJAR*           C;
+} JarNumaArg;
+
+typedef struct{
+   const NumaJAR*    numa;
+   ReplJAR*          R;
+   const UniJAR*     x;
+   int*              claimed;   /* one flag per node */
+} JarReplArg;
+
+static int jar_numa_read_cpulist( const char* path, int* cpus, const int max_cpus ) {
+/* parses a sysfs cpu list such as "0-3,8-11" into cpus, returns the number of cpus */
+  FILE* fp = fopen( path, "r" );
+  int   n = 0, lo, hi, c;
+  char  sep;
+
+  if (fp == NULL) {
+    return 0;
+  }
+  while (fscanf( fp, "%d", &lo ) == 1) {
+    hi = lo;
+    sep = (char)fgetc( fp );
+    if (sep == '-') {
+      if (fscanf( fp, "%d", &hi ) != 1) break;
+      sep = (char)fgetc( fp );
+    }
+    for (c=lo; c<=hi && n<max_cpus; ++c) {
+      cpus[n++] = c;
+    }
+    if (sep != ',') break;
+  }
+  fclose( fp );
+  return n;
+}
+
+int jar_numa_init( NumaJAR* numa ) {
+/* discovers the nodes and their cpus, returns the number of nodes */
+  const int max_cpus = (int)sysconf( _SC_NPROCESSORS_CONF ) + 1;
+  char path[64];
+  int  node, i, n;
+
+  numa->cpus    = (int*) malloc( max_cpus*sizeof(int) );
+  numa->node_of = (int*) malloc( max_cpus*sizeof(int) );
+  numa->ncpus   = 0;
+  numa->nnodes  = 0;
+  numa->max_cpu = max_cpus-1;
+  numa->caller  = NULL;
+  for (i=0; i<max_cpus; ++i) {
+    numa->node_of[i] = 0;
+  }
+
+  for (node=0; node<max_cpus && numa->ncpus<max_cpus; ++node) {
+    snprintf( path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node );
+    if (access( path, R_OK ) != 0) {
+      continue;
+    }
+    n = jar_numa_read_cpulist( path, numa->cpus+numa->ncpus, max_cpus-numa->ncpus );
+    for (i=0; i<n; ++i) {
+      numa->node_of[numa->cpus[numa->ncpus+i]] = numa->nnodes;
+    }
+    numa->ncpus  += n;
+    numa->nnodes += (n > 0);
+  }
+
+  /* no topology: one node with the online cpus */
+  if (numa->ncpus == 0) {
+    n = (int)sysconf( _SC_NPROCESSORS_ONLN );
+    for (i=0; i<n && i<max_cpus; ++i) {
+      numa->cpus[i] = i;
+    }
+    numa->ncpus  = (n < max_cpus) ? n : max_cpus;
+    numa->nnodes = 1;
+  }
+
+  return numa->nnodes;
+}
+
+void jar_numa_destroy( NumaJAR* numa ) {
+  jar_numa_unpin_threads( numa );
+  free( numa->cpus );
+  free( numa->node_of );
+  numa->cpus    = NULL;
+  numa->node_of = NULL;
+}
+
+int jar_numa_node( const NumaJAR* numa ) {
+/* the node of the cpu the calling thread runs on */
+  const int cpu = sched_getcpu();
+
+  return (cpu >= 0 && cpu <= numa->max_cpu) ? numa->node_of[cpu] : 0;
+}
+
+void jar_numa_pin_threads( NumaJAR* numa ) {
+/* 
+pins worker t of the default JAR pool to cpu numa->cpus[t mod ncpus] and the calling thread, 
+which runs the last part of the loops below, to the cpu after the workers; the mask of the
+calling thread is kept for jar_numa_unpin_threads
+*/
+  PoolJAR* pool = jar_pool_default();
+  const int nworkers = jar_pool_size( pool ) - 1;
+  cpu_set_t set;
+
+  if (numa->caller == NULL) {
+    numa->caller = malloc( sizeof(cpu_set_t) );
+    if (sched_getaffinity( 0, sizeof(cpu_set_t), (cpu_set_t*)numa->caller ) != 0) {
+      free( numa->caller );
+      numa->caller = NULL;
+      return;
+    }
+  }
+  jar_pool_pin( pool, numa->cpus, numa->ncpus );
+  CPU_ZERO( &set );
+  CPU_SET( numa->cpus[nworkers % numa->ncpus], &set );
+  sched_setaffinity( 0, sizeof(set), &set );
+}
+
+void jar_numa_unpin_threads( NumaJAR* numa ) {
+/* gives the calling thread its mask from before jar_numa_pin_threads back, the workers stay pinned */
+  if (numa->caller != NULL) {
+    sched_setaffinity( 0, sizeof(cpu_set_t), (const cpu_set_t*)numa->caller );
+    free( numa->caller );
+    numa->caller = NULL;
+  }
+}
+
+static void jar_numa_partition_task( void* arg, const int t ) {
+/* allocation and first touch of block t by the participant that owns it */
+  const JarNumaArg* a = (const JarNumaArg*)arg;
+  PartMatJAR* P = a->P;
+  const int mb = P->m0[t+1] - P->m0[t];
+  const int K = P->K;
+  int k, m;
+
+  P->A[t] = (UniJAR*) jar_malloc_huge( ((size_t)mb*K > 0 ? (size_t)mb*K : 1)*sizeof(UniJAR) );
+  for (k=0; k<K; ++k) {
+    for (m=0; m<mb; ++m) {
+      P->A[t][((size_t)k*mb)+m] = a->A[((size_t)k*a->lda)+P->m0[t]+m];
+    }
+  }
+}
+
+PartMatJAR* jar_numa_partition( const int M, const int K, const UniJAR* A, const int lda ) {
+/*
+splits the M x K col-major matrix A (leading dimension lda) into row blocks of multiples
+of 16 rows, one per participant of the default JAR pool; each participant allocates and 
+fills its own block in a static loop
+*/
+  PartMatJAR* P = (PartMatJAR*) malloc( sizeof(PartMatJAR) );
+  JarNumaArg a;
+  int t;
+
+  assert (M >= 0 && K >= 0 && lda >= M);
+
+  P->nparts = jar_pool_size( jar_pool_default() );
+  P->M  = M;
+  P->K  = K;
+  P->m0 = (int*) malloc( (P->nparts+1)*sizeof(int) );
+  P->A  = (UniJAR**) malloc( P->nparts*sizeof(UniJAR*) );
+  for (t=0; t<=P->nparts; ++t) {
+    const int nblk = (M+15)/16;
+    P->m0[t] = (int)(((long long)nblk*t/P->nparts)*16);
+    P->m0[t] = (P->m0[t] < M) ? P->m0[t] : M;
+  }
+
+  a.P = P; a.A = A; a.lda = lda;
+  jar_parallel_for_static( P->nparts, jar_numa_partition_task, &a );
+
+  return P;
+}
+
+void jar_numa_partition_free( PartMatJAR* P ) {
+  int t;
+
+  for (t=0; t<P->nparts; ++t) {
+    jar_free( P->A[t] );
+  }
+  free( P->A );
+  free( P->m0 );
+  free( P );
+}
+
+static void jar_numa_matvec_task( void* arg, const int t ) {
+/* the rows of block t of c = A*b */
+  const JarNumaArg* a = (const JarNumaArg*)arg;
+  const PartMatJAR* P = a->P;
+  const int m0 = P->m0[t];
+  const int mb = P->m0[t+1] - m0;
+  UniJAR* c = a->C;
+  int m;
+
+  for (m=0; m<mb; ++m) {
+    c[m0+m].I = JAR_ZERO;
+  }
+  jar_matvecacc_avx512( mb, P->K, P->A[t], mb, a->B, c+m0 );
+  for (m=0; m<mb; ++m) {
+    c[m0+m] = LinFP32_2_LogPS80( c[m0+m] );
+  }
+}
+
+void jar_numa_matvecmul( const PartMatJAR* P, const UniJAR* b, UniJAR* c ) {
+/* c = A*b for the partitioned A, the owner of block t computes its rows */
+  JarNumaArg a;
+
+  a.P = (PartMatJAR*)P; a.B = b; a.C = c;
+  jar_parallel_for_static( P->nparts, jar_numa_matvec_task, &a );
+}
+
+static void jar_numa_matmul_task( void* arg, const int t ) {
+/* the rows of block t of C = A*B */
+  const JarNumaArg* a = (const JarNumaArg*)arg;
+  const PartMatJAR* P = a->P;
+  const int m0 = P->m0[t];
+  const int mb = P->m0[t+1] - m0;
+  const int N = a->N;
+  UniJAR* C = a->C;
+  int m, n;
+
+  for (n=0; n<N; ++n) {
+    for (m=0; m<mb; ++m) {
+      C[((size_t)n*P->M)+m0+m].I = JAR_ZERO;
+    }
+  }
+  jar_matmulacc_avx512( mb, N, P->K, P->A[t], mb, a->B, P->K, C+m0, P->M );
+  for (n=0; n<N; ++n) {
+    for (m=0; m<mb; ++m) {
+      C[((size_t)n*P->M)+m0+m] = LinFP32_2_LogPS80( C[((size_t)n*P->M)+m0+m] );
+    }
+  }
+}
+
+void jar_numa_matmul( const PartMatJAR* P, const int N, const UniJAR* B, UniJAR* C ) {
+/* C = A*B for the partitioned A, B is K x N and C is M x N col-major */
+  JarNumaArg a;
+
+  assert (N >= 0);
+
+  a.P = (PartMatJAR*)P; a.N = N; a.B = B; a.C = C;
+  jar_parallel_for_static( P->nparts, jar_numa_matmul_task, &a );
+}
+
+static void jar_numa_replicate_task( void* arg, const int t ) {
+/* the first participant on a node allocates and fills the copy of that node */
+  const JarReplArg* a = (const JarReplArg*)arg;
+  const int node = jar_numa_node( a->numa );
+  const size_t n = a->R->n;
+
+  (void)t;
+  if (__atomic_exchange_n( &a->claimed[node], 1, __ATOMIC_RELAXED ) == 0) {
+    a->R->copy[node] = (UniJAR*) jar_malloc( (n > 0 ? n : 1)*sizeof(UniJAR) );
+    memcpy( a->R->copy[node], a->x, n*sizeof(UniJAR) );
+  }
+}
+
+ReplJAR* jar_numa_replicate( const NumaJAR* numa, const size_t n, const UniJAR* x ) {
+/* one copy of the n values x per node, each allocated and filled by a participant on its node */
+  ReplJAR* R = (ReplJAR*) malloc( sizeof(ReplJAR) );
+  JarReplArg a;
+  int nd;
+
+  R->nnodes = numa->nnodes;
+  R->n      = n;
+  R->copy   = (UniJAR**) calloc( numa->nnodes, sizeof(UniJAR*) );
+
+  a.numa = numa; a.R = R; a.x = x;
+  a.claimed = (int*) calloc( numa->nnodes, sizeof(int) );
+  jar_parallel_for_static( jar_pool_size( jar_pool_default() ), jar_numa_replicate_task, &a );
+  free( a.claimed );
+
+  /* nodes without a thread read the copy of node 0 or of any node that has one */
+  for (nd=0; nd<R->nnodes; ++nd) {
+    if (R->copy[nd] == NULL) {
+      int o = 0;
+      while (o < R->nnodes && (R->copy[o] == NULL || o == nd)) ++o;
+      R->copy[nd] = (UniJAR*) jar_malloc( (n > 0 ? n : 1)*sizeof(UniJAR) );
+      memcpy( R->copy[nd], (o < R->nnodes) ? R->copy[o] : x, n*sizeof(UniJAR) );
+    }
+  }
+
+  return R;
+}
+
+const UniJAR* jar_numa_local( const NumaJAR* numa, const ReplJAR* R ) {
+/* the copy on the node of the calling thread */
+  return R->copy[jar_numa_node( numa )];
+}
+
+void jar_numa_replicate_free( ReplJAR* R ) {
+  int nd;
+
+  for (nd=0; nd<R->nnodes; ++nd) {
+    jar_free( R->copy[nd] );
+  }
+  free( R->copy );
+  free( R );
+}
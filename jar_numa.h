@@ -0,0 +1,93 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  NUMA placement for JAR inference on multi-socket hosts, without a libnuma dependency.
+ *
+ *  jar_numa_init reads the node topology from /sys/devices/system/node (one node with
+ *  all online cpus if it is not available) and orders the cpus node by node. 
+ *  jar_numa_pin_threads pins worker t of the default JAR pool (jar_pool.h) to the t-th 
+ *  cpu of that order, so that consecutive workers share a node, and the calling thread to
+ *  the cpu after them. It has to be called before the routines below, from the thread 
+ *  that calls them; jar_numa_unpin_threads (or jar_numa_destroy) gives that thread its
+ *  previous mask back.
+ *
+ *  Large weights are partitioned by rows (jar_numa_partition): in a static pool loop, 
+ *  participant t allocates and copies, i.e. first-touches, its block of rows, so the pages
+ *  of the block are on the node of the thread that reads them in jar_numa_matvecmul and 
+ *  jar_numa_matmul, which use the same static assignment. Small weights can instead be 
+ *  replicated once per node (jar_numa_replicate) and read through jar_numa_local. The 
+ *  results are identical to jar_matvecmul / jar_matmul.
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_NUMA
+
+#define JAR_NUMA
+#include "jar_sim.h"
+
+typedef struct{
+   int       nnodes;
+   int       ncpus;
+   int*      cpus;        /* online cpus ordered node by node */
+   int       max_cpu;
+   int*      node_of;     /* node of cpu id 0 ... max_cpu */
+   void*     caller;      /* cpu mask of the thread that called jar_numa_pin_threads */
+} NumaJAR;
+
+typedef struct{
+   int       M;
+   int       K;
+   int       nparts;
+   int*      m0;          /* first row of each block, nparts+1 entries */
+   UniJAR**  A;           /* block t is (m0[t+1]-m0[t]) x K col-major */
+} PartMatJAR;
+
+typedef struct{
+   int       nnodes;
+   size_t    n;
+   UniJAR**  copy;        /* one copy per node */
+} ReplJAR;
+
+int jar_numa_init( NumaJAR* numa );
+void jar_numa_destroy( NumaJAR* numa );
+int jar_numa_node( const NumaJAR* numa );
+void jar_numa_pin_threads( NumaJAR* numa );
+void jar_numa_unpin_threads( NumaJAR* numa );
+PartMatJAR* jar_numa_partition( const int M, const int K, const UniJAR* A, const int lda );
+void jar_numa_partition_free( PartMatJAR* P );
+void jar_numa_matvecmul( const PartMatJAR* P, const UniJAR* b, UniJAR* c );
+void jar_numa_matmul( const PartMatJAR* P, const int N, const UniJAR* B, UniJAR* C );
+ReplJAR* jar_numa_replicate( const NumaJAR* numa, const size_t n, const UniJAR* x );
+const UniJAR* jar_numa_local( const NumaJAR* numa, const ReplJAR* R );
+void jar_numa_replicate_free( ReplJAR* R );
+
+#endif
@@ -0,0 +1,194 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "jar_numstat.h"
+
+typedef struct JarNumThread{
+   NumStatJAR             stat[JAR_NUMSTAT_TAGS];
+   struct JarNumThread*   next;
+} JarNumThread;
+
+int jar_numstat_flags = 0;
+
+static pthread_mutex_t jar_numstat_lock = PTHREAD_MUTEX_INITIALIZER;
+static JarNumThread* jar_numstat_threads = NULL;
+static __thread JarNumThread* jar_numstat_self = NULL;
+static __thread int jar_numstat_cur = 0;
+
+void jar_numstat_enable( const int on ) {
+  __atomic_store_n( &jar_numstat_flags, on ? 1 : 0, __ATOMIC_RELAXED );
+}
+
+int jar_numstat_enabled( ) {
+  return __atomic_load_n( &jar_numstat_flags, __ATOMIC_RELAXED );
+}
+
+int jar_numstat_tag( const int tag ) {
+/* sets the tag of the calling thread, returns the previous one */
+  const int prev = jar_numstat_cur;
+
+  jar_numstat_cur = (tag >= 0 && tag < JAR_NUMSTAT_TAGS) ? tag : 0;
+  return prev;
+}
+
+int jar_numstat_current( ) {
+  return jar_numstat_cur;
+}
+
+void jar_numstat_init( NumStatJAR* s ) {
+  memset( s, 0, sizeof(NumStatJAR) );
+  s->max_exp = JAR_NUMSTAT_NOEXP;
+}
+
+void jar_numstat_scan( NumStatJAR* s, const size_t n, const UniJAR* x ) {
+/* counts n LinFP32 values about to be converted into s */
+  size_t i = 0;
+
+#if defined(__AVX512F__)
+  NumVecJAR v;
+
+  jar_numstat_vec_init( &v );
+  for ( ; i+16<=n; i+=16) {
+    jar_numstat_vec( &v, _mm512_loadu_epi32( x+i ) );
+  }
+  jar_numstat_vec_flush( s, &v );
+#endif
+  for ( ; i<n; ++i) {
+    jar_numstat_one( s, x[i].I );
+  }
+}
+
+#if defined(__AVX512F__)
+void jar_numstat_vec_flush( NumStatJAR* s, const NumVecJAR* v ) {
+/* adds the lane counters of v to s */
+  const int64_t e = (int64_t)_mm512_reduce_max_epu32( v->max_exp );
+
+  s->values   += v->values;
+  s->zero     += (uint64_t)_mm512_reduce_add_epi32( v->zero );
+  s->flush    += (uint64_t)_mm512_reduce_add_epi32( v->flush );
+  s->saturate += (uint64_t)_mm512_reduce_add_epi32( v->saturate );
+  if (e > 0 && e - 127 > s->max_exp) s->max_exp = e - 127;
+}
+#endif
+
+static void jar_numstat_store( uint64_t* x, const uint64_t v ) {
+/* only the owning thread writes, readers may load at any time */
+  __atomic_store_n( x, __atomic_load_n( x, __ATOMIC_RELAXED ) + v, __ATOMIC_RELAXED );
+}
+
+void jar_numstat_add( const int tag, const NumStatJAR* s ) {
+/* adds the counts of one call to the table of the calling thread */
+  JarNumThread* th = jar_numstat_self;
+  NumStatJAR* t;
+  int k;
+
+  if (th == NULL) {
+    th = (JarNumThread*) calloc( 1, sizeof(JarNumThread) );
+    for (k=0; k<JAR_NUMSTAT_TAGS; ++k) th->stat[k].max_exp = JAR_NUMSTAT_NOEXP;
+    pthread_mutex_lock( &jar_numstat_lock );
+    th->next = jar_numstat_threads;
+    jar_numstat_threads = th;
+    pthread_mutex_unlock( &jar_numstat_lock );
+    jar_numstat_self = th;
+  }
+  t = th->stat + ((tag >= 0 && tag < JAR_NUMSTAT_TAGS) ? tag : 0);
+  jar_numstat_store( &t->calls, 1 );
+  jar_numstat_store( &t->values, s->values );
+  jar_numstat_store( &t->zero, s->zero );
+  jar_numstat_store( &t->flush, s->flush );
+  jar_numstat_store( &t->saturate, s->saturate );
+  if (s->max_exp > __atomic_load_n( &t->max_exp, __ATOMIC_RELAXED )) {
+    __atomic_store_n( &t->max_exp, s->max_exp, __ATOMIC_RELAXED );
+  }
+}
+
+void jar_numstat_reset( ) {
+  JarNumThread* th;
+  int k;
+
+  pthread_mutex_lock( &jar_numstat_lock );
+  for (th=jar_numstat_threads; th!=NULL; th=th->next) {
+    for (k=0; k<JAR_NUMSTAT_TAGS; ++k) {
+      __atomic_store_n( &th->stat[k].calls, 0, __ATOMIC_RELAXED );
+      __atomic_store_n( &th->stat[k].values, 0, __ATOMIC_RELAXED );
+      __atomic_store_n( &th->stat[k].zero, 0, __ATOMIC_RELAXED );
+      __atomic_store_n( &th->stat[k].flush, 0, __ATOMIC_RELAXED );
+      __atomic_store_n( &th->stat[k].saturate, 0, __ATOMIC_RELAXED );
+      __atomic_store_n( &th->stat[k].max_exp, JAR_NUMSTAT_NOEXP, __ATOMIC_RELAXED );
+    }
+  }
+  pthread_mutex_unlock( &jar_numstat_lock );
+}
+
+void jar_numstat_snapshot( NumStatJAR* s ) {
+/* s[JAR_NUMSTAT_TAGS], the sums over all threads */
+  JarNumThread* th;
+  int k;
+
+  for (k=0; k<JAR_NUMSTAT_TAGS; ++k) {
+    jar_numstat_init( s+k );
+  }
+  pthread_mutex_lock( &jar_numstat_lock );
+  for (th=jar_numstat_threads; th!=NULL; th=th->next) {
+    for (k=0; k<JAR_NUMSTAT_TAGS; ++k) {
+      const int64_t e = __atomic_load_n( &th->stat[k].max_exp, __ATOMIC_RELAXED );
+      s[k].calls    += __atomic_load_n( &th->stat[k].calls, __ATOMIC_RELAXED );
+      s[k].values   += __atomic_load_n( &th->stat[k].values, __ATOMIC_RELAXED );
+      s[k].zero     += __atomic_load_n( &th->stat[k].zero, __ATOMIC_RELAXED );
+      s[k].flush    += __atomic_load_n( &th->stat[k].flush, __ATOMIC_RELAXED );
+      s[k].saturate += __atomic_load_n( &th->stat[k].saturate, __ATOMIC_RELAXED );
+      if (e > s[k].max_exp) s[k].max_exp = e;
+    }
+  }
+  pthread_mutex_unlock( &jar_numstat_lock );
+}
+
+void jar_numstat_print( FILE* fp, const NumStatJAR* s ) {
+/* one line per tag of the snapshot s that has counts */
+  int k;
+
+  fprintf( fp, "%4s %10s %12s %10s %8s %10s %8s %10s %8s %7s\n", "tag", "calls", "values", "zero", "%", "flush", "%",
+           "saturate", "%", "max exp" );
+  for (k=0; k<JAR_NUMSTAT_TAGS; ++k) {
+    const double n = (s[k].values > 0) ? (double)s[k].values : 1.0;
+    if (s[k].calls == 0) continue;
+    fprintf( fp, "%4i %10llu %12llu %10llu %8.3f %10llu %8.3f %10llu %8.3f ", k, (unsigned long long)s[k].calls,
+             (unsigned long long)s[k].values, (unsigned long long)s[k].zero, 100.0*(double)s[k].zero/n,
+             (unsigned long long)s[k].flush, 100.0*(double)s[k].flush/n,
+             (unsigned long long)s[k].saturate, 100.0*(double)s[k].saturate/n );
+    if (s[k].max_exp == JAR_NUMSTAT_NOEXP) fprintf( fp, "%7s\n", "-" );
+    else fprintf( fp, "%7lli\n", (long long)s[k].max_exp );
+  }
+}
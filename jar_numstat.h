@@ -0,0 +1,151 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Numerical event counters of the conversions LinFP32 --> LogPS80 at the end of the 
+ *  JAR kernels, to find the layers that clip.
+ *
+ *  For every value converted, with m the exponent it has after rounding the fraction to
+ *  LOG2_IND_BITS (the exponent rnd_2_PS80 sees), NumStatJAR counts
+ *
+ *    zero       |x| <= 2^-63, i.e. JAR_ZERO or below (products with JAR_ZERO vanish)
+ *    flush      other values with m <= -7, flushed by rnd_2_PS80
+ *    saturate   m >= 6 (infinities and NaN included), saturated by rnd_2_PS80
+ *
+ *  and keeps max_exp, the largest exponent of a non-zero linear-domain accumulator, as
+ *  a high-water mark. Counting is done in the epilogues of jar_dotprod, jar_matvecmul, 
+ *  jar_matmul (scalar and _avx512), jar_convert_LinFP32_2_LogPS80 and the groups of 
+ *  jar_graph_run, 16 lanes at a time with AVX512, into counters local to the call that
+ *  are added once per call to the table of the calling thread: no atomics, locks or 
+ *  shared cache lines on the hot path.
+ *
+ *  Counts are kept per tag, 0 ... JAR_NUMSTAT_TAGS-1. jar_numstat_tag sets the tag of
+ *  the calling thread (0 by default) and returns the previous one, e.g. to tag each 
+ *  call with the layer or tensor it computes; pooled conversions use the tag of the 
+ *  calling thread. jar_graph_run tags the results of each group with the id of the 
+ *  value it produces (modulo JAR_NUMSTAT_TAGS).
+ *
+ *  Counting is off until jar_numstat_enable( 1 ) and is compiled out with 
+ *  JAR_NO_NUMSTAT. jar_numstat_snapshot sums the tables of all threads, 
+ *  jar_numstat_reset clears them (at quiescent points).
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_NUMSTAT
+
+#define JAR_NUMSTAT
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "jar_type.h"
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#define JAR_NUMSTAT_TAGS  64
+/* no exponent recorded yet */
+#define JAR_NUMSTAT_NOEXP (-128)
+
+typedef struct{
+   uint64_t   calls;
+   uint64_t   values;
+   uint64_t   zero;
+   uint64_t   flush;
+   uint64_t   saturate;
+   int64_t    max_exp;
+} NumStatJAR;
+
+extern int jar_numstat_flags;
+
+#if defined(JAR_NO_NUMSTAT)
+#define JAR_NUMSTAT_ON()  0
+#else
+#define JAR_NUMSTAT_ON()  __atomic_load_n( &jar_numstat_flags, __ATOMIC_RELAXED )
+#endif
+
+static inline void jar_numstat_one( NumStatJAR* s, const unsigned int x ) {
+/* counts one LinFP32 value about to be converted */
+  const unsigned int a = x & CLEAR_SIGN;
+  const int e = (int)((a + (1u << (LOG2_IND_SHIFT-1))) >> 23);
+
+  s->values++;
+  if (a <= JAR_ZERO) {
+    s->zero++;
+    return;
+  }
+  s->flush    += (e <= 127-7);
+  s->saturate += (e >= 127+6);
+  if ((int64_t)(a >> 23) - 127 > s->max_exp) s->max_exp = (int64_t)(a >> 23) - 127;
+}
+
+#if defined(__AVX512F__)
+typedef struct{
+   __m512i    zero;
+   __m512i    flush;
+   __m512i    saturate;
+   __m512i    max_exp;   /* biased */
+   uint64_t   values;
+} NumVecJAR;
+
+static inline void jar_numstat_vec_init( NumVecJAR* v ) {
+  v->zero = v->flush = v->saturate = v->max_exp = _mm512_setzero_si512();
+  v->values = 0;
+}
+
+static inline void jar_numstat_vec( NumVecJAR* v, const __m512i x ) {
+/* counts 16 LinFP32 values about to be converted, see jar_numstat_one */
+  const __m512i one = _mm512_set1_epi32( 1 );
+  const __m512i a = _mm512_and_epi32( x, _mm512_set1_epi32( CLEAR_SIGN ) );
+  const __m512i e = _mm512_srli_epi32( _mm512_add_epi32( a, _mm512_set1_epi32( 1u << (LOG2_IND_SHIFT-1) ) ), 23 );
+  const __mmask16 z = _mm512_cmple_epu32_mask( a, _mm512_set1_epi32( JAR_ZERO ) );
+
+  v->zero     = _mm512_mask_add_epi32( v->zero, z, v->zero, one );
+  v->flush    = _mm512_mask_add_epi32( v->flush, _mm512_kandn( z, _mm512_cmple_epi32_mask( e, _mm512_set1_epi32( 127-7 ) ) ), v->flush, one );
+  v->saturate = _mm512_mask_add_epi32( v->saturate, _mm512_cmpge_epi32_mask( e, _mm512_set1_epi32( 127+6 ) ), v->saturate, one );
+  v->max_exp  = _mm512_mask_max_epu32( v->max_exp, (__mmask16)~z, v->max_exp, _mm512_srli_epi32( a, 23 ) );
+  v->values  += 16;
+}
+
+void jar_numstat_vec_flush( NumStatJAR* s, const NumVecJAR* v );
+#endif
+
+void jar_numstat_enable( const int on );
+int jar_numstat_enabled( );
+int jar_numstat_tag( const int tag );
+int jar_numstat_current( );
+void jar_numstat_init( NumStatJAR* s );
+void jar_numstat_scan( NumStatJAR* s, const size_t n, const UniJAR* x );
+void jar_numstat_add( const int tag, const NumStatJAR* s );
+void jar_numstat_reset( );
+void jar_numstat_snapshot( NumStatJAR* s );
+void jar_numstat_print( FILE* fp, const NumStatJAR* s );
+
+#endif
@@ -0,0 +1,160 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "jar_ooc.h"
+#include "jar_mem.h"
+#include "jar_pool.h"
+
+static void jar_ooc_willneed( const void* p, const size_t nbytes ) {
+/* asks the kernel to read the pages of [p, p+nbytes) ahead, asynchronously */
+  const uintptr_t page = (uintptr_t)sysconf( _SC_PAGESIZE );
+  const uintptr_t lo   = (uintptr_t)p & ~(page-1);
+
+  if (nbytes > 0) {
+    madvise( (void*)lo, ((uintptr_t)p + nbytes) - lo, MADV_WILLNEED );
+  }
+}
+
+typedef struct{
+   int            M;
+   int            NB;
+   int            KB;
+   const UniJAR*  A;
+   int            lda;
+   const UniJAR*  B;
+   int            ldb;
+   UniJAR*        C;
+   int            ldc;
+} JarOocArg;
+
+static void jar_ooc_task( void* arg, const int t ) {
+/* row block t of a panel product, the block of A stays in cache while sweeping over B */
+  const JarOocArg* a = (const JarOocArg*)arg;
+  const int m0 = t*JAR_OOC_MB;
+  const int mb = (a->M-m0 < JAR_OOC_MB) ? a->M-m0 : JAR_OOC_MB;
+
+  jar_matmulacc_avx512( mb, a->NB, a->KB, a->A+m0, a->lda, a->B, a->ldb, a->C+m0, a->ldc );
+}
+
+static void jar_ooc_panel( const int M, const int NB, const int KB, const UniJAR* A, const int lda,
+                           const UniJAR* B, const int ldb, UniJAR* C, const int ldc ) {
+/* C += A*B for one panel, the row blocks of JAR_OOC_MB rows are tasks of the JAR thread pool */
+  JarOocArg a;
+
+  a.M = M; a.NB = NB; a.KB = KB; a.A = A; a.lda = lda; a.B = B; a.ldb = ldb; a.C = C; a.ldc = ldc;
+  jar_parallel_for( (M + JAR_OOC_MB - 1)/JAR_OOC_MB, jar_ooc_task, &a );
+}
+
+int jar_matmul_ooc( const TensorJAR* A, const TensorJAR* B, const int fd, const size_t offset, const size_t mem ) {
+/*
+computes C = A*B out of core, see jar_ooc.h. mem is the memory budget in bytes for the
+accumulator of C and the resident panels of A and B.
+*/
+  const int    M = A->rows;
+  const int    K = A->cols;
+  const int    N = B->cols;
+  const int    lda = A->ld;
+  const int    ldb = B->ld;
+  const size_t budget = (mem < JAR_OOC_MIN_MEM) ? JAR_OOC_MIN_MEM : mem;
+  const UniJAR* a = (const UniJAR*)A->data;
+  const UniJAR* b = (const UniJAR*)B->data;
+  UniJAR* c;
+  size_t  nb_, kb_, i;
+  int     NB, KB, n0, k0, ok = 1;
+
+  assert (A->encoding == JAR_ENC_LOGPS80 && B->encoding == JAR_ENC_LOGPS80);
+  assert (lda >= M && ldb >= K && B->rows == K);
+
+  /* half of the budget for C and B, half for two panels of A; panel offsets fit in int */
+  nb_ = (budget/2) / (((size_t)M + ldb + 1)*sizeof(UniJAR));
+  kb_ = (budget/2) / (2*((size_t)lda + 1)*sizeof(UniJAR));
+  nb_ = (nb_ > 8) ? (nb_/8)*8 : (nb_ > 0 ? nb_ : 1);
+  nb_ = (nb_ < (size_t)INT32_MAX/((size_t)M+ldb+1)) ? nb_ : (size_t)INT32_MAX/((size_t)M+ldb+1);
+  kb_ = (kb_ > 0) ? kb_ : 1;
+  kb_ = (kb_ < (size_t)INT32_MAX/((size_t)lda+1)) ? kb_ : (size_t)INT32_MAX/((size_t)lda+1);
+  NB  = (nb_ < (size_t)N) ? (int)nb_ : (N > 0 ? N : 1);
+  KB  = (kb_ < (size_t)K) ? (int)kb_ : (K > 0 ? K : 1);
+
+  c = (UniJAR*) jar_malloc( (size_t)M*NB*sizeof(UniJAR) );
+  if (c == NULL) {
+    return -1;
+  }
+
+  jar_ooc_willneed( b, (size_t)ldb*NB*sizeof(UniJAR) );
+  jar_ooc_willneed( a, (size_t)lda*KB*sizeof(UniJAR) );
+
+  for (n0=0; ok && n0<N; n0+=NB) {
+    const int nb = (N-n0 < NB) ? N-n0 : NB;
+    const UniJAR* bp = b + (size_t)n0*ldb;
+
+    for (i=0; i<(size_t)M*nb; ++i) {
+      c[i].I = JAR_ZERO;
+    }
+
+    for (k0=0; k0<K; k0+=KB) {
+      const int kb = (K-k0 < KB) ? K-k0 : KB;
+
+      /* read ahead the next panel of A, or the first panel of A and the next panel of B */
+      if (k0+KB < K) {
+        const int kn = (K-k0-KB < KB) ? K-k0-KB : KB;
+        jar_ooc_willneed( a + (size_t)(k0+KB)*lda, (size_t)lda*kn*sizeof(UniJAR) );
+      } else if (n0+NB < N) {
+        const int nn = (N-n0-NB < NB) ? N-n0-NB : NB;
+        jar_ooc_willneed( a, (size_t)lda*KB*sizeof(UniJAR) );
+        jar_ooc_willneed( b + (size_t)(n0+NB)*ldb, (size_t)ldb*nn*sizeof(UniJAR) );
+      }
+
+      jar_ooc_panel( M, nb, kb, a + (size_t)k0*lda, lda, bp + k0, ldb, c, M );
+    }
+
+    jar_convert_LinFP32_2_LogPS80( (size_t)M*nb, c, c, NULL );
+
+    {
+      const size_t nbytes = (size_t)M*nb*sizeof(UniJAR);
+      const off_t  pos    = (off_t)(offset + (size_t)n0*M*sizeof(UniJAR));
+      size_t  done = 0;
+      ssize_t r = 1;
+      while (done < nbytes && r > 0) {
+        r = pwrite( fd, (const char*)c + done, nbytes - done, pos + (off_t)done );
+        done += (r > 0) ? (size_t)r : 0;
+      }
+      ok = (done == nbytes);
+    }
+  }
+
+  jar_free( c );
+  return ok ? 0 : -1;
+}
@@ -0,0 +1,66 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Out-of-core GEMM C = A*B for LogPS80 matrices that do not fit in memory. A (M x K)
+ *  and B (K x N) are 32-bit col-major tensors of memory-mapped .jar files (see 
+ *  jar_file.h) and C (M x N) is written to a file descriptor, e.g. at the payload 
+ *  offset of a .jar file whose header was written with jar_file_write_header.
+ *
+ *  C is computed in panels of NB columns. For a panel, the K x NB panel of B stays
+ *  resident and the M x KB panels of A (column ranges; A->ld and B->ld may pad the
+ *  columns) are streamed in order of k; the panel of C is accumulated in the linear
+ *  domain by jar_matmulacc and converted to LogPS80 once, then written. Before a panel
+ *  of A is multiplied the next one (and before the last one the next panel of B) is
+ *  passed to madvise(WILLNEED), so the kernel reads it ahead asynchronously while the
+ *  current panel is computed. NB and KB are chosen so that the accumulator of C, the
+ *  panel of B and two panels of A fit in the memory budget. Each element is accumulated
+ *  in the same order as in jar_matmul, so the result is identical to the in-memory
+ *  product.
+ *
+ *  jar_matmul_ooc returns 0 on success and -1 if the accumulator of C cannot be
+ *  allocated or writing C fails.
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_OOC
+
+#define JAR_OOC
+#include "jar_file.h"
+
+/* rows per task of a panel product, a multiple of 16 */
+#define JAR_OOC_MB       64
+/* smallest memory budget, in bytes */
+#define JAR_OOC_MIN_MEM  (1 << 20)
+
+int jar_matmul_ooc( const TensorJAR* A, const TensorJAR* B, const int fd, const size_t offset, const size_t mem );
+
+#endif
@@ -0,0 +1,340 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "jar_perf.h"
+#include "jar_sim.h"
+#include "jar_mem.h"
+#include "jar_pool.h"
+#include "jar_timer.h"
+
+/* the L1-resident GEMM of jar_perf_peak_jar */
+#define JAR_PEAK_M   64
+#define JAR_PEAK_N   16
+#define JAR_PEAK_K   64
+/* FMA iterations of a jar_perf_peak_fp32 task */
+#define JAR_PEAK_IT  4096
+/* elements per task of jar_perf_stream */
+#define JAR_STREAM_CHUNK  65536
+
+static void jar_perf_event( PerfJAR* p, const char* name, const uint32_t type, const uint64_t config ) {
+  if (p->nevents < JAR_PERF_MAX_EVENTS) {
+    snprintf( p->name[p->nevents], JAR_PERF_NAME_LEN, "%s", name );
+    p->type[p->nevents]   = type;
+    p->config[p->nevents] = config;
+    p->nevents++;
+  }
+}
+
+void jar_perf_init( PerfJAR* p ) {
+/* the default events, nothing is opened yet */
+  memset( p, 0, sizeof(PerfJAR) );
+  jar_perf_event( p, "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES );
+  jar_perf_event( p, "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS );
+  jar_perf_event( p, "l1d_miss", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                  (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) );
+  jar_perf_event( p, "llc_ref", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES );
+  jar_perf_event( p, "llc_miss", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES );
+  jar_perf_event( p, "branch_miss", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES );
+  jar_perf_event( p, "task_clock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK );
+  jar_perf_event( p, "page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS );
+}
+
+int jar_perf_add( PerfJAR* p, const char* spec ) {
+/* adds the raw event "name=rHEX", returns -1 if spec is malformed or the list is full */
+  const char* eq = strchr( spec, '=' );
+  char name[JAR_PERF_NAME_LEN];
+  char* end;
+  uint64_t config;
+
+  if (eq == NULL || eq == spec || eq - spec >= JAR_PERF_NAME_LEN || eq[1] != 'r' || p->nevents == JAR_PERF_MAX_EVENTS) {
+    return -1;
+  }
+  config = strtoull( eq+2, &end, 16 );
+  if (end == eq+2 || *end != '\0') {
+    return -1;
+  }
+  memcpy( name, spec, eq - spec );
+  name[eq - spec] = '\0';
+  jar_perf_event( p, name, PERF_TYPE_RAW, config );
+  return 0;
+}
+
+int jar_perf_open( PerfJAR* p ) {
+/* opens the events on all current threads of the process, returns the number of available events */
+  DIR* d = opendir( "/proc/self/task" );
+  struct dirent* de;
+  int* tid = NULL;
+  int  ntid = 0, cap = 0, t, e, navail = 0;
+
+  if (d == NULL) {
+    tid = (int*) malloc( sizeof(int) );
+    tid[ntid++] = 0;
+  } else {
+    while ((de = readdir( d )) != NULL) {
+      if (de->d_name[0] < '0' || de->d_name[0] > '9') continue;
+      if (ntid == cap) {
+        cap = (cap > 0) ? 2*cap : 16;
+        tid = (int*) realloc( tid, cap*sizeof(int) );
+      }
+      tid[ntid++] = atoi( de->d_name );
+    }
+    closedir( d );
+  }
+
+  p->nthreads = ntid;
+  p->fd = (int*) malloc( (size_t)ntid*p->nevents*sizeof(int) );
+  for (e=0; e<p->nevents; ++e) {
+    p->avail[e] = 0;
+    for (t=0; t<ntid; ++t) {
+      struct perf_event_attr attr;
+      memset( &attr, 0, sizeof(attr) );
+      attr.size           = sizeof(attr);
+      attr.type           = p->type[e];
+      attr.config         = p->config[e];
+      attr.disabled       = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv     = 1;
+      attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      p->fd[t*p->nevents+e] = (int)syscall( __NR_perf_event_open, &attr, tid[t], -1, -1, 0 );
+      if (p->fd[t*p->nevents+e] >= 0) {
+        p->avail[e] = 1;
+      }
+    }
+    navail += p->avail[e];
+  }
+  free( tid );
+  return navail;
+}
+
+void jar_perf_start( PerfJAR* p ) {
+  int i;
+
+  for (i=0; i<p->nthreads*p->nevents; ++i) {
+    if (p->fd[i] >= 0) {
+      ioctl( p->fd[i], PERF_EVENT_IOC_RESET, 0 );
+      ioctl( p->fd[i], PERF_EVENT_IOC_ENABLE, 0 );
+    }
+  }
+}
+
+void jar_perf_stop( PerfJAR* p ) {
+/* stops counting and sums the counts of all threads, scaled by time enabled / time running */
+  int t, e;
+
+  for (e=0; e<p->nevents; ++e) {
+    p->count[e] = 0.0;
+  }
+  for (t=0; t<p->nthreads; ++t) {
+    for (e=0; e<p->nevents; ++e) {
+      const int fd = p->fd[t*p->nevents+e];
+      uint64_t v[3];
+      if (fd < 0) continue;
+      ioctl( fd, PERF_EVENT_IOC_DISABLE, 0 );
+      if (read( fd, v, sizeof(v) ) == (ssize_t)sizeof(v) && v[2] > 0) {
+        p->count[e] += (double)v[0]*((double)v[1]/(double)v[2]);
+      }
+    }
+  }
+}
+
+int jar_perf_find( const PerfJAR* p, const char* name ) {
+/* index of an available event, -1 if there is none of that name */
+  int e;
+
+  for (e=0; e<p->nevents; ++e) {
+    if (p->avail[e] && strcmp( p->name[e], name ) == 0) return e;
+  }
+  return -1;
+}
+
+void jar_perf_close( PerfJAR* p ) {
+  int i;
+
+  for (i=0; i<p->nthreads*p->nevents; ++i) {
+    if (p->fd[i] >= 0) close( p->fd[i] );
+  }
+  free( p->fd );
+  p->fd = NULL;
+  p->nthreads = 0;
+}
+
+typedef struct{
+   int       ntasks;
+   UniJAR*   buf;       /* A, B, C per task */
+   float*    a;
+   float*    b;
+   float*    c;
+   size_t    n;
+} JarPeakArg;
+
+static void jar_peak_jar_task( void* arg, const int t ) {
+  JarPeakArg* a = (JarPeakArg*)arg;
+  UniJAR* A = a->buf + (size_t)t*(JAR_PEAK_M*JAR_PEAK_K + JAR_PEAK_K*JAR_PEAK_N + JAR_PEAK_M*JAR_PEAK_N);
+  UniJAR* B = A + JAR_PEAK_M*JAR_PEAK_K;
+  UniJAR* C = B + JAR_PEAK_K*JAR_PEAK_N;
+  int r;
+
+  for (r=0; r<8; ++r) {
+    jar_matmul_avx512( JAR_PEAK_M, JAR_PEAK_N, JAR_PEAK_K, A, B, C );
+  }
+}
+
+static void jar_peak_jar_call( void* arg ) {
+  JarPeakArg* a = (JarPeakArg*)arg;
+  jar_parallel_for( a->ntasks, jar_peak_jar_task, a );
+}
+
+double jar_perf_peak_jar( ) {
+/* JAR operations per second of an L1-resident GEMM on all threads */
+  const size_t per = JAR_PEAK_M*JAR_PEAK_K + JAR_PEAK_K*JAR_PEAK_N + JAR_PEAK_M*JAR_PEAK_N;
+  JarPeakArg a;
+  TimingJAR t;
+  size_t i;
+
+  a.ntasks = 4*jar_pool_size( jar_pool_default() );
+  a.buf = (UniJAR*) jar_malloc( per*a.ntasks*sizeof(UniJAR) );
+  for (i=0; i<per*a.ntasks; ++i) {
+    a.buf[i] = LinFP32_2_LogPS80( two_2_k( (int)(i % 5) - 2 ) );
+  }
+  jar_timer_measure( jar_peak_jar_call, &a, 0.2, &t );
+  jar_free( a.buf );
+  return 8.0*2.0*JAR_PEAK_M*JAR_PEAK_N*JAR_PEAK_K*a.ntasks/t.min;
+}
+
+static void jar_peak_fp32_task( void* arg, const int t ) {
+/* 8 independent chains of 16-wide FMAs */
+  volatile float sink;
+  const float x = 0.999f, y = 0.001f*(float)(t+1);
+  float s = 0.0f;
+  int i, j;
+#if defined(__AVX512F__)
+  __m512 acc[8];
+  const __m512 vx = _mm512_set1_ps( x ), vy = _mm512_set1_ps( y );
+
+  for (j=0; j<8; ++j) acc[j] = _mm512_set1_ps( (float)j );
+  for (i=0; i<JAR_PEAK_IT; ++i) {
+    for (j=0; j<8; ++j) acc[j] = _mm512_fmadd_ps( acc[j], vx, vy );
+  }
+  for (j=0; j<8; ++j) s += _mm512_reduce_add_ps( acc[j] );
+#else
+  float acc[8][16];
+  int l;
+
+  for (j=0; j<8; ++j) for (l=0; l<16; ++l) acc[j][l] = (float)(j+l);
+  for (i=0; i<JAR_PEAK_IT; ++i) {
+    for (j=0; j<8; ++j) for (l=0; l<16; ++l) acc[j][l] = acc[j][l]*x + y;
+  }
+  for (j=0; j<8; ++j) for (l=0; l<16; ++l) s += acc[j][l];
+#endif
+  sink = s;
+  (void)sink;
+  (void)arg;
+}
+
+static void jar_peak_fp32_call( void* arg ) {
+  JarPeakArg* a = (JarPeakArg*)arg;
+  jar_parallel_for( a->ntasks, jar_peak_fp32_task, a );
+}
+
+double jar_perf_peak_fp32( ) {
+/* FP32 flops per second of register-resident FMAs on all threads */
+  JarPeakArg a;
+  TimingJAR t;
+
+  a.ntasks = 4*jar_pool_size( jar_pool_default() );
+  jar_timer_measure( jar_peak_fp32_call, &a, 0.2, &t );
+  return 2.0*16.0*8.0*JAR_PEAK_IT*a.ntasks/t.min;
+}
+
+static void jar_stream_init_task( void* arg, const int t ) {
+/* first touch by the thread that runs the triad on the same chunk, both loops are static */
+  JarPeakArg* a = (JarPeakArg*)arg;
+  const size_t i0 = (size_t)t*JAR_STREAM_CHUNK;
+  const size_t i1 = (i0 + JAR_STREAM_CHUNK < a->n) ? i0 + JAR_STREAM_CHUNK : a->n;
+  size_t i;
+
+  for (i=i0; i<i1; ++i) {
+    a->a[i] = 0.0f;
+    a->b[i] = 1.0f;
+    a->c[i] = 2.0f;
+  }
+}
+
+static void jar_stream_task( void* arg, const int t ) {
+  JarPeakArg* a = (JarPeakArg*)arg;
+  const size_t i0 = (size_t)t*JAR_STREAM_CHUNK;
+  const size_t i1 = (i0 + JAR_STREAM_CHUNK < a->n) ? i0 + JAR_STREAM_CHUNK : a->n;
+  float* x = a->a;
+  const float* y = a->b;
+  const float* z = a->c;
+  size_t i;
+
+  for (i=i0; i<i1; ++i) {
+    x[i] = y[i] + 3.0f*z[i];
+  }
+}
+
+static void jar_stream_call( void* arg ) {
+  JarPeakArg* a = (JarPeakArg*)arg;
+  jar_parallel_for_static( a->ntasks, jar_stream_task, a );
+}
+
+double jar_perf_stream( const size_t nbytes ) {
+/* STREAM triad a = b + s*c, bytes per second counting three arrays per pass */
+  JarPeakArg a;
+  TimingJAR t;
+
+  a.n = nbytes/sizeof(float);
+  a.ntasks = (int)((a.n + JAR_STREAM_CHUNK - 1)/JAR_STREAM_CHUNK);
+  a.a = (float*) jar_malloc_huge( a.n*sizeof(float) );
+  a.b = (float*) jar_malloc_huge( a.n*sizeof(float) );
+  a.c = (float*) jar_malloc_huge( a.n*sizeof(float) );
+  if (a.a == NULL || a.b == NULL || a.c == NULL) {
+    jar_free( a.c );
+    jar_free( a.b );
+    jar_free( a.a );
+    return 0.0;
+  }
+  jar_parallel_for_static( a.ntasks, jar_stream_init_task, &a );
+  jar_timer_measure( jar_stream_call, &a, 0.2, &t );
+  jar_free( a.c );
+  jar_free( a.b );
+  jar_free( a.a );
+  return 3.0*(double)a.n*sizeof(float)/t.min;
+}
@@ -0,0 +1,86 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Hardware performance counters (Linux perf_event_open) and machine ceilings for
+ *  roofline analysis of the JAR kernels.
+ *
+ *  PerfJAR holds a list of events: by default cycles, instructions, L1D read misses,
+ *  last level cache references and misses, branch misses, and the software events 
+ *  task-clock and page-faults. Further events, e.g. L2 misses or uops per port, are model
+ *  specific and are added as raw events with jar_perf_add( p, "name=rUUEE" ) (umask UU, 
+ *  event EE in hex as in perf's rNNNN syntax; e.g. l2_miss=r3f24 and port0=r01a1 on 
+ *  Skylake). jar_perf_open attaches the events to every thread of the process that 
+ *  exists at that time, the thread pool included, so jar_perf_start / jar_perf_stop
+ *  count the work of all threads between them; counts are scaled for multiplexing. 
+ *  Events the kernel or the hardware does not provide (no PMU in a VM, 
+ *  perf_event_paranoid) are marked unavailable and the others still count.
+ *
+ *  jar_perf_peak_jar and jar_perf_peak_fp32 measure the compute ceilings on all threads
+ *  of the default pool: a JAR GEMM that stays in L1 (JAR operations per second, one 
+ *  multiply-add being two) and an FP32 FMA loop on registers (flops per second). 
+ *  jar_perf_stream measures the STREAM triad bandwidth in bytes per second over arrays
+ *  of nbytes each.
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_PERF
+
+#define JAR_PERF
+#include <stdint.h>
+#include <stddef.h>
+
+#define JAR_PERF_MAX_EVENTS  16
+#define JAR_PERF_NAME_LEN    24
+
+typedef struct{
+   int        nevents;
+   char       name[JAR_PERF_MAX_EVENTS][JAR_PERF_NAME_LEN];
+   uint32_t   type[JAR_PERF_MAX_EVENTS];
+   uint64_t   config[JAR_PERF_MAX_EVENTS];
+   int        avail[JAR_PERF_MAX_EVENTS];
+   double     count[JAR_PERF_MAX_EVENTS];   /* of the last jar_perf_start / jar_perf_stop */
+   int        nthreads;
+   int*       fd;                           /* nthreads x nevents */
+} PerfJAR;
+
+void jar_perf_init( PerfJAR* p );
+int jar_perf_add( PerfJAR* p, const char* spec );
+int jar_perf_open( PerfJAR* p );
+void jar_perf_start( PerfJAR* p );
+void jar_perf_stop( PerfJAR* p );
+int jar_perf_find( const PerfJAR* p, const char* name );
+void jar_perf_close( PerfJAR* p );
+double jar_perf_peak_jar( );
+double jar_perf_peak_fp32( );
+double jar_perf_stream( const size_t nbytes );
+
+#endif
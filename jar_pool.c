@@ -0,0 +1,436 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <assert.h>
+#include "jar_pool.h"
+
+/* task range [lo, hi) of one participant, lo in the low 32 bits, on its own cache line */
+typedef struct{
+   uint64_t       r;
+   char           pad[64 - sizeof(uint64_t)];
+} JarRange;
+
+struct PoolJAR{
+   int             nworkers;
+   int             nslots;        /* workers, submitter, helpers */
+   int             spin;
+   pthread_t*      threads;
+   JarRange*       range;
+   int*            helper;        /* helper slots in use */
+   pthread_mutex_t submit;        /* one loop at a time */
+   pthread_mutex_t lock;
+   pthread_cond_t  wake;
+   pthread_cond_t  done;
+   /* current loop */
+   TaskJAR         fn;
+   void*           arg;
+   int             active;
+   int             steal;         /* tasks of the current loop may be stolen */
+   int             pending;
+   int             nbusy;
+   unsigned long   gen;
+   unsigned long   detach;
+   int             nattached;
+   int             stop;
+};
+
+typedef struct{
+   PoolJAR*        pool;
+   int             slot;
+} JarWorkerArg;
+
+static __thread int jar_pool_in_task = 0;
+
+static PoolJAR*        jar_pool_dflt = NULL;
+static pthread_once_t  jar_pool_once = PTHREAD_ONCE_INIT;
+
+static inline uint64_t jar_range( const uint32_t lo, const uint32_t hi ) {
+  return (uint64_t)lo | ((uint64_t)hi << 32);
+}
+
+static inline void jar_pool_pause( ) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#endif
+}
+
+static int jar_pool_pop( PoolJAR* pool, const int slot, int* task ) {
+/* takes the first task of the own range */
+  uint64_t r = __atomic_load_n( &pool->range[slot].r, __ATOMIC_ACQUIRE );
+
+  while ((uint32_t)r < (uint32_t)(r >> 32)) {
+    if (__atomic_compare_exchange_n( &pool->range[slot].r, &r, r+1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE )) {
+      *task = (int)(uint32_t)r;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static int jar_pool_steal( PoolJAR* pool, const int slot ) {
+/* moves the back half of the range of another participant to the own (empty) range */
+  int v, i;
+
+  for (i=1; i<pool->nslots; ++i) {
+    v = (slot + i) % pool->nslots;
+    uint64_t r = __atomic_load_n( &pool->range[v].r, __ATOMIC_ACQUIRE );
+    while ((uint32_t)r < (uint32_t)(r >> 32)) {
+      const uint32_t lo = (uint32_t)r, hi = (uint32_t)(r >> 32);
+      const uint32_t mid = hi - (hi - lo + 1)/2;
+      if (__atomic_compare_exchange_n( &pool->range[v].r, &r, jar_range( lo, mid ), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE )) {
+        __atomic_store_n( &pool->range[slot].r, jar_range( mid, hi ), __ATOMIC_RELEASE );
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+static int jar_pool_participate( PoolJAR* pool, const int slot ) {
+/* runs tasks of the current loop until there is nothing left to take or steal */
+  const int prev = jar_pool_in_task;
+  int task, n = 0;
+
+  __atomic_add_fetch( &pool->nbusy, 1, __ATOMIC_SEQ_CST );
+  if (__atomic_load_n( &pool->active, __ATOMIC_SEQ_CST )) {
+    TaskJAR fn = pool->fn;
+    void*   arg = pool->arg;
+    const int steal = pool->steal;
+    jar_pool_in_task = 1;
+    do {
+      while (jar_pool_pop( pool, slot, &task )) {
+        fn( arg, task );
+        ++n;
+        if (__atomic_sub_fetch( &pool->pending, 1, __ATOMIC_ACQ_REL ) == 0) {
+          pthread_mutex_lock( &pool->lock );
+          pthread_cond_broadcast( &pool->done );
+          pthread_mutex_unlock( &pool->lock );
+        }
+      }
+    } while (steal && jar_pool_steal( pool, slot ));
+    jar_pool_in_task = prev;
+  }
+  __atomic_sub_fetch( &pool->nbusy, 1, __ATOMIC_SEQ_CST );
+  return n;
+}
+
+static int jar_pool_wait_work( PoolJAR* pool, unsigned long* gen, const unsigned long* detach ) {
+/* 
+spins, then parks until a new loop is published (returns 1), the pool stops or, for an
+attached thread, jar_pool_detach is called (returns 0)
+*/
+  int i;
+
+  for (i=0; i<pool->spin; ++i) {
+    if (__atomic_load_n( &pool->gen, __ATOMIC_ACQUIRE ) != *gen || __atomic_load_n( &pool->stop, __ATOMIC_ACQUIRE ) ||
+        (detach != NULL && __atomic_load_n( &pool->detach, __ATOMIC_ACQUIRE ) != *detach)) {
+      break;
+    }
+    jar_pool_pause();
+  }
+  pthread_mutex_lock( &pool->lock );
+  while (pool->gen == *gen && !pool->stop && (detach == NULL || pool->detach == *detach)) {
+    pthread_cond_wait( &pool->wake, &pool->lock );
+  }
+  i = (pool->gen != *gen && !pool->stop && (detach == NULL || pool->detach == *detach));
+  *gen = pool->gen;
+  pthread_mutex_unlock( &pool->lock );
+  return i;
+}
+
+static void* jar_pool_worker( void* p ) {
+  JarWorkerArg* w = (JarWorkerArg*)p;
+  PoolJAR* pool = w->pool;
+  const int slot = w->slot;
+  unsigned long gen = 0;
+
+  free( w );
+  while (jar_pool_wait_work( pool, &gen, NULL )) {
+    jar_pool_participate( pool, slot );
+  }
+  return NULL;
+}
+
+PoolJAR* jar_pool_create( const int nworkers, const int spin ) {
+/* a pool with nworkers threads besides the submitting thread, spin polls before parking */
+  PoolJAR* pool = (PoolJAR*) calloc( 1, sizeof(PoolJAR) );
+  int t;
+
+  assert (nworkers >= 0);
+
+  pool->nworkers = nworkers;
+  pool->nslots   = nworkers + 1 + JAR_POOL_MAX_HELPERS;
+  pool->spin     = (spin > 0) ? spin : 0;
+  pool->threads  = (pthread_t*) malloc( (nworkers > 0 ? nworkers : 1)*sizeof(pthread_t) );
+  pool->helper   = (int*) calloc( JAR_POOL_MAX_HELPERS, sizeof(int) );
+  if (posix_memalign( (void**)&pool->range, 64, pool->nslots*sizeof(JarRange) ) != 0) {
+    free( pool->helper ); free( pool->threads ); free( pool );
+    return NULL;
+  }
+  for (t=0; t<pool->nslots; ++t) {
+    pool->range[t].r = 0;
+  }
+  pthread_mutex_init( &pool->submit, NULL );
+  pthread_mutex_init( &pool->lock, NULL );
+  pthread_cond_init( &pool->wake, NULL );
+  pthread_cond_init( &pool->done, NULL );
+
+  for (t=0; t<nworkers; ++t) {
+    JarWorkerArg* w = (JarWorkerArg*) malloc( sizeof(JarWorkerArg) );
+    w->pool = pool;
+    w->slot = t;
+    if (pthread_create( pool->threads+t, NULL, jar_pool_worker, w ) != 0) {
+      free( w );
+      pool->nworkers = t;
+      break;
+    }
+  }
+
+  return pool;
+}
+
+void jar_pool_destroy( PoolJAR* pool ) {
+/* stops and joins the workers; attached threads return from jar_pool_attach */
+  int t;
+
+  if (pool == NULL) {
+    return;
+  }
+  pthread_mutex_lock( &pool->lock );
+  pool->stop = 1;
+  pthread_cond_broadcast( &pool->wake );
+  pthread_mutex_unlock( &pool->lock );
+  for (t=0; t<pool->nworkers; ++t) {
+    pthread_join( pool->threads[t], NULL );
+  }
+  pthread_cond_destroy( &pool->done );
+  pthread_cond_destroy( &pool->wake );
+  pthread_mutex_destroy( &pool->lock );
+  pthread_mutex_destroy( &pool->submit );
+  free( pool->range );
+  free( pool->helper );
+  free( pool->threads );
+  free( pool );
+}
+
+int jar_pool_size( const PoolJAR* pool ) {
+/* the number of threads of the pool including the submitting thread */
+  return pool->nworkers + 1;
+}
+
+static void jar_pool_run( PoolJAR* pool, const int ntasks, TaskJAR fn, void* arg, const int steal ) {
+/* runs fn( arg, task ) for task = 0, ..., ntasks-1 on the pool and returns when all are done */
+  const int slot = (pool != NULL) ? pool->nworkers : 0;
+  int t, i;
+
+  if (ntasks <= 0) {
+    return;
+  }
+  if (pool == NULL || jar_pool_in_task || ntasks == 1 ||
+      (pool->nworkers == 0 && __atomic_load_n( &pool->nattached, __ATOMIC_ACQUIRE ) == 0)) {
+    for (t=0; t<ntasks; ++t) {
+      fn( arg, t );
+    }
+    return;
+  }
+
+  pthread_mutex_lock( &pool->submit );
+
+  /* split the tasks over the workers and this thread, helpers start empty and steal */
+  pool->fn      = fn;
+  pool->arg     = arg;
+  pool->steal   = steal;
+  pool->pending = ntasks;
+  for (i=0; i<pool->nslots; ++i) {
+    const int p = pool->nworkers + 1;
+    const uint32_t lo = (i < p) ? (uint32_t)(((long long)ntasks*i)/p) : 0;
+    const uint32_t hi = (i < p) ? (uint32_t)(((long long)ntasks*(i+1))/p) : 0;
+    __atomic_store_n( &pool->range[i].r, jar_range( lo, hi ), __ATOMIC_RELAXED );
+  }
+  __atomic_store_n( &pool->active, 1, __ATOMIC_SEQ_CST );
+
+  pthread_mutex_lock( &pool->lock );
+  __atomic_add_fetch( &pool->gen, 1, __ATOMIC_SEQ_CST );
+  pthread_cond_broadcast( &pool->wake );
+  pthread_mutex_unlock( &pool->lock );
+
+  jar_pool_participate( pool, slot );
+
+  /* wait for the tasks taken by others */
+  for (i=0; i<pool->spin && __atomic_load_n( &pool->pending, __ATOMIC_ACQUIRE ) > 0; ++i) {
+    jar_pool_pause();
+  }
+  pthread_mutex_lock( &pool->lock );
+  while (__atomic_load_n( &pool->pending, __ATOMIC_ACQUIRE ) > 0) {
+    pthread_cond_wait( &pool->done, &pool->lock );
+  }
+  pthread_mutex_unlock( &pool->lock );
+
+  /* nobody may still look at this loop when the next one is set up */
+  __atomic_store_n( &pool->active, 0, __ATOMIC_SEQ_CST );
+  while (__atomic_load_n( &pool->nbusy, __ATOMIC_SEQ_CST ) > 0) {
+    sched_yield();
+  }
+
+  pthread_mutex_unlock( &pool->submit );
+}
+
+void jar_pool_parallel_for( PoolJAR* pool, const int ntasks, TaskJAR fn, void* arg ) {
+/* runs fn( arg, task ) for task = 0, ..., ntasks-1 on the pool and returns when all are done */
+  jar_pool_run( pool, ntasks, fn, arg, 1 );
+}
+
+void jar_pool_parallel_for_static( PoolJAR* pool, const int ntasks, TaskJAR fn, void* arg ) {
+/* 
+jar_pool_parallel_for without stealing: worker t runs the tasks [ntasks*t/P, ntasks*(t+1)/P)
+and the submitting thread those of t = nworkers, P = jar_pool_size( pool )
+*/
+  jar_pool_run( pool, ntasks, fn, arg, 0 );
+}
+
+int jar_pool_pin( PoolJAR* pool, const int* cpus, const int ncpus ) {
+/* pins worker t to cpu cpus[t % ncpus], returns the number of workers pinned */
+  cpu_set_t set;
+  int t, n = 0;
+
+  if (pool == NULL || ncpus <= 0) {
+    return 0;
+  }
+  for (t=0; t<pool->nworkers; ++t) {
+    CPU_ZERO( &set );
+    CPU_SET( cpus[t % ncpus], &set );
+    n += (pthread_setaffinity_np( pool->threads[t], sizeof(set), &set ) == 0);
+  }
+  return n;
+}
+
+static int jar_pool_helper_slot( PoolJAR* pool ) {
+/* reserves a helper slot, returns -1 if all are in use */
+  int h;
+
+  for (h=0; h<JAR_POOL_MAX_HELPERS; ++h) {
+    int expected = 0;
+    if (__atomic_compare_exchange_n( pool->helper+h, &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE )) {
+      return h;
+    }
+  }
+  return -1;
+}
+
+int jar_pool_help( PoolJAR* pool ) {
+/* runs tasks of the current loop from an external thread, returns the number of tasks run */
+  const int h = jar_pool_helper_slot( pool );
+  int n = 0;
+
+  if (h >= 0) {
+    n = jar_pool_participate( pool, pool->nworkers + 1 + h );
+    __atomic_store_n( pool->helper+h, 0, __ATOMIC_RELEASE );
+  }
+  return n;
+}
+
+void jar_pool_attach( PoolJAR* pool ) {
+/* the calling thread serves as a worker of the pool until jar_pool_detach or jar_pool_destroy */
+  const int h = jar_pool_helper_slot( pool );
+  unsigned long gen, detach;
+
+  if (h < 0) {
+    return;
+  }
+  /* counted as attached only once a later jar_pool_detach is sure to be seen */
+  pthread_mutex_lock( &pool->lock );
+  gen    = pool->gen;
+  detach = pool->detach;
+  pthread_mutex_unlock( &pool->lock );
+  __atomic_add_fetch( &pool->nattached, 1, __ATOMIC_ACQ_REL );
+
+  /* a loop that is already running */
+  jar_pool_participate( pool, pool->nworkers + 1 + h );
+  while (jar_pool_wait_work( pool, &gen, &detach )) {
+    jar_pool_participate( pool, pool->nworkers + 1 + h );
+  }
+  __atomic_sub_fetch( &pool->nattached, 1, __ATOMIC_ACQ_REL );
+  __atomic_store_n( pool->helper+h, 0, __ATOMIC_RELEASE );
+}
+
+int jar_pool_attached( const PoolJAR* pool ) {
+/* the number of threads in jar_pool_attach that return on the next jar_pool_detach */
+  return __atomic_load_n( &pool->nattached, __ATOMIC_ACQUIRE );
+}
+
+void jar_pool_detach( PoolJAR* pool ) {
+/* makes all threads in jar_pool_attach return, threads that attach later are not affected */
+  pthread_mutex_lock( &pool->lock );
+  pool->detach++;
+  pthread_cond_broadcast( &pool->wake );
+  pthread_mutex_unlock( &pool->lock );
+}
+
+static void jar_pool_default_init( ) {
+  const char* env = getenv( "JAR_NUM_THREADS" );
+  int n = (env != NULL) ? atoi( env ) : (int)sysconf( _SC_NPROCESSORS_ONLN );
+
+  jar_pool_dflt = jar_pool_create( (n > 1) ? n-1 : 0, JAR_POOL_SPIN );
+}
+
+PoolJAR* jar_pool_default( ) {
+  pthread_once( &jar_pool_once, jar_pool_default_init );
+  return __atomic_load_n( &jar_pool_dflt, __ATOMIC_ACQUIRE );
+}
+
+void jar_pool_set_default( PoolJAR* pool ) {
+/* makes pool the default pool, the previous one is not destroyed */
+  pthread_once( &jar_pool_once, jar_pool_default_init );
+  __atomic_store_n( &jar_pool_dflt, pool, __ATOMIC_RELEASE );
+}
+
+int jar_pool_serial( const int serial ) {
+/* loops submitted from the calling thread run serially while serial is set, returns the previous setting */
+  const int prev = jar_pool_in_task;
+
+  jar_pool_in_task = serial;
+  return prev;
+}
+
+void jar_parallel_for( const int ntasks, TaskJAR fn, void* arg ) {
+  jar_pool_parallel_for( jar_pool_default(), ntasks, fn, arg );
+}
+
+void jar_parallel_for_static( const int ntasks, TaskJAR fn, void* arg ) {
+  jar_pool_parallel_for_static( jar_pool_default(), ntasks, fn, arg );
+}
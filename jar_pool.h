@@ -0,0 +1,92 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Work-stealing thread pool that runs the parallel loops of the JAR kernels, 
+ *  independent of OpenMP.
+ *
+ *  A parallel loop of ntasks tasks is split into one contiguous range of task indices
+ *  per participant (the workers and the submitting thread). A participant takes tasks
+ *  from the front of its own range; when it runs dry it steals the back half of the
+ *  range of another participant. Ranges are single 64-bit words updated with CAS, so
+ *  neither taking nor stealing locks.
+ *
+ *  Idle workers spin for a bounded number of polls and then park on a condition 
+ *  variable, so the pool does not burn cores that the host application needs. The 
+ *  submitter waits for the end of a loop in the same way. Threads of the application
+ *  can join in: jar_pool_help runs tasks of the current loop, if any, and returns, and 
+ *  jar_pool_attach serves as a worker until jar_pool_detach is called. A thread that
+ *  attaches after jar_pool_detach keeps serving, jar_pool_attached tells when it is in.
+ *
+ *  jar_parallel_for runs a loop on the default pool, which is created on first use with
+ *  JAR_NUM_THREADS (environment) threads, the number of online cpus by default; 
+ *  jar_pool_set_default replaces it, e.g. by a pool without workers for serial runs. 
+ *  Loops submitted from inside a task run serially on the calling thread, as do all loops
+ *  of a thread after jar_pool_serial( 1 ), and only one loop runs on a pool at a time; 
+ *  concurrent submitters are serialized.
+ *
+ *  jar_pool_parallel_for_static runs a loop without stealing, so every task runs on the
+ *  participant whose range it starts in, e.g. for first touch of memory by the thread that
+ *  later reads it. jar_pool_pin pins the workers to given cpus (the submitting thread is 
+ *  left alone).
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_POOL
+
+#define JAR_POOL
+
+/* polls before an idle thread parks */
+#define JAR_POOL_SPIN         4000
+/* external threads that can join a loop at the same time */
+#define JAR_POOL_MAX_HELPERS  16
+
+typedef struct PoolJAR PoolJAR;
+
+typedef void (*TaskJAR)( void* arg, const int task );
+
+PoolJAR* jar_pool_create( const int nworkers, const int spin );
+void jar_pool_destroy( PoolJAR* pool );
+int jar_pool_size( const PoolJAR* pool );
+void jar_pool_parallel_for( PoolJAR* pool, const int ntasks, TaskJAR fn, void* arg );
+void jar_pool_parallel_for_static( PoolJAR* pool, const int ntasks, TaskJAR fn, void* arg );
+int jar_pool_pin( PoolJAR* pool, const int* cpus, const int ncpus );
+int jar_pool_help( PoolJAR* pool );
+void jar_pool_attach( PoolJAR* pool );
+int jar_pool_attached( const PoolJAR* pool );
+void jar_pool_detach( PoolJAR* pool );
+PoolJAR* jar_pool_default( );
+void jar_pool_set_default( PoolJAR* pool );
+int jar_pool_serial( const int serial );
+void jar_parallel_for( const int ntasks, TaskJAR fn, void* arg );
+void jar_parallel_for_static( const int ntasks, TaskJAR fn, void* arg );
+
+#endif
@@ -0,0 +1,603 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "jar_rnn.h"
+#include "jar_mem.h"
+
+void jar_rnn_pack_weights( const int G, const int I, const int H, const UniJAR** Wx, const UniJAR** Wh, UniJAR* W ) {
+/*
+Concatenates the G per-gate matrices Wx[g] (H x I) and Wh[g] (H x H), all col-major,
+into the (G*H) x (I+H) col-major matrix W = [ Wx[0] Wh[0]; ... ; Wx[G-1] Wh[G-1] ].
+*/
+  int g, k, m;
+  const int ld = G*H;
+
+  assert (G > 0);
+  assert (I >= 0);
+  assert (H > 0);
+
+  for (k=0; k<I; ++k) {
+    for (g=0; g<G; ++g) {
+      for (m=0; m<H; ++m) {
+        W[(k*ld)+(g*H)+m] = Wx[g][(k*H)+m];
+      }
+    }
+  }
+  for (k=0; k<H; ++k) {
+    for (g=0; g<G; ++g) {
+      for (m=0; m<H; ++m) {
+        W[((I+k)*ld)+(g*H)+m] = Wh[g][(k*H)+m];
+      }
+    }
+  }
+}
+
+UniJAR sigmoid_LogPS80( UniJAR x ) {
+/* sigmoid of a LogPS80 input, returned as LogPS80 */
+  return sigmoid_PS8_tbl[ LogPS80_2_PS8( x ) ];
+}
+
+UniJAR tanh_LogPS80( UniJAR x ) {
+/* tanh of a LogPS80 input, returned as LogPS80 */
+  return tanh_PS8_tbl[ LogPS80_2_PS8( x ) ];
+}
+
+#if defined(__AVX512F__)
+__m512i sigmoid_LogPS80_avx512( const __m512i x ) {
+  return _mm512_i32gather_epi32( LogPS80_2_PS8_avx512( x ), sigmoid_PS8_tbl, 4 );
+}
+
+__m512i tanh_LogPS80_avx512( const __m512i x ) {
+  return _mm512_i32gather_epi32( LogPS80_2_PS8_avx512( x ), tanh_PS8_tbl, 4 );
+}
+#endif
+
+static void jar_lstm_step( const int I, const int H, const UniJAR* W, const UniJAR* bias, UniJAR* xh, UniJAR* c, UniJAR* acc ) {
+/*
+One LSTM step on xh = [x_t; h]. The gate pre-activations are accumulated in acc (4*H) 
+starting from the bias, the new h overwrites xh[I..I+H) and c is updated in place.
+    c = f*c + i*g  (two JAR products accumulated in the linear domain)
+    h = o*tanh(c)  (one sum2_LogPS80 rounded to PS80)
+*/
+  UniJAR* h = xh + I;
+  UniJAR  zi, zf, zg, zo, a;
+  int     j;
+
+  for (j=0; j<4*H; ++j) {
+    acc[j] = LogPS80_2_LinFP32( bias[j] );
+  }
+  jar_matvecacc( 4*H, I+H, W, 4*H, xh, acc );
+
+  for (j=0; j<H; ++j) {
+    zi = sigmoid_LogPS80( LinFP32_2_LogPS80( acc[j] ) );
+    zf = sigmoid_LogPS80( LinFP32_2_LogPS80( acc[H+j] ) );
+    zg = tanh_LogPS80( LinFP32_2_LogPS80( acc[(2*H)+j] ) );
+    zo = sigmoid_LogPS80( LinFP32_2_LogPS80( acc[(3*H)+j] ) );
+    a.I = JAR_ZERO;
+    jar_fma( &zf, c+j, &a );
+    jar_fma( &zi, &zg, &a );
+    c[j] = LinFP32_2_LogPS80( a );
+    h[j] = rnd_2_PS80( sum2_LogPS80( zo, tanh_LogPS80( c[j] ) ) );
+  }
+}
+
+static void jar_lstm_step_avx512( const int I, const int H, const UniJAR* W, const UniJAR* bias, UniJAR* xh, UniJAR* c, UniJAR* acc ) {
+/* vectorized version of jar_lstm_step */
+  UniJAR* h = xh + I;
+  UniJAR  zi, zf, zg, zo, a;
+  int     j;
+
+  j = 0;
+#if defined(__AVX512F__)
+  for ( ; j<((4*H)/16)*16; j+=16) {
+    _mm512_storeu_epi32( acc+j, LogPS80_2_LinFP32_avx512( _mm512_loadu_epi32( bias+j ) ) );
+  }
+#endif
+  for ( ; j<4*H; ++j) {
+    acc[j] = LogPS80_2_LinFP32( bias[j] );
+  }
+  jar_matvecacc_avx512( 4*H, I+H, W, 4*H, xh, acc );
+
+  j = 0;
+#if defined(__AVX512F__)
+  for ( ; j<(H/16)*16; j+=16) {
+    __m512i vi = sigmoid_LogPS80_avx512( LinFP32_2_LogPS80_avx512( _mm512_loadu_epi32( acc+j ) ) );
+    __m512i vf = sigmoid_LogPS80_avx512( LinFP32_2_LogPS80_avx512( _mm512_loadu_epi32( acc+H+j ) ) );
+    __m512i vg = tanh_LogPS80_avx512( LinFP32_2_LogPS80_avx512( _mm512_loadu_epi32( acc+(2*H)+j ) ) );
+    __m512i vo = sigmoid_LogPS80_avx512( LinFP32_2_LogPS80_avx512( _mm512_loadu_epi32( acc+(3*H)+j ) ) );
+    __m512i va = _mm512_set1_epi32( JAR_ZERO );
+    __m512i vc;
+    va = jar_fma_avx512( vf, _mm512_loadu_epi32( c+j ), va );
+    va = jar_fma_avx512( vi, vg, va );
+    vc = LinFP32_2_LogPS80_avx512( va );
+    _mm512_storeu_epi32( c+j, vc );
+    _mm512_storeu_epi32( h+j, rnd_2_PS80_avx512( sum2_LogPS80_avx512( vo, tanh_LogPS80_avx512( vc ) ) ) );
+  }
+#endif
+  for ( ; j<H; ++j) {
+    zi = sigmoid_LogPS80( LinFP32_2_LogPS80( acc[j] ) );
+    zf = sigmoid_LogPS80( LinFP32_2_LogPS80( acc[H+j] ) );
+    zg = tanh_LogPS80( LinFP32_2_LogPS80( acc[(2*H)+j] ) );
+    zo = sigmoid_LogPS80( LinFP32_2_LogPS80( acc[(3*H)+j] ) );
+    a.I = JAR_ZERO;
+    jar_fma( &zf, c+j, &a );
+    jar_fma( &zi, &zg, &a );
+    c[j] = LinFP32_2_LogPS80( a );
+    h[j] = rnd_2_PS80( sum2_LogPS80( zo, tanh_LogPS80( c[j] ) ) );
+  }
+}
+
+static void jar_gru_step( const int I, const int H, const UniJAR* W, const UniJAR* bias, UniJAR* xh, UniJAR* acc ) {
+/*
+One GRU step on xh = [x_t; h]. The accumulators acc (4*H) hold r, z, n_x and n_h. The rows 
+of r and z see all of [x_t; h]; the rows of n are split into the x part and the h part so 
+that r can scale the latter. W is still swept only once. The new h overwrites xh[I..I+H).
+    n = tanh( n_x + r*n_h )
+    h = (1-z)*n + z*h      (1-z is sigmoid of the negated pre-activation)
+*/
+  UniJAR* h = xh + I;
+  UniJAR  zr, zu, zuc, nh, pre, zn, a;
+  int     j;
+
+  for (j=0; j<4*H; ++j) {
+    acc[j] = LogPS80_2_LinFP32( bias[j] );
+  }
+  jar_matvecacc( 2*H, I+H, W, 3*H, xh, acc );
+  jar_matvecacc( H, I, W+(2*H), 3*H, xh, acc+(2*H) );
+  jar_matvecacc( H, H, W+(I*3*H)+(2*H), 3*H, h, acc+(3*H) );
+
+  for (j=0; j<H; ++j) {
+    zr  = sigmoid_LogPS80( LinFP32_2_LogPS80( acc[j] ) );
+    zu  = LinFP32_2_LogPS80( acc[H+j] );
+    zuc = zu; zuc.I ^= SIGN_MASK;
+    zu  = sigmoid_LogPS80( zu );
+    zuc = sigmoid_LogPS80( zuc );
+    nh  = LinFP32_2_LogPS80( acc[(3*H)+j] );
+    pre = acc[(2*H)+j];
+    jar_fma( &zr, &nh, &pre );
+    zn  = tanh_LogPS80( LinFP32_2_LogPS80( pre ) );
+    a.I = JAR_ZERO;
+    jar_fma( &zuc, &zn, &a );
+    jar_fma( &zu, h+j, &a );
+    h[j] = LinFP32_2_LogPS80( a );
+  }
+}
+
+static void jar_gru_step_avx512( const int I, const int H, const UniJAR* W, const UniJAR* bias, UniJAR* xh, UniJAR* acc ) {
+/* vectorized version of jar_gru_step */
+  UniJAR* h = xh + I;
+  UniJAR  zr, zu, zuc, nh, pre, zn, a;
+  int     j;
+
+  j = 0;
+#if defined(__AVX512F__)
+  for ( ; j<((4*H)/16)*16; j+=16) {
+    _mm512_storeu_epi32( acc+j, LogPS80_2_LinFP32_avx512( _mm512_loadu_epi32( bias+j ) ) );
+  }
+#endif
+  for ( ; j<4*H; ++j) {
+    acc[j] = LogPS80_2_LinFP32( bias[j] );
+  }
+  jar_matvecacc_avx512( 2*H, I+H, W, 3*H, xh, acc );
+  jar_matvecacc_avx512( H, I, W+(2*H), 3*H, xh, acc+(2*H) );
+  jar_matvecacc_avx512( H, H, W+(I*3*H)+(2*H), 3*H, h, acc+(3*H) );
+
+  j = 0;
+#if defined(__AVX512F__)
+  for ( ; j<(H/16)*16; j+=16) {
+    __m512i vr  = sigmoid_LogPS80_avx512( LinFP32_2_LogPS80_avx512( _mm512_loadu_epi32( acc+j ) ) );
+    __m512i vu  = LinFP32_2_LogPS80_avx512( _mm512_loadu_epi32( acc+H+j ) );
+    __m512i vuc = sigmoid_LogPS80_avx512( _mm512_xor_epi32( vu, _mm512_set1_epi32( SIGN_MASK ) ) );
+    __m512i vnh = LinFP32_2_LogPS80_avx512( _mm512_loadu_epi32( acc+(3*H)+j ) );
+    __m512i vpre = jar_fma_avx512( vr, vnh, _mm512_loadu_epi32( acc+(2*H)+j ) );
+    __m512i vn  = tanh_LogPS80_avx512( LinFP32_2_LogPS80_avx512( vpre ) );
+    __m512i va  = _mm512_set1_epi32( JAR_ZERO );
+    vu = sigmoid_LogPS80_avx512( vu );
+    va = jar_fma_avx512( vuc, vn, va );
+    va = jar_fma_avx512( vu, _mm512_loadu_epi32( h+j ), va );
+    _mm512_storeu_epi32( h+j, LinFP32_2_LogPS80_avx512( va ) );
+  }
+#endif
+  for ( ; j<H; ++j) {
+    zr  = sigmoid_LogPS80( LinFP32_2_LogPS80( acc[j] ) );
+    zu  = LinFP32_2_LogPS80( acc[H+j] );
+    zuc = zu; zuc.I ^= SIGN_MASK;
+    zu  = sigmoid_LogPS80( zu );
+    zuc = sigmoid_LogPS80( zuc );
+    nh  = LinFP32_2_LogPS80( acc[(3*H)+j] );
+    pre = acc[(2*H)+j];
+    jar_fma( &zr, &nh, &pre );
+    zn  = tanh_LogPS80( LinFP32_2_LogPS80( pre ) );
+    a.I = JAR_ZERO;
+    jar_fma( &zuc, &zn, &a );
+    jar_fma( &zu, h+j, &a );
+    h[j] = LinFP32_2_LogPS80( a );
+  }
+}
+
+void jar_lstm_cell( const int I, const int H, const UniJAR* W, const UniJAR* bias, const UniJAR* x, UniJAR* h, UniJAR* c, UniJAR* work ) {
+/* 
+one LSTM step: h and c are updated in place. work must hold (I+H) + 4*H UniJAR.
+*/
+  UniJAR* xh  = work;
+  UniJAR* acc = work + I + H;
+  int     k;
+
+  assert (I >= 0);
+  assert (H > 0);
+
+  for (k=0; k<I; ++k) xh[k] = x[k];
+  for (k=0; k<H; ++k) xh[I+k] = h[k];
+  jar_lstm_step( I, H, W, bias, xh, c, acc );
+  for (k=0; k<H; ++k) h[k] = xh[I+k];
+}
+
+void jar_lstm_cell_avx512( const int I, const int H, const UniJAR* W, const UniJAR* bias, const UniJAR* x, UniJAR* h, UniJAR* c, UniJAR* work ) {
+/* 
+one LSTM step: h and c are updated in place. work must hold (I+H) + 4*H UniJAR.
+*/
+  UniJAR* xh  = work;
+  UniJAR* acc = work + I + H;
+  int     k;
+
+  assert (I >= 0);
+  assert (H > 0);
+
+  for (k=0; k<I; ++k) xh[k] = x[k];
+  for (k=0; k<H; ++k) xh[I+k] = h[k];
+  jar_lstm_step_avx512( I, H, W, bias, xh, c, acc );
+  for (k=0; k<H; ++k) h[k] = xh[I+k];
+}
+
+void jar_lstm_seq( const int I, const int H, const int T, const UniJAR* W, const UniJAR* bias, const UniJAR* X, UniJAR* h, UniJAR* c, UniJAR* Y ) {
+/*
+runs T LSTM steps over the columns of X (I x T, col-major). h and c hold the initial state
+on entry and the final state on exit. If Y is not NULL, the hidden state of every step is
+written to the columns of Y (H x T). The hidden state lives in the [x_t; h] buffer for the
+whole sequence and is never copied between steps.
+*/
+  ArenaJAR* ws = jar_workspace();
+  const size_t mark = jar_arena_mark( ws );
+  UniJAR* work = (UniJAR*) jar_arena_alloc( ws, ((I+H)+(4*H))*sizeof(UniJAR) );
+  UniJAR* xh   = work;
+  UniJAR* acc  = work + I + H;
+  int     k, t;
+
+  assert (I >= 0);
+  assert (H > 0);
+  assert (T >= 0);
+
+  for (k=0; k<H; ++k) xh[I+k] = h[k];
+  for (t=0; t<T; ++t) {
+    for (k=0; k<I; ++k) xh[k] = X[(t*I)+k];
+    jar_lstm_step( I, H, W, bias, xh, c, acc );
+    if (Y != NULL) {
+      for (k=0; k<H; ++k) Y[(t*H)+k] = xh[I+k];
+    }
+  }
+  for (k=0; k<H; ++k) h[k] = xh[I+k];
+
+  jar_arena_release( ws, mark );
+}
+
+void jar_lstm_seq_avx512( const int I, const int H, const int T, const UniJAR* W, const UniJAR* bias, const UniJAR* X, UniJAR* h, UniJAR* c, UniJAR* Y ) {
+/* vectorized version of jar_lstm_seq */
+  ArenaJAR* ws = jar_workspace();
+  const size_t mark = jar_arena_mark( ws );
+  UniJAR* work = (UniJAR*) jar_arena_alloc( ws, ((I+H)+(4*H))*sizeof(UniJAR) );
+  UniJAR* xh   = work;
+  UniJAR* acc  = work + I + H;
+  int     k, t;
+
+  assert (I >= 0);
+  assert (H > 0);
+  assert (T >= 0);
+
+  for (k=0; k<H; ++k) xh[I+k] = h[k];
+  for (t=0; t<T; ++t) {
+    for (k=0; k<I; ++k) xh[k] = X[(t*I)+k];
+    jar_lstm_step_avx512( I, H, W, bias, xh, c, acc );
+    if (Y != NULL) {
+      for (k=0; k<H; ++k) Y[(t*H)+k] = xh[I+k];
+    }
+  }
+  for (k=0; k<H; ++k) h[k] = xh[I+k];
+
+  jar_arena_release( ws, mark );
+}
+
+void jar_gru_cell( const int I, const int H, const UniJAR* W, const UniJAR* bias, const UniJAR* x, UniJAR* h, UniJAR* work ) {
+/* 
+one GRU step: h is updated in place. work must hold (I+H) + 4*H UniJAR.
+*/
+  UniJAR* xh  = work;
+  UniJAR* acc = work + I + H;
+  int     k;
+
+  assert (I >= 0);
+  assert (H > 0);
+
+  for (k=0; k<I; ++k) xh[k] = x[k];
+  for (k=0; k<H; ++k) xh[I+k] = h[k];
+  jar_gru_step( I, H, W, bias, xh, acc );
+  for (k=0; k<H; ++k) h[k] = xh[I+k];
+}
+
+void jar_gru_cell_avx512( const int I, const int H, const UniJAR* W, const UniJAR* bias, const UniJAR* x, UniJAR* h, UniJAR* work ) {
+/* 
+one GRU step: h is updated in place. work must hold (I+H) + 4*H UniJAR.
+*/
+  UniJAR* xh  = work;
+  UniJAR* acc = work + I + H;
+  int     k;
+
+  assert (I >= 0);
+  assert (H > 0);
+
+  for (k=0; k<I; ++k) xh[k] = x[k];
+  for (k=0; k<H; ++k) xh[I+k] = h[k];
+  jar_gru_step_avx512( I, H, W, bias, xh, acc );
+  for (k=0; k<H; ++k) h[k] = xh[I+k];
+}
+
+void jar_gru_seq( const int I, const int H, const int T, const UniJAR* W, const UniJAR* bias, const UniJAR* X, UniJAR* h, UniJAR* Y ) {
+/* runs T GRU steps, see jar_lstm_seq */
+  ArenaJAR* ws = jar_workspace();
+  const size_t mark = jar_arena_mark( ws );
+  UniJAR* work = (UniJAR*) jar_arena_alloc( ws, ((I+H)+(4*H))*sizeof(UniJAR) );
+  UniJAR* xh   = work;
+  UniJAR* acc  = work + I + H;
+  int     k, t;
+
+  assert (I >= 0);
+  assert (H > 0);
+  assert (T >= 0);
+
+  for (k=0; k<H; ++k) xh[I+k] = h[k];
+  for (t=0; t<T; ++t) {
+    for (k=0; k<I; ++k) xh[k] = X[(t*I)+k];
+    jar_gru_step( I, H, W, bias, xh, acc );
+    if (Y != NULL) {
+      for (k=0; k<H; ++k) Y[(t*H)+k] = xh[I+k];
+    }
+  }
+  for (k=0; k<H; ++k) h[k] = xh[I+k];
+
+  jar_arena_release( ws, mark );
+}
+
+void jar_gru_seq_avx512( const int I, const int H, const int T, const UniJAR* W, const UniJAR* bias, const UniJAR* X, UniJAR* h, UniJAR* Y ) {
+/* vectorized version of jar_gru_seq */
+  ArenaJAR* ws = jar_workspace();
+  const size_t mark = jar_arena_mark( ws );
+  UniJAR* work = (UniJAR*) jar_arena_alloc( ws, ((I+H)+(4*H))*sizeof(UniJAR) );
+  UniJAR* xh   = work;
+  UniJAR* acc  = work + I + H;
+  int     k, t;
+
+  assert (I >= 0);
+  assert (H > 0);
+  assert (T >= 0);
+
+  for (k=0; k<H; ++k) xh[I+k] = h[k];
+  for (t=0; t<T; ++t) {
+    for (k=0; k<I; ++k) xh[k] = X[(t*I)+k];
+    jar_gru_step_avx512( I, H, W, bias, xh, acc );
+    if (Y != NULL) {
+      for (k=0; k<H; ++k) Y[(t*H)+k] = xh[I+k];
+    }
+  }
+  for (k=0; k<H; ++k) h[k] = xh[I+k];
+
+  jar_arena_release( ws, mark );
+}
+
+static void gen_act_PS8_tbl( char name[], const int use_tanh ) {
+/* Generates and print the table of an activation function over all 256 Posit(8,0) codes */
+/* The accurate value of each code is evaluated in double and rounded to LogPS80.        */
+   int num_entries, num_entries_per_line, num_lines;
+   int i, j, code;
+   UniJAR y;
+   double v;
+
+   num_entries = 256;
+   num_entries_per_line = 4;
+   num_lines = num_entries / num_entries_per_line;
+
+   printf("UniJAR %s[%d] = {\n", name, num_entries);
+
+   for ( i=0; i<num_lines; i++ ){
+       for ( j=0; j<num_entries_per_line; j++ ){
+           code = i*num_entries_per_line + j;
+           v = ((PS8_tbl[code].I & CLEAR_SIGN) == JAR_ZERO) ? 0.0 : (double)LogPS80_2_Lin_val( PS8_tbl[code] );
+           y.F = (float)( use_tanh ? tanh( v ) : 1.0/(1.0 + exp( -v )) );
+           y = LinFP32_2_LogPS80( y );
+           /* now prints out y */
+           if (j < num_entries_per_line-1) {
+               printf("0X%08X,", y.I);
+           }
+           else {
+               if (i < num_lines-1) {
+                   printf("0X%08X,\n",y.I);
+              }
+              else {
+                   printf("0X%08X\n",y.I);
+              }
+           }
+       }
+   } 
+   printf("}\n");
+}
+
+void gen_sigmoid_PS8_tbl( ) {
+   gen_act_PS8_tbl( "sigmoid_PS8_tbl", 0 );
+}
+
+void gen_tanh_PS8_tbl( ) {
+   gen_act_PS8_tbl( "tanh_PS8_tbl", 1 );
+}
+
+UniJAR sigmoid_PS8_tbl[256] = {
+0X3F000000,0X3F000000,0X3F000000,0X3F080000,
+0X3F080000,0X3F080000,0X3F080000,0X3F0C0000,
+0X3F0C0000,0X3F0C0000,0X3F0C0000,0X3F100000,
+0X3F100000,0X3F100000,0X3F100000,0X3F180000,
+0X3F180000,0X3F180000,0X3F180000,0X3F1C0000,
+0X3F1C0000,0X3F1C0000,0X3F1C0000,0X3F1C0000,
+0X3F200000,0X3F200000,0X3F200000,0X3F200000,
+0X3F240000,0X3F240000,0X3F240000,0X3F280000,
+0X3F280000,0X3F280000,0X3F280000,0X3F280000,
+0X3F300000,0X3F300000,0X3F300000,0X3F300000,
+0X3F300000,0X3F300000,0X3F300000,0X3F300000,
+0X3F300000,0X3F300000,0X3F300000,0X3F380000,
+0X3F380000,0X3F380000,0X3F380000,0X3F3C0000,
+0X3F3C0000,0X3F3C0000,0X3F3C0000,0X3F3C0000,
+0X3F400000,0X3F400000,0X3F400000,0X3F400000,
+0X3F440000,0X3F440000,0X3F440000,0X3F480000,
+0X3F480000,0X3F480000,0X3F480000,0X3F4C0000,
+0X3F4C0000,0X3F4C0000,0X3F4C0000,0X3F500000,
+0X3F500000,0X3F500000,0X3F500000,0X3F500000,
+0X3F500000,0X3F580000,0X3F580000,0X3F580000,
+0X3F580000,0X3F580000,0X3F580000,0X3F580000,
+0X3F5C0000,0X3F5C0000,0X3F5C0000,0X3F600000,
+0X3F600000,0X3F600000,0X3F640000,0X3F640000,
+0X3F640000,0X3F640000,0X3F680000,0X3F680000,
+0X3F680000,0X3F6C0000,0X3F700000,0X3F700000,
+0X3F700000,0X3F700000,0X3F740000,0X3F740000,
+0X3F740000,0X3F780000,0X3F780000,0X3F780000,
+0X3F780000,0X3F780000,0X3F780000,0X3F7C0000,
+0X3F7C0000,0X3F7C0000,0X3F7C0000,0X3F800000,
+0X3F800000,0X3F800000,0X3F800000,0X3F800000,
+0X3F800000,0X3F800000,0X3F800000,0X3F800000,
+0X3F800000,0X3F800000,0X3F800000,0X3F800000,
+0X3F000000,0X20000000,0X20000000,0X20000000,
+0X3C800000,0X3C800000,0X3C800000,0X3C800000,
+0X3C800000,0X3C800000,0X3C800000,0X3C800000,
+0X3C800000,0X3C800000,0X3C800000,0X3C800000,
+0X3C800000,0X3C800000,0X3D000000,0X3D000000,
+0X3D000000,0X3D400000,0X3D400000,0X3D400000,
+0X3D800000,0X3D800000,0X3DA00000,0X3DA00000,
+0X3DC00000,0X3DC00000,0X3DE00000,0X3DE00000,
+0X3E000000,0X3E000000,0X3E000000,0X3E100000,
+0X3E100000,0X3E100000,0X3E200000,0X3E200000,
+0X3E300000,0X3E300000,0X3E300000,0X3E400000,
+0X3E400000,0X3E400000,0X3E500000,0X3E500000,
+0X3E500000,0X3E500000,0X3E600000,0X3E600000,
+0X3E600000,0X3E600000,0X3E700000,0X3E700000,
+0X3E700000,0X3E700000,0X3E800000,0X3E800000,
+0X3E800000,0X3E880000,0X3E880000,0X3E880000,
+0X3E880000,0X3E900000,0X3E980000,0X3E980000,
+0X3E980000,0X3E980000,0X3EA00000,0X3EA00000,
+0X3EA80000,0X3EA80000,0X3EA80000,0X3EA80000,
+0X3EA80000,0X3EB00000,0X3EB00000,0X3EB00000,
+0X3EB00000,0X3EB80000,0X3EB80000,0X3EB80000,
+0X3EB80000,0X3EB80000,0X3EC00000,0X3EC00000,
+0X3EC00000,0X3EC00000,0X3EC00000,0X3EC80000,
+0X3EC80000,0X3EC80000,0X3EC80000,0X3EC80000,
+0X3EC80000,0X3ED00000,0X3ED00000,0X3ED00000,
+0X3ED80000,0X3ED80000,0X3ED80000,0X3ED80000,
+0X3EE00000,0X3EE00000,0X3EE00000,0X3EE00000,
+0X3EE00000,0X3EE00000,0X3EE00000,0X3EE80000,
+0X3EE80000,0X3EE80000,0X3EE80000,0X3EF00000,
+0X3EF00000,0X3EF00000,0X3EF00000,0X3EF00000,
+0X3EF00000,0X3EF80000,0X3EF80000,0X3EF80000,
+0X3EF80000,0X3F000000,0X3F000000,0X3F000000
+};
+
+UniJAR tanh_PS8_tbl[256] = {
+0X20000000,0X3C800000,0X3D000000,0X3D400000,
+0X3D800000,0X3DA00000,0X3DC00000,0X3DE00000,
+0X3E000000,0X3E100000,0X3E200000,0X3E300000,
+0X3E400000,0X3E500000,0X3E600000,0X3E700000,
+0X3E800000,0X3E880000,0X3E880000,0X3E900000,
+0X3E980000,0X3EA80000,0X3EA80000,0X3EB00000,
+0X3EB80000,0X3EC00000,0X3EC80000,0X3ED00000,
+0X3ED80000,0X3EE00000,0X3EE00000,0X3EE80000,
+0X3EF00000,0X3EF00000,0X3EF80000,0X3EF80000,
+0X3F000000,0X3F000000,0X3F080000,0X3F0C0000,
+0X3F0C0000,0X3F100000,0X3F100000,0X3F180000,
+0X3F1C0000,0X3F1C0000,0X3F200000,0X3F200000,
+0X3F240000,0X3F280000,0X3F280000,0X3F300000,
+0X3F300000,0X3F300000,0X3F380000,0X3F380000,
+0X3F3C0000,0X3F400000,0X3F400000,0X3F440000,
+0X3F440000,0X3F480000,0X3F4C0000,0X3F4C0000,
+0X3F500000,0X3F500000,0X3F500000,0X3F500000,
+0X3F580000,0X3F580000,0X3F580000,0X3F5C0000,
+0X3F5C0000,0X3F600000,0X3F600000,0X3F640000,
+0X3F640000,0X3F680000,0X3F680000,0X3F680000,
+0X3F6C0000,0X3F6C0000,0X3F700000,0X3F700000,
+0X3F700000,0X3F700000,0X3F700000,0X3F700000,
+0X3F740000,0X3F740000,0X3F740000,0X3F780000,
+0X3F780000,0X3F780000,0X3F780000,0X3F780000,
+0X3F780000,0X3F780000,0X3F780000,0X3F7C0000,
+0X3F7C0000,0X3F7C0000,0X3F7C0000,0X3F7C0000,
+0X3F800000,0X3F800000,0X3F800000,0X3F800000,
+0X3F800000,0X3F800000,0X3F800000,0X3F800000,
+0X3F800000,0X3F800000,0X3F800000,0X3F800000,
+0X3F800000,0X3F800000,0X3F800000,0X3F800000,
+0X3F800000,0X3F800000,0X3F800000,0X3F800000,
+0X3F800000,0X3F800000,0X3F800000,0X3F800000,
+0X20000000,0XBF800000,0XBF800000,0XBF800000,
+0XBF800000,0XBF800000,0XBF800000,0XBF800000,
+0XBF800000,0XBF800000,0XBF800000,0XBF800000,
+0XBF800000,0XBF800000,0XBF800000,0XBF800000,
+0XBF800000,0XBF800000,0XBF800000,0XBF800000,
+0XBF800000,0XBF800000,0XBF800000,0XBF800000,
+0XBF800000,0XBF7C0000,0XBF7C0000,0XBF7C0000,
+0XBF7C0000,0XBF7C0000,0XBF780000,0XBF780000,
+0XBF780000,0XBF780000,0XBF780000,0XBF780000,
+0XBF780000,0XBF780000,0XBF740000,0XBF740000,
+0XBF740000,0XBF700000,0XBF700000,0XBF700000,
+0XBF700000,0XBF700000,0XBF700000,0XBF6C0000,
+0XBF6C0000,0XBF680000,0XBF680000,0XBF680000,
+0XBF640000,0XBF640000,0XBF600000,0XBF600000,
+0XBF5C0000,0XBF5C0000,0XBF580000,0XBF580000,
+0XBF580000,0XBF500000,0XBF500000,0XBF500000,
+0XBF500000,0XBF4C0000,0XBF4C0000,0XBF480000,
+0XBF440000,0XBF440000,0XBF400000,0XBF400000,
+0XBF3C0000,0XBF380000,0XBF380000,0XBF300000,
+0XBF300000,0XBF300000,0XBF280000,0XBF280000,
+0XBF240000,0XBF200000,0XBF200000,0XBF1C0000,
+0XBF1C0000,0XBF180000,0XBF100000,0XBF100000,
+0XBF0C0000,0XBF0C0000,0XBF080000,0XBF000000,
+0XBF000000,0XBEF80000,0XBEF80000,0XBEF00000,
+0XBEF00000,0XBEE80000,0XBEE00000,0XBEE00000,
+0XBED80000,0XBED00000,0XBEC80000,0XBEC00000,
+0XBEB80000,0XBEB00000,0XBEA80000,0XBEA80000,
+0XBE980000,0XBE900000,0XBE880000,0XBE880000,
+0XBE800000,0XBE700000,0XBE600000,0XBE500000,
+0XBE400000,0XBE300000,0XBE200000,0XBE100000,
+0XBE000000,0XBDE00000,0XBDC00000,0XBDA00000,
+0XBD800000,0XBD400000,0XBD000000,0XBC800000
+};
@@ -0,0 +1,85 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Recurrent cells (LSTM, GRU) for step-by-step inference at batch 1.
+ *
+ *  The gate weights of a cell are concatenated into one col-major matrix W of size
+ *  (G*H) x (I+H), G = 4 for LSTM (gate order i, f, g, o) and G = 3 for GRU (gate 
+ *  order r, z, n), so that one sweep over W against the vector [x_t; h_{t-1}] produces
+ *  all gate pre-activations in linear domain accumulators (see jar_matvecacc).
+ *  bias holds G*H LogPS80 values for LSTM, and 4*H for GRU as the hidden part of the 
+ *  n gate has its own bias (order r, z, n_x, n_h).
+ *
+ *  sigmoid and tanh are applied in the epilogue by converting the pre-activation to
+ *  LogPS80 and looking up a 256-entry table indexed by its Posit(8,0) code. The tables
+ *  are generated by gen_sigmoid_PS8_tbl and gen_tanh_PS8_tbl.
+ *
+ *  The cell state c and hidden state h are LogPS80 vectors of length H. The *_cell
+ *  routines take a workspace of (I+H) + 4*H UniJAR; the *_seq routines run T steps
+ *  with [x_t; h] and the accumulators kept in one small buffer across steps, taken
+ *  from the workspace arena of the calling thread (see jar_mem.h).
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_RNN
+
+#define JAR_RNN
+#include "jar_sim.h"
+
+void jar_rnn_pack_weights( const int G, const int I, const int H, const UniJAR** Wx, const UniJAR** Wh, UniJAR* W );
+
+UniJAR sigmoid_LogPS80( UniJAR x );
+UniJAR tanh_LogPS80( UniJAR x );
+
+void jar_lstm_cell( const int I, const int H, const UniJAR* W, const UniJAR* bias, const UniJAR* x, UniJAR* h, UniJAR* c, UniJAR* work );
+void jar_lstm_cell_avx512( const int I, const int H, const UniJAR* W, const UniJAR* bias, const UniJAR* x, UniJAR* h, UniJAR* c, UniJAR* work );
+void jar_lstm_seq( const int I, const int H, const int T, const UniJAR* W, const UniJAR* bias, const UniJAR* X, UniJAR* h, UniJAR* c, UniJAR* Y );
+void jar_lstm_seq_avx512( const int I, const int H, const int T, const UniJAR* W, const UniJAR* bias, const UniJAR* X, UniJAR* h, UniJAR* c, UniJAR* Y );
+
+void jar_gru_cell( const int I, const int H, const UniJAR* W, const UniJAR* bias, const UniJAR* x, UniJAR* h, UniJAR* work );
+void jar_gru_cell_avx512( const int I, const int H, const UniJAR* W, const UniJAR* bias, const UniJAR* x, UniJAR* h, UniJAR* work );
+void jar_gru_seq( const int I, const int H, const int T, const UniJAR* W, const UniJAR* bias, const UniJAR* X, UniJAR* h, UniJAR* Y );
+void jar_gru_seq_avx512( const int I, const int H, const int T, const UniJAR* W, const UniJAR* bias, const UniJAR* X, UniJAR* h, UniJAR* Y );
+
+void gen_sigmoid_PS8_tbl( );
+void gen_tanh_PS8_tbl( );
+
+extern UniJAR sigmoid_PS8_tbl[256];
+extern UniJAR tanh_PS8_tbl[256];
+
+#if defined(__AVX512F__)
+__m512i sigmoid_LogPS80_avx512( const __m512i x );
+__m512i tanh_LogPS80_avx512( const __m512i x );
+#endif
+
+#endif
+
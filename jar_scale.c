@@ -0,0 +1,283 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "jar_scale.h"
+
+static int jar_calib_cost( const int m ) {
+/* lost fraction bits of a value with exponent m after scaling, see jar_scale.h */
+  if (m >= 6) {
+    return JAR_CALIB_SAT_COST*(m-5);
+  } else if (m <= -7) {
+    return JAR_CALIB_FLUSH_COST;
+  } else if (m >= 0) {
+    return m;
+  } else {
+    return -1-m;
+  }
+}
+
+void jar_calib_hist( const size_t n, const UniJAR* x, unsigned long long* hist ) {
+/*
+adds the biased exponents of the n LinFP32 values x to the histogram hist[JAR_CALIB_BINS]
+*/
+  size_t i;
+
+  assert (x != NULL && hist != NULL);
+
+  for (i=0; i<n; ++i) {
+    hist[(x[i].I & BEXP_MASK) >> 23]++;
+  }
+}
+
+void jar_calib_hist_rows( const int M, const int N, const UniJAR* X, unsigned long long* hist ) {
+/*
+per-row version of jar_calib_hist for the M x N col-major LinFP32 matrix X, the 
+histogram of row m is hist[m*JAR_CALIB_BINS ... (m+1)*JAR_CALIB_BINS-1]
+*/
+  int m, n;
+
+  assert (M >= 0);
+  assert (N >= 0);
+
+  for (n=0; n<N; ++n) {
+    for (m=0; m<M; ++m) {
+      hist[(m*JAR_CALIB_BINS) + ((X[(n*M)+m].I & BEXP_MASK) >> 23)]++;
+    }
+  }
+}
+
+int jar_calib_shift( const unsigned long long* hist ) {
+/*
+returns the shift k such that storing x * 2^k in LogPS80 minimizes the total cost
+of the values in the histogram; zeros, denormals, Inf and NaN are ignored. Ties go to 
+the shift of smallest magnitude, so an empty histogram gives 0.
+*/
+  double cost, best = -1.0;
+  int    k, e, kbest = 0;
+
+  for (k=0; k<=2*JAR_SHIFT_MAX; ++k) {
+    /* search 0, 1, -1, 2, -2, ... */
+    const int s = (k & 1) ? (k+1)/2 : -k/2;
+    cost = 0.0;
+    for (e=1; e<JAR_CALIB_BINS-1; ++e) {
+      if (hist[e] != 0) {
+        cost += (double)hist[e] * (double)jar_calib_cost( e-127+s );
+      }
+    }
+    if (best < 0.0 || cost < best) {
+      best  = cost;
+      kbest = s;
+    }
+  }
+
+  return kbest;
+}
+
+UniJAR jar_shift_LogPS80( UniJAR x, const int k ) {
+/*
+returns the LogPS80 value x scaled by 2^k, which is an add to the exponent field;
+JAR_ZERO is kept. The result may be outside the PS80 range.
+*/
+  UniJAR y;
+
+  if ((x.I & CLEAR_SIGN) == JAR_ZERO) {
+    return x;
+  }
+  y.I = x.I + ((unsigned int)k << 23);
+  return y;
+}
+
+void jar_quantize_scaled( const size_t n, const UniJAR* x, const int k, UniJAR* y ) {
+/*
+converts the n LinFP32 values x * 2^k to LogPS80, y may alias x
+*/
+  size_t i;
+  const float s = ldexpf( 1.0f, k );
+  UniJAR t;
+
+  assert (x != NULL && y != NULL);
+
+  for (i=0; i<n; ++i) {
+    t.F = x[i].F * s;
+    y[i] = LinFP32_2_LogPS80( t );
+  }
+}
+
+void jar_quantize_scaled_rows( const int M, const int N, const UniJAR* X, const int* k, UniJAR* Y ) {
+/*
+converts the M x N col-major LinFP32 matrix X to LogPS80 with row m scaled by 2^k[m]
+*/
+  int m, n;
+  UniJAR t;
+
+  assert (M >= 0);
+  assert (N >= 0);
+
+  for (n=0; n<N; ++n) {
+    for (m=0; m<M; ++m) {
+      t.F = X[(n*M)+m].F * ldexpf( 1.0f, k[m] );
+      Y[(n*M)+m] = LinFP32_2_LogPS80( t );
+    }
+  }
+}
+
+void jar_matmul_scaled( const int M, const int N, const int K, const UniJAR* A, const UniJAR* B, UniJAR* C, const int* shift ) {
+/* 
+compute C = diag(2^shift) * A * B in JAR, see jar_matmul. The shift of row m is added to
+the exponent constant of sum2_LogPS80, so it is applied to each product exactly. 
+shift == NULL is no shift. All matrices are in col-major format. 
+*/
+  UniJAR sign_z, z;
+  unsigned int add;
+  int    m, n, k;
+
+  assert (M >= 0);
+  assert (N >= 0);
+  assert (K >= 0);
+
+  /* let's set result to JAR_ZERO */
+  for (m=0; m<M*N; ++m) {
+    C[m].I = JAR_ZERO;
+  }
+
+  /* let's perform a matrix matrix multiplication */ 
+  for (k=0; k<K; ++k) {
+    for (n=0; n<N; ++n) {
+      for (m=0; m<M; ++m) {
+        /* products with a zero operand are left out: with a negative shift the exponent */
+        /* of JAR_ZERO*JAR_ZERO would wrap around through the sign bit                     */
+        if ((A[(k*M)+m].I & CLEAR_SIGN) <= JAR_ZERO || (B[(n*K)+k].I & CLEAR_SIGN) <= JAR_ZERO) continue;
+        /* "sum2_LogPS80" with the shift folded into the exponent constant */
+        add = 0X40800000 + ((shift == NULL) ? 0 : ((unsigned int)shift[m] << 23));
+        sign_z.I = (A[(k*M)+m].I & SIGN_MASK) + (B[(n*K)+k].I & SIGN_MASK);
+        z.I = A[(k*M)+m].I + B[(n*K)+k].I + add;
+        z.I = (z.I & CLEAR_SIGN) | sign_z.I;
+        C[(n*M)+m].F += LogPS80_2_LinFP32( z ).F;
+      }
+    }
+  }
+
+  /* let convert to LogPS80 after accumulation */
+  for (m=0; m<M*N; ++m) {
+    C[m] = LinFP32_2_LogPS80( C[m] );
+  }
+}
+
+#if defined(__AVX512F__)
+static inline __m512i jar_fma_scaled_avx512( const __m512i a, const __m512i b, const __m512i c, const __m512i add ) {
+/* jar_fma_avx512 with the exponent constant of sum2_LogPS80 given per lane, products */
+/* with a zero operand are left out as in jar_matmul_scaled                            */
+  const __mmask16 nz = _mm512_cmpgt_epu32_mask( _mm512_and_epi32( a, _mm512_set1_epi32( CLEAR_SIGN ) ), _mm512_set1_epi32( JAR_ZERO ) ) &
+                       _mm512_cmpgt_epu32_mask( _mm512_and_epi32( b, _mm512_set1_epi32( CLEAR_SIGN ) ), _mm512_set1_epi32( JAR_ZERO ) );
+
+  return _mm512_castps_si512( _mm512_mask_add_ps( _mm512_castsi512_ps( c ), nz, _mm512_castsi512_ps( c ), 
+                                                  _mm512_castsi512_ps( jar_prod_avx512( a, b, add ) ) ) );
+}
+#endif
+
+void jar_matmul_scaled_avx512( const int M, const int N, const int K, const UniJAR* A, const UniJAR* B, UniJAR* C, const int* shift ) {
+/* 
+compute C = diag(2^shift) * A * B in JAR, see jar_matmul_scaled and jar_matmul_rnd_avx512.
+The per-row exponent constants are loaded once per block of 16 rows.
+All matrices are in col-major format. 
+*/
+  int    m, n, k, mr;
+
+  assert (M >= 0);
+  assert (N >= 0);
+  assert (K >= 0);
+
+  m = 0;
+#if defined(__AVX512F__)
+  for ( m=0; m<(M/16)*16; m+=16 ) {
+    __m512i add = _mm512_set1_epi32( 0X40800000 );
+    if (shift != NULL) {
+      add = _mm512_add_epi32( add, _mm512_slli_epi32( _mm512_loadu_epi32( shift+m ), 23 ) );
+    }
+    for ( n=0; n<(N/8)*8; n+=8 ) {
+      __m512i vc0 = _mm512_set1_epi32( JAR_ZERO );
+      __m512i vc1 = _mm512_set1_epi32( JAR_ZERO );
+      __m512i vc2 = _mm512_set1_epi32( JAR_ZERO );
+      __m512i vc3 = _mm512_set1_epi32( JAR_ZERO );
+      __m512i vc4 = _mm512_set1_epi32( JAR_ZERO );
+      __m512i vc5 = _mm512_set1_epi32( JAR_ZERO );
+      __m512i vc6 = _mm512_set1_epi32( JAR_ZERO );
+      __m512i vc7 = _mm512_set1_epi32( JAR_ZERO );
+      for (k=0; k<K; ++k) {
+        __m512i va  = _mm512_loadu_epi32( A+(k*M)+m );
+        vc0 = jar_fma_scaled_avx512( va, _mm512_set1_epi32( B[((n+0)*K)+k].I ), vc0, add );
+        vc1 = jar_fma_scaled_avx512( va, _mm512_set1_epi32( B[((n+1)*K)+k].I ), vc1, add );
+        vc2 = jar_fma_scaled_avx512( va, _mm512_set1_epi32( B[((n+2)*K)+k].I ), vc2, add );
+        vc3 = jar_fma_scaled_avx512( va, _mm512_set1_epi32( B[((n+3)*K)+k].I ), vc3, add );
+        vc4 = jar_fma_scaled_avx512( va, _mm512_set1_epi32( B[((n+4)*K)+k].I ), vc4, add );
+        vc5 = jar_fma_scaled_avx512( va, _mm512_set1_epi32( B[((n+5)*K)+k].I ), vc5, add );
+        vc6 = jar_fma_scaled_avx512( va, _mm512_set1_epi32( B[((n+6)*K)+k].I ), vc6, add );
+        vc7 = jar_fma_scaled_avx512( va, _mm512_set1_epi32( B[((n+7)*K)+k].I ), vc7, add );
+      }
+      _mm512_storeu_epi32( C+((n+0)*M)+m, LinFP32_2_LogPS80_avx512( vc0 ) );
+      _mm512_storeu_epi32( C+((n+1)*M)+m, LinFP32_2_LogPS80_avx512( vc1 ) );
+      _mm512_storeu_epi32( C+((n+2)*M)+m, LinFP32_2_LogPS80_avx512( vc2 ) );
+      _mm512_storeu_epi32( C+((n+3)*M)+m, LinFP32_2_LogPS80_avx512( vc3 ) );
+      _mm512_storeu_epi32( C+((n+4)*M)+m, LinFP32_2_LogPS80_avx512( vc4 ) );
+      _mm512_storeu_epi32( C+((n+5)*M)+m, LinFP32_2_LogPS80_avx512( vc5 ) );
+      _mm512_storeu_epi32( C+((n+6)*M)+m, LinFP32_2_LogPS80_avx512( vc6 ) );
+      _mm512_storeu_epi32( C+((n+7)*M)+m, LinFP32_2_LogPS80_avx512( vc7 ) );
+    }
+    for (    ; n<N ; ++n ) {
+      __m512i vc0 = _mm512_set1_epi32( JAR_ZERO );
+      for (k=0; k<K; ++k) {
+        __m512i va  = _mm512_loadu_epi32( A+(k*M)+m );
+        vc0 = jar_fma_scaled_avx512( va, _mm512_set1_epi32( B[(n*K)+k].I ), vc0, add );
+      }
+      _mm512_storeu_epi32( C+(n*M)+m, LinFP32_2_LogPS80_avx512( vc0 ) );
+    }
+  }
+#endif
+
+  /* remaining rows (all rows without AVX512) */
+  for (n=0; n<N; ++n) {
+    for (mr=m; mr<M; ++mr) {
+      UniJAR sign_z, z, c;
+      const unsigned int add = 0X40800000 + ((shift == NULL) ? 0 : ((unsigned int)shift[mr] << 23));
+      c.I = JAR_ZERO;
+      for (k=0; k<K; ++k) {
+        if ((A[(k*M)+mr].I & CLEAR_SIGN) <= JAR_ZERO || (B[(n*K)+k].I & CLEAR_SIGN) <= JAR_ZERO) continue;
+        sign_z.I = (A[(k*M)+mr].I & SIGN_MASK) + (B[(n*K)+k].I & SIGN_MASK);
+        z.I = A[(k*M)+mr].I + B[(n*K)+k].I + add;
+        z.I = (z.I & CLEAR_SIGN) | sign_z.I;
+        c.F += LogPS80_2_LinFP32( z ).F;
+      }
+      C[(n*M)+mr] = LinFP32_2_LogPS80( c );
+    }
+  }
+}
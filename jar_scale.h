@@ -0,0 +1,75 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Power-of-two scaling of tensors so that they fit the range of Posit(8,0).
+ *
+ *  LogPS80 saturates magnitudes with exponent >= 6 and flushes exponent <= -7, and
+ *  its precision tapers away from 1 (5-m fraction bits for m >= 0, 6+m for m < 0).
+ *  A tensor is therefore stored as x * 2^k with an integer shift k per tensor or per
+ *  row (output channel) chosen by calibration:
+ *
+ *    jar_calib_hist[_rows]  collect histograms of the FP32 exponents of sample data;
+ *                           they accumulate, so they can be called over many batches
+ *    jar_calib_shift        picks the shift minimizing the expected loss of fraction
+ *                           bits, saturation and flush, for one histogram
+ *
+ *  In the logarithmic domain a scale by 2^k is an integer add of k to the exponent 
+ *  field. jar_matmul_scaled folds the per-row shift kc[m]-ka[m]-kb of scaled inputs
+ *  A*2^ka, B*2^kb and output C*2^kc into the add constant of sum2_LogPS80, so the
+ *  rescaling costs nothing in the inner loop.
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_SCALE
+
+#define JAR_SCALE
+#include "jar_sim.h"
+
+/* one histogram bin per biased FP32 exponent */
+#define JAR_CALIB_BINS       256
+/* shifts are searched in [-JAR_SHIFT_MAX, JAR_SHIFT_MAX] */
+#define JAR_SHIFT_MAX        32
+/* cost of a flushed value and, per binade of overflow, of a saturated value, */
+/* in lost fraction bits */
+#define JAR_CALIB_FLUSH_COST 6
+#define JAR_CALIB_SAT_COST   8
+
+void jar_calib_hist( const size_t n, const UniJAR* x, unsigned long long* hist );
+void jar_calib_hist_rows( const int M, const int N, const UniJAR* X, unsigned long long* hist );
+int jar_calib_shift( const unsigned long long* hist );
+UniJAR jar_shift_LogPS80( UniJAR x, const int k );
+void jar_quantize_scaled( const size_t n, const UniJAR* x, const int k, UniJAR* y );
+void jar_quantize_scaled_rows( const int M, const int N, const UniJAR* X, const int* k, UniJAR* Y );
+void jar_matmul_scaled( const int M, const int N, const int K, const UniJAR* A, const UniJAR* B, UniJAR* C, const int* shift );
+void jar_matmul_scaled_avx512( const int M, const int N, const int K, const UniJAR* A, const UniJAR* B, UniJAR* C, const int* shift );
+
+#endif
@@ -0,0 +1,164 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  jar_serve: serves a chain of weight matrices from a .jar file with dynamic batching
+ *  (see jar_server.h).
+ *
+ *    jar_serve [options] socket model.jar [name ...]
+ *
+ *      -batch n    largest batch in vectors (default 32)
+ *      -wait us    longest time a request waits for a batch to fill (default 200)
+ *      -relu       ReLU between the layers
+ *      -trace out  kernel counters printed at shutdown and the last events of each 
+ *                  thread written to out as a Chrome trace (see jar_trace.h)
+ *
+ *  The layers are the named tensors, or all tensors in file order. 32-bit tensors with
+ *  ld = rows are used in place in the mapped file; 8-bit tensors and padded ones are
+ *  unpacked once. Tensors stored with a shift are rejected. SIGINT and SIGTERM stop the
+ *  server, which then prints the latency percentiles.
+ *
+ ****************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include "jar_file.h"
+#include "jar_mem.h"
+#include "jar_utils.h"
+#include "jar_server.h"
+#include "jar_trace.h"
+
+static void jar_serve_signal( int sig ) {
+  (void)sig;
+  jar_server_stop();
+}
+
+static void print_usage( ) {
+  printf("usage: jar_serve [-batch n] [-wait us] [-relu] [-trace out.json] socket model.jar [name ...]\n");
+}
+
+int main( int argc, char* argv[] ) {
+  ServerConfJAR conf;
+  FileJAR* f;
+  const char* trace = NULL;
+  TraceJAR s;
+  const TensorJAR** layer;
+  const UniJAR** W;
+  UniJAR** own;
+  int* rows;
+  int* cols;
+  int a = 1, l, j, nl, ret;
+
+  conf.max_batch   = 32;
+  conf.max_wait_us = 200;
+  conf.relu        = 0;
+  while (a < argc && argv[a][0] == '-') {
+    if (strcmp( argv[a], "-relu" ) == 0) {
+      conf.relu = 1;
+    } else if (strcmp( argv[a], "-batch" ) == 0 && a+1 < argc) {
+      conf.max_batch = atoi( argv[++a] );
+    } else if (strcmp( argv[a], "-wait" ) == 0 && a+1 < argc) {
+      conf.max_wait_us = atoi( argv[++a] );
+    } else if (strcmp( argv[a], "-trace" ) == 0 && a+1 < argc) {
+      trace = argv[++a];
+    } else {
+      print_usage();
+      return 1;
+    }
+    ++a;
+  }
+  if (argc-a < 2 || conf.max_batch < 1 || conf.max_batch > JAR_SERVER_MAX_BATCH || conf.max_wait_us < 0) {
+    print_usage();
+    return 1;
+  }
+  conf.path = argv[a];
+
+  f = jar_file_open( argv[a+1] );
+  if (f == NULL) {
+    fprintf( stderr, "jar_serve: cannot open %s\n", argv[a+1] );
+    return 1;
+  }
+  nl = (argc-a > 2) ? argc-a-2 : f->ntensors;
+  layer = (const TensorJAR**) malloc( nl*sizeof(TensorJAR*) );
+  W     = (const UniJAR**) malloc( nl*sizeof(UniJAR*) );
+  own   = (UniJAR**) calloc( nl, sizeof(UniJAR*) );
+  rows  = (int*) malloc( nl*sizeof(int) );
+  cols  = (int*) malloc( nl*sizeof(int) );
+  for (l=0; l<nl; ++l) {
+    const TensorJAR* t = (argc-a > 2) ? jar_file_find( f, argv[a+2+l] ) : f->tensors+l;
+    if (t == NULL || t->shift != 0 || t->layout != JAR_LAYOUT_COLMAJOR) {
+      fprintf( stderr, "jar_serve: tensor %s is missing, scaled or not col-major\n", (argc-a > 2) ? argv[a+2+l] : t->name );
+      return 1;
+    }
+    rows[l] = t->rows;
+    cols[l] = t->cols;
+    if (t->encoding == JAR_ENC_LOGPS80 && t->ld == t->rows) {
+      W[l] = (const UniJAR*)t->data;
+    } else {
+      own[l] = (UniJAR*) jar_malloc( (size_t)t->rows*t->cols*sizeof(UniJAR) );
+      for (j=0; j<t->cols; ++j) {
+        if (t->encoding == JAR_ENC_PS8) {
+          jar_unpack_PS8( t->rows, (const unsigned char*)t->data + (size_t)j*t->ld, own[l] + (size_t)j*t->rows );
+        } else {
+          memcpy( own[l] + (size_t)j*t->rows, (const UniJAR*)t->data + (size_t)j*t->ld, t->rows*sizeof(UniJAR) );
+        }
+      }
+      W[l] = own[l];
+    }
+    layer[l] = t;
+    printf("layer %i: %-24s %8i x %-8i\n", l, t->name, rows[l], cols[l]);
+  }
+
+  signal( SIGINT, jar_serve_signal );
+  signal( SIGTERM, jar_serve_signal );
+  printf("serving on %s, batch %i, wait %i us\n", conf.path, conf.max_batch, conf.max_wait_us);
+  fflush( stdout );
+  if (trace != NULL) {
+    jar_trace_enable( JAR_TRACE_COUNT | JAR_TRACE_EVENTS );
+  }
+  ret = jar_server_run( &conf, nl, W, rows, cols );
+  if (trace != NULL) {
+    jar_trace_snapshot( &s );
+    jar_trace_print( stdout, &s );
+    if (jar_trace_export( trace ) != 0) {
+      fprintf( stderr, "jar_serve: cannot write %s\n", trace );
+    }
+  }
+
+  for (l=0; l<nl; ++l) {
+    jar_free( own[l] );
+  }
+  free( cols ); free( rows ); free( own ); free( W ); free( layer );
+  jar_file_close( f );
+  return (ret == 0) ? 0 : 1;
+}
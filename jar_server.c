@@ -0,0 +1,686 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <assert.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "jar_server.h"
+#include "jar_graph.h"
+
+typedef struct{
+   int            fd;
+   int            maxn;
+   UniJAR*        in;
+   UniJAR*        out;
+   size_t         size;
+   int            busy;       /* a request is queued or running */
+   int            closing;    /* closed by the client while busy */
+   uint32_t       seq;
+   int            n;
+   double         t_arrive;
+   int            hello;      /* the HELLO of the client is outstanding */
+   double         t_accept;
+   MsgJAR         msg;        /* message being received, the socket is non-blocking */
+   size_t         got;
+   int            mfd;        /* descriptor passed with msg */
+} JarConn;
+
+typedef struct{
+   ServerConfJAR        conf;
+   int                  nlayers;
+   const UniJAR* const* W;
+   const int*           rows;
+   const int*           cols;
+   JarConn              conn[JAR_SERVER_MAX_CLIENTS];
+   int                  queue[JAR_SERVER_MAX_CLIENTS];   /* connections with a request, FIFO */
+   int                  qhead;
+   int                  qlen;
+   int                  stop;
+   pthread_mutex_t      lock;
+   pthread_cond_t       cond;
+   GraphJAR*            graph[JAR_SERVER_MAX_BATCH+1];
+   UniJAR*              X;
+   UniJAR*              Y;
+   float*               lat;        /* ring of the last JAR_SERVER_LAT latencies */
+   uint64_t             count;
+   uint64_t             batches;
+} JarServer;
+
+static volatile sig_atomic_t jar_server_stopping = 0;
+
+static double jar_server_now( ) {
+  struct timespec t;
+
+  clock_gettime( CLOCK_MONOTONIC, &t );
+  return (double)t.tv_sec + 1.0e-9*(double)t.tv_nsec;
+}
+
+static int jar_send_msg( const int fd, const MsgJAR* m ) {
+  return (send( fd, m, sizeof(MsgJAR), MSG_NOSIGNAL ) == (ssize_t)sizeof(MsgJAR)) ? 0 : -1;
+}
+
+static int jar_recv_msg( const int fd, MsgJAR* m ) {
+/* receives one message, blocking (client side) */
+  size_t got = 0;
+
+  while (got < sizeof(MsgJAR)) {
+    const ssize_t r = recv( fd, (char*)m + got, sizeof(MsgJAR) - got, 0 );
+    if (r < 0 && errno == EINTR) {
+      continue;
+    }
+    if (r <= 0) {
+      return -1;
+    }
+    got += (size_t)r;
+  }
+  return 0;
+}
+
+static int jar_conn_read( JarConn* c ) {
+/* 
+reads what is available of the message of connection c without blocking, returns 1 when
+it is complete, 0 when more is to come and -1 when the connection is closed or broken
+*/
+  char ctl[CMSG_SPACE(sizeof(int))];
+  struct iovec io;
+  struct msghdr h;
+  ssize_t r;
+
+  while (c->got < sizeof(MsgJAR)) {
+    memset( &h, 0, sizeof(h) );
+    io.iov_base = (char*)&c->msg + c->got;
+    io.iov_len  = sizeof(MsgJAR) - c->got;
+    h.msg_iov        = &io;
+    h.msg_iovlen     = 1;
+    h.msg_control    = ctl;
+    h.msg_controllen = sizeof(ctl);
+    r = recvmsg( c->fd, &h, MSG_DONTWAIT );
+    if (r < 0 && errno == EINTR) {
+      continue;
+    }
+    if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return 0;
+    }
+    if (r <= 0) {
+      return -1;
+    }
+    if (h.msg_controllen > 0) {
+      struct cmsghdr* cm = CMSG_FIRSTHDR( &h );
+      if (cm != NULL && cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS) {
+        int pfd;
+        memcpy( &pfd, CMSG_DATA( cm ), sizeof(int) );
+        if (c->hello && c->mfd < 0) {
+          c->mfd = pfd;
+        } else {
+          close( pfd );
+        }
+      }
+    }
+    c->got += (size_t)r;
+  }
+  c->got = 0;
+  return 1;
+}
+
+static int jar_float_cmp( const void* a, const void* b ) {
+  const float x = *(const float*)a, y = *(const float*)b;
+  return (x > y) - (x < y);
+}
+
+static void jar_server_stats( JarServer* s, MsgJAR* m ) {
+/* percentiles of the recorded latencies, lock held */
+  const size_t n = (s->count < JAR_SERVER_LAT) ? (size_t)s->count : JAR_SERVER_LAT;
+  float* l = (float*) malloc( (n > 0 ? n : 1)*sizeof(float) );
+
+  memset( m, 0, sizeof(MsgJAR) );
+  m->type    = JAR_MSG_STATS;
+  m->count   = s->count;
+  m->batches = s->batches;
+  if (n > 0) {
+    memcpy( l, s->lat, n*sizeof(float) );
+    qsort( l, n, sizeof(float), jar_float_cmp );
+    m->lat[0] = l[(n-1)/2];
+    m->lat[1] = l[((n-1)*90)/100];
+    m->lat[2] = l[((n-1)*99)/100];
+    m->lat[3] = l[n-1];
+  }
+  free( l );
+}
+
+static void jar_conn_close( JarConn* c ) {
+  if (c->in != NULL) {
+    munmap( c->in, c->size );
+  }
+  if (c->mfd >= 0) {
+    close( c->mfd );
+  }
+  close( c->fd );
+  memset( c, 0, sizeof(JarConn) );
+  c->fd  = -1;
+  c->mfd = -1;
+}
+
+static GraphJAR* jar_server_graph( JarServer* s, const int n ) {
+/* the model planned for a batch of n vectors, built on first use */
+  GraphJAR* g = s->graph[n];
+  int l, v = 0;
+
+  if (g != NULL) {
+    return g;
+  }
+  g = (GraphJAR*) malloc( sizeof(GraphJAR) );
+  jar_graph_init( g, s->cols[0], n );
+  for (l=0; l<s->nlayers; ++l) {
+    v = jar_graph_gemm( g, v, s->rows[l], s->W[l] );
+    if (s->conf.relu && l < s->nlayers-1) {
+      v = jar_graph_act( g, v, JAR_OP_RELU );
+    }
+  }
+  if (jar_graph_plan( g, 1 ) != 0) {
+    jar_graph_destroy( g );
+    free( g );
+    return NULL;
+  }
+  s->graph[n] = g;
+  return g;
+}
+
+static void* jar_server_batcher( void* p ) {
+/* 
+collects requests until the batch is full or the oldest one is due, runs the batch as one
+graph and answers the requests
+*/
+  JarServer* s = (JarServer*)p;
+  const int K = s->cols[0], M = s->rows[s->nlayers-1];
+  int take[JAR_SERVER_MAX_CLIENTS];
+  int i, ntake, nb, total;
+  double now;
+
+  pthread_mutex_lock( &s->lock );
+  while (1) {
+    while (s->qlen == 0 && !s->stop) {
+      pthread_cond_wait( &s->cond, &s->lock );
+    }
+    if (s->qlen == 0) {
+      break;
+    }
+
+    /* wait for more requests until the batch is full or the oldest request is due */
+    while (!s->stop) {
+      const double due = s->conn[s->queue[s->qhead]].t_arrive + 1.0e-6*s->conf.max_wait_us;
+      struct timespec ts;
+      total = 0;
+      for (i=0; i<s->qlen; ++i) {
+        total += s->conn[s->queue[(s->qhead+i) % JAR_SERVER_MAX_CLIENTS]].n;
+      }
+      if (total >= s->conf.max_batch || jar_server_now() >= due) {
+        break;
+      }
+      ts.tv_sec  = (time_t)due;
+      ts.tv_nsec = (long)((due - (double)ts.tv_sec)*1.0e9);
+      pthread_cond_timedwait( &s->cond, &s->lock, &ts );
+    }
+
+    /* requests in arrival order as long as they fit */
+    ntake = 0;
+    nb = 0;
+    while (s->qlen > 0) {
+      const int c = s->queue[s->qhead];
+      if (ntake > 0 && nb + s->conn[c].n > s->conf.max_batch) {
+        break;
+      }
+      take[ntake++] = c;
+      nb += s->conn[c].n;
+      s->qhead = (s->qhead + 1) % JAR_SERVER_MAX_CLIENTS;
+      s->qlen--;
+    }
+    pthread_mutex_unlock( &s->lock );
+
+    {
+      GraphJAR* g = jar_server_graph( s, nb );
+      int off = 0;
+      for (i=0; i<ntake; ++i) {
+        const JarConn* c = s->conn + take[i];
+        memcpy( s->X + (size_t)off*K, c->in, (size_t)c->n*K*sizeof(UniJAR) );
+        off += c->n;
+      }
+      if (g != NULL) {
+        jar_graph_run( g, s->X, s->Y );
+      }
+      off = 0;
+      for (i=0; i<ntake; ++i) {
+        const JarConn* c = s->conn + take[i];
+        memcpy( c->out, s->Y + (size_t)off*M, (size_t)c->n*M*sizeof(UniJAR) );
+        off += c->n;
+      }
+
+      /* the client may send its next request as soon as it has the answer */
+      pthread_mutex_lock( &s->lock );
+      now = jar_server_now();
+      for (i=0; i<ntake; ++i) {
+        JarConn* c = s->conn + take[i];
+        MsgJAR m;
+        s->lat[s->count % JAR_SERVER_LAT] = (float)(1.0e6*(now - c->t_arrive));
+        s->count++;
+        c->busy = 0;
+        if (c->closing) {
+          jar_conn_close( c );
+          continue;
+        }
+        memset( &m, 0, sizeof(m) );
+        m.type   = JAR_MSG_DONE;
+        m.seq    = c->seq;
+        m.n      = c->n;
+        m.status = (g != NULL) ? 0 : (uint32_t)-1;
+        jar_send_msg( c->fd, &m );
+      }
+      s->batches++;
+    }
+  }
+  pthread_mutex_unlock( &s->lock );
+  return NULL;
+}
+
+static void jar_server_accept( JarServer* s, const int lfd ) {
+/* 
+sends the model dimensions to a new client; its HELLO with the shared memory segment is 
+received by the poll loop like any other message (jar_server_hello)
+*/
+  const int fd = accept( lfd, NULL, NULL );
+  MsgJAR m;
+  int i;
+
+  if (fd < 0) {
+    return;
+  }
+  for (i=0; i<JAR_SERVER_MAX_CLIENTS && s->conn[i].fd >= 0; ++i);
+  memset( &m, 0, sizeof(m) );
+  m.type   = JAR_MSG_HELLO;
+  m.rows   = (uint32_t)s->rows[s->nlayers-1];
+  m.cols   = (uint32_t)s->cols[0];
+  m.status = (i < JAR_SERVER_MAX_CLIENTS) ? 0 : (uint32_t)-1;
+  if (jar_send_msg( fd, &m ) != 0 || i == JAR_SERVER_MAX_CLIENTS) {
+    close( fd );
+    return;
+  }
+
+  fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) | O_NONBLOCK );
+  pthread_mutex_lock( &s->lock );
+  s->conn[i].fd       = fd;
+  s->conn[i].hello    = 1;
+  s->conn[i].t_accept = jar_server_now();
+  pthread_mutex_unlock( &s->lock );
+}
+
+static void jar_server_hello( JarServer* s, const int i ) {
+/* maps the shared memory segment of the HELLO of connection i if it is large enough for maxn vectors */
+  JarConn* c = s->conn + i;
+  const size_t K = s->cols[0], M = s->rows[s->nlayers-1];
+  MsgJAR m = c->msg;
+  struct stat st;
+  int ok;
+
+  ok = (m.type == JAR_MSG_HELLO && c->mfd >= 0 && m.n > 0 && 
+        (size_t)m.n <= (SIZE_MAX/sizeof(UniJAR))/(K + M) &&
+        fstat( c->mfd, &st ) == 0 && (size_t)st.st_size >= (K + M)*m.n*sizeof(UniJAR));
+
+  pthread_mutex_lock( &s->lock );
+  if (ok) {
+    c->maxn = (int)m.n;
+    c->size = (K + M)*m.n*sizeof(UniJAR);
+    c->in   = (UniJAR*) mmap( NULL, c->size, PROT_READ | PROT_WRITE, MAP_SHARED, c->mfd, 0 );
+    if (c->in == MAP_FAILED) {
+      c->in = NULL;
+      ok = 0;
+    } else {
+      c->out = c->in + K*m.n;
+    }
+  }
+  close( c->mfd );
+  c->mfd   = -1;
+  c->hello = 0;
+  pthread_mutex_unlock( &s->lock );
+
+  m.type   = JAR_MSG_HELLO;
+  m.status = ok ? 0 : (uint32_t)-1;
+  jar_send_msg( c->fd, &m );
+  if (!ok) {
+    pthread_mutex_lock( &s->lock );
+    jar_conn_close( c );
+    pthread_mutex_unlock( &s->lock );
+  }
+}
+
+static void jar_server_request( JarServer* s, const int i ) {
+/* one message of connection i, read as far as it is available */
+  JarConn* c = s->conn + i;
+  MsgJAR m;
+  int r;
+
+  r = jar_conn_read( c );
+  if (r == 0) {
+    return;
+  }
+  if (r < 0) {
+    pthread_mutex_lock( &s->lock );
+    if (c->busy) {
+      c->closing = 1;
+    } else {
+      jar_conn_close( c );
+    }
+    pthread_mutex_unlock( &s->lock );
+    return;
+  }
+  if (c->hello) {
+    jar_server_hello( s, i );
+    return;
+  }
+  m = c->msg;
+
+  if (m.type == JAR_MSG_INFER) {
+    pthread_mutex_lock( &s->lock );
+    if (c->busy || m.n == 0 || (int)m.n > c->maxn || (int)m.n > s->conf.max_batch) {
+      pthread_mutex_unlock( &s->lock );
+      m.type   = JAR_MSG_DONE;
+      m.status = (uint32_t)-1;
+      jar_send_msg( c->fd, &m );
+      return;
+    }
+    c->busy     = 1;
+    c->seq      = m.seq;
+    c->n        = (int)m.n;
+    c->t_arrive = jar_server_now();
+    s->queue[(s->qhead + s->qlen) % JAR_SERVER_MAX_CLIENTS] = i;
+    s->qlen++;
+    pthread_cond_signal( &s->cond );
+    pthread_mutex_unlock( &s->lock );
+  } else if (m.type == JAR_MSG_STATS) {
+    pthread_mutex_lock( &s->lock );
+    jar_server_stats( s, &m );
+    pthread_mutex_unlock( &s->lock );
+    jar_send_msg( c->fd, &m );
+  } else if (m.type == JAR_MSG_SHUTDOWN) {
+    jar_server_stopping = 1;
+    m.status = 0;
+    jar_send_msg( c->fd, &m );
+  }
+}
+
+void jar_server_stop( ) {
+/* makes jar_server_run return, can be called from a signal handler */
+  jar_server_stopping = 1;
+}
+
+int jar_server_run( const ServerConfJAR* conf, const int nlayers, const UniJAR* const* W, const int* rows, const int* cols ) {
+/* 
+serves the model W[0], ..., W[nlayers-1] (W[l] is rows[l] x cols[l] in col-major format) on
+the socket conf->path until jar_server_stop is called or a client sends JAR_MSG_SHUTDOWN
+*/
+  JarServer* s = (JarServer*) calloc( 1, sizeof(JarServer) );
+  struct sockaddr_un addr;
+  struct pollfd pfd[JAR_SERVER_MAX_CLIENTS+1];
+  int pconn[JAR_SERVER_MAX_CLIENTS+1];
+  pthread_condattr_t ca;
+  pthread_t batcher;
+  MsgJAR st;
+  int lfd, i, np, maxrows = 0, l;
+
+  assert (nlayers > 0);
+  for (l=1; l<nlayers; ++l) {
+    if (cols[l] != rows[l-1]) {
+      fprintf( stderr, "jar_server: layer %i has %i columns, layer %i has %i rows\n", l, cols[l], l-1, rows[l-1] );
+      free( s );
+      return -1;
+    }
+  }
+  for (l=0; l<nlayers; ++l) {
+    maxrows = (rows[l] > maxrows) ? rows[l] : maxrows;
+  }
+
+  s->conf    = *conf;
+  s->conf.max_batch = (conf->max_batch < 1) ? 1 : (conf->max_batch > JAR_SERVER_MAX_BATCH) ? JAR_SERVER_MAX_BATCH : conf->max_batch;
+  s->nlayers = nlayers;
+  s->W       = W;
+  s->rows    = rows;
+  s->cols    = cols;
+  s->X   = (UniJAR*) jar_malloc( (size_t)cols[0]*s->conf.max_batch*sizeof(UniJAR) );
+  s->Y   = (UniJAR*) jar_malloc( (size_t)maxrows*s->conf.max_batch*sizeof(UniJAR) );
+  s->lat = (float*) malloc( JAR_SERVER_LAT*sizeof(float) );
+  for (i=0; i<JAR_SERVER_MAX_CLIENTS; ++i) {
+    s->conn[i].fd  = -1;
+    s->conn[i].mfd = -1;
+  }
+
+  memset( &addr, 0, sizeof(addr) );
+  addr.sun_family = AF_UNIX;
+  strncpy( addr.sun_path, conf->path, sizeof(addr.sun_path)-1 );
+  unlink( conf->path );
+  lfd = socket( AF_UNIX, SOCK_STREAM, 0 );
+  if (lfd < 0 || bind( lfd, (struct sockaddr*)&addr, sizeof(addr) ) != 0 || listen( lfd, 64 ) != 0) {
+    fprintf( stderr, "jar_server: cannot listen on %s\n", conf->path );
+    if (lfd >= 0) close( lfd );
+    jar_free( s->Y ); jar_free( s->X ); free( s->lat ); free( s );
+    return -1;
+  }
+
+  pthread_mutex_init( &s->lock, NULL );
+  pthread_condattr_init( &ca );
+  pthread_condattr_setclock( &ca, CLOCK_MONOTONIC );
+  pthread_cond_init( &s->cond, &ca );
+  pthread_condattr_destroy( &ca );
+  pthread_create( &batcher, NULL, jar_server_batcher, s );
+
+  jar_server_stopping = 0;
+  while (!jar_server_stopping) {
+    np = 0;
+    pfd[np].fd = lfd; pfd[np].events = POLLIN; pconn[np++] = -1;
+    pthread_mutex_lock( &s->lock );
+    for (i=0; i<JAR_SERVER_MAX_CLIENTS; ++i) {
+      /* a client gets one second for its HELLO */
+      if (s->conn[i].fd >= 0 && s->conn[i].hello && jar_server_now() - s->conn[i].t_accept > 1.0) {
+        jar_conn_close( s->conn+i );
+      }
+      if (s->conn[i].fd >= 0 && !s->conn[i].closing) {
+        pfd[np].fd = s->conn[i].fd; pfd[np].events = POLLIN; pconn[np++] = i;
+      }
+    }
+    pthread_mutex_unlock( &s->lock );
+    if (poll( pfd, np, 50 ) <= 0) {
+      continue;
+    }
+    for (i=0; i<np; ++i) {
+      if (pfd[i].revents == 0) {
+        continue;
+      }
+      if (pconn[i] < 0) {
+        jar_server_accept( s, lfd );
+      } else {
+        jar_server_request( s, pconn[i] );
+      }
+    }
+  }
+
+  pthread_mutex_lock( &s->lock );
+  s->stop = 1;
+  pthread_cond_signal( &s->cond );
+  pthread_mutex_unlock( &s->lock );
+  pthread_join( batcher, NULL );
+
+  jar_server_stats( s, &st );
+  printf("jar_server: %llu requests in %llu batches (%.2f per batch), latency p50 %.1f us, p90 %.1f us, p99 %.1f us, max %.1f us\n",
+         (unsigned long long)st.count, (unsigned long long)st.batches, 
+         (st.batches > 0) ? (double)st.count/(double)st.batches : 0.0, st.lat[0], st.lat[1], st.lat[2], st.lat[3]);
+  fflush( stdout );
+
+  for (i=0; i<JAR_SERVER_MAX_CLIENTS; ++i) {
+    if (s->conn[i].fd >= 0) {
+      jar_conn_close( s->conn+i );
+    }
+  }
+  for (i=0; i<=JAR_SERVER_MAX_BATCH; ++i) {
+    if (s->graph[i] != NULL) {
+      jar_graph_destroy( s->graph[i] );
+      free( s->graph[i] );
+    }
+  }
+  close( lfd );
+  unlink( conf->path );
+  pthread_cond_destroy( &s->cond );
+  pthread_mutex_destroy( &s->lock );
+  jar_free( s->Y );
+  jar_free( s->X );
+  free( s->lat );
+  free( s );
+  return 0;
+}
+
+int jar_client_connect( ClientJAR* c, const char* path, const int maxn ) {
+/* connects to the server at path with a shared memory segment for maxn vectors */
+  char ctl[CMSG_SPACE(sizeof(int))];
+  struct sockaddr_un addr;
+  struct msghdr h;
+  struct cmsghdr* cm;
+  struct iovec io;
+  MsgJAR m;
+  int mfd;
+
+  memset( c, 0, sizeof(ClientJAR) );
+  c->fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+  memset( &addr, 0, sizeof(addr) );
+  addr.sun_family = AF_UNIX;
+  strncpy( addr.sun_path, path, sizeof(addr.sun_path)-1 );
+  if (c->fd < 0 || connect( c->fd, (struct sockaddr*)&addr, sizeof(addr) ) != 0 ||
+      jar_recv_msg( c->fd, &m ) != 0 || m.type != JAR_MSG_HELLO || m.status != 0) {
+    if (c->fd >= 0) close( c->fd );
+    c->fd = -1;
+    return -1;
+  }
+  c->rows = (int)m.rows;
+  c->cols = (int)m.cols;
+  c->maxn = maxn;
+  c->size = ((size_t)c->rows + c->cols)*maxn*sizeof(UniJAR);
+
+  mfd = memfd_create( "jar_client", 0 );
+  if (mfd < 0 || ftruncate( mfd, (off_t)c->size ) != 0 ||
+      (c->in = (UniJAR*) mmap( NULL, c->size, PROT_READ | PROT_WRITE, MAP_SHARED, mfd, 0 )) == MAP_FAILED) {
+    if (mfd >= 0) close( mfd );
+    close( c->fd );
+    c->fd = -1;
+    c->in = NULL;
+    return -1;
+  }
+  c->out = c->in + (size_t)c->cols*maxn;
+
+  memset( &m, 0, sizeof(m) );
+  m.type = JAR_MSG_HELLO;
+  m.n    = (uint32_t)maxn;
+  memset( &h, 0, sizeof(h) );
+  io.iov_base = &m;
+  io.iov_len  = sizeof(m);
+  h.msg_iov        = &io;
+  h.msg_iovlen     = 1;
+  h.msg_control    = ctl;
+  h.msg_controllen = sizeof(ctl);
+  cm = CMSG_FIRSTHDR( &h );
+  cm->cmsg_level = SOL_SOCKET;
+  cm->cmsg_type  = SCM_RIGHTS;
+  cm->cmsg_len   = CMSG_LEN(sizeof(int));
+  memcpy( CMSG_DATA( cm ), &mfd, sizeof(int) );
+  if (sendmsg( c->fd, &h, MSG_NOSIGNAL ) != (ssize_t)sizeof(m) ||
+      jar_recv_msg( c->fd, &m ) != 0 || m.status != 0) {
+    close( mfd );
+    jar_client_close( c );
+    return -1;
+  }
+  close( mfd );
+  return 0;
+}
+
+int jar_client_infer( ClientJAR* c, const int n ) {
+/* runs the model on the first n input vectors of the segment (c->in), the results are in c->out */
+  MsgJAR m;
+
+  assert (n > 0 && n <= c->maxn);
+
+  memset( &m, 0, sizeof(m) );
+  m.type = JAR_MSG_INFER;
+  m.seq  = ++c->seq;
+  m.n    = (uint32_t)n;
+  if (jar_send_msg( c->fd, &m ) != 0 || jar_recv_msg( c->fd, &m ) != 0 ||
+      m.type != JAR_MSG_DONE || m.seq != c->seq) {
+    return -1;
+  }
+  return (m.status == 0) ? 0 : -1;
+}
+
+int jar_client_stats( ClientJAR* c, MsgJAR* stats ) {
+  memset( stats, 0, sizeof(MsgJAR) );
+  stats->type = JAR_MSG_STATS;
+  if (jar_send_msg( c->fd, stats ) != 0 || jar_recv_msg( c->fd, stats ) != 0) {
+    return -1;
+  }
+  return 0;
+}
+
+int jar_client_shutdown( ClientJAR* c ) {
+  MsgJAR m;
+
+  memset( &m, 0, sizeof(m) );
+  m.type = JAR_MSG_SHUTDOWN;
+  if (jar_send_msg( c->fd, &m ) != 0 || jar_recv_msg( c->fd, &m ) != 0) {
+    return -1;
+  }
+  return 0;
+}
+
+void jar_client_close( ClientJAR* c ) {
+  if (c->in != NULL) {
+    munmap( c->in, c->size );
+  }
+  if (c->fd >= 0) {
+    close( c->fd );
+  }
+  memset( c, 0, sizeof(ClientJAR) );
+  c->fd = -1;
+}
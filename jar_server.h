@@ -0,0 +1,111 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Inference server with dynamic batching over a Unix domain socket.
+ *
+ *  The model is a chain of weight matrices W_1, ..., W_L (rows_l x cols_l, cols_l =
+ *  rows_{l-1}), e.g. the tensors of a .jar file in file order, optionally with a ReLU
+ *  between the layers. It runs as a jar_graph (see jar_graph.h) on the columns of one 
+ *  batch; a graph is planned once for every batch size that occurs.
+ *
+ *  A client creates a shared memory segment (memfd) for up to maxn input vectors of 
+ *  cols_1 and output vectors of rows_L LogPS80 values, and passes it with JAR_MSG_HELLO
+ *  when it connects. A request (JAR_MSG_INFER) names the number of vectors in the
+ *  segment; the server answers with JAR_MSG_DONE when their results are in the segment.
+ *  Payloads never go through the socket.
+ *
+ *  Requests of all clients are coalesced: a batch is run as soon as it holds max_batch
+ *  vectors or its oldest request has waited max_wait_us microseconds, so under load a
+ *  GEMV per request becomes one GEMM per batch that reads the weights once. The latency
+ *  of every request, from its arrival to its answer, is recorded; JAR_MSG_STATS returns
+ *  the percentiles of the last JAR_SERVER_LAT requests, which are also printed when the
+ *  server stops (JAR_MSG_SHUTDOWN or jar_server_stop).
+ *
+ *  The client functions and jar_server_run return 0 on success and -1 on an error.
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_SERVER
+
+#define JAR_SERVER
+#include <stdint.h>
+#include "jar_sim.h"
+
+#define JAR_SERVER_MAX_CLIENTS  64
+#define JAR_SERVER_MAX_BATCH    256
+#define JAR_SERVER_LAT          65536
+
+#define JAR_MSG_HELLO     1
+#define JAR_MSG_INFER     2
+#define JAR_MSG_DONE      3
+#define JAR_MSG_STATS     4
+#define JAR_MSG_SHUTDOWN  5
+
+typedef struct{
+   uint32_t       type;
+   uint32_t       seq;
+   uint32_t       n;          /* vectors of a request, maxn of a client */
+   uint32_t       status;     /* 0 or -1 */
+   uint32_t       rows;       /* output length of the model */
+   uint32_t       cols;       /* input length of the model */
+   uint64_t       count;      /* requests, JAR_MSG_STATS */
+   uint64_t       batches;
+   float          lat[4];     /* p50, p90, p99 and max latency in microseconds */
+} MsgJAR;
+
+typedef struct{
+   const char*    path;       /* of the socket */
+   int            max_batch;  /* vectors, at most JAR_SERVER_MAX_BATCH */
+   int            max_wait_us;
+   int            relu;
+} ServerConfJAR;
+
+typedef struct{
+   int            fd;
+   int            maxn;
+   int            rows;
+   int            cols;
+   uint32_t       seq;
+   UniJAR*        in;         /* cols x maxn, col-major */
+   UniJAR*        out;        /* rows x maxn */
+   size_t         size;
+} ClientJAR;
+
+int jar_server_run( const ServerConfJAR* conf, const int nlayers, const UniJAR* const* W, const int* rows, const int* cols );
+void jar_server_stop( );
+int jar_client_connect( ClientJAR* c, const char* path, const int maxn );
+int jar_client_infer( ClientJAR* c, const int n );
+int jar_client_stats( ClientJAR* c, MsgJAR* stats );
+int jar_client_shutdown( ClientJAR* c );
+void jar_client_close( ClientJAR* c );
+
+#endif
@@ -0,0 +1,439 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <assert.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "jar_shard.h"
+#include "jar_pool.h"
+#include "jar_timer.h"
+
+#define JAR_SHARD_PAD( n )  ( ((n) + 63) & ~(size_t)63 )
+
+typedef struct{
+   size_t         a_len;
+   size_t         b_off;
+   size_t         b_len;
+   size_t         c_off;
+   size_t         c_len;
+} JarShardLayout;
+
+static void jar_shard_layout( const ShardJAR* s, const int w, const int N, JarShardLayout* l ) {
+/* mailbox of worker w: its slice of A, then its rows of B and its results for maxn columns */
+  const size_t n = (size_t)(s->p0[w+1] - s->p0[w]);
+  size_t bmax, cw;
+
+  if (s->split == JAR_SHARD_M) {
+    l->a_len = n*s->K*sizeof(UniJAR);
+    l->b_len = (size_t)s->K*N*sizeof(UniJAR);
+    l->c_len = n*N*sizeof(UniJAR);
+    bmax = (size_t)s->K*s->maxn*sizeof(UniJAR);
+  } else {
+    cw = (s->acc == JAR_ACC_EXACT) ? sizeof(long long) : sizeof(UniJAR);
+    l->a_len = (size_t)s->M*n*sizeof(UniJAR);
+    l->b_len = n*N*sizeof(UniJAR);
+    l->c_len = (size_t)s->M*N*cw;
+    bmax = n*s->maxn*sizeof(UniJAR);
+  }
+  l->b_off = JAR_SHARD_PAD( l->a_len );
+  l->c_off = l->b_off + JAR_SHARD_PAD( bmax );
+}
+
+static void jar_shard_view( const ShardJAR* s, const int w, const int N, AccJAR* v ) {
+/* the partial accumulators of worker w of JAR_SHARD_K in its mailbox */
+  JarShardLayout l;
+
+  jar_shard_layout( s, w, N, &l );
+  v->mode = s->acc;
+  v->M = s->M;
+  v->N = N;
+  v->lin = (s->acc == JAR_ACC_LINEAR) ? (UniJAR*)(s->box[w] + l.c_off) : NULL;
+  v->fix = (s->acc == JAR_ACC_EXACT) ? (long long*)(s->box[w] + l.c_off) : NULL;
+}
+
+static void jar_shard_free( ShardJAR* s ) {
+  free( s->seconds );
+  free( s->box );
+  free( s->p0 );
+  s->seconds = NULL;
+  s->box = NULL;
+  s->p0 = NULL;
+}
+
+int jar_shard_create( ShardJAR* s, const ShardOpsJAR* ops, const int nworkers, const int threads, const int split, const int acc,
+                      const int M, const int K, const int maxn, const UniJAR* A ) {
+/*
+splits A over nworkers workers started by the transport ops, each with threads threads,
+see jar_shard.h. acc is the accumulator mode of JAR_SHARD_K.
+*/
+  const int P = nworkers;
+  const int D = (split == JAR_SHARD_M) ? M : K;
+  JarShardLayout l;
+  ShardCmdJAR cmd;
+  int w, k, status = 0;
+
+  assert (P > 0 && threads > 0);
+  assert (split == JAR_SHARD_M || split == JAR_SHARD_K);
+  assert (acc == JAR_ACC_LINEAR || acc == JAR_ACC_EXACT);
+  assert (M >= 0 && K >= 0 && maxn >= 0);
+
+  s->ops = ops;
+  s->ctx = NULL;
+  s->nworkers = P;
+  s->threads = threads;
+  s->split = split;
+  s->acc = acc;
+  s->M = M;
+  s->K = K;
+  s->maxn = maxn;
+  s->p0 = (int*) malloc( (P+1)*sizeof(int) );
+  s->box = (unsigned char**) calloc( P, sizeof(unsigned char*) );
+  s->seconds = (double*) calloc( P, sizeof(double) );
+  if (s->p0 == NULL || s->box == NULL || s->seconds == NULL) {
+    jar_shard_free( s );
+    return -1;
+  }
+
+  /* slices of rows in multiples of JAR_SHARD_ALIGN, for the 16-row blocks of the kernels */
+  for (w=0; w<P; ++w) {
+    long long p = (long long)D*w/P;
+    if (split == JAR_SHARD_M) p = (p + JAR_SHARD_ALIGN/2)/JAR_SHARD_ALIGN*JAR_SHARD_ALIGN;
+    s->p0[w] = (p < D) ? (int)p : D;
+  }
+  s->p0[P] = D;
+
+  s->box_size = 64;
+  for (w=0; w<P; ++w) {
+    jar_shard_layout( s, w, maxn, &l );
+    if (l.c_off + l.c_len > s->box_size) s->box_size = l.c_off + l.c_len;
+  }
+  if (ops->start( s ) != 0) {
+    jar_shard_free( s );
+    return -1;
+  }
+
+  /* place the slices of A, the coordinator keeps no copy */
+  for (w=0; w<P; ++w) {
+    const int n = s->p0[w+1] - s->p0[w];
+    UniJAR* a = (UniJAR*)s->box[w];
+    jar_shard_layout( s, w, maxn, &l );
+    if (split == JAR_SHARD_M) {
+      for (k=0; k<K; ++k) {
+        memcpy( a+(size_t)k*n, A+(size_t)k*M+s->p0[w], (size_t)n*sizeof(UniJAR) );
+      }
+    } else {
+      memcpy( a, A+(size_t)s->p0[w]*M, l.a_len );
+    }
+    memset( &cmd, 0, sizeof(cmd) );
+    cmd.op = JAR_SHARD_OP_LOAD;
+    cmd.in_len = l.a_len;
+    status |= ops->send( s, w, &cmd );
+  }
+  for (w=0; w<P; ++w) {
+    status |= ops->recv( s, w, &cmd ) | cmd.status;
+  }
+  if (status != 0) {
+    jar_shard_destroy( s );
+    return -1;
+  }
+
+  return 0;
+}
+
+int jar_shard_matmul( ShardJAR* s, const int N, const UniJAR* B, UniJAR* C ) {
+/*
+C = A*B for the K x N B (col-major) and the M x N C (col-major), N <= maxn. The workers 
+run concurrently; their compute times are in s->seconds.
+*/
+  const int P = s->nworkers;
+  JarShardLayout l;
+  ShardCmdJAR cmd;
+  AccJAR v0, v;
+  int w, n, status = 0;
+
+  assert (N >= 0 && N <= s->maxn);
+
+  for (w=0; w<P; ++w) {
+    const int kw = s->p0[w+1] - s->p0[w];
+    unsigned char* b = s->box[w];
+    jar_shard_layout( s, w, N, &l );
+    if (s->split == JAR_SHARD_M) {
+      memcpy( b+l.b_off, B, l.b_len );
+    } else {
+      for (n=0; n<N; ++n) {
+        memcpy( b+l.b_off+(size_t)n*kw*sizeof(UniJAR), B+(size_t)n*s->K+s->p0[w], (size_t)kw*sizeof(UniJAR) );
+      }
+    }
+    memset( &cmd, 0, sizeof(cmd) );
+    cmd.op = JAR_SHARD_OP_MATMUL;
+    cmd.N = N;
+    cmd.in_off = l.b_off;
+    cmd.in_len = l.b_len;
+    cmd.out_off = l.c_off;
+    cmd.out_len = l.c_len;
+    status |= s->ops->send( s, w, &cmd );
+  }
+  for (w=0; w<P; ++w) {
+    status |= s->ops->recv( s, w, &cmd ) | cmd.status;
+    s->seconds[w] = cmd.seconds;
+  }
+  if (status != 0) {
+    return -1;
+  }
+
+  if (s->split == JAR_SHARD_M) {
+    for (w=0; w<P; ++w) {
+      const int mw = s->p0[w+1] - s->p0[w];
+      jar_shard_layout( s, w, N, &l );
+      for (n=0; n<N; ++n) {
+        memcpy( C+(size_t)n*s->M+s->p0[w], s->box[w]+l.c_off+(size_t)n*mw*sizeof(UniJAR), (size_t)mw*sizeof(UniJAR) );
+      }
+    }
+  } else {
+    /* reduction of the partial accumulators in the linear domain, then one conversion */
+    jar_shard_view( s, 0, N, &v0 );
+    for (w=1; w<P; ++w) {
+      jar_shard_view( s, w, N, &v );
+      jar_acc_merge( &v0, &v );
+    }
+    jar_acc_finalize( &v0, C, NULL );
+  }
+
+  return 0;
+}
+
+static void jar_shard_compute( ShardJAR* s, const int w, const int N ) {
+/* the part of worker w of C = A*B on its mailbox */
+  const int n = s->p0[w+1] - s->p0[w];
+  unsigned char* b = s->box[w];
+  JarShardLayout l;
+  AccJAR v;
+
+  jar_shard_layout( s, w, N, &l );
+  if (s->split == JAR_SHARD_M) {
+    jar_matmul_avx512( n, N, s->K, (const UniJAR*)b, (const UniJAR*)(b+l.b_off), (UniJAR*)(b+l.c_off) );
+  } else {
+    jar_shard_view( s, w, N, &v );
+    jar_acc_zero( &v );
+    jar_acc_matmul_avx512( &v, n, (const UniJAR*)b, s->M, (const UniJAR*)(b+l.b_off), n );
+  }
+}
+
+int jar_shard_worker( ShardJAR* s, const int w ) {
+/* serves the commands to worker w until JAR_SHARD_OP_STOP */
+  ShardCmdJAR cmd;
+  double t;
+
+  for (;;) {
+    if (s->ops->next( s, w, &cmd ) != 0) {
+      return -1;
+    }
+    t = jar_timer_now();
+    cmd.status = 0;
+    if (cmd.op == JAR_SHARD_OP_MATMUL) {
+      if (cmd.N < 0 || cmd.N > s->maxn) {
+        cmd.status = -1;
+      } else {
+        jar_shard_compute( s, w, cmd.N );
+      }
+    } else if (cmd.op != JAR_SHARD_OP_LOAD && cmd.op != JAR_SHARD_OP_STOP) {
+      cmd.status = -1;
+    }
+    cmd.seconds = jar_timer_now() - t;
+    if (s->ops->reply( s, w, &cmd ) != 0) {
+      return -1;
+    }
+    if (cmd.op == JAR_SHARD_OP_STOP) {
+      return 0;
+    }
+  }
+}
+
+void jar_shard_destroy( ShardJAR* s ) {
+/* stops the workers and frees the mailboxes */
+  if (s->ctx != NULL) {
+    s->ops->stop( s );
+  }
+  jar_shard_free( s );
+}
+
+/* jar_shard_shm: forked workers, memfd mailboxes mapped by the coordinator and the workers, */
+/* commands over one socket pair per worker                                                 */
+
+typedef struct{
+   pid_t*         pid;
+   int*           fd;         /* coordinator end of the socket pair of each worker */
+   int            wfd;        /* worker end, in a worker */
+} JarShardShm;
+
+static int jar_shard_shm_write( const int fd, const ShardCmdJAR* cmd ) {
+  return (send( fd, cmd, sizeof(ShardCmdJAR), MSG_NOSIGNAL ) == (ssize_t)sizeof(ShardCmdJAR)) ? 0 : -1;
+}
+
+static int jar_shard_shm_read( const int fd, ShardCmdJAR* cmd ) {
+  size_t got = 0;
+
+  while (got < sizeof(ShardCmdJAR)) {
+    ssize_t r = recv( fd, (char*)cmd + got, sizeof(ShardCmdJAR) - got, 0 );
+    if (r < 0 && errno == EINTR) {
+      continue;
+    }
+    if (r <= 0) {
+      return -1;
+    }
+    got += (size_t)r;
+  }
+  return 0;
+}
+
+static void jar_shard_shm_stop( ShardJAR* s ) {
+  JarShardShm* c = (JarShardShm*)s->ctx;
+  ShardCmdJAR cmd;
+  int w;
+
+  for (w=0; w<s->nworkers && c->fd != NULL && c->pid != NULL; ++w) {
+    if (c->fd[w] >= 0) {
+      memset( &cmd, 0, sizeof(cmd) );
+      cmd.op = JAR_SHARD_OP_STOP;
+      if (jar_shard_shm_write( c->fd[w], &cmd ) == 0) jar_shard_shm_read( c->fd[w], &cmd );
+      close( c->fd[w] );
+    }
+    if (c->pid[w] > 0) waitpid( c->pid[w], NULL, 0 );
+  }
+  for (w=0; w<s->nworkers; ++w) {
+    if (s->box[w] != NULL) munmap( s->box[w], s->box_size );
+    s->box[w] = NULL;
+  }
+  free( c->fd );
+  free( c->pid );
+  free( c );
+  s->ctx = NULL;
+}
+
+static int jar_shard_shm_start( ShardJAR* s ) {
+  JarShardShm* c = (JarShardShm*) calloc( 1, sizeof(JarShardShm) );
+  int w, v, mfd, sv[2];
+
+  if (c == NULL) return -1;
+  s->ctx = c;
+  c->pid = (pid_t*) calloc( s->nworkers, sizeof(pid_t) );
+  c->fd = (int*) malloc( s->nworkers*sizeof(int) );
+  c->wfd = -1;
+  if (c->pid == NULL || c->fd == NULL) {
+    jar_shard_shm_stop( s );
+    return -1;
+  }
+  for (w=0; w<s->nworkers; ++w) c->fd[w] = -1;
+
+  for (w=0; w<s->nworkers; ++w) {
+    void* p = MAP_FAILED;
+    mfd = memfd_create( "jar_shard", 0 );
+    if (mfd >= 0 && ftruncate( mfd, (off_t)s->box_size ) == 0) {
+      p = mmap( NULL, s->box_size, PROT_READ | PROT_WRITE, MAP_SHARED, mfd, 0 );
+    }
+    if (mfd >= 0) close( mfd );
+    if (p == MAP_FAILED) {
+      jar_shard_shm_stop( s );
+      return -1;
+    }
+    s->box[w] = (unsigned char*)p;
+  }
+
+  for (w=0; w<s->nworkers; ++w) {
+    if (socketpair( AF_UNIX, SOCK_STREAM, 0, sv ) != 0) {
+      jar_shard_shm_stop( s );
+      return -1;
+    }
+    fflush( stdout );
+    c->pid[w] = fork();
+    if (c->pid[w] == 0) {
+      /* the worker keeps its own mailbox and socket, and gets a pool of its own */
+      PoolJAR* pool = jar_pool_create( s->threads-1, JAR_POOL_SPIN );
+      close( sv[0] );
+      for (v=0; v<w; ++v) close( c->fd[v] );
+      for (v=0; v<s->nworkers; ++v) {
+        if (v != w) munmap( s->box[v], s->box_size );
+      }
+      c->wfd = sv[1];
+      if (pool != NULL) {
+        jar_pool_set_default( pool );
+      } else {
+        jar_pool_serial( 1 );
+      }
+      _exit( jar_shard_worker( s, w ) == 0 ? 0 : 1 );
+    }
+    close( sv[1] );
+    if (c->pid[w] < 0) {
+      close( sv[0] );
+      jar_shard_shm_stop( s );
+      return -1;
+    }
+    c->fd[w] = sv[0];
+  }
+
+  return 0;
+}
+
+static int jar_shard_shm_send( ShardJAR* s, const int w, const ShardCmdJAR* cmd ) {
+/* the in range is in the shared mailbox already */
+  return jar_shard_shm_write( ((JarShardShm*)s->ctx)->fd[w], cmd );
+}
+
+static int jar_shard_shm_recv( ShardJAR* s, const int w, ShardCmdJAR* cmd ) {
+  return jar_shard_shm_read( ((JarShardShm*)s->ctx)->fd[w], cmd );
+}
+
+static int jar_shard_shm_next( ShardJAR* s, const int w, ShardCmdJAR* cmd ) {
+  (void)w;
+  return jar_shard_shm_read( ((JarShardShm*)s->ctx)->wfd, cmd );
+}
+
+static int jar_shard_shm_reply( ShardJAR* s, const int w, const ShardCmdJAR* cmd ) {
+  (void)w;
+  return jar_shard_shm_write( ((JarShardShm*)s->ctx)->wfd, cmd );
+}
+
+const ShardOpsJAR jar_shard_shm = {
+  "shm",
+  jar_shard_shm_start,
+  jar_shard_shm_send,
+  jar_shard_shm_recv,
+  jar_shard_shm_stop,
+  jar_shard_shm_next,
+  jar_shard_shm_reply
+};
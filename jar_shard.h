@@ -0,0 +1,133 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  JAR GEMM sharded over worker processes, a stand-in for scale-out across nodes.
+ *
+ *  jar_shard_create splits the M x K weights A (col-major) over nworkers workers and
+ *  places the slice of each worker in its mailbox, a memory region that the worker
+ *  owns; the coordinator (the calling process) keeps no copy of A. Two splits exist:
+ *
+ *    JAR_SHARD_M   worker w owns rows [p0[w], p0[w+1]) of A and computes those rows of
+ *                  C = A*B with jar_matmul_avx512; the results equal jar_matmul_avx512
+ *    JAR_SHARD_K   worker w owns columns [p0[w], p0[w+1]) of A and accumulates the 
+ *                  product with the same rows of B in an M x N AccJAR of mode acc (see
+ *                  jar_acc.h); the coordinator merges the partial accumulators in the
+ *                  linear domain, in worker order, and converts once to LogPS80. With
+ *                  JAR_ACC_EXACT the results do not depend on the number of workers
+ *
+ *  jar_shard_matmul computes C = A*B for a K x N B with N <= maxn: it writes B, or the
+ *  rows of B of the worker, to each mailbox, runs all workers and collects their
+ *  results. The compute time of each worker is kept in seconds[] for the load balance.
+ *
+ *  The transport is a ShardOpsJAR. The coordinator sends a ShardCmdJAR to a worker 
+ *  together with the bytes [in_off, in_off+in_len) of its mailbox and receives the 
+ *  reply together with the bytes [out_off, out_off+out_len); the worker side mirrors
+ *  this with next and reply. jar_shard_shm forks the workers and maps the mailboxes
+ *  as shared memory (memfd), so only the commands go through pipes and the ranges are
+ *  not copied. A transport across nodes (MPI, sockets) would run jar_shard_worker on
+ *  each node with the same parameters and move the ranges as messages.
+ *
+ *  Forked workers do not use the thread pool inherited from the coordinator but make
+ *  their own pool of threads threads (threads-1 workers); jar_shard_create must not be
+ *  called while a parallel loop runs. Functions returning int return 0 on success and
+ *  -1 on an error.
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_SHARD
+
+#define JAR_SHARD
+#include <stddef.h>
+#include "jar_sim.h"
+#include "jar_acc.h"
+
+#define JAR_SHARD_M           0
+#define JAR_SHARD_K           1
+
+#define JAR_SHARD_OP_LOAD     1
+#define JAR_SHARD_OP_MATMUL   2
+#define JAR_SHARD_OP_STOP     3
+
+/* slices of JAR_SHARD_M are multiples of this number of rows where possible */
+#define JAR_SHARD_ALIGN       16
+
+typedef struct ShardJAR ShardJAR;
+
+typedef struct{
+   int            op;
+   int            N;
+   int            status;     /* reply: 0 or -1 */
+   double         seconds;    /* reply: compute time of the worker */
+   size_t         in_off;     /* mailbox bytes written by the coordinator */
+   size_t         in_len;
+   size_t         out_off;    /* mailbox bytes written by the worker */
+   size_t         out_len;
+} ShardCmdJAR;
+
+typedef struct{
+   const char*    name;
+   /* coordinator: creates the mailboxes box[w] of box_size bytes and starts the workers */
+   int            (*start)( ShardJAR* s );
+   int            (*send)( ShardJAR* s, const int w, const ShardCmdJAR* cmd );
+   int            (*recv)( ShardJAR* s, const int w, ShardCmdJAR* cmd );
+   /* coordinator: ends the workers and frees the mailboxes */
+   void           (*stop)( ShardJAR* s );
+   /* worker w */
+   int            (*next)( ShardJAR* s, const int w, ShardCmdJAR* cmd );
+   int            (*reply)( ShardJAR* s, const int w, const ShardCmdJAR* cmd );
+} ShardOpsJAR;
+
+struct ShardJAR{
+   const ShardOpsJAR*  ops;
+   void*          ctx;        /* state of the transport */
+   int            nworkers;
+   int            threads;    /* threads per worker */
+   int            split;
+   int            acc;        /* accumulator mode of JAR_SHARD_K */
+   int            M;
+   int            K;
+   int            maxn;
+   int*           p0;         /* first row or column of A of each worker, nworkers+1 entries */
+   size_t         box_size;
+   unsigned char** box;       /* mailbox of each worker */
+   double*        seconds;    /* compute time of each worker in the last jar_shard_matmul */
+};
+
+extern const ShardOpsJAR jar_shard_shm;
+
+int  jar_shard_create( ShardJAR* s, const ShardOpsJAR* ops, const int nworkers, const int threads, const int split, const int acc,
+                       const int M, const int K, const int maxn, const UniJAR* A );
+int  jar_shard_matmul( ShardJAR* s, const int N, const UniJAR* B, UniJAR* C );
+int  jar_shard_worker( ShardJAR* s, const int w );
+void jar_shard_destroy( ShardJAR* s );
+
+#endif
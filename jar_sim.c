@@ -32,6 +32,9 @@
 #include <stdio.h>
 #include <math.h>
 #include "jar_sim.h"
+#include "jar_pool.h"
+#include "jar_trace.h"
+#include "jar_numstat.h"
 
 #define  DEBUG_sim  0
 
@@ -100,6 +103,33 @@ non-zero within range sum.
 
 }
 
+UniJAR LinFP32_2_LogPS80_rnd( UniJAR x, const RndJAR* rnd, const size_t idx ) {
+/*
+LinFP32_2_LogPS80 with a selectable rounding mode for the final rounding to PS80 precision
+(step (3) above). rnd == NULL or rnd->mode == JAR_RND_NEAREST gives LinFP32_2_LogPS80.
+For JAR_RND_STOCHASTIC the random bits of the element with index idx are generated by
+Philox4x32-10 as described in jar_type.h. Steps (1) and (2) are unchanged.
+*/
+   UniJAR y, z;
+   unsigned int ctr[4];
+   int    i;
+
+   if (rnd == NULL || rnd->mode == JAR_RND_NEAREST) {
+      return LinFP32_2_LogPS80( x );
+   }
+
+   y = rnd_2_L_frac( x, LOG2_IND_BITS );
+   i = (y.I & FRAC_MASK) >> LOG2_IND_SHIFT;
+   z = log2_tbl[i];
+   y.I &= CLEAR_FRAC; y.I |= z.I;
+
+   ctr[0] = (unsigned int)idx;
+   ctr[1] = (unsigned int)((unsigned long long)idx >> 32);
+   ctr[2] = rnd->ctr[0];
+   ctr[3] = rnd->ctr[1];
+   return rnd_2_PS80_sr( y, philox4x32_10( ctr, rnd->key ) );
+}
+
 UniJAR LogPS80_2_LinFP32( UniJAR x ) {
 /*
 Input is in the logarithmic domain with range and precision 
@@ -181,50 +211,86 @@ void jar_fma( const UniJAR* a, const UniJAR* b, UniJAR* c ) {
 }
 
 #if defined(__AVX512F__)
-__m512i jar_fma_avx512( const __m512i a, const __m512i b, const __m512i c ) {
-#if 0
-  __m512i y;
-
-  UniJAR tmpa[16];
-  UniJAR tmpb[16];
-  UniJAR tmpc[16];
-  int i;
+__m512i sum2_LogPS80_avx512( const __m512i x, const __m512i y ) {
+/* 16-wide version of sum2_LogPS80 */
+  __m512i sign_z;
+  __m512i z;
 
-  _mm512_storeu_epi32( tmpa, a );
-  _mm512_storeu_epi32( tmpb, b );
-  _mm512_storeu_epi32( tmpc, c );
+  sign_z = _mm512_add_epi32( _mm512_and_epi32( x, _mm512_set1_epi32( SIGN_MASK ) ), _mm512_and_epi32( y, _mm512_set1_epi32( SIGN_MASK ) ) );
+  z = _mm512_add_epi32( _mm512_add_epi32( x, y ), _mm512_set1_epi32( 0X40800000 ) );
+  z = _mm512_or_epi32( _mm512_and_epi32( z, _mm512_set1_epi32( CLEAR_SIGN ) ), sign_z );
 
-  for ( i = 0; i < 16; i++ ) {
-    jar_fma( tmpa+i, tmpb+i, tmpc+i );
-  }
+  return z;
+}
 
-  y = _mm512_loadu_epi32( tmpc );
-#else
-  __m512i sign_z;
-  __m512i z;
+__m512i LogPS80_2_LinFP32_avx512( const __m512i x ) {
+/* 16-wide version of LogPS80_2_LinFP32 */
   __m512i i;
   __m512i y;
-  __m512i x;
-
-  /* "sum2_LogPS80 function */
-  sign_z = _mm512_add_epi32( _mm512_and_epi32( a, _mm512_set1_epi32( SIGN_MASK ) ), _mm512_and_epi32( b, _mm512_set1_epi32( SIGN_MASK ) ) );
-  z = _mm512_add_epi32( _mm512_add_epi32( a, b ), _mm512_set1_epi32( 0X40800000 ) );
-  z = _mm512_or_epi32( _mm512_and_epi32( z, _mm512_set1_epi32( CLEAR_SIGN ) ), sign_z );
+  __m512i z;
 
-  /* "LogPS80_2_LinFP32" function */
-  x = z;
   i = _mm512_srai_epi32( _mm512_and_epi32( x, _mm512_set1_epi32( FRAC_MASK ) ), EXP2_IND_SHIFT );
   z = _mm512_i32gather_epi32( i, exp2_tbl, 4 );
   y = _mm512_and_epi32( x, _mm512_set1_epi32( CLEAR_FRAC ) );
   y = _mm512_or_epi32( y, z );
 
-  /* let's do fp32 add to c of y */
-  y = _mm512_castps_si512( _mm512_add_ps( _mm512_castsi512_ps(c), _mm512_castsi512_ps(y) ) );
+  return y;
+}
+
+__m512i LinFP32_2_LogPS80_avx512( const __m512i x ) {
+/* 16-wide version of LinFP32_2_LogPS80, see the scalar code for the three steps */
+  __m512i i;
+  __m512i y;
+  __m512i z;
+
+  y = rnd_2_L_frac_avx512( x, LOG2_IND_BITS );
+  i = _mm512_srai_epi32( _mm512_and_epi32( y, _mm512_set1_epi32( FRAC_MASK ) ), LOG2_IND_SHIFT );
+  z = _mm512_i32gather_epi32( i, log2_tbl, 4 );
+  y = _mm512_and_epi32( y, _mm512_set1_epi32( CLEAR_FRAC ) );
+  y = _mm512_or_epi32( y, z );
+
+  return rnd_2_PS80_avx512( y );
+}
 #endif
-  return y; 
+
+#if defined(__AVX512F__)
+__m512i LinFP32_2_LogPS80_rnd_avx512( const __m512i x, const RndJAR* rnd, const size_t idx ) {
+/* 16-wide version of LinFP32_2_LogPS80_rnd, the lanes have the indices idx, ..., idx+15 */
+  __m512i i;
+  __m512i y;
+  __m512i z;
+  __m512i lo, hi;
+
+  if (rnd == NULL || rnd->mode == JAR_RND_NEAREST) {
+    return LinFP32_2_LogPS80_avx512( x );
+  }
+
+  y = rnd_2_L_frac_avx512( x, LOG2_IND_BITS );
+  i = _mm512_srai_epi32( _mm512_and_epi32( y, _mm512_set1_epi32( FRAC_MASK ) ), LOG2_IND_SHIFT );
+  z = _mm512_i32gather_epi32( i, log2_tbl, 4 );
+  y = _mm512_and_epi32( y, _mm512_set1_epi32( CLEAR_FRAC ) );
+  y = _mm512_or_epi32( y, z );
+
+  /* 64-bit lane indices split into the two low counter words */
+  lo = _mm512_add_epi32( _mm512_set1_epi32( (unsigned int)idx ),
+                         _mm512_set_epi32( 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 ) );
+  hi = _mm512_set1_epi32( (unsigned int)((unsigned long long)idx >> 32) );
+  hi = _mm512_mask_add_epi32( hi, _mm512_cmplt_epu32_mask( lo, _mm512_set1_epi32( (unsigned int)idx ) ), hi, _mm512_set1_epi32( 1 ) );
+  z = philox4x32_10_avx512( lo, hi, _mm512_set1_epi32( rnd->ctr[0] ), _mm512_set1_epi32( rnd->ctr[1] ), rnd->key );
+
+  return rnd_2_PS80_sr_avx512( y, z );
 }
 #endif
 
+static void jar_sim_numstat( const size_t n, const UniJAR* x ) {
+/* counts the numerical events of n accumulators about to be converted */
+  NumStatJAR s;
+
+  jar_numstat_init( &s );
+  jar_numstat_scan( &s, n, x );
+  jar_numstat_add( jar_numstat_current(), &s );
+}
+
 UniJAR jar_dotprod( const int n, const UniJAR* x, const UniJAR* y ) {
 /* 
 compute n-length dotprod in JAR. In particular, inputs x[], y[] and output are LogPS80 
@@ -239,6 +305,7 @@ are not necessarily exact.
    int    i;
 
    assert (n >= 0);
+   JAR_TRACE_BEGIN( t );
    z.I = JAR_ZERO;
    for (i=0; i<n; i++) {
 #if  1
@@ -249,7 +316,9 @@ are not necessarily exact.
      z.F += w.F;
 #endif
    }
+   if (JAR_NUMSTAT_ON()) jar_sim_numstat( 1, &z );
    z = LinFP32_2_LogPS80( z );
+   JAR_TRACE_END( t, JAR_TK_DOTPROD, JAR_TP_COMPUTE, 8*(size_t)n, 2*(size_t)n );
    return z;
 }
 
@@ -268,6 +337,7 @@ are not necessarily exact. Matrix A is in col-major format.
 
   assert (M >= 0);
   assert (K >= 0);
+  JAR_TRACE_BEGIN( t );
 
   /* let's set result to JAR_ZERO */
   for (m=0; m<M; ++m) {
@@ -281,10 +351,70 @@ are not necessarily exact. Matrix A is in col-major format.
     }
   }
 
+  JAR_TRACE_END( t, JAR_TK_MATVECMUL, JAR_TP_COMPUTE, 4*((size_t)M*K + K + M), 2*(size_t)M*K );
+
   /* let convert to LogPS80 after accumulation */
+  JAR_TRACE_BEGIN( te );
+  if (JAR_NUMSTAT_ON()) jar_sim_numstat( (size_t)M, c );
   for (m=0; m<M; ++m) {
     c[m] = LinFP32_2_LogPS80( c[m] );
   }
+  JAR_TRACE_END( te, JAR_TK_MATVECMUL, JAR_TP_EPILOGUE, 8*(size_t)M, 0 );
+}
+
+typedef struct{
+   int             M;
+   int             K;
+   const UniJAR*   A;
+   const UniJAR*   b;
+   UniJAR*         c;
+   int             tag;      /* numerical event tag, -1 when not counting */
+} JarMatvecArg;
+
+static void jar_matvec_task( void* arg, const int t ) {
+/* rows t*JAR_MATVEC_MC ... of jar_matvecmul_avx512 */
+  const JarMatvecArg* a = (const JarMatvecArg*)arg;
+  const int M = a->M, K = a->K;
+  const int m0 = t*JAR_MATVEC_MC;
+  const int m1 = (m0+JAR_MATVEC_MC < M) ? m0+JAR_MATVEC_MC : M;
+  UniJAR* c = a->c;
+  NumStatJAR s;
+  int    m, mr, k;
+
+  /* let's set result to JAR_ZERO */
+  for (m=m0; m<m1; ++m) {
+    c[m].I = JAR_ZERO;
+  }
+
+  /* let's perform a matrix vector multiplication */
+  m = m0;
+#if defined(__AVX512F__)
+  for ( ; m+16<=m1; m+=16) {
+    __m512i vc = _mm512_loadu_epi32( c+m );
+    for (k=0; k<K; ++k) {
+      __m512i va = _mm512_loadu_epi32( a->A+((size_t)k*M)+m );
+      __m512i vb = _mm512_set1_epi32( a->b[k].I );
+      vc = jar_fma_avx512( va, vb, vc );
+    }
+    _mm512_storeu_epi32( c+m, vc );
+  }
+#endif
+  mr = m;
+  for (k=0; k<K; ++k) {
+    for (m=mr; m<m1; ++m) {
+      jar_fma( a->A+((size_t)k*M)+m, a->b+k, c+m );
+    }
+  }
+
+  /* let convert to LogPS80 after accumulation */
+  if (a->tag >= 0) {
+    jar_numstat_init( &s );
+    jar_numstat_scan( &s, (size_t)(m1-m0), c+m0 );
+    jar_numstat_add( a->tag, &s );
+  }
+  for (m=m0; m<m1; ++m) {
+    c[m] = LinFP32_2_LogPS80( c[m] );
+  }
 }
 
 void jar_matvecmul_avx512( const int M, const int K, const UniJAR* A, const UniJAR* b, UniJAR* c ) {
@@ -292,52 +422,186 @@ void jar_matvecmul_avx512( const int M, const int K, const UniJAR* A, const UniJ
 compute matrix-vector product in JAR. In particular, inputs A[][], b[] and output c[] are LogPS80 
 but accumulation of products are done in linear domain. The additions of LogPS80 quantities
 and also accumulation of LinFP32 numbers are exact; but conversion between the two domains
-are not necessarily exact. Matrix A is in col-major format. 
+are not necessarily exact. Matrix A is in col-major format. Slices of JAR_MATVEC_MC rows are
+tasks of the JAR thread pool.
+*/
+  JarMatvecArg a;
+
+  assert (M >= 0);
+  assert (K >= 0);
+  JAR_TRACE_BEGIN( t );
+
+  a.M = M; a.K = K; a.A = A; a.b = b; a.c = c;
+  a.tag = JAR_NUMSTAT_ON() ? jar_numstat_current() : -1;
+  jar_parallel_for( (M + JAR_MATVEC_MC - 1)/JAR_MATVEC_MC, jar_matvec_task, &a );
+  JAR_TRACE_END( t, JAR_TK_MATVECMUL, JAR_TP_COMPUTE, 4*((size_t)M*K + K + M), 2*(size_t)M*K );
+}
+
+
+void jar_matvecacc( const int M, const int K, const UniJAR* A, const int lda, const UniJAR* b, UniJAR* c ) {
+/* 
+accumulate a matrix-vector product in JAR: c += A*b. Inputs A[][] and b[] are LogPS80 while
+c[] is a linear domain (LinFP32) accumulator that is neither initialized nor converted back 
+to LogPS80 here. This lets callers continue an accumulation over several calls, e.g. over
+the blocks of a concatenated input vector, and convert only once at the end. 
+Matrix A is in col-major format with leading dimension lda >= M.
 */
-#if 0
-  UniJAR w;
-#endif
   int    m, k;
 
   assert (M >= 0);
   assert (K >= 0);
+  assert (lda >= M);
+  JAR_TRACE_BEGIN( t );
 
-  /* let's set result to JAR_ZERO */
-  for (m=0; m<M; ++m) {
-    c[m].I = JAR_ZERO;
+  for (k=0; k<K; ++k) {
+    for ( m=0; m<M ; ++m ) {
+      jar_fma( A+(k*lda)+m, b+k, c+m );
+    }
   }
+  JAR_TRACE_END( t, JAR_TK_MATVECACC, JAR_TP_COMPUTE, 4*((size_t)M*K + K + 2*(size_t)M), 2*(size_t)M*K );
+}
 
-  /* let's perform a matrix vector multiplication */
+void jar_matvecacc_avx512( const int M, const int K, const UniJAR* A, const int lda, const UniJAR* b, UniJAR* c ) {
+/* 
+accumulate a matrix-vector product in JAR: c += A*b, see jar_matvecacc. Four independent
+16-wide accumulators are kept in flight to hide the latency of the FP32 adds.
+*/
+  int    m, k;
+
+  assert (M >= 0);
+  assert (K >= 0);
+  assert (lda >= M);
+  JAR_TRACE_BEGIN( t );
+
+  m = 0;
 #if defined(__AVX512F__)
-  for (m=0; m<(M/16)*16; m+=16) {
+  for ( ; m<(M/64)*64; m+=64) {
+    __m512i vc0 = _mm512_loadu_epi32( c+m );
+    __m512i vc1 = _mm512_loadu_epi32( c+m+16 );
+    __m512i vc2 = _mm512_loadu_epi32( c+m+32 );
+    __m512i vc3 = _mm512_loadu_epi32( c+m+48 );
+    for (k=0; k<K; ++k) {
+      __m512i vb = _mm512_set1_epi32( b[k].I );
+      vc0 = jar_fma_avx512( _mm512_loadu_epi32( A+(k*lda)+m ), vb, vc0 );
+      vc1 = jar_fma_avx512( _mm512_loadu_epi32( A+(k*lda)+m+16 ), vb, vc1 );
+      vc2 = jar_fma_avx512( _mm512_loadu_epi32( A+(k*lda)+m+32 ), vb, vc2 );
+      vc3 = jar_fma_avx512( _mm512_loadu_epi32( A+(k*lda)+m+48 ), vb, vc3 );
+    }
+    _mm512_storeu_epi32( c+m, vc0 );
+    _mm512_storeu_epi32( c+m+16, vc1 );
+    _mm512_storeu_epi32( c+m+32, vc2 );
+    _mm512_storeu_epi32( c+m+48, vc3 );
+  }
+  for ( ; m<(M/16)*16; m+=16) {
     __m512i vc = _mm512_loadu_epi32( c+m );
     for (k=0; k<K; ++k) {
-      __m512i va = _mm512_loadu_epi32( A+(k*M)+m );
+      __m512i va = _mm512_loadu_epi32( A+(k*lda)+m );
       __m512i vb = _mm512_set1_epi32( b[k].I );
       vc = jar_fma_avx512( va, vb, vc );
     }
     _mm512_storeu_epi32( c+m, vc );
   }
+#endif
   for (   ; m<M        ; ++m ) {
     for (k=0; k<K; ++k) {
-      jar_fma( A+(k*M)+m, b+k, c+m );
+      jar_fma( A+(k*lda)+m, b+k, c+m );
     }
   }
-#else
+  JAR_TRACE_END( t, JAR_TK_MATVECACC, JAR_TP_COMPUTE, 4*((size_t)M*K + K + 2*(size_t)M), 2*(size_t)M*K );
+}
+
+void jar_matmulacc( const int M, const int N, const int K, const UniJAR* A, const int lda, const UniJAR* B, const int ldb, UniJAR* C, const int ldc ) {
+/* 
+accumulate a matrix-matrix product in JAR: C += A*B. Inputs A[][] and B[][] are LogPS80 while
+C[][] is a linear domain (LinFP32) accumulator that is neither initialized nor converted back
+to LogPS80 here, see jar_matvecacc. This lets callers accumulate over blocks of K.
+All matrices are in col-major format with leading dimensions lda >= M, ldb >= K, ldc >= M.
+*/
+  int    m, n, k;
+
+  assert (M >= 0);
+  assert (N >= 0);
+  assert (K >= 0);
+  assert (lda >= M && ldb >= K && ldc >= M);
+  JAR_TRACE_BEGIN( t );
+
   for (k=0; k<K; ++k) {
-    for ( m=0; m<M ; ++m ) {
-      jar_fma( A+(k*M)+m, b+k, c+m );
+    for (n=0; n<N; ++n) {
+      for (m=0; m<M; ++m) {
+        jar_fma( A+(k*lda)+m, B+(n*ldb)+k, C+(n*ldc)+m );
+      }
+    }
+  }
+  JAR_TRACE_END( t, JAR_TK_MATMULACC, JAR_TP_COMPUTE, 4*((size_t)M*K + (size_t)K*N + 2*(size_t)M*N), 2*(size_t)M*N*K );
+}
+
+void jar_matmulacc_avx512( const int M, const int N, const int K, const UniJAR* A, const int lda, const UniJAR* B, const int ldb, UniJAR* C, const int ldc ) {
+/* 
+16x8 register-blocked version of jar_matmulacc, the products of each element are added
+in the same order as in jar_matmulacc
+*/
+  int    m, n, k, mr;
+
+  assert (M >= 0);
+  assert (N >= 0);
+  assert (K >= 0);
+  assert (lda >= M && ldb >= K && ldc >= M);
+  JAR_TRACE_BEGIN( t );
+
+  m = 0;
+#if defined(__AVX512F__)
+  for ( m=0; m<(M/16)*16; m+=16 ) {
+    for ( n=0; n<(N/8)*8; n+=8 ) {
+      __m512i vc0 = _mm512_loadu_epi32( C+((n+0)*ldc)+m );
+      __m512i vc1 = _mm512_loadu_epi32( C+((n+1)*ldc)+m );
+      __m512i vc2 = _mm512_loadu_epi32( C+((n+2)*ldc)+m );
+      __m512i vc3 = _mm512_loadu_epi32( C+((n+3)*ldc)+m );
+      __m512i vc4 = _mm512_loadu_epi32( C+((n+4)*ldc)+m );
+      __m512i vc5 = _mm512_loadu_epi32( C+((n+5)*ldc)+m );
+      __m512i vc6 = _mm512_loadu_epi32( C+((n+6)*ldc)+m );
+      __m512i vc7 = _mm512_loadu_epi32( C+((n+7)*ldc)+m );
+      for (k=0; k<K; ++k) {
+        __m512i va  = _mm512_loadu_epi32( A+(k*lda)+m );
+        vc0 = jar_fma_avx512( va, _mm512_set1_epi32( B[((n+0)*ldb)+k].I ), vc0 );
+        vc1 = jar_fma_avx512( va, _mm512_set1_epi32( B[((n+1)*ldb)+k].I ), vc1 );
+        vc2 = jar_fma_avx512( va, _mm512_set1_epi32( B[((n+2)*ldb)+k].I ), vc2 );
+        vc3 = jar_fma_avx512( va, _mm512_set1_epi32( B[((n+3)*ldb)+k].I ), vc3 );
+        vc4 = jar_fma_avx512( va, _mm512_set1_epi32( B[((n+4)*ldb)+k].I ), vc4 );
+        vc5 = jar_fma_avx512( va, _mm512_set1_epi32( B[((n+5)*ldb)+k].I ), vc5 );
+        vc6 = jar_fma_avx512( va, _mm512_set1_epi32( B[((n+6)*ldb)+k].I ), vc6 );
+        vc7 = jar_fma_avx512( va, _mm512_set1_epi32( B[((n+7)*ldb)+k].I ), vc7 );
+      }
+      _mm512_storeu_epi32( C+((n+0)*ldc)+m, vc0 );
+      _mm512_storeu_epi32( C+((n+1)*ldc)+m, vc1 );
+      _mm512_storeu_epi32( C+((n+2)*ldc)+m, vc2 );
+      _mm512_storeu_epi32( C+((n+3)*ldc)+m, vc3 );
+      _mm512_storeu_epi32( C+((n+4)*ldc)+m, vc4 );
+      _mm512_storeu_epi32( C+((n+5)*ldc)+m, vc5 );
+      _mm512_storeu_epi32( C+((n+6)*ldc)+m, vc6 );
+      _mm512_storeu_epi32( C+((n+7)*ldc)+m, vc7 );
+    }
+    for (    ; n<N ; ++n ) {
+      __m512i vc0 = _mm512_loadu_epi32( C+(n*ldc)+m );
+      for (k=0; k<K; ++k) {
+        __m512i va  = _mm512_loadu_epi32( A+(k*lda)+m );
+        vc0 = jar_fma_avx512( va, _mm512_set1_epi32( B[(n*ldb)+k].I ), vc0 );
+      }
+      _mm512_storeu_epi32( C+(n*ldc)+m, vc0 );
     }
   }
 #endif
 
-  /* let convert to LogPS80 after accumulation */
-  for (m=0; m<M; ++m) {
-    c[m] = LinFP32_2_LogPS80( c[m] );
+  /* remaining rows (all rows without AVX512) */
+  for (n=0; n<N; ++n) {
+    for (k=0; k<K; ++k) {
+      for (mr=m; mr<M; ++mr) {
+        jar_fma( A+(k*lda)+mr, B+(n*ldb)+k, C+(n*ldc)+mr );
+      }
+    }
   }
+  JAR_TRACE_END( t, JAR_TK_MATMULACC, JAR_TP_COMPUTE, 4*((size_t)M*K + (size_t)K*N + 2*(size_t)M*N), 2*(size_t)M*N*K );
 }
 
-
 void jar_matmul( const int M, const int N, const int K, const UniJAR* A, const UniJAR* B, UniJAR* C ) {
 /* 
 compute matrix-vector product in JAR. In particular, inputs A[][], B[][] and output C[][] are LogPS80 
@@ -353,6 +617,7 @@ are not necessarily exact. All matrices are in col-major format.
   assert (M >= 0);
   assert (M >= 0);
   assert (K >= 0);
+  JAR_TRACE_BEGIN( t );
 
   /* let's set result to JAR_ZERO */
   for (m=0; m<M*N; ++m) {
@@ -374,10 +639,15 @@ are not necessarily exact. All matrices are in col-major format.
     }
   }
 
+  JAR_TRACE_END( t, JAR_TK_MATMUL, JAR_TP_COMPUTE, 4*((size_t)M*K + (size_t)K*N + (size_t)M*N), 2*(size_t)M*N*K );
+
   /* let convert to LogPS80 after accumulation */
+  JAR_TRACE_BEGIN( te );
+  if (JAR_NUMSTAT_ON()) jar_sim_numstat( (size_t)M*N, C );
   for (m=0; m<M*N; ++m) {
     C[m] = LinFP32_2_LogPS80( C[m] );
   }
+  JAR_TRACE_END( te, JAR_TK_MATMUL, JAR_TP_EPILOGUE, 8*(size_t)M*N, 0 );
 }
 
 
@@ -387,99 +657,503 @@ compute matrix-vector product in JAR. In particular, inputs A[][], B[][] and out
 but accumulation of products are done in linear domain. The additions of LogPS80 quantities
 and also accumulation of LinFP32 numbers are exact; but conversion between the two domains
 are not necessarily exact. All matrices are in col-major format. 
+This is jar_matmul_rnd_avx512 with round-to-nearest conversion.
 */
-#if 0
-  UniJAR w;
-#endif
-  int    m, n, k;
+  jar_matmul_rnd_avx512( M, N, K, A, B, C, NULL );
+}
 
-  assert (M >= 0);
-  assert (M >= 0);
-  assert (K >= 0);
+typedef struct{
+   int             M;
+   int             N;
+   int             K;
+   const UniJAR*   A;
+   const UniJAR*   B;
+   UniJAR*         C;
+   const RndJAR*   rnd;
+   int             tm;       /* tasks along M */
+   int             tag;      /* numerical event tag, -1 when not counting */
+} JarMatmulArg;
 
-  /* let's set result to JAR_ZERO */
-  for (m=0; m<M*N; ++m) {
-    C[m].I = JAR_ZERO;
-  }
+static void jar_matmul_task( void* arg, const int t ) {
+/* 
+the JAR_MATMUL_MC x JAR_MATMUL_NC tile t of jar_matmul_rnd_avx512: 16x8 register blocks, 
+then single columns, then the rows below 16 (in the last tile along M only)
+*/
+  const JarMatmulArg* a = (const JarMatmulArg*)arg;
+  const int M = a->M, K = a->K;
+  const UniJAR* A = a->A;
+  const UniJAR* B = a->B;
+  UniJAR* C = a->C;
+  const RndJAR* rnd = a->rnd;
+  const int ns = (a->tag >= 0);
+  const int m0 = (t % a->tm)*JAR_MATMUL_MC, n0 = (t / a->tm)*JAR_MATMUL_NC;
+  const int m1 = (m0+JAR_MATMUL_MC < M) ? m0+JAR_MATMUL_MC : M;
+  const int n1 = (n0+JAR_MATMUL_NC < a->N) ? n0+JAR_MATMUL_NC : a->N;
+  NumStatJAR s;
+  int    m, n, k, mr;
+#if defined(__AVX512F__)
+  NumVecJAR nv;
 
+  jar_numstat_vec_init( &nv );
+#endif
+
+  m = m0;
 #if defined(__AVX512F__)
   /* let's perform a matrix matrix multiplication */
-  for ( m=0; m<(M/16)*16; m+=16 ) {
-    for ( n=0; n<(N/8)*8; n+=8 ) {
-      __m512i vc0 = _mm512_loadu_epi32( C+((n+0)*M)+m );
-      __m512i vc1 = _mm512_loadu_epi32( C+((n+1)*M)+m );
-      __m512i vc2 = _mm512_loadu_epi32( C+((n+2)*M)+m );
-      __m512i vc3 = _mm512_loadu_epi32( C+((n+3)*M)+m );
-      __m512i vc4 = _mm512_loadu_epi32( C+((n+4)*M)+m );
-      __m512i vc5 = _mm512_loadu_epi32( C+((n+5)*M)+m );
-      __m512i vc6 = _mm512_loadu_epi32( C+((n+6)*M)+m );
-      __m512i vc7 = _mm512_loadu_epi32( C+((n+7)*M)+m );
+  for ( m=m0; m+16<=m1; m+=16 ) {
+    for ( n=n0; n+8<=n1; n+=8 ) {
+      __m512i vc0 = _mm512_set1_epi32( JAR_ZERO );
+      __m512i vc1 = _mm512_set1_epi32( JAR_ZERO );
+      __m512i vc2 = _mm512_set1_epi32( JAR_ZERO );
+      __m512i vc3 = _mm512_set1_epi32( JAR_ZERO );
+      __m512i vc4 = _mm512_set1_epi32( JAR_ZERO );
+      __m512i vc5 = _mm512_set1_epi32( JAR_ZERO );
+      __m512i vc6 = _mm512_set1_epi32( JAR_ZERO );
+      __m512i vc7 = _mm512_set1_epi32( JAR_ZERO );
       for (k=0; k<K; ++k) {
-        __m512i va  = _mm512_loadu_epi32( A+(k*M)+m );
-        __m512i vb0 = _mm512_set1_epi32( B[((n+0)*K)+k].I );
+        __m512i va  = _mm512_loadu_epi32( A+((size_t)k*M)+m );
+        __m512i vb0 = _mm512_set1_epi32( B[((size_t)(n+0)*K)+k].I );
         vc0 = jar_fma_avx512( va, vb0, vc0 );
-        __m512i vb1 = _mm512_set1_epi32( B[((n+1)*K)+k].I );
+        __m512i vb1 = _mm512_set1_epi32( B[((size_t)(n+1)*K)+k].I );
         vc1 = jar_fma_avx512( va, vb1, vc1 );
-        __m512i vb2 = _mm512_set1_epi32( B[((n+2)*K)+k].I );
+        __m512i vb2 = _mm512_set1_epi32( B[((size_t)(n+2)*K)+k].I );
         vc2 = jar_fma_avx512( va, vb2, vc2 );
-        __m512i vb3 = _mm512_set1_epi32( B[((n+3)*K)+k].I );
+        __m512i vb3 = _mm512_set1_epi32( B[((size_t)(n+3)*K)+k].I );
         vc3 = jar_fma_avx512( va, vb3, vc3 );
-        __m512i vb4 = _mm512_set1_epi32( B[((n+4)*K)+k].I );
+        __m512i vb4 = _mm512_set1_epi32( B[((size_t)(n+4)*K)+k].I );
         vc4 = jar_fma_avx512( va, vb4, vc4 );
-        __m512i vb5 = _mm512_set1_epi32( B[((n+5)*K)+k].I );
+        __m512i vb5 = _mm512_set1_epi32( B[((size_t)(n+5)*K)+k].I );
         vc5 = jar_fma_avx512( va, vb5, vc5 );
-        __m512i vb6 = _mm512_set1_epi32( B[((n+6)*K)+k].I );
+        __m512i vb6 = _mm512_set1_epi32( B[((size_t)(n+6)*K)+k].I );
         vc6 = jar_fma_avx512( va, vb6, vc6 );
-        __m512i vb7 = _mm512_set1_epi32( B[((n+7)*K)+k].I );
+        __m512i vb7 = _mm512_set1_epi32( B[((size_t)(n+7)*K)+k].I );
         vc7 = jar_fma_avx512( va, vb7, vc7 );
       }
-      _mm512_storeu_epi32( C+((n+0)*M)+m, vc0 );
-      _mm512_storeu_epi32( C+((n+1)*M)+m, vc1 );
-      _mm512_storeu_epi32( C+((n+2)*M)+m, vc2 );
-      _mm512_storeu_epi32( C+((n+3)*M)+m, vc3 );
-      _mm512_storeu_epi32( C+((n+4)*M)+m, vc4 );
-      _mm512_storeu_epi32( C+((n+5)*M)+m, vc5 );
-      _mm512_storeu_epi32( C+((n+6)*M)+m, vc6 );
-      _mm512_storeu_epi32( C+((n+7)*M)+m, vc7 );
+      /* let convert to LogPS80 after accumulation, while still in registers */
+      if (ns) {
+        jar_numstat_vec( &nv, vc0 ); jar_numstat_vec( &nv, vc1 ); jar_numstat_vec( &nv, vc2 ); jar_numstat_vec( &nv, vc3 );
+        jar_numstat_vec( &nv, vc4 ); jar_numstat_vec( &nv, vc5 ); jar_numstat_vec( &nv, vc6 ); jar_numstat_vec( &nv, vc7 );
+      }
+      _mm512_storeu_epi32( C+((size_t)(n+0)*M)+m, LinFP32_2_LogPS80_rnd_avx512( vc0, rnd, ((size_t)(n+0)*M)+m ) );
+      _mm512_storeu_epi32( C+((size_t)(n+1)*M)+m, LinFP32_2_LogPS80_rnd_avx512( vc1, rnd, ((size_t)(n+1)*M)+m ) );
+      _mm512_storeu_epi32( C+((size_t)(n+2)*M)+m, LinFP32_2_LogPS80_rnd_avx512( vc2, rnd, ((size_t)(n+2)*M)+m ) );
+      _mm512_storeu_epi32( C+((size_t)(n+3)*M)+m, LinFP32_2_LogPS80_rnd_avx512( vc3, rnd, ((size_t)(n+3)*M)+m ) );
+      _mm512_storeu_epi32( C+((size_t)(n+4)*M)+m, LinFP32_2_LogPS80_rnd_avx512( vc4, rnd, ((size_t)(n+4)*M)+m ) );
+      _mm512_storeu_epi32( C+((size_t)(n+5)*M)+m, LinFP32_2_LogPS80_rnd_avx512( vc5, rnd, ((size_t)(n+5)*M)+m ) );
+      _mm512_storeu_epi32( C+((size_t)(n+6)*M)+m, LinFP32_2_LogPS80_rnd_avx512( vc6, rnd, ((size_t)(n+6)*M)+m ) );
+      _mm512_storeu_epi32( C+((size_t)(n+7)*M)+m, LinFP32_2_LogPS80_rnd_avx512( vc7, rnd, ((size_t)(n+7)*M)+m ) );
     }
-    for (    ; n<N ; ++n ) {
-      __m512i vc0 = _mm512_loadu_epi32( C+((n+0)*M)+m );
+    for (    ; n<n1 ; ++n ) {
+      __m512i vc0 = _mm512_set1_epi32( JAR_ZERO );
       for (k=0; k<K; ++k) {
-        __m512i va  = _mm512_loadu_epi32( A+(k*M)+m );
-        __m512i vb0 = _mm512_set1_epi32( B[((n+0)*K)+k].I );
+        __m512i va  = _mm512_loadu_epi32( A+((size_t)k*M)+m );
+        __m512i vb0 = _mm512_set1_epi32( B[((size_t)n*K)+k].I );
         vc0 = jar_fma_avx512( va, vb0, vc0 );
       }
-      _mm512_storeu_epi32( C+((n+0)*M)+m, vc0 );
+      if (ns) jar_numstat_vec( &nv, vc0 );
+      _mm512_storeu_epi32( C+((size_t)n*M)+m, LinFP32_2_LogPS80_rnd_avx512( vc0, rnd, ((size_t)n*M)+m ) );
     }
   }
-  for (k=0; k<K; ++k) {
-    for (n=0; n<N; ++n) {
-      for ( ; m<M; ++m) {
-        jar_fma( A+(k*M)+m, B+(n*K)+k, C+(n*M)+m );
+#endif
+
+  /* remaining rows (all rows without AVX512) */
+  jar_numstat_init( &s );
+  for (n=n0; n<n1; ++n) {
+    UniJAR* c = C+((size_t)n*M);
+    for (mr=m; mr<m1; ++mr) {
+      c[mr].I = JAR_ZERO;
+    }
+    for (k=0; k<K; ++k) {
+      for (mr=m; mr<m1; ++mr) {
+        jar_fma( A+((size_t)k*M)+mr, B+((size_t)n*K)+k, c+mr );
       }
     }
+    if (ns) jar_numstat_scan( &s, (size_t)(m1-m), c+m );
+    for (mr=m; mr<m1; ++mr) {
+      c[mr] = LinFP32_2_LogPS80_rnd( c[mr], rnd, ((size_t)n*M)+mr );
+    }
+  }
+  if (ns) {
+#if defined(__AVX512F__)
+    jar_numstat_vec_flush( &s, &nv );
+#endif
+    jar_numstat_add( a->tag, &s );
+  }
+}
+
+void jar_matmul_rnd_avx512( const int M, const int N, const int K, const UniJAR* A, const UniJAR* B, UniJAR* C, const RndJAR* rnd ) {
+/* 
+compute matrix-matrix product in JAR, see jar_matmul_avx512. The conversion to LogPS80 is fused 
+into the epilogue of each 16x8 register block and uses the rounding mode rnd (NULL for 
+round-to-nearest); the element index used for stochastic rounding is n*M+m. Tiles of 
+JAR_MATMUL_MC x JAR_MATMUL_NC of C are tasks of the JAR thread pool. 
+All matrices are in col-major format. 
+*/
+  JarMatmulArg a;
+
+  assert (M >= 0);
+  assert (N >= 0);
+  assert (K >= 0);
+  JAR_TRACE_BEGIN( t );
+
+  a.M = M; a.N = N; a.K = K; a.A = A; a.B = B; a.C = C; a.rnd = rnd;
+  a.tm = (M + JAR_MATMUL_MC - 1)/JAR_MATMUL_MC;
+  a.tag = JAR_NUMSTAT_ON() ? jar_numstat_current() : -1;
+  jar_parallel_for( a.tm*((N + JAR_MATMUL_NC - 1)/JAR_MATMUL_NC), jar_matmul_task, &a );
+  JAR_TRACE_END( t, JAR_TK_MATMUL, JAR_TP_COMPUTE, 4*((size_t)M*K + (size_t)K*N + (size_t)M*N), 2*(size_t)M*N*K );
+}
+
+#if defined(__AVX512F__)
+static inline void jar_block_kernel_avx512( const int MV, const int NR, const int K, const UniJAR* A, const int lda,
+                                            const UniJAR* B, const int ldb, UniJAR* C, const int ldc,
+                                            const int first, const int last, NumVecJAR* nv ) {
+/* 
+MV*16 x NR register block of C += A*B over K, C starts at JAR_ZERO if first and is converted 
+to LogPS80 if last; MV and NR are constants at every call so the accumulators stay in registers
+*/
+  __m512i vc[2][12];
+  int    i, j, k;
+
+  for (j=0; j<NR; ++j) {
+    for (i=0; i<MV; ++i) {
+      vc[i][j] = first ? _mm512_set1_epi32( JAR_ZERO ) : _mm512_loadu_epi32( C+(j*ldc)+16*i );
+    }
   }
-#else
-  /* let's perform a matrix matrix multiplication */ 
   for (k=0; k<K; ++k) {
-    for (n=0; n<N; ++n) {
-      for (m=0; m<M; ++m) {
-#if 1
-        jar_fma( A+(k*M)+m, B+(n*K)+k, C+(n*M)+m );
-#else
-        w = LogPS80_2_LinFP32(
-                 sum2_LogPS80( A[(k*M)+m], B[(n*K)+k] ) );
-        C[(n*M)+m].F += w.F;
+    __m512i va[2];
+    for (i=0; i<MV; ++i) {
+      va[i] = _mm512_loadu_epi32( A+(k*lda)+16*i );
+    }
+    for (j=0; j<NR; ++j) {
+      const __m512i vb = _mm512_set1_epi32( B[(j*ldb)+k].I );
+      for (i=0; i<MV; ++i) {
+        vc[i][j] = jar_fma_avx512( va[i], vb, vc[i][j] );
+      }
+    }
+  }
+  for (j=0; j<NR; ++j) {
+    for (i=0; i<MV; ++i) {
+      if (last && nv != NULL) jar_numstat_vec( nv, vc[i][j] );
+      _mm512_storeu_epi32( C+(j*ldc)+16*i, last ? LinFP32_2_LogPS80_avx512( vc[i][j] ) : vc[i][j] );
+    }
+  }
+}
+
+static void jar_block_avx512( const int mv, const int nr, const int K, const UniJAR* A, const int lda,
+                              const UniJAR* B, const int ldb, UniJAR* C, const int ldc,
+                              const int first, const int last, NumVecJAR* nv ) {
+/* the register blocks of BlockJAR, nr = 1 for the remaining columns */
+  if (mv == 2) {
+    switch (nr) {
+    case 12: jar_block_kernel_avx512( 2, 12, K, A, lda, B, ldb, C, ldc, first, last, nv ); break;
+    case 8:  jar_block_kernel_avx512( 2, 8, K, A, lda, B, ldb, C, ldc, first, last, nv ); break;
+    case 4:  jar_block_kernel_avx512( 2, 4, K, A, lda, B, ldb, C, ldc, first, last, nv ); break;
+    default: jar_block_kernel_avx512( 2, 1, K, A, lda, B, ldb, C, ldc, first, last, nv ); break;
+    }
+  } else {
+    switch (nr) {
+    case 12: jar_block_kernel_avx512( 1, 12, K, A, lda, B, ldb, C, ldc, first, last, nv ); break;
+    case 8:  jar_block_kernel_avx512( 1, 8, K, A, lda, B, ldb, C, ldc, first, last, nv ); break;
+    case 4:  jar_block_kernel_avx512( 1, 4, K, A, lda, B, ldb, C, ldc, first, last, nv ); break;
+    default: jar_block_kernel_avx512( 1, 1, K, A, lda, B, ldb, C, ldc, first, last, nv ); break;
+    }
+  }
+}
 #endif
+
+typedef struct{
+   int             M;
+   int             N;
+   int             K;
+   const UniJAR*   A;
+   const UniJAR*   B;
+   UniJAR*         C;
+   const BlockJAR* p;
+   int             mt;       /* rows per task */
+   int             nt;       /* columns per task */
+   int             tm;       /* tasks along M */
+   int             tag;      /* numerical event tag, -1 when not counting */
+} JarBlockArg;
+
+static void jar_block_task( void* arg, const int t ) {
+/* 
+the region of C of task t: for each block of kc (in order, so every element is accumulated
+in the order of jar_matmul), each block of mc rows and each group of nr columns, the register
+blocks of mv vectors, then of one vector, then the rows below 16
+*/
+  const JarBlockArg* a = (const JarBlockArg*)arg;
+  const BlockJAR* p = a->p;
+  const int M = a->M, K = a->K;
+  const int m0 = (t % a->tm)*a->mt, n0 = (t / a->tm)*a->nt;
+  const int m1 = (m0+a->mt < M) ? m0+a->mt : M;
+  const int n1 = (n0+a->nt < a->N) ? n0+a->nt : a->N;
+  const int kc = (p->kc > 0 && p->kc < K) ? p->kc : ((K > 0) ? K : 1);
+  NumStatJAR s;
+  int k0, mb, mb1, n, nb, m, j, k;
+#if defined(__AVX512F__)
+  NumVecJAR nv;
+
+  jar_numstat_vec_init( &nv );
+#endif
+
+  jar_numstat_init( &s );
+  for (k0=0; k0<K || k0==0; k0+=kc) {
+    const int kb = (k0+kc < K) ? kc : K-k0;
+    const int first = (k0 == 0), last = (k0+kb >= K);
+    for (mb=m0; mb<m1; mb+=p->mc) {
+      mb1 = (mb+p->mc < m1) ? mb+p->mc : m1;
+      for (n=n0; n<n1; n+=nb) {
+        nb = (n+p->nr <= n1) ? p->nr : 1;
+        m = mb;
+#if defined(__AVX512F__)
+        for ( ; m+16*p->mv<=mb1; m+=16*p->mv) {
+          jar_block_avx512( p->mv, nb, kb, a->A+((size_t)k0*M)+m, M, a->B+((size_t)n*K)+k0, K, a->C+((size_t)n*M)+m, M,
+                            first, last, (a->tag >= 0) ? &nv : NULL );
+        }
+        for ( ; m+16<=mb1; m+=16) {
+          jar_block_avx512( 1, nb, kb, a->A+((size_t)k0*M)+m, M, a->B+((size_t)n*K)+k0, K, a->C+((size_t)n*M)+m, M,
+                            first, last, (a->tag >= 0) ? &nv : NULL );
+        }
+#endif
+        for (j=n; j<n+nb; ++j) {
+          UniJAR* c = a->C+((size_t)j*M);
+          int mr;
+          for (mr=m; mr<mb1 && first; ++mr) c[mr].I = JAR_ZERO;
+          for (k=k0; k<k0+kb; ++k) {
+            for (mr=m; mr<mb1; ++mr) {
+              jar_fma( a->A+((size_t)k*M)+mr, a->B+((size_t)j*K)+k, c+mr );
+            }
+          }
+          if (last) {
+            if (a->tag >= 0) jar_numstat_scan( &s, (size_t)(mb1-m), c+m );
+            for (mr=m; mr<mb1; ++mr) c[mr] = LinFP32_2_LogPS80( c[mr] );
+          }
+        }
       }
     }
   }
+  if (a->tag >= 0) {
+#if defined(__AVX512F__)
+    jar_numstat_vec_flush( &s, &nv );
 #endif
+    jar_numstat_add( a->tag, &s );
+  }
+}
 
-  /* let convert to LogPS80 after accumulation */
-  for (m=0; m<M*N; ++m) {
-    C[m] = LinFP32_2_LogPS80( C[m] );
+void jar_matmul_blocked_avx512( const int M, const int N, const int K, const UniJAR* A, const UniJAR* B, UniJAR* C, const BlockJAR* p ) {
+/* 
+jar_matmul_avx512 with the register and cache blocking and the task split of p (see jar_type.h),
+e.g. as tuned by jar_tune. Each element is accumulated in the order of jar_matmul and rounded to 
+nearest, so the result is identical for every p. mc must be a multiple of 16, mv 1 or 2 and nr 
+one of 1, 4, 8, 12. All matrices are in col-major format.
+*/
+  JarBlockArg a;
+
+  assert (M >= 0);
+  assert (N >= 0);
+  assert (K >= 0);
+  assert (p->mc >= 16 && p->mc % 16 == 0 && p->nc >= 1);
+  assert ((p->mv == 1 || p->mv == 2) && (p->nr == 1 || p->nr == 4 || p->nr == 8 || p->nr == 12));
+  JAR_TRACE_BEGIN( t );
+
+  if (M == 0 || N == 0) {
+    return;
+  }
+  a.M = M; a.N = N; a.K = K; a.A = A; a.B = B; a.C = C; a.p = p;
+  a.mt = (p->split == JAR_SPLIT_M || p->split == JAR_SPLIT_MN) ? p->mc : M;
+  a.nt = (p->split == JAR_SPLIT_N || p->split == JAR_SPLIT_MN) ? p->nc : N;
+  a.tm = (M + a.mt - 1)/a.mt;
+  a.tag = JAR_NUMSTAT_ON() ? jar_numstat_current() : -1;
+  jar_parallel_for( a.tm*((N + a.nt - 1)/a.nt), jar_block_task, &a );
+  JAR_TRACE_END( t, JAR_TK_MATMUL, JAR_TP_COMPUTE, 4*((size_t)M*K + (size_t)K*N + (size_t)M*N), 2*(size_t)M*N*K );
+}
+
+#if defined(__AVX512F__)
+static inline void jar_vblock_kernel_avx512( const int MV, const int K, const UniJAR* A, const int lda, const UniJAR* b,
+                                             UniJAR* c, NumVecJAR* nv ) {
+/* MV*16 rows of c = A*b with MV independent accumulators */
+  __m512i vc[4];
+  int    i, k;
+
+  for (i=0; i<MV; ++i) {
+    vc[i] = _mm512_set1_epi32( JAR_ZERO );
+  }
+  for (k=0; k<K; ++k) {
+    const __m512i vb = _mm512_set1_epi32( b[k].I );
+    for (i=0; i<MV; ++i) {
+      vc[i] = jar_fma_avx512( _mm512_loadu_epi32( A+(k*lda)+16*i ), vb, vc[i] );
+    }
+  }
+  for (i=0; i<MV; ++i) {
+    if (nv != NULL) jar_numstat_vec( nv, vc[i] );
+    _mm512_storeu_epi32( c+16*i, LinFP32_2_LogPS80_avx512( vc[i] ) );
+  }
+}
+#endif
+
+static void jar_vblock_task( void* arg, const int t ) {
+/* rows t*mc ... of the matrix vector product */
+  const JarBlockArg* a = (const JarBlockArg*)arg;
+  const int M = a->M, K = a->K;
+  const int m0 = t*a->mt;
+  const int m1 = (m0+a->mt < M) ? m0+a->mt : M;
+  NumStatJAR s;
+  int m = m0, mr, k;
+#if defined(__AVX512F__)
+  const int mv = a->p->mv;
+  NumVecJAR nv;
+  NumVecJAR* pv = (a->tag >= 0) ? &nv : NULL;
+
+  jar_numstat_vec_init( &nv );
+  for ( ; m+16*mv<=m1; m+=16*mv) {
+    if (mv == 4) jar_vblock_kernel_avx512( 4, K, a->A+m, M, a->B, a->C+m, pv );
+    else if (mv == 2) jar_vblock_kernel_avx512( 2, K, a->A+m, M, a->B, a->C+m, pv );
+    else jar_vblock_kernel_avx512( 1, K, a->A+m, M, a->B, a->C+m, pv );
+  }
+  for ( ; m+16<=m1; m+=16) {
+    jar_vblock_kernel_avx512( 1, K, a->A+m, M, a->B, a->C+m, pv );
+  }
+#endif
+  jar_numstat_init( &s );
+  for (mr=m; mr<m1; ++mr) {
+    a->C[mr].I = JAR_ZERO;
+  }
+  for (k=0; k<K; ++k) {
+    for (mr=m; mr<m1; ++mr) {
+      jar_fma( a->A+((size_t)k*M)+mr, a->B+k, a->C+mr );
+    }
+  }
+  if (a->tag >= 0) {
+    jar_numstat_scan( &s, (size_t)(m1-m), a->C+m );
+#if defined(__AVX512F__)
+    jar_numstat_vec_flush( &s, &nv );
+#endif
+    jar_numstat_add( a->tag, &s );
+  }
+  for (mr=m; mr<m1; ++mr) {
+    a->C[mr] = LinFP32_2_LogPS80( a->C[mr] );
+  }
+}
+
+void jar_matvecmul_blocked_avx512( const int M, const int K, const UniJAR* A, const UniJAR* b, UniJAR* c, const BlockJAR* p ) {
+/* 
+jar_matvecmul_avx512 with mv (1, 2 or 4) independent 16-row accumulators and, unless split is
+JAR_SPLIT_NONE, pool tasks of mc rows (a multiple of 16). The result is identical for every p.
+*/
+  JarBlockArg a;
+
+  assert (M >= 0);
+  assert (K >= 0);
+  assert (p->mc >= 16 && p->mc % 16 == 0 && (p->mv == 1 || p->mv == 2 || p->mv == 4));
+  JAR_TRACE_BEGIN( t );
+
+  a.M = M; a.N = 1; a.K = K; a.A = A; a.B = b; a.C = c; a.p = p;
+  a.mt = (p->split == JAR_SPLIT_NONE) ? M : p->mc;
+  a.nt = 1;
+  a.tm = (M > 0) ? (M + a.mt - 1)/a.mt : 0;
+  a.tag = JAR_NUMSTAT_ON() ? jar_numstat_current() : -1;
+  jar_parallel_for( a.tm, jar_vblock_task, &a );
+  JAR_TRACE_END( t, JAR_TK_MATVECMUL, JAR_TP_COMPUTE, 4*((size_t)M*K + K + M), 2*(size_t)M*K );
+}
+
+typedef struct{
+   size_t         n;
+   const UniJAR*  x;
+   UniJAR*        y;
+   const RndJAR*  rnd;
+   int            tag;      /* numerical event tag, -1 when not counting */
+} JarConvertArg;
+
+static void jar_convert_task( void* arg, const int task ) {
+/* converts chunk task of JAR_CONVERT_CHUNK elements */
+  const JarConvertArg* a = (const JarConvertArg*)arg;
+  size_t i  = (size_t)task*JAR_CONVERT_CHUNK;
+  size_t i1 = (i+JAR_CONVERT_CHUNK < a->n) ? i+JAR_CONVERT_CHUNK : a->n;
+
+  if (a->tag >= 0) {
+    NumStatJAR s;
+    jar_numstat_init( &s );
+    jar_numstat_scan( &s, i1-i, a->x+i );
+    jar_numstat_add( a->tag, &s );
+  }
+#if defined(__AVX512F__)
+  for ( ; i+16<=i1; i+=16) {
+    _mm512_storeu_epi32( a->y+i, LinFP32_2_LogPS80_rnd_avx512( _mm512_loadu_epi32( a->x+i ), a->rnd, i ) );
+  }
+#endif
+  for ( ; i<i1; ++i) {
+    a->y[i] = LinFP32_2_LogPS80_rnd( a->x[i], a->rnd, i );
+  }
+}
+
+void jar_convert_LinFP32_2_LogPS80( const size_t n, const UniJAR* x, UniJAR* y, const RndJAR* rnd ) {
+/*
+converts n LinFP32 values to LogPS80 with rounding mode rnd (NULL for round-to-nearest),
+the element index for stochastic rounding is the position in the array. y may alias x.
+Chunks of JAR_CONVERT_CHUNK elements are tasks of the JAR thread pool.
+*/
+  JarConvertArg a;
+
+  assert (x != NULL && y != NULL);
+  JAR_TRACE_BEGIN( t );
+
+  a.n = n; a.x = x; a.y = y; a.rnd = rnd;
+  a.tag = JAR_NUMSTAT_ON() ? jar_numstat_current() : -1;
+  jar_parallel_for( (int)((n + JAR_CONVERT_CHUNK - 1)/JAR_CONVERT_CHUNK), jar_convert_task, &a );
+  JAR_TRACE_END( t, JAR_TK_CONVERT, JAR_TP_COMPUTE, 8*n, 0 );
+}
+
+typedef struct{
+   size_t         n;
+   const UniJAR*  x;
+   float*         f;
+} JarDecodeArg;
+
+static void jar_decode_task( void* arg, const int task ) {
+/* decodes chunk task of JAR_CONVERT_CHUNK elements */
+  const JarDecodeArg* a = (const JarDecodeArg*)arg;
+  size_t i  = (size_t)task*JAR_CONVERT_CHUNK;
+  size_t i1 = (i+JAR_CONVERT_CHUNK < a->n) ? i+JAR_CONVERT_CHUNK : a->n;
+
+#if defined(__AVX512F__)
+  for ( ; i+16<=i1; i+=16) {
+    _mm512_storeu_ps( a->f+i, LogPS80_2_Lin_val_avx512( _mm512_loadu_epi32( a->x+i ) ) );
+  }
+#endif
+  for ( ; i<i1; ++i) {
+    a->f[i] = LogPS80_2_Lin_val_tbl( a->x[i] );
+  }
+}
+
+void jar_convert_LogPS80_2_Lin_val( const size_t n, const UniJAR* x, float* f ) {
+/*
+decodes n LogPS80 values to their exact linear values, bit-identical to LogPS80_2_Lin_val
+but through the 32-entry exp2_val_tbl instead of libm exp2. f may alias x. Chunks of 
+JAR_CONVERT_CHUNK elements are tasks of the JAR thread pool.
+*/
+  JarDecodeArg a;
+
+  assert (x != NULL && f != NULL);
+  JAR_TRACE_BEGIN( t );
+
+  a.n = n; a.x = x; a.f = f;
+  jar_parallel_for( (int)((n + JAR_CONVERT_CHUNK - 1)/JAR_CONVERT_CHUNK), jar_decode_task, &a );
+  JAR_TRACE_END( t, JAR_TK_CONVERT, JAR_TP_COMPUTE, 8*n, 0 );
+}
+
+void jar_fill_uniform( const size_t n, UniJAR* x, float* f, unsigned int* seed ) {
+/*
+test data of the JAR tools: n values uniform in [-2, 2) from the linear congruential 
+generator *seed, as LogPS80 in x and, if f is not NULL, as LinFP32 in f
+*/
+  size_t i;
+
+  for (i=0; i<n; ++i) {
+    *seed = *seed*1664525u + 1013904223u;
+    x[i].F = -2.0f + 4.0f*(float)(*seed >> 8)/16777216.0f;
+    if (f != NULL) f[i] = x[i].F;
   }
+  jar_convert_LinFP32_2_LogPS80( n, x, x, NULL );
 }
 
 
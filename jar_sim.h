@@ -88,21 +88,68 @@
 #include "jar_type.h"
 #include "jar_utils.h"
 
+/* elements per task of jar_convert_LinFP32_2_LogPS80 and jar_convert_LogPS80_2_Lin_val */
+#define JAR_CONVERT_CHUNK  4096
+/* rows and columns of C per task of jar_matmul_rnd_avx512 (multiples of 16 and 8) */
+#define JAR_MATMUL_MC      128
+#define JAR_MATMUL_NC      64
+/* rows per task of jar_matvecmul_avx512 (a multiple of 16) */
+#define JAR_MATVEC_MC      256
+
 UniJAR LinFP32_2_LogPS80( UniJAR x );
+UniJAR LinFP32_2_LogPS80_rnd( UniJAR x, const RndJAR* rnd, const size_t idx );
+void jar_convert_LinFP32_2_LogPS80( const size_t n, const UniJAR* x, UniJAR* y, const RndJAR* rnd );
+void jar_convert_LogPS80_2_Lin_val( const size_t n, const UniJAR* x, float* f );
+void jar_fill_uniform( const size_t n, UniJAR* x, float* f, unsigned int* seed );
 UniJAR LogPS80_2_LinFP32( UniJAR x );
 UniJAR sum2_LogPS80( UniJAR x, UniJAR y );
+void jar_fma( const UniJAR* a, const UniJAR* b, UniJAR* c );
 UniJAR jar_dotprod( const int n, const UniJAR* x, const UniJAR* y );
 void jar_matvecmul( const int M, const int K, const UniJAR* A, const UniJAR* b, UniJAR* c );
 void jar_matvecmul_avx512( const int M, const int K, const UniJAR* A, const UniJAR* b, UniJAR* c );
+void jar_matvecacc( const int M, const int K, const UniJAR* A, const int lda, const UniJAR* b, UniJAR* c );
+void jar_matvecacc_avx512( const int M, const int K, const UniJAR* A, const int lda, const UniJAR* b, UniJAR* c );
+void jar_matmulacc( const int M, const int N, const int K, const UniJAR* A, const int lda, const UniJAR* B, const int ldb, UniJAR* C, const int ldc );
+void jar_matmulacc_avx512( const int M, const int N, const int K, const UniJAR* A, const int lda, const UniJAR* B, const int ldb, UniJAR* C, const int ldc );
 void jar_matmul( const int M, const int N, const int K, const UniJAR* A, const UniJAR* B, UniJAR* C );
 void jar_matmul_avx512( const int M, const int N, const int K, const UniJAR* A, const UniJAR* B, UniJAR* C );
+void jar_matmul_rnd_avx512( const int M, const int N, const int K, const UniJAR* A, const UniJAR* B, UniJAR* C, const RndJAR* rnd );
+void jar_matmul_blocked_avx512( const int M, const int N, const int K, const UniJAR* A, const UniJAR* B, UniJAR* C, const BlockJAR* p );
+void jar_matvecmul_blocked_avx512( const int M, const int K, const UniJAR* A, const UniJAR* b, UniJAR* c, const BlockJAR* p );
 
 extern UniJAR exp2_tbl[64];
 extern UniJAR log2_tbl[32];
 
 #if defined(__AVX512F__)
 #include <immintrin.h>
-inline __m512i jar_fma_avx512( const __m512i a, const __m512i b, const __m512i c );
+__m512i sum2_LogPS80_avx512( const __m512i x, const __m512i y );
+__m512i LogPS80_2_LinFP32_avx512( const __m512i x );
+__m512i LinFP32_2_LogPS80_avx512( const __m512i x );
+__m512i LinFP32_2_LogPS80_rnd_avx512( const __m512i x, const RndJAR* rnd, const size_t idx );
+
+static inline __m512i jar_prod_avx512( const __m512i a, const __m512i b, const __m512i add ) {
+/* 
+the LinFP32 products of the LogPS80 a and b: sum2_LogPS80 with the exponent constant add 
+(0x40800000, or a per-lane scaled one), then the exp2_tbl lookup of LogPS80_2_LinFP32. 
+Shared by jar_fma_avx512 and the kernels that use the products differently.
+*/
+  __m512i sign_z;
+  __m512i z;
+  __m512i i;
+
+  sign_z = _mm512_add_epi32( _mm512_and_epi32( a, _mm512_set1_epi32( SIGN_MASK ) ), _mm512_and_epi32( b, _mm512_set1_epi32( SIGN_MASK ) ) );
+  z = _mm512_add_epi32( _mm512_add_epi32( a, b ), add );
+  z = _mm512_or_epi32( _mm512_and_epi32( z, _mm512_set1_epi32( CLEAR_SIGN ) ), sign_z );
+
+  i = _mm512_srai_epi32( _mm512_and_epi32( z, _mm512_set1_epi32( FRAC_MASK ) ), EXP2_IND_SHIFT );
+  return _mm512_or_epi32( _mm512_and_epi32( z, _mm512_set1_epi32( CLEAR_FRAC ) ), _mm512_i32gather_epi32( i, exp2_tbl, 4 ) );
+}
+
+static inline __m512i jar_fma_avx512( const __m512i a, const __m512i b, const __m512i c ) {
+/* 16-wide jar_fma: c + a*b, with a, b LogPS80 and c LinFP32 */
+  return _mm512_castps_si512( _mm512_add_ps( _mm512_castsi512_ps( c ), 
+                                             _mm512_castsi512_ps( jar_prod_avx512( a, b, _mm512_set1_epi32( 0X40800000 ) ) ) ) );
+}
 #endif
 
 #endif
@@ -0,0 +1,372 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "jar_sparse.h"
+#include "jar_mem.h"
+#include "jar_pool.h"
+#include "jar_trace.h"
+#include "jar_numstat.h"
+
+typedef struct{
+   const SparseJAR*  S;
+   int               N;
+   const UniJAR*     B;
+   UniJAR*           C;
+   int               nt;       /* tasks */
+   int               tag;      /* numerical event tag, -1 when not counting */
+} JarSparseArg;
+
+static int jar_sparse_block_nonzero( const int M, const UniJAR* A, const int m0, const int m1, const int k0, const int k1 ) {
+/* 1 if A[m0:m1, k0:k1] has an element with |x| > 2^-63 */
+  int m, k;
+
+  for (k=k0; k<k1; ++k) {
+    for (m=m0; m<m1; ++m) {
+      if ((A[(size_t)k*M+m].I & CLEAR_SIGN) > JAR_ZERO) return 1;
+    }
+  }
+  return 0;
+}
+
+int jar_sparse_from_dense( const int M, const int K, const UniJAR* A, const int bm, const int bk, SparseJAR* S ) {
+/*
+converts the col-major M x K LogPS80 matrix A to CSR (bm = bk = 1) or BSR with bm x bk
+blocks, keeping the blocks that are not all zero. Returns 0, or -1 if out of memory.
+*/
+  const int kb = (K + bk - 1)/bk;
+  size_t j, bs;
+  int i, c, m, k;
+
+  assert (M >= 0 && K >= 0);
+  assert (bm > 0 && bk > 0);
+  memset( S, 0, sizeof(SparseJAR) );
+  S->M = M; S->K = K; S->bm = bm; S->bk = bk;
+  S->mb = (M + bm - 1)/bm;
+  bs = (size_t)bm*bk;
+
+  S->row_ptr = (size_t*) jar_malloc( ((size_t)S->mb+1)*sizeof(size_t) );
+  if (S->row_ptr == NULL) return -1;
+  S->row_ptr[0] = 0;
+  for (i=0; i<S->mb; ++i) {
+    const int m1 = (i*bm+bm < M) ? i*bm+bm : M;
+    S->row_ptr[i+1] = S->row_ptr[i];
+    for (c=0; c<kb; ++c) {
+      S->row_ptr[i+1] += jar_sparse_block_nonzero( M, A, i*bm, m1, c*bk, (c*bk+bk < K) ? c*bk+bk : K );
+    }
+  }
+  S->nb = S->row_ptr[S->mb];
+
+  S->col_idx = (int*) jar_malloc( (S->nb > 0 ? S->nb : 1)*sizeof(int) );
+  S->val = (UniJAR*) jar_malloc( (S->nb > 0 ? S->nb : 1)*bs*sizeof(UniJAR) );
+  if (S->col_idx == NULL || S->val == NULL) {
+    jar_sparse_free( S );
+    return -1;
+  }
+  j = 0;
+  for (i=0; i<S->mb; ++i) {
+    const int m1 = (i*bm+bm < M) ? i*bm+bm : M;
+    for (c=0; c<kb; ++c) {
+      const int k1 = (c*bk+bk < K) ? c*bk+bk : K;
+      UniJAR* v = S->val + j*bs;
+      if (!jar_sparse_block_nonzero( M, A, i*bm, m1, c*bk, k1 )) continue;
+      S->col_idx[j] = c;
+      for (k=0; k<bk; ++k) {
+        for (m=0; m<bm; ++m) {
+          v[(size_t)k*bm+m].I = (i*bm+m < m1 && c*bk+k < k1) ? A[(size_t)(c*bk+k)*M+i*bm+m].I : JAR_ZERO;
+        }
+      }
+      ++j;
+    }
+  }
+
+  /* the cost of the groups of block rows, for the task split of jar_spmm_avx512 */
+  S->rows = (bm == 1 && bk == 1) ? 16 : 1;
+  S->ng   = (S->mb + S->rows - 1)/S->rows;
+  S->ops  = (size_t*) jar_malloc( ((size_t)S->ng+1)*sizeof(size_t) );
+  if (S->ops == NULL) {
+    jar_sparse_free( S );
+    return -1;
+  }
+  S->ops[0] = 0;
+  for (c=0; c<S->ng; ++c) {
+    const int i1 = ((c+1)*S->rows < S->mb) ? (c+1)*S->rows : S->mb;
+    S->ops[c+1] = S->ops[c] + (S->row_ptr[i1] - S->row_ptr[c*S->rows])*bs + (size_t)S->rows*bm;
+  }
+  return 0;
+}
+
+void jar_sparse_to_dense( const SparseJAR* S, UniJAR* A ) {
+/* expands S to the col-major M x K matrix A, the elements not stored are JAR_ZERO */
+  const size_t bs = (size_t)S->bm*S->bk;
+  size_t j;
+  int i, m, k;
+
+  for (j=0; j<(size_t)S->M*S->K; ++j) {
+    A[j].I = JAR_ZERO;
+  }
+  for (i=0; i<S->mb; ++i) {
+    for (j=S->row_ptr[i]; j<S->row_ptr[i+1]; ++j) {
+      const UniJAR* v = S->val + j*bs;
+      for (k=0; k<S->bk && S->col_idx[j]*S->bk+k < S->K; ++k) {
+        for (m=0; m<S->bm && i*S->bm+m < S->M; ++m) {
+          A[(size_t)(S->col_idx[j]*S->bk+k)*S->M + i*S->bm+m] = v[(size_t)k*S->bm+m];
+        }
+      }
+    }
+  }
+}
+
+void jar_sparse_free( SparseJAR* S ) {
+  jar_free( S->ops );
+  jar_free( S->val );
+  jar_free( S->col_idx );
+  jar_free( S->row_ptr );
+  memset( S, 0, sizeof(SparseJAR) );
+}
+
+static void jar_sparse_rows( const SparseJAR* S, const int i0, const int i1, const int N, const UniJAR* B, UniJAR* C ) {
+/* accumulates rows of the block rows i0 ... i1-1 of C = A*B in the linear domain, in ascending k */
+  const size_t bs = (size_t)S->bm*S->bk;
+  size_t j;
+  int i, n, m, k;
+
+  for (n=0; n<N; ++n) {
+    const UniJAR* b = B + (size_t)n*S->K;
+    UniJAR* c = C + (size_t)n*S->M;
+    for (i=i0; i<i1; ++i) {
+      const int m0 = i*S->bm, m1 = (m0+S->bm < S->M) ? m0+S->bm : S->M;
+      for (m=m0; m<m1; ++m) {
+        c[m].I = JAR_ZERO;
+      }
+      for (j=S->row_ptr[i]; j<S->row_ptr[i+1]; ++j) {
+        const UniJAR* v = S->val + j*bs;
+        const int k0 = S->col_idx[j]*S->bk, k1 = (k0+S->bk < S->K) ? k0+S->bk : S->K;
+        for (k=k0; k<k1; ++k) {
+          for (m=m0; m<m1; ++m) {
+            jar_fma( v + (size_t)(k-k0)*S->bm + (m-m0), b+k, c+m );
+          }
+        }
+      }
+    }
+  }
+}
+
+static void jar_sparse_epilogue( const SparseJAR* S, const int m0, const int m1, const int N, UniJAR* C, const int tag ) {
+/* converts rows m0 ... m1-1 of the N columns of C to LogPS80 */
+  int n, m;
+
+  for (n=0; n<N; ++n) {
+    UniJAR* c = C + (size_t)n*S->M;
+    if (tag >= 0) {
+      NumStatJAR s;
+      jar_numstat_init( &s );
+      jar_numstat_scan( &s, m1-m0, c+m0 );
+      jar_numstat_add( tag, &s );
+    }
+    m = m0;
+#if defined(__AVX512F__)
+    for ( ; m+16<=m1; m+=16) {
+      _mm512_storeu_epi32( c+m, LinFP32_2_LogPS80_avx512( _mm512_loadu_epi32( c+m ) ) );
+    }
+#endif
+    for ( ; m<m1; ++m) {
+      c[m] = LinFP32_2_LogPS80( c[m] );
+    }
+  }
+}
+
+void jar_spmv( const SparseJAR* S, const UniJAR* x, UniJAR* y ) {
+/* y = A*x for the sparse A, see jar_sparse.h */
+  jar_spmm( S, 1, x, y );
+}
+
+void jar_spmm( const SparseJAR* S, const int N, const UniJAR* B, UniJAR* C ) {
+/* C = A*B for the sparse A and the dense K x N B, see jar_sparse.h */
+  const size_t nv = S->nb*S->bm*S->bk;
+
+  assert (N >= 0);
+  JAR_TRACE_BEGIN( t );
+  jar_sparse_rows( S, 0, S->mb, N, B, C );
+  JAR_TRACE_END( t, (N == 1) ? JAR_TK_SPMV : JAR_TK_SPMM, JAR_TP_COMPUTE,
+                 4*nv + 4*S->nb + 4*((size_t)S->K + S->M)*N, 2*nv*N );
+
+  JAR_TRACE_BEGIN( te );
+  jar_sparse_epilogue( S, 0, S->M, N, C, JAR_NUMSTAT_ON() ? jar_numstat_current() : -1 );
+  JAR_TRACE_END( te, (N == 1) ? JAR_TK_SPMV : JAR_TK_SPMM, JAR_TP_EPILOGUE, 8*(size_t)S->M*N, 0 );
+}
+
+#if defined(__AVX512F__)
+static void jar_sparse_csr16_avx512( const SparseJAR* S, const int r0, const int n0, const int nr, const UniJAR* B, UniJAR* C ) {
+/* rows r0 ... r0+15 (lanes) of columns n0 ... n0+nr-1 of C, each lane walks its own row */
+  const __mmask16 live = (r0+16 <= S->M) ? 0xFFFF : (__mmask16)((1 << (S->M-r0)) - 1);
+  const size_t base = S->row_ptr[r0];
+  int p[16], len[16];
+  __m512i vp, vlen, vc[JAR_SPARSE_NR];
+  int l, j, n, maxlen = 0;
+
+  for (l=0; l<16; ++l) {
+    p[l] = len[l] = 0;
+    if (live & (1 << l)) {
+      p[l]   = (int)(S->row_ptr[r0+l] - base);
+      len[l] = (int)(S->row_ptr[r0+l+1] - S->row_ptr[r0+l]);
+      maxlen = (len[l] > maxlen) ? len[l] : maxlen;
+    }
+  }
+  vp   = _mm512_loadu_si512( p );
+  vlen = _mm512_loadu_si512( len );
+  for (n=0; n<nr; ++n) {
+    vc[n] = _mm512_set1_epi32( JAR_ZERO );
+  }
+  for (j=0; j<maxlen; ++j) {
+    const __m512i vj = _mm512_set1_epi32( j );
+    const __mmask16 k = _mm512_cmplt_epi32_mask( vj, vlen );
+    const __m512i idx = _mm512_add_epi32( vp, vj );
+    const __m512i va = _mm512_mask_i32gather_epi32( _mm512_set1_epi32( JAR_ZERO ), k, idx, S->val + base, 4 );
+    const __m512i vk = _mm512_mask_i32gather_epi32( _mm512_setzero_si512(), k, idx, S->col_idx + base, 4 );
+    for (n=0; n<nr; ++n) {
+      const __m512i vb = _mm512_mask_i32gather_epi32( _mm512_setzero_si512(), k, vk, B + (size_t)(n0+n)*S->K, 4 );
+      vc[n] = _mm512_mask_mov_epi32( vc[n], k, jar_fma_avx512( va, vb, vc[n] ) );
+    }
+  }
+  for (n=0; n<nr; ++n) {
+    _mm512_mask_storeu_epi32( C + (size_t)(n0+n)*S->M + r0, live, vc[n] );
+  }
+}
+
+static void jar_sparse_bsr16_avx512( const SparseJAR* S, const int i, const int s, const int n0, const int nr, const UniJAR* B, UniJAR* C ) {
+/* rows 16*s ... 16*s+15 (lanes) of block row i of columns n0 ... n0+nr-1 of C */
+  const int r0 = i*S->bm + 16*s;
+  const __mmask16 live = (r0+16 <= S->M) ? 0xFFFF : (__mmask16)((1 << (S->M-r0)) - 1);
+  const size_t bs = (size_t)S->bm*S->bk;
+  __m512i vc[JAR_SPARSE_NR];
+  size_t j;
+  int k, kn, n;
+
+  for (n=0; n<nr; ++n) {
+    vc[n] = _mm512_set1_epi32( JAR_ZERO );
+  }
+  for (j=S->row_ptr[i]; j<S->row_ptr[i+1]; ++j) {
+    const UniJAR* v = S->val + j*bs + 16*s;
+    const int k0 = S->col_idx[j]*S->bk;
+    kn = (k0+S->bk < S->K) ? S->bk : S->K-k0;
+    for (k=0; k<kn; ++k) {
+      const __m512i va = _mm512_loadu_epi32( v + (size_t)k*S->bm );
+      for (n=0; n<nr; ++n) {
+        vc[n] = jar_fma_avx512( va, _mm512_set1_epi32( B[(size_t)(n0+n)*S->K + k0+k].I ), vc[n] );
+      }
+    }
+  }
+  for (n=0; n<nr; ++n) {
+    _mm512_mask_storeu_epi32( C + (size_t)(n0+n)*S->M + r0, live, vc[n] );
+  }
+}
+#endif
+
+static int jar_sparse_group( const SparseJAR* S, const int nt, const int task ) {
+/* the first group of task, i.e. the first g with ops[g] >= task/nt of the total */
+  const size_t total = S->ops[S->ng];
+  const size_t v = (total/nt)*task + ((total%nt)*task)/nt;
+  int lo = 0, hi = S->ng;
+
+  while (lo < hi) {
+    const int mid = lo + (hi-lo)/2;
+    if (S->ops[mid] < v) lo = mid+1; else hi = mid;
+  }
+  return lo;
+}
+
+static void jar_sparse_task( void* arg, const int task ) {
+/* the block rows of the groups of task, then their conversion to LogPS80 */
+  const JarSparseArg* a = (const JarSparseArg*)arg;
+  const SparseJAR* S = a->S;
+  const int g0 = jar_sparse_group( S, a->nt, task );
+  const int g1 = jar_sparse_group( S, a->nt, task+1 );
+  const int i0 = g0*S->rows;
+  const int i1 = (g1*S->rows < S->mb) ? g1*S->rows : S->mb;
+  const int m1 = (i1*S->bm < S->M) ? i1*S->bm : S->M;
+#if defined(__AVX512F__)
+  int i, s, n0;
+
+  for (n0=0; n0<a->N; n0+=JAR_SPARSE_NR) {
+    const int nr = (n0+JAR_SPARSE_NR < a->N) ? JAR_SPARSE_NR : a->N-n0;
+    if (S->bm == 1 && S->bk == 1) {
+      for (i=i0; i<i1; i+=16) {
+        jar_sparse_csr16_avx512( S, i, n0, nr, a->B, a->C );
+      }
+    } else if (S->bm % 16 == 0) {
+      for (i=i0; i<i1; ++i) {
+        for (s=0; s<S->bm/16 && i*S->bm+16*s < S->M; ++s) {
+          jar_sparse_bsr16_avx512( S, i, s, n0, nr, a->B, a->C );
+        }
+      }
+    } else {
+      jar_sparse_rows( S, i0, i1, nr, a->B + (size_t)n0*S->K, a->C + (size_t)n0*S->M );
+    }
+  }
+#else
+  jar_sparse_rows( S, i0, i1, a->N, a->B, a->C );
+#endif
+  jar_sparse_epilogue( S, i0*S->bm, m1, a->N, a->C, a->tag );
+}
+
+void jar_spmv_avx512( const SparseJAR* S, const UniJAR* x, UniJAR* y ) {
+/* y = A*x for the sparse A on the JAR thread pool, see jar_sparse.h */
+  jar_spmm_avx512( S, 1, x, y );
+}
+
+void jar_spmm_avx512( const SparseJAR* S, const int N, const UniJAR* B, UniJAR* C ) {
+/*
+C = A*B for the sparse A and the dense K x N B on the JAR thread pool, see jar_sparse.h.
+The block rows are grouped (16 rows for CSR) and consecutive groups form tasks of about 
+JAR_SPARSE_TASK_OPS products, split at the prefix sums S->ops.
+*/
+  const size_t nv = S->nb*S->bm*S->bk;
+  const size_t target = (JAR_SPARSE_TASK_OPS/N > 0) ? JAR_SPARSE_TASK_OPS/N : 1;
+  JarSparseArg a;
+  size_t nt;
+
+  assert (N >= 0);
+  if (N == 0 || S->M == 0) return;
+  JAR_TRACE_BEGIN( t );
+
+  nt = (S->ops[S->ng] + target - 1)/target;
+  a.S = S; a.N = N; a.B = B; a.C = C;
+  a.nt = (nt < 1) ? 1 : (nt > (size_t)S->ng) ? S->ng : (int)nt;
+  a.tag = JAR_NUMSTAT_ON() ? jar_numstat_current() : -1;
+  jar_parallel_for( a.nt, jar_sparse_task, &a );
+
+  JAR_TRACE_END( t, (N == 1) ? JAR_TK_SPMV : JAR_TK_SPMM, JAR_TP_COMPUTE,
+                 4*nv + 4*S->nb + 4*((size_t)S->K + S->M)*N, 2*nv*N );
+}
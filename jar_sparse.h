@@ -0,0 +1,92 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Sparse LogPS80 matrices in compressed sparse row (CSR) and block sparse row (BSR)
+ *  storage, and the JAR products y = A*x (SpMV) and C = A*B (SpMM) with a dense x or B.
+ *
+ *  SparseJAR stores the M x K matrix as blocks of bm x bk elements (1 x 1 for CSR).
+ *  Block row i (rows i*bm ... i*bm+bm-1) has the blocks row_ptr[i] ... row_ptr[i+1]-1
+ *  in ascending block column col_idx[j] (columns col_idx[j]*bk ...); the values of 
+ *  block j are val[j*bm*bk ...], bm x bk col-major, padded with JAR_ZERO past M and K.
+ *  jar_sparse_from_dense keeps the blocks that have an element other than zero, i.e. 
+ *  with |x| > 2^-63 (JAR_ZERO and below, whose products vanish).
+ *
+ *  The products use the jar_fma pipeline (sum2_LogPS80, exp2_tbl lookup, FP32 
+ *  accumulation) and convert each result once to LogPS80. Every row accumulates its 
+ *  products in ascending column order, as jar_matvecmul and jar_matmul do, so the 
+ *  results equal the dense ones with the zero products left out (up to the sign of 
+ *  zero results: a row without stored values is +JAR_ZERO), and the scalar and _avx512
+ *  kernels give identical results. The run time is proportional to the stored
+ *  values. With AVX512, CSR kernels run 16 rows per vector with masked gathers and BSR
+ *  kernels (bm a multiple of 16, other block heights run the scalar code) 16 rows of a
+ *  block per vector; the _avx512 kernels split the rows into tasks of the JAR thread pool
+ *  with similar numbers of stored values, found in the prefix sums (ops) that 
+ *  jar_sparse_from_dense computes once. x has K elements, y M, B is K x N and C M x N,
+ *  col-major.
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_SPARSE
+
+#define JAR_SPARSE
+#include <stddef.h>
+#include "jar_sim.h"
+
+/* products per task of jar_spmv_avx512 / jar_spmm_avx512 */
+#define JAR_SPARSE_TASK_OPS  65536
+/* columns of B per pass of jar_spmm_avx512 */
+#define JAR_SPARSE_NR        4
+
+typedef struct{
+   int        M;
+   int        K;
+   int        bm;
+   int        bk;
+   int        mb;
+   size_t     nb;
+   size_t*    row_ptr;
+   int*       col_idx;
+   UniJAR*    val;
+   int        rows;       /* block rows per group of the _avx512 kernels, 16 for CSR */
+   int        ng;         /* groups */
+   size_t*    ops;        /* products per column of B of groups 0 ... g-1 plus a cost per row, ng+1 entries */
+} SparseJAR;
+
+int  jar_sparse_from_dense( const int M, const int K, const UniJAR* A, const int bm, const int bk, SparseJAR* S );
+void jar_sparse_to_dense( const SparseJAR* S, UniJAR* A );
+void jar_sparse_free( SparseJAR* S );
+void jar_spmv( const SparseJAR* S, const UniJAR* x, UniJAR* y );
+void jar_spmv_avx512( const SparseJAR* S, const UniJAR* x, UniJAR* y );
+void jar_spmm( const SparseJAR* S, const int N, const UniJAR* B, UniJAR* C );
+void jar_spmm_avx512( const SparseJAR* S, const int N, const UniJAR* B, UniJAR* C );
+
+#endif
@@ -0,0 +1,91 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "jar_timer.h"
+
+double jar_timer_now( ) {
+/* seconds on the monotonic clock */
+  struct timespec t;
+
+  clock_gettime( CLOCK_MONOTONIC, &t );
+  return (double)t.tv_sec + 1.0e-9*(double)t.tv_nsec;
+}
+
+static int jar_double_cmp( const void* a, const void* b ) {
+  const double x = *(const double*)a, y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+void jar_timer_measure( BenchJAR fn, void* arg, const double min_time, TimingJAR* t ) {
+  double s[JAR_TIMER_MAX_SAMPLES];
+  double start, now, one, total = 0.0, sq = 0.0;
+  long   calls = 0, r;
+  int    n = 0, i;
+
+  /* warm-up, which also estimates the time of one call */
+  start = jar_timer_now();
+  do {
+    fn( arg );
+    ++calls;
+    now = jar_timer_now();
+  } while (now - start < JAR_TIMER_WARMUP);
+  one = (now - start)/(double)calls;
+
+  memset( t, 0, sizeof(TimingJAR) );
+  t->reps = (one < JAR_TIMER_SAMPLE) ? (long)(JAR_TIMER_SAMPLE/one) : 1;
+
+  start = jar_timer_now();
+  while (n < JAR_TIMER_MAX_SAMPLES && (n < JAR_TIMER_MIN_SAMPLES || jar_timer_now() - start < min_time)) {
+    const double s0 = jar_timer_now();
+    for (r=0; r<t->reps; ++r) {
+      fn( arg );
+    }
+    s[n] = (jar_timer_now() - s0)/(double)t->reps;
+    total += s[n];
+    sq    += s[n]*s[n];
+    ++n;
+  }
+
+  qsort( s, n, sizeof(double), jar_double_cmp );
+  t->samples = n;
+  t->median  = (n % 2) ? s[n/2] : 0.5*(s[n/2-1] + s[n/2]);
+  i = (int)ceil( 0.99*n ) - 1;
+  t->p99     = s[(i < 0) ? 0 : i];
+  t->min     = s[0];
+  t->max     = s[n-1];
+  t->mean    = total/(double)n;
+  t->stddev  = (n > 1) ? sqrt( fmax( 0.0, (sq - total*total/(double)n)/(double)(n-1) ) ) : 0.0;
+}
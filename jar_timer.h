@@ -0,0 +1,69 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Timing of JAR kernels for benchmarks and tuning.
+ *
+ *  jar_timer_measure runs fn( arg ) repeatedly on the monotonic clock: first for
+ *  JAR_TIMER_WARMUP seconds to warm caches, page tables and the thread pool, then in 
+ *  samples of reps calls each, with reps chosen so that a sample takes about 
+ *  JAR_TIMER_SAMPLE seconds, until min_time seconds and JAR_TIMER_MIN_SAMPLES samples
+ *  have been taken (at most JAR_TIMER_MAX_SAMPLES). The statistics are over the time
+ *  per call of the samples.
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_TIMER
+
+#define JAR_TIMER
+
+#define JAR_TIMER_WARMUP       0.02
+#define JAR_TIMER_SAMPLE       0.002
+#define JAR_TIMER_MIN_SAMPLES  5
+#define JAR_TIMER_MAX_SAMPLES  1000
+
+typedef struct{
+   double        median;     /* seconds per call */
+   double        p99;
+   double        min;
+   double        max;
+   double        mean;
+   double        stddev;
+   long          reps;       /* calls per sample */
+   int           samples;
+} TimingJAR;
+
+typedef void (*BenchJAR)( void* arg );
+
+double jar_timer_now( );
+void jar_timer_measure( BenchJAR fn, void* arg, const double min_time, TimingJAR* t );
+
+#endif
@@ -0,0 +1,262 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include "jar_trace.h"
+
+typedef struct{
+   uint64_t      t0;
+   uint64_t      dur;
+   uint64_t      bytes;
+   uint64_t      flops;
+   int           kernel;
+   int           phase;
+} JarTraceEvent;
+
+typedef struct JarTraceThread{
+   int                     tid;
+   TraceStatJAR            stat[JAR_TRACE_KERNELS][JAR_TRACE_PHASES];
+   JarTraceEvent*          ring;
+   uint64_t                nring;     /* events written since the last reset */
+   struct JarTraceThread*  next;
+} JarTraceThread;
+
+int jar_trace_flags = 0;
+
+static pthread_mutex_t jar_trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t jar_trace_once = PTHREAD_ONCE_INIT;
+static JarTraceThread* jar_trace_threads = NULL;
+static int jar_trace_nthreads = 0;
+static __thread JarTraceThread* jar_trace_self = NULL;
+static uint64_t jar_trace_start = 0;
+static double jar_trace_hz = 1.0e9;
+
+static const char* jar_trace_kernels[JAR_TRACE_KERNELS] = {
+  "dotprod", "matvecmul", "matvecacc", "matmul", "matmulacc", "convert", "ps8", "spmv", "spmm", "nm", "acc"
+};
+static const char* jar_trace_phases[JAR_TRACE_PHASES] = { "pack", "compute", "epilogue" };
+
+static double jar_trace_wall( ) {
+  struct timespec ts;
+
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (double)ts.tv_sec + 1.0e-9*(double)ts.tv_nsec;
+}
+
+static void jar_trace_calibrate( ) {
+/* time stamp counter rate over 20 ms of wall time */
+  const double w0 = jar_trace_wall();
+  const uint64_t c0 = jar_trace_tsc();
+  struct timespec ts = { 0, 20000000 };
+  double w1;
+  uint64_t c1;
+
+  nanosleep( &ts, NULL );
+  w1 = jar_trace_wall();
+  c1 = jar_trace_tsc();
+  jar_trace_hz = (double)(c1 - c0)/(w1 - w0);
+  __atomic_store_n( &jar_trace_start, jar_trace_tsc(), __ATOMIC_RELAXED );
+}
+
+void jar_trace_enable( const int flags ) {
+/* JAR_TRACE_COUNT and / or JAR_TRACE_EVENTS, 0 turns instrumentation off */
+  pthread_once( &jar_trace_once, jar_trace_calibrate );
+  __atomic_store_n( &jar_trace_flags, (flags & JAR_TRACE_EVENTS) ? (flags | JAR_TRACE_COUNT) : flags, __ATOMIC_RELAXED );
+}
+
+int jar_trace_enabled( ) {
+  return __atomic_load_n( &jar_trace_flags, __ATOMIC_RELAXED );
+}
+
+static JarTraceThread* jar_trace_register( ) {
+  JarTraceThread* th = (JarTraceThread*) calloc( 1, sizeof(JarTraceThread) );
+
+  th->tid = (int)syscall( SYS_gettid );
+  pthread_mutex_lock( &jar_trace_lock );
+  th->next = jar_trace_threads;
+  jar_trace_threads = th;
+  ++jar_trace_nthreads;
+  pthread_mutex_unlock( &jar_trace_lock );
+  jar_trace_self = th;
+  return th;
+}
+
+static void jar_trace_add( uint64_t* x, const uint64_t v ) {
+/* only the owning thread writes, readers may load at any time */
+  __atomic_store_n( x, __atomic_load_n( x, __ATOMIC_RELAXED ) + v, __ATOMIC_RELAXED );
+}
+
+void jar_trace_record( const int kernel, const int phase, const uint64_t t0, const uint64_t bytes, const uint64_t flops ) {
+/* adds the phase that started at t0 to the counters (and the ring) of the calling thread */
+  const uint64_t t1 = jar_trace_tsc();
+  JarTraceThread* th = (jar_trace_self != NULL) ? jar_trace_self : jar_trace_register();
+  TraceStatJAR* s = &th->stat[kernel][phase];
+
+  jar_trace_add( &s->calls, 1 );
+  jar_trace_add( &s->cycles, t1 - t0 );
+  jar_trace_add( &s->bytes, bytes );
+  jar_trace_add( &s->flops, flops );
+  if (__atomic_load_n( &jar_trace_flags, __ATOMIC_RELAXED ) & JAR_TRACE_EVENTS) {
+    JarTraceEvent* ring = __atomic_load_n( &th->ring, __ATOMIC_RELAXED );
+    const uint64_t n = __atomic_load_n( &th->nring, __ATOMIC_RELAXED );
+    JarTraceEvent* e;
+    if (ring == NULL) {
+      ring = (JarTraceEvent*) malloc( JAR_TRACE_RING*sizeof(JarTraceEvent) );
+      if (ring == NULL) return;
+      __atomic_store_n( &th->ring, ring, __ATOMIC_RELEASE );
+    }
+    e = ring + (n % JAR_TRACE_RING);
+    e->t0 = t0;
+    e->dur = t1 - t0;
+    e->bytes = bytes;
+    e->flops = flops;
+    e->kernel = kernel;
+    e->phase = phase;
+    __atomic_store_n( &th->nring, n+1, __ATOMIC_RELEASE );
+  }
+}
+
+void jar_trace_reset( ) {
+  JarTraceThread* th;
+  int k, p;
+
+  pthread_mutex_lock( &jar_trace_lock );
+  for (th=jar_trace_threads; th!=NULL; th=th->next) {
+    for (k=0; k<JAR_TRACE_KERNELS; ++k) {
+      for (p=0; p<JAR_TRACE_PHASES; ++p) {
+        __atomic_store_n( &th->stat[k][p].calls, 0, __ATOMIC_RELAXED );
+        __atomic_store_n( &th->stat[k][p].cycles, 0, __ATOMIC_RELAXED );
+        __atomic_store_n( &th->stat[k][p].bytes, 0, __ATOMIC_RELAXED );
+        __atomic_store_n( &th->stat[k][p].flops, 0, __ATOMIC_RELAXED );
+      }
+    }
+    __atomic_store_n( &th->nring, 0, __ATOMIC_RELAXED );
+  }
+  __atomic_store_n( &jar_trace_start, jar_trace_tsc(), __ATOMIC_RELAXED );
+  pthread_mutex_unlock( &jar_trace_lock );
+}
+
+void jar_trace_snapshot( TraceJAR* s ) {
+/* sums the counters of all threads */
+  JarTraceThread* th;
+  int k, p;
+
+  memset( s, 0, sizeof(TraceJAR) );
+  s->tsc_hz = jar_trace_hz;
+  pthread_mutex_lock( &jar_trace_lock );
+  s->nthreads = jar_trace_nthreads;
+  for (th=jar_trace_threads; th!=NULL; th=th->next) {
+    const uint64_t n = __atomic_load_n( &th->nring, __ATOMIC_ACQUIRE );
+    s->events  += (n < JAR_TRACE_RING) ? n : JAR_TRACE_RING;
+    s->dropped += (n < JAR_TRACE_RING) ? 0 : n - JAR_TRACE_RING;
+    for (k=0; k<JAR_TRACE_KERNELS; ++k) {
+      for (p=0; p<JAR_TRACE_PHASES; ++p) {
+        s->stat[k][p].calls  += __atomic_load_n( &th->stat[k][p].calls, __ATOMIC_RELAXED );
+        s->stat[k][p].cycles += __atomic_load_n( &th->stat[k][p].cycles, __ATOMIC_RELAXED );
+        s->stat[k][p].bytes  += __atomic_load_n( &th->stat[k][p].bytes, __ATOMIC_RELAXED );
+        s->stat[k][p].flops  += __atomic_load_n( &th->stat[k][p].flops, __ATOMIC_RELAXED );
+      }
+    }
+  }
+  pthread_mutex_unlock( &jar_trace_lock );
+}
+
+void jar_trace_print( FILE* fp, const TraceJAR* s ) {
+/* one line per kernel and phase that was called */
+  int k, p;
+
+  fprintf( fp, "%-10s %-9s %10s %12s %12s %9s %9s\n", "kernel", "phase", "calls", "total ms", "us/call", "GB/s", "GFLOP/s" );
+  for (k=0; k<JAR_TRACE_KERNELS; ++k) {
+    for (p=0; p<JAR_TRACE_PHASES; ++p) {
+      const TraceStatJAR* t = &s->stat[k][p];
+      const double sec = (double)t->cycles/s->tsc_hz;
+      if (t->calls == 0) continue;
+      fprintf( fp, "%-10s %-9s %10llu %12.3f %12.3f %9.3f %9.3f\n", jar_trace_kernels[k], jar_trace_phases[p],
+               (unsigned long long)t->calls, 1.0e3*sec, 1.0e6*sec/(double)t->calls,
+               (sec > 0.0) ? 1.0e-9*(double)t->bytes/sec : 0.0, (sec > 0.0) ? 1.0e-9*(double)t->flops/sec : 0.0 );
+    }
+  }
+  if (s->events > 0 || s->dropped > 0) {
+    fprintf( fp, "%llu events in %i threads, %llu dropped\n", (unsigned long long)s->events, s->nthreads,
+             (unsigned long long)s->dropped );
+  }
+}
+
+int jar_trace_export( const char* path ) {
+/* Chrome trace-event JSON of the events in the rings, returns 0 on success and -1 on error */
+  const int pid = (int)getpid();
+  const uint64_t start = __atomic_load_n( &jar_trace_start, __ATOMIC_RELAXED );
+  const double us = 1.0e6/jar_trace_hz;
+  FILE* fp = fopen( path, "w" );
+  JarTraceThread* th;
+  uint64_t i, n, dropped = 0;
+  int first = 1;
+
+  if (fp == NULL) {
+    return -1;
+  }
+  fprintf( fp, "{\"traceEvents\":[\n" );
+  pthread_mutex_lock( &jar_trace_lock );
+  for (th=jar_trace_threads; th!=NULL; th=th->next) {
+    const JarTraceEvent* ring = __atomic_load_n( &th->ring, __ATOMIC_ACQUIRE );
+    n = __atomic_load_n( &th->nring, __ATOMIC_ACQUIRE );
+    fprintf( fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%i,\"tid\":%i,\"args\":{\"name\":\"jar %i\"}}",
+             first ? "" : ",\n", pid, th->tid, th->tid );
+    first = 0;
+    if (ring == NULL) continue;
+    dropped += (n > JAR_TRACE_RING) ? n - JAR_TRACE_RING : 0;
+    for (i=(n > JAR_TRACE_RING) ? n - JAR_TRACE_RING : 0; i<n; ++i) {
+      const JarTraceEvent* e = ring + (i % JAR_TRACE_RING);
+      if (e->t0 < start) continue;
+      fprintf( fp, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%i,\"tid\":%i,\"ts\":%.3f,\"dur\":%.3f,"
+               "\"args\":{\"bytes\":%llu,\"flops\":%llu}}", jar_trace_kernels[e->kernel], jar_trace_phases[e->phase],
+               pid, th->tid, us*(double)(e->t0 - start), us*(double)e->dur,
+               (unsigned long long)e->bytes, (unsigned long long)e->flops );
+    }
+  }
+  pthread_mutex_unlock( &jar_trace_lock );
+  fprintf( fp, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"tsc_hz\":%.0f,\"dropped\":%llu}}\n",
+           jar_trace_hz, (unsigned long long)dropped );
+  return (fclose( fp ) == 0) ? 0 : -1;
+}
+
+const char* jar_trace_kernel_name( const int kernel ) {
+  return (kernel >= 0 && kernel < JAR_TRACE_KERNELS) ? jar_trace_kernels[kernel] : "?";
+}
+
+const char* jar_trace_phase_name( const int phase ) {
+  return (phase >= 0 && phase < JAR_TRACE_PHASES) ? jar_trace_phases[phase] : "?";
+}
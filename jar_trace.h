@@ -0,0 +1,145 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Instrumentation of the JAR kernels: per-thread counters of calls, cycles, bytes 
+ *  touched and flops for each kernel and phase (pack, compute, epilogue), and an 
+ *  optional per-thread ring of timed events exported in the Chrome trace-event format
+ *  (chrome://tracing, ui.perfetto.dev).
+ *
+ *  Instrumentation is compiled in unless JAR_NO_TRACE is defined and is off at run 
+ *  time until jar_trace_enable( JAR_TRACE_COUNT ) (counters) or 
+ *  jar_trace_enable( JAR_TRACE_COUNT | JAR_TRACE_EVENTS ) (counters and events). When
+ *  off, an instrumented phase costs one load and branch; when on, two reads of the time
+ *  stamp counter and a few adds to counters owned by the calling thread, no locks and
+ *  no shared cache lines. With JAR_NO_TRACE the macros expand to nothing.
+ *
+ *  jar_trace_snapshot sums the counters of all threads, jar_trace_reset clears them and
+ *  the events, and jar_trace_export writes the events and per-thread names as JSON. 
+ *  The rings keep the last JAR_TRACE_RING events of each thread; older ones are counted
+ *  as dropped. Snapshots may be taken at any time, reset and export are meant for 
+ *  quiescent points (no kernels running). Cycles are time stamp counter ticks, 
+ *  converted to seconds with the rate measured at the first enable.
+ *
+ *  The conversion to LogPS80 that jar_matmul_avx512 fuses into its register blocks is 
+ *  part of the compute phase; only the unfused remainder is counted as epilogue.
+ *
+ *  A kernel is instrumented by bracketing each phase:
+ *
+ *    JAR_TRACE_BEGIN( t );
+ *    ... compute ...
+ *    JAR_TRACE_END( t, JAR_TK_MATMUL, JAR_TP_COMPUTE, bytes, flops );
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_TRACE
+
+#define JAR_TRACE
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define JAR_TRACE_COUNT   1
+#define JAR_TRACE_EVENTS  2
+/* events kept per thread */
+#define JAR_TRACE_RING    65536
+
+/* kernels */
+#define JAR_TK_DOTPROD    0
+#define JAR_TK_MATVECMUL  1
+#define JAR_TK_MATVECACC  2
+#define JAR_TK_MATMUL     3
+#define JAR_TK_MATMULACC  4
+#define JAR_TK_CONVERT    5
+#define JAR_TK_PS8        6
+#define JAR_TK_SPMV       7
+#define JAR_TK_SPMM       8
+#define JAR_TK_NM         9
+#define JAR_TK_ACC        10
+#define JAR_TRACE_KERNELS 11
+
+/* phases */
+#define JAR_TP_PACK       0
+#define JAR_TP_COMPUTE    1
+#define JAR_TP_EPILOGUE   2
+#define JAR_TRACE_PHASES  3
+
+typedef struct{
+   uint64_t      calls;
+   uint64_t      cycles;
+   uint64_t      bytes;
+   uint64_t      flops;
+} TraceStatJAR;
+
+typedef struct{
+   double        tsc_hz;                 /* cycles per second */
+   int           nthreads;               /* threads that recorded since the start */
+   uint64_t      events;                 /* events held in the rings */
+   uint64_t      dropped;                /* events overwritten in the rings */
+   TraceStatJAR  stat[JAR_TRACE_KERNELS][JAR_TRACE_PHASES];
+} TraceJAR;
+
+extern int jar_trace_flags;
+
+static inline uint64_t jar_trace_tsc( ) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (uint64_t)ts.tv_sec*1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+#if defined(JAR_NO_TRACE)
+#define JAR_TRACE_BEGIN( t )
+#define JAR_TRACE_END( t, kernel, phase, bytes, flops )
+#else
+#define JAR_TRACE_BEGIN( t ) \
+  const uint64_t t = __atomic_load_n( &jar_trace_flags, __ATOMIC_RELAXED ) ? jar_trace_tsc() : 0
+#define JAR_TRACE_END( t, kernel, phase, bytes, flops ) \
+  do { if (t != 0) jar_trace_record( kernel, phase, t, (uint64_t)(bytes), (uint64_t)(flops) ); } while (0)
+#endif
+
+void jar_trace_enable( const int flags );
+int jar_trace_enabled( );
+void jar_trace_record( const int kernel, const int phase, const uint64_t t0, const uint64_t bytes, const uint64_t flops );
+void jar_trace_reset( );
+void jar_trace_snapshot( TraceJAR* s );
+void jar_trace_print( FILE* fp, const TraceJAR* s );
+int jar_trace_export( const char* path );
+const char* jar_trace_kernel_name( const int kernel );
+const char* jar_trace_phase_name( const int phase );
+
+#endif
@@ -0,0 +1,293 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "jar_train.h"
+#include "jar_pool.h"
+
+typedef struct{
+   int            M;
+   int            N;
+   int            K;
+   const UniJAR*  X;
+   const UniJAR*  Y;
+   UniJAR*        Z;
+   double*        Z_acc;
+} JarTrainArg;
+
+void jar_matmul_bwd_data( const int M, const int N, const int K, const UniJAR* A, const UniJAR* dC, UniJAR* dB ) {
+/* 
+compute the data gradient dB = A^T * dC in JAR. dB[k,n] is the dot product of column k of A
+with column n of dC, both contiguous. The products are summed in FP32 over blocks of
+JAR_ACC_BLOCK terms and the block sums in FP64, then converted to LogPS80 once. 
+A is M x K, dC is M x N and dB is K x N, all in col-major format.
+*/
+  UniJAR p, t;
+  double s;
+  int    m, n, k, m0, m1;
+
+  assert (M >= 0);
+  assert (N >= 0);
+  assert (K >= 0);
+
+  for (n=0; n<N; ++n) {
+    for (k=0; k<K; ++k) {
+      s = 0.0;
+      for (m0=0; m0<M; m0+=JAR_ACC_BLOCK) {
+        m1 = (m0+JAR_ACC_BLOCK < M) ? m0+JAR_ACC_BLOCK : M;
+        p.I = JAR_ZERO;
+        for (m=m0; m<m1; ++m) {
+          jar_fma( A+(k*M)+m, dC+(n*M)+m, &p );
+        }
+        s += (double)p.F;
+      }
+      t.F = (float)s;
+      dB[(n*K)+k] = LinFP32_2_LogPS80( t );
+    }
+  }
+}
+
+static void jar_bwd_data_block( const int M, const int K, const UniJAR* A, const UniJAR* dC, UniJAR* dB,
+                                const int k, const int n, const int kb, const int nb ) {
+/* 
+computes the kb x nb block (kb, nb <= 4) of dB = A^T * dC starting at (k, n). Every pair 
+(i, j) owns a 16-wide accumulator, so each loaded vector of A and of dC is used 4 times.
+*/
+  double s[4][4];
+  UniJAR p, t;
+  int    i, j, m, m0, m1;
+  int    mv = 0;
+
+  for (i=0; i<kb; ++i) {
+    for (j=0; j<nb; ++j) {
+      s[i][j] = 0.0;
+    }
+  }
+
+#if defined(__AVX512F__)
+  mv = (M/16)*16;
+  for (m0=0; m0<mv; m0+=JAR_ACC_BLOCK) {
+    __m512i vacc[4][4];
+    m1 = (m0+JAR_ACC_BLOCK < mv) ? m0+JAR_ACC_BLOCK : mv;
+    for (i=0; i<kb; ++i) {
+      for (j=0; j<nb; ++j) {
+        vacc[i][j] = _mm512_setzero_si512();
+      }
+    }
+    for (m=m0; m<m1; m+=16) {
+      __m512i va[4];
+      __m512i vc[4];
+      for (i=0; i<kb; ++i) {
+        va[i] = _mm512_loadu_epi32( A+((k+i)*M)+m );
+      }
+      for (j=0; j<nb; ++j) {
+        vc[j] = _mm512_loadu_epi32( dC+((n+j)*M)+m );
+      }
+      for (i=0; i<kb; ++i) {
+        for (j=0; j<nb; ++j) {
+          vacc[i][j] = jar_fma_avx512( va[i], vc[j], vacc[i][j] );
+        }
+      }
+    }
+    for (i=0; i<kb; ++i) {
+      for (j=0; j<nb; ++j) {
+        s[i][j] += (double)_mm512_reduce_add_ps( _mm512_castsi512_ps( vacc[i][j] ) );
+      }
+    }
+  }
+#endif
+
+  for (i=0; i<kb; ++i) {
+    for (j=0; j<nb; ++j) {
+      for (m0=mv; m0<M; m0+=JAR_ACC_BLOCK) {
+        m1 = (m0+JAR_ACC_BLOCK < M) ? m0+JAR_ACC_BLOCK : M;
+        p.I = JAR_ZERO;
+        for (m=m0; m<m1; ++m) {
+          jar_fma( A+((k+i)*M)+m, dC+((n+j)*M)+m, &p );
+        }
+        s[i][j] += (double)p.F;
+      }
+      t.F = (float)s[i][j];
+      dB[((n+j)*K)+k+i] = LinFP32_2_LogPS80( t );
+    }
+  }
+}
+
+static void jar_bwd_data_task( void* arg, const int t ) {
+/* 4 x 4 block t of dB, see jar_matmul_bwd_data_avx512 */
+  const JarTrainArg* a = (const JarTrainArg*)arg;
+  const int kblocks = (a->K+3)/4;
+  const int k  = (t % kblocks)*4;
+  const int n  = (t / kblocks)*4;
+  const int kb = (a->K-k < 4) ? a->K-k : 4;
+  const int nb = (a->N-n < 4) ? a->N-n : 4;
+
+  jar_bwd_data_block( a->M, a->K, a->X, a->Y, a->Z, k, n, kb, nb );
+}
+
+void jar_matmul_bwd_data_avx512( const int M, const int N, const int K, const UniJAR* A, const UniJAR* dC, UniJAR* dB ) {
+/* 
+compute the data gradient dB = A^T * dC in JAR, see jar_matmul_bwd_data. dB is computed in 
+4 x 4 blocks which are tasks of the JAR thread pool.
+*/
+  JarTrainArg a;
+
+  assert (M >= 0);
+  assert (N >= 0);
+  assert (K >= 0);
+
+  a.M = M; a.N = N; a.K = K; a.X = A; a.Y = dC; a.Z = dB; a.Z_acc = NULL;
+  jar_parallel_for( ((K+3)/4)*((N+3)/4), jar_bwd_data_task, &a );
+}
+
+void jar_matmul_bwd_weight( const int M, const int N, const int K, const UniJAR* dC, const UniJAR* B, double* dA_acc ) {
+/* 
+accumulate the weight gradient dA_acc += dC * B^T in JAR. The products are summed in FP32 
+over blocks of JAR_ACC_BLOCK samples and added into the FP64 accumulator dA_acc, which is
+not converted here (see jar_acc_2_LogPS80). dC is M x N, B is K x N and dA_acc is M x K,
+all in col-major format.
+*/
+  UniJAR p;
+  int    m, n, k, n0, n1;
+
+  assert (M >= 0);
+  assert (N >= 0);
+  assert (K >= 0);
+
+  for (n0=0; n0<N; n0+=JAR_ACC_BLOCK) {
+    n1 = (n0+JAR_ACC_BLOCK < N) ? n0+JAR_ACC_BLOCK : N;
+    for (k=0; k<K; ++k) {
+      for (m=0; m<M; ++m) {
+        p.I = JAR_ZERO;
+        for (n=n0; n<n1; ++n) {
+          jar_fma( dC+(n*M)+m, B+(n*K)+k, &p );
+        }
+        dA_acc[((size_t)k*M)+m] += (double)p.F;
+      }
+    }
+  }
+}
+
+static void jar_bwd_weight_block( const int M, const int N, const int K, const UniJAR* dC, const UniJAR* B, double* dA_acc,
+                                  const int k, const int kb ) {
+/* 
+accumulates the columns k, ..., k+kb-1 (kb <= 8) of dA_acc += dC * B^T. As in the 16x8
+blocking of jar_matmul_avx512, one vector of dC is combined with kb broadcasts of B.
+*/
+  UniJAR p;
+  int    j, m, n, n0, n1;
+
+  m = 0;
+#if defined(__AVX512F__)
+  for ( ; m<(M/16)*16; m+=16) {
+    for (n0=0; n0<N; n0+=JAR_ACC_BLOCK) {
+      __m512i vacc[8];
+      n1 = (n0+JAR_ACC_BLOCK < N) ? n0+JAR_ACC_BLOCK : N;
+      for (j=0; j<kb; ++j) {
+        vacc[j] = _mm512_setzero_si512();
+      }
+      for (n=n0; n<n1; ++n) {
+        __m512i va = _mm512_loadu_epi32( dC+(n*M)+m );
+        for (j=0; j<kb; ++j) {
+          vacc[j] = jar_fma_avx512( va, _mm512_set1_epi32( B[(n*K)+k+j].I ), vacc[j] );
+        }
+      }
+      for (j=0; j<kb; ++j) {
+        double* d = dA_acc + ((size_t)(k+j)*M) + m;
+        __m256  lo = _mm512_castps512_ps256( _mm512_castsi512_ps( vacc[j] ) );
+        __m256  hi = _mm256_castsi256_ps( _mm512_extracti64x4_epi64( vacc[j], 1 ) );
+        _mm512_storeu_pd( d,   _mm512_add_pd( _mm512_loadu_pd( d ),   _mm512_cvtps_pd( lo ) ) );
+        _mm512_storeu_pd( d+8, _mm512_add_pd( _mm512_loadu_pd( d+8 ), _mm512_cvtps_pd( hi ) ) );
+      }
+    }
+  }
+#endif
+  for ( ; m<M; ++m) {
+    for (j=0; j<kb; ++j) {
+      for (n0=0; n0<N; n0+=JAR_ACC_BLOCK) {
+        n1 = (n0+JAR_ACC_BLOCK < N) ? n0+JAR_ACC_BLOCK : N;
+        p.I = JAR_ZERO;
+        for (n=n0; n<n1; ++n) {
+          jar_fma( dC+(n*M)+m, B+(n*K)+k+j, &p );
+        }
+        dA_acc[((size_t)(k+j)*M)+m] += (double)p.F;
+      }
+    }
+  }
+}
+
+static void jar_bwd_weight_task( void* arg, const int t ) {
+/* columns 8t ... 8t+7 of dA_acc, see jar_matmul_bwd_weight_avx512 */
+  const JarTrainArg* a = (const JarTrainArg*)arg;
+  const int k  = t*8;
+  const int kb = (a->K-k < 8) ? a->K-k : 8;
+
+  jar_bwd_weight_block( a->M, a->N, a->K, a->X, a->Y, a->Z_acc, k, kb );
+}
+
+void jar_matmul_bwd_weight_avx512( const int M, const int N, const int K, const UniJAR* dC, const UniJAR* B, double* dA_acc ) {
+/* 
+accumulate the weight gradient dA_acc += dC * B^T in JAR, see jar_matmul_bwd_weight. Blocks
+of 8 columns of dA_acc are tasks of the JAR thread pool, so no two threads ever update the
+same accumulator.
+*/
+  JarTrainArg a;
+
+  assert (M >= 0);
+  assert (N >= 0);
+  assert (K >= 0);
+
+  a.M = M; a.N = N; a.K = K; a.X = dC; a.Y = B; a.Z = NULL; a.Z_acc = dA_acc;
+  jar_parallel_for( (K+7)/8, jar_bwd_weight_task, &a );
+}
+
+void jar_acc_2_LogPS80( const size_t n, const double* acc, UniJAR* x, const RndJAR* rnd ) {
+/* 
+converts n FP64 linear domain accumulators to LogPS80 with rounding mode rnd
+(NULL for round-to-nearest), see LinFP32_2_LogPS80_rnd
+*/
+  size_t i = 0;
+  UniJAR t;
+
+#if defined(__AVX512F__)
+  for ( ; i<(n/16)*16; i+=16) {
+    __m256  lo = _mm512_cvtpd_ps( _mm512_loadu_pd( acc+i ) );
+    __m256  hi = _mm512_cvtpd_ps( _mm512_loadu_pd( acc+i+8 ) );
+    __m512d v  = _mm512_insertf64x4( _mm512_castpd256_pd512( _mm256_castps_pd( lo ) ), _mm256_castps_pd( hi ), 1 );
+    _mm512_storeu_epi32( x+i, LinFP32_2_LogPS80_rnd_avx512( _mm512_castpd_si512( v ), rnd, i ) );
+  }
+#endif
+  for ( ; i<n; ++i) {
+    t.F = (float)acc[i];
+    x[i] = LinFP32_2_LogPS80_rnd( t, rnd, i );
+  }
+}
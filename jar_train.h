@@ -0,0 +1,67 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Kernels for training in JAR.
+ *
+ *  With the forward product C = A*B of jar_matmul (A = weights, M x K; B = activations,
+ *  K x N, one sample per column; all col-major) the two gradient products are
+ *
+ *     jar_matmul_bwd_data:    dB = A^T * dC     (K x N, LogPS80)
+ *     jar_matmul_bwd_weight:  dA_acc += dC * B^T (M x K, linear domain)
+ *
+ *  Both reduce over a dimension that can be long (M for dB, the batch N for dA). The 
+ *  products are accumulated in FP32 over blocks of JAR_ACC_BLOCK terms and the block sums
+ *  are added into FP64, which keeps the emulated accumulator close to exact for long 
+ *  reductions. The weight gradient stays in the caller's FP64 accumulator dA_acc so that
+ *  it can be accumulated over several micro-batches and converted to LogPS80 only once 
+ *  by jar_acc_2_LogPS80. The caller initializes dA_acc, usually to zero. Weight updates
+ *  that are small relative to the weights can pass a stochastic rounding mode (RndJAR) to
+ *  jar_acc_2_LogPS80 so that they are not systematically rounded away.
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_TRAIN
+
+#define JAR_TRAIN
+#include "jar_sim.h"
+
+/* number of products summed in FP32 before the partial sum is added into FP64 */
+#define JAR_ACC_BLOCK  256
+
+void jar_matmul_bwd_data( const int M, const int N, const int K, const UniJAR* A, const UniJAR* dC, UniJAR* dB );
+void jar_matmul_bwd_data_avx512( const int M, const int N, const int K, const UniJAR* A, const UniJAR* dC, UniJAR* dB );
+void jar_matmul_bwd_weight( const int M, const int N, const int K, const UniJAR* dC, const UniJAR* B, double* dA_acc );
+void jar_matmul_bwd_weight_avx512( const int M, const int N, const int K, const UniJAR* dC, const UniJAR* B, double* dA_acc );
+void jar_acc_2_LogPS80( const size_t n, const double* acc, UniJAR* x, const RndJAR* rnd );
+
+#endif
+
@@ -0,0 +1,405 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "jar_tune.h"
+#include "jar_sim.h"
+#include "jar_mem.h"
+#include "jar_timer.h"
+
+#define JAR_TUNE_LINE  512
+/* factor by which a blocked candidate has to beat the default kernel */
+#define JAR_TUNE_MARGIN  1.03
+
+static const char* jar_tune_classes[JAR_SHAPE_CLASSES] = { "gemv", "small", "skinny", "square" };
+/* the parameters standing for jar_matmul_avx512 / jar_matvecmul_avx512 */
+static const BlockJAR jar_tune_kernel = { 0, 0, 0, 0, 0, 0 };
+
+static pthread_once_t jar_tune_once = PTHREAD_ONCE_INIT;
+static BlockJAR jar_tune_p[JAR_SHAPE_CLASSES];
+static double jar_tune_gops[JAR_SHAPE_CLASSES];
+static int jar_tune_have[JAR_SHAPE_CLASSES];
+static char jar_tune_model[128];
+static char jar_tune_file[JAR_TUNE_LINE];
+
+int jar_tune_class( const int M, const int N, const int K ) {
+  if (N == 1) return JAR_SHAPE_GEMV;
+  if ((double)M*N*K <= 2097152.0) return JAR_SHAPE_SMALL;
+  if (M <= 32 || N <= 32) return JAR_SHAPE_SKINNY;
+  return JAR_SHAPE_SQUARE;
+}
+
+const char* jar_tune_class_name( const int cls ) {
+  return (cls >= 0 && cls < JAR_SHAPE_CLASSES) ? jar_tune_classes[cls] : "?";
+}
+
+const char* jar_tune_isa( ) {
+#if defined(__AVX512F__)
+  return "avx512";
+#else
+  return "scalar";
+#endif
+}
+
+void jar_tune_default( const int cls, BlockJAR* p ) {
+/* the parameters of a class before tuning */
+  p->mv = 1; p->nr = 8; p->mc = 128; p->kc = 0; p->nc = 64; p->split = JAR_SPLIT_M;
+  if (cls == JAR_SHAPE_GEMV) {
+    p->mv = 4; p->nr = 1; p->mc = 256;
+  } else if (cls == JAR_SHAPE_SMALL) {
+    p->mc = 64; p->split = JAR_SPLIT_NONE;
+  } else if (cls == JAR_SHAPE_SQUARE) {
+    p->kc = 256; p->nc = 128; p->split = JAR_SPLIT_MN;
+  }
+}
+
+static int jar_tune_valid( const int cls, const BlockJAR* p ) {
+  if (memcmp( p, &jar_tune_kernel, sizeof(BlockJAR) ) == 0) {
+    return 1;
+  }
+  if (p->mc < 16 || p->mc % 16 != 0 || p->kc < 0 || p->nc < 1 || p->split < JAR_SPLIT_NONE || p->split > JAR_SPLIT_MN) {
+    return 0;
+  }
+  if (cls == JAR_SHAPE_GEMV) {
+    return p->mv == 1 || p->mv == 2 || p->mv == 4;
+  }
+  return (p->mv == 1 || p->mv == 2) && (p->nr == 1 || p->nr == 4 || p->nr == 8 || p->nr == 12);
+}
+
+static int jar_tune_parse( const char* line, char* cpu, char* isa, int* cls, BlockJAR* p, double* gops ) {
+/* one line of the cache, returns 0 if it is well formed */
+  const char* f[5];
+  char name[32];
+  int i;
+
+  f[0] = line;
+  for (i=1; i<5; ++i) {
+    f[i] = strchr( f[i-1], '|' );
+    if (f[i] == NULL) return -1;
+    ++f[i];
+  }
+  if (f[1]-f[0]-1 >= 128 || f[2]-f[1]-1 >= 16 || f[3]-f[2]-1 >= 32) return -1;
+  memcpy( cpu, f[0], f[1]-f[0]-1 ); cpu[f[1]-f[0]-1] = '\0';
+  memcpy( isa, f[1], f[2]-f[1]-1 ); isa[f[2]-f[1]-1] = '\0';
+  memcpy( name, f[2], f[3]-f[2]-1 ); name[f[3]-f[2]-1] = '\0';
+  for (*cls=0; *cls<JAR_SHAPE_CLASSES && strcmp( name, jar_tune_classes[*cls] ) != 0; ++*cls) ;
+  if (*cls == JAR_SHAPE_CLASSES) return -1;
+  if (sscanf( f[3], "%i %i %i %i %i %i", &p->mv, &p->nr, &p->mc, &p->kc, &p->nc, &p->split ) != 6) return -1;
+  if (sscanf( f[4], "%lf", gops ) != 1) return -1;
+  return jar_tune_valid( *cls, p ) ? 0 : -1;
+}
+
+static int jar_tune_read( const char* path ) {
+  FILE* fp = fopen( path, "r" );
+  char line[JAR_TUNE_LINE], cpu[128], isa[16];
+  BlockJAR p;
+  double gops;
+  int cls, n = 0;
+
+  if (fp == NULL) {
+    return -1;
+  }
+  while (fgets( line, sizeof(line), fp ) != NULL) {
+    if (line[0] == '#' || jar_tune_parse( line, cpu, isa, &cls, &p, &gops ) != 0) continue;
+    if (strcmp( cpu, jar_tune_model ) == 0 && strcmp( isa, jar_tune_isa() ) == 0) {
+      jar_tune_p[cls] = p;
+      jar_tune_gops[cls] = gops;
+      jar_tune_have[cls] = 1;
+      ++n;
+    }
+  }
+  fclose( fp );
+  return n;
+}
+
+static void jar_tune_init( ) {
+/* cpu model, cache path and the parameters of the cache file */
+  const char* env = getenv( "JAR_TUNE_FILE" );
+  const char* home = getenv( "HOME" );
+  FILE* fp = fopen( "/proc/cpuinfo", "r" );
+  char line[JAR_TUNE_LINE];
+  char* c;
+  int cls;
+
+  strcpy( jar_tune_model, "unknown" );
+  while (fp != NULL && fgets( line, sizeof(line), fp ) != NULL) {
+    if (strncmp( line, "model name", 10 ) == 0 && (c = strchr( line, ':' )) != NULL) {
+      for (++c; *c == ' ' || *c == '\t'; ++c) ;
+      c[strcspn( c, "\n" )] = '\0';
+      strncpy( jar_tune_model, c, sizeof(jar_tune_model)-1 );
+      break;
+    }
+  }
+  if (fp != NULL) fclose( fp );
+  for (c=jar_tune_model; *c; ++c) {
+    if (*c == '|') *c = ' ';
+  }
+
+  if (env != NULL) {
+    snprintf( jar_tune_file, sizeof(jar_tune_file), "%s", env );
+  } else if (home != NULL) {
+    snprintf( jar_tune_file, sizeof(jar_tune_file), "%s/.jar_tune", home );
+  }
+
+  for (cls=0; cls<JAR_SHAPE_CLASSES; ++cls) {
+    jar_tune_default( cls, jar_tune_p+cls );
+  }
+  if (jar_tune_file[0] != '\0') {
+    jar_tune_read( jar_tune_file );
+  }
+}
+
+const char* jar_tune_cpu( ) {
+  pthread_once( &jar_tune_once, jar_tune_init );
+  return jar_tune_model;
+}
+
+const char* jar_tune_path( ) {
+/* the cache file, "" if there is none */
+  pthread_once( &jar_tune_once, jar_tune_init );
+  return jar_tune_file;
+}
+
+const BlockJAR* jar_tune_params( const int cls ) {
+  pthread_once( &jar_tune_once, jar_tune_init );
+  return jar_tune_p + cls;
+}
+
+void jar_tune_set( const int cls, const BlockJAR* p, const double gops ) {
+/* not while tuned kernels run */
+  pthread_once( &jar_tune_once, jar_tune_init );
+  jar_tune_p[cls] = *p;
+  jar_tune_gops[cls] = gops;
+  jar_tune_have[cls] = 1;
+}
+
+int jar_tune_load( const char* path ) {
+/* the entries of this cpu and instruction set, returns their number or -1 if path cannot be read */
+  pthread_once( &jar_tune_once, jar_tune_init );
+  return jar_tune_read( path );
+}
+
+int jar_tune_save( const char* path ) {
+/* rewrites path with the tuned classes of this cpu and instruction set, returns 0 on success */
+  FILE* in = fopen( path, "r" );
+  FILE* out;
+  char tmp[JAR_TUNE_LINE+8], line[JAR_TUNE_LINE], cpu[128], isa[16];
+  BlockJAR p;
+  double gops;
+  int cls;
+
+  pthread_once( &jar_tune_once, jar_tune_init );
+  snprintf( tmp, sizeof(tmp), "%s.tmp", path );
+  out = fopen( tmp, "w" );
+  if (out == NULL) {
+    if (in != NULL) fclose( in );
+    return -1;
+  }
+  fprintf( out, "# jar_tune cache: cpu model|isa|class|mv nr mc kc nc split|GOP/s\n" );
+  while (in != NULL && fgets( line, sizeof(line), in ) != NULL) {
+    if (line[0] == '#' || jar_tune_parse( line, cpu, isa, &cls, &p, &gops ) != 0) continue;
+    if (strcmp( cpu, jar_tune_model ) == 0 && strcmp( isa, jar_tune_isa() ) == 0 && jar_tune_have[cls]) continue;
+    fputs( line, out );
+  }
+  if (in != NULL) fclose( in );
+  for (cls=0; cls<JAR_SHAPE_CLASSES; ++cls) {
+    const BlockJAR* q = jar_tune_p+cls;
+    if (!jar_tune_have[cls]) continue;
+    fprintf( out, "%s|%s|%s|%i %i %i %i %i %i|%.3f\n", jar_tune_model, jar_tune_isa(), jar_tune_classes[cls],
+             q->mv, q->nr, q->mc, q->kc, q->nc, q->split, jar_tune_gops[cls] );
+  }
+  if (fclose( out ) != 0 || rename( tmp, path ) != 0) {
+    remove( tmp );
+    return -1;
+  }
+  return 0;
+}
+
+typedef struct{
+   int             cls;
+   int             M;
+   int             N;
+   int             K;
+   UniJAR*         A;
+   UniJAR*         B;
+   UniJAR*         C;
+   const BlockJAR* p;
+} JarTuneArg;
+
+static void jar_tune_gemm( const int cls, const int M, const int N, const int K, const UniJAR* A, const UniJAR* B, UniJAR* C, const BlockJAR* p ) {
+/* the product of class cls with the parameters p, mv 0 is the default kernel */
+  if (cls == JAR_SHAPE_GEMV) {
+    if (p->mv == 0) {
+      jar_matvecmul_avx512( M, K, A, B, C );
+    } else {
+      jar_matvecmul_blocked_avx512( M, K, A, B, C, p );
+    }
+  } else {
+    if (p->mv == 0) {
+      jar_matmul_avx512( M, N, K, A, B, C );
+    } else {
+      jar_matmul_blocked_avx512( M, N, K, A, B, C, p );
+    }
+  }
+}
+
+static void jar_tune_call( void* arg ) {
+  JarTuneArg* a = (JarTuneArg*)arg;
+
+  jar_tune_gemm( a->cls, a->M, a->N, a->K, a->A, a->B, a->C, a->p );
+}
+
+static double jar_tune_try( JarTuneArg* a, const BlockJAR* p, const double min_time, BlockJAR* best, double* gbest, FILE* log ) {
+/* GOP/s of p, which replaces best if it is faster */
+  TimingJAR t;
+  double gops;
+
+  if (!jar_tune_valid( a->cls, p )) {
+    return 0.0;
+  }
+  a->p = p;
+  jar_timer_measure( jar_tune_call, a, min_time, &t );
+  gops = 2.0e-9*a->M*a->N*a->K/t.median;
+  if (log != NULL && p->mv == 0) {
+    fprintf( log, "  %-6s default kernel: %9.3f GOP/s\n", jar_tune_classes[a->cls], gops );
+  } else if (log != NULL) {
+    fprintf( log, "  %-6s mv %i nr %2i mc %4i kc %4i nc %4i split %i: %9.3f GOP/s\n", jar_tune_classes[a->cls],
+             p->mv, p->nr, p->mc, p->kc, p->nc, p->split, gops );
+  }
+  if (gops > *gbest) {
+    *gbest = gops;
+    *best = *p;
+  }
+  return gops;
+}
+
+double jar_tune_run( const int cls, const int M, const int N, const int K, const double min_time, BlockJAR* best, FILE* log ) {
+/* 
+tunes class cls on the shape M x N x K, returns the best GOP/s and its parameters in best;
+the parameters in use are not changed (see jar_tune_set). The default kernel is timed as
+well and wins unless the best blocking beats it by JAR_TUNE_MARGIN.
+*/
+#if defined(__AVX512F__)
+  static const int mvs[3] = { 1, 2, 4 };
+  static const int nrs[3] = { 4, 8, 12 };
+#endif
+  static const int mcs[5] = { 32, 64, 128, 256, 512 };
+  static const int kcs[4] = { 0, 128, 256, 512 };
+  static const int mcv[5] = { 64, 256, 1024, 4096, 16384 };
+  static const int ncs[3] = { 16, 64, 256 };
+  const int n = (cls == JAR_SHAPE_GEMV) ? 1 : N;
+  unsigned int seed = 4711;
+  JarTuneArg a;
+  BlockJAR p, b;
+  double g = 0.0, g0 = 0.0;
+  int u, v;
+
+  a.cls = cls; a.M = M; a.N = n; a.K = K;
+  a.A = (UniJAR*) jar_malloc( (size_t)M*K*sizeof(UniJAR) );
+  a.B = (UniJAR*) jar_malloc( (size_t)K*n*sizeof(UniJAR) );
+  a.C = (UniJAR*) jar_malloc( (size_t)M*n*sizeof(UniJAR) );
+  jar_fill_uniform( (size_t)M*K, a.A, NULL, &seed );
+  jar_fill_uniform( (size_t)K*n, a.B, NULL, &seed );
+
+  jar_tune_default( cls, &b );
+  jar_tune_try( &a, &b, min_time, &b, &g, log );
+  if (cls == JAR_SHAPE_GEMV) {
+#if defined(__AVX512F__)
+    for (u=0; u<3; ++u) {
+      p = b; p.mv = mvs[u];
+      jar_tune_try( &a, &p, min_time, &b, &g, log );
+    }
+#endif
+    p = b;
+    for (u=0; u<5; ++u) {
+      p.mc = mcv[u];
+      for (v=JAR_SPLIT_NONE; v<=JAR_SPLIT_M; ++v) {
+        p.split = v;
+        if (v == JAR_SPLIT_NONE && u > 0) continue;
+        jar_tune_try( &a, &p, min_time, &b, &g, log );
+      }
+    }
+  } else {
+#if defined(__AVX512F__)
+    p = b;
+    for (u=0; u<2; ++u) {
+      for (v=0; v<3; ++v) {
+        p.mv = mvs[u]; p.nr = nrs[v];
+        jar_tune_try( &a, &p, min_time, &b, &g, log );
+      }
+    }
+#endif
+    p = b;
+    for (u=0; u<5; ++u) {
+      for (v=0; v<4; ++v) {
+        p.mc = mcs[u]; p.kc = kcs[v];
+        if (p.kc >= K) continue;
+        jar_tune_try( &a, &p, min_time, &b, &g, log );
+      }
+    }
+    p = b;
+    for (v=JAR_SPLIT_NONE; v<=JAR_SPLIT_MN; ++v) {
+      for (u=0; u<3; ++u) {
+        p.split = v; p.nc = ncs[u];
+        if ((v == JAR_SPLIT_NONE || v == JAR_SPLIT_M) && u > 0) continue;
+        jar_tune_try( &a, &p, min_time, &b, &g, log );
+      }
+    }
+  }
+  jar_tune_try( &a, &jar_tune_kernel, min_time, &p, &g0, log );
+  if (g0*JAR_TUNE_MARGIN >= g) {
+    b = jar_tune_kernel;
+    g = g0;
+  }
+  *best = b;
+
+  jar_free( a.C );
+  jar_free( a.B );
+  jar_free( a.A );
+  return g;
+}
+
+void jar_matmul_tuned( const int M, const int N, const int K, const UniJAR* A, const UniJAR* B, UniJAR* C ) {
+/* 
+jar_matmul_blocked_avx512 with the parameters of the class of M x N x K, or jar_matmul_avx512
+if the default kernel won the tuning; a product with one column is a GEMV
+*/
+  const int cls = jar_tune_class( M, N, K );
+
+  jar_tune_gemm( cls, M, N, K, A, B, C, jar_tune_params( cls ) );
+}
+
+void jar_matvecmul_tuned( const int M, const int K, const UniJAR* A, const UniJAR* b, UniJAR* c ) {
+  jar_tune_gemm( JAR_SHAPE_GEMV, M, 1, K, A, b, c, jar_tune_params( JAR_SHAPE_GEMV ) );
+}
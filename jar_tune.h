@@ -0,0 +1,86 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Autotuning of the blocking of the JAR GEMM and GEMV (BlockJAR, see jar_type.h) per
+ *  instruction set and shape class, with an on-disk cache keyed by cpu model.
+ *
+ *  Shapes fall in the classes gemv (N = 1), small (M*N*K <= 2^21), skinny (M or N at 
+ *  most 32) and square (the rest). jar_matmul_tuned and jar_matvecmul_tuned run 
+ *  jar_matmul_blocked_avx512 / jar_matvecmul_blocked_avx512 with the parameters of the
+ *  class of their shape, or jar_matmul_avx512 / jar_matvecmul_avx512 where the default
+ *  kernel won (parameters all 0); the results do not depend on the parameters.
+ *
+ *  jar_tune_run benchmarks candidates on one shape of a class with jar_timer_measure 
+ *  and keeps the fastest. The search is staged, each stage starting from the best so 
+ *  far: the register block (mv x nr, AVX512 only), then the cache blocks mc x kc, then
+ *  nc and the task split. The default kernel is timed last and kept unless the best
+ *  blocking is faster by a margin, so the tuned kernels do not fall behind it.
+ *
+ *  The cache is a text file with one line per cpu model, instruction set and class:
+ *
+ *    cpu model|isa|class|mv nr mc kc nc split|GOP/s
+ *
+ *  On first use the parameters are loaded from jar_tune_path() (JAR_TUNE_FILE, else 
+ *  $HOME/.jar_tune) for the running cpu and instruction set, so tuned runs pay only
+ *  for reading the file; classes without an entry use the built-in defaults. 
+ *  jar_tune_save rewrites the file with the entries of this cpu replaced and those of 
+ *  other cpus kept, so one file can serve a fleet.
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_TUNE
+
+#define JAR_TUNE
+#include <stdio.h>
+#include "jar_type.h"
+
+#define JAR_SHAPE_GEMV     0
+#define JAR_SHAPE_SMALL    1
+#define JAR_SHAPE_SKINNY   2
+#define JAR_SHAPE_SQUARE   3
+#define JAR_SHAPE_CLASSES  4
+
+int jar_tune_class( const int M, const int N, const int K );
+const char* jar_tune_class_name( const int cls );
+const char* jar_tune_isa( );
+const char* jar_tune_cpu( );
+const char* jar_tune_path( );
+void jar_tune_default( const int cls, BlockJAR* p );
+const BlockJAR* jar_tune_params( const int cls );
+void jar_tune_set( const int cls, const BlockJAR* p, const double gops );
+double jar_tune_run( const int cls, const int M, const int N, const int K, const double min_time, BlockJAR* best, FILE* log );
+int jar_tune_load( const char* path );
+int jar_tune_save( const char* path );
+void jar_matmul_tuned( const int M, const int N, const int K, const UniJAR* A, const UniJAR* B, UniJAR* C );
+void jar_matvecmul_tuned( const int M, const int K, const UniJAR* A, const UniJAR* b, UniJAR* c );
+
+#endif
@@ -59,6 +59,40 @@ typedef union{
 #define EXP2_FRAC_BITS   5
 #define LOG2_FRAC_BITS   7
 
+/* Rounding modes of the conversion to LogPS80. For stochastic rounding the     */
+/* random bits of the element with index i are the first word of Philox4x32-10  */
+/* with counter (i_lo, i_hi, ctr[0], ctr[1]) and key (key[0], key[1]), so they  */
+/* are reproducible and independent of the order or thread of evaluation.       */
+/* ctr is typically a step or micro-batch count, key a per-tensor seed.         */
+
+#define JAR_RND_NEAREST     0
+#define JAR_RND_STOCHASTIC  1
+
+typedef struct{
+   int            mode;
+   unsigned int   key[2];
+   unsigned int   ctr[2];
+} RndJAR;
+
+/* Blocking of jar_matmul_blocked_avx512 / jar_matvecmul_blocked_avx512: register   */
+/* blocks of mv 16-row vectors by nr columns, cache blocks of mc rows, kc of K      */
+/* (0: all of K) and nc columns, and how the product is split into pool tasks.      */
+/* See jar_tune.h for the tuning of these per shape class and cpu.                  */
+
+#define JAR_SPLIT_NONE      0
+#define JAR_SPLIT_M         1
+#define JAR_SPLIT_N         2
+#define JAR_SPLIT_MN        3
+
+typedef struct{
+   int            mv;
+   int            nr;
+   int            mc;
+   int            kc;
+   int            nc;
+   int            split;
+} BlockJAR;
+
 #endif
 
 
@@ -35,6 +35,7 @@
 
 #include "jar_type.h"
 #include "jar_utils.h"
+#include "jar_trace.h"
 
 #define DEBUG_utils 0
 
@@ -140,6 +141,250 @@ UniJAR rnd_2_PS80( UniJAR x ) {
    return y;
 }
 
+#if defined(__AVX512F__)
+__m512i LogPS80_2_PS8_avx512( const __m512i x ) {
+/*
+16-wide version of LogPS80_2_PS8. The codes are returned in the low byte of
+each 32-bit lane so that they can be used directly as gather indices.
+*/
+   __m512i m, g, p_pos, p_neg, p, one;
+   __mmask16 is_pos, is_zero, is_neg;
+
+   one = _mm512_set1_epi32( 1 );
+   m = _mm512_sub_epi32( _mm512_srli_epi32( _mm512_and_epi32( x, _mm512_set1_epi32( BEXP_MASK ) ), 23 ), _mm512_set1_epi32( 127 ) );
+   m = _mm512_min_epi32( m, _mm512_set1_epi32( 6 ) );
+   g = _mm512_srli_epi32( _mm512_and_epi32( x, _mm512_set1_epi32( FRAC_MASK ) ), 18 );
+   is_pos  = _mm512_cmpge_epi32_mask( m, _mm512_setzero_si512() );
+   is_zero = _mm512_cmplt_epi32_mask( m, _mm512_set1_epi32( -6 ) );
+   is_neg  = _mm512_test_epi32_mask( x, _mm512_set1_epi32( SIGN_MASK ) );
+
+   p_pos = _mm512_sub_epi32( _mm512_set1_epi32( 128 ), _mm512_sllv_epi32( one, _mm512_sub_epi32( _mm512_set1_epi32( 6 ), m ) ) );
+   p_pos = _mm512_add_epi32( p_pos, _mm512_srlv_epi32( g, m ) );
+   p_neg = _mm512_sllv_epi32( one, _mm512_add_epi32( _mm512_set1_epi32( 6 ), m ) );
+   p_neg = _mm512_add_epi32( p_neg, _mm512_srlv_epi32( g, _mm512_sub_epi32( _mm512_set1_epi32( -1 ), m ) ) );
+
+   p = _mm512_mask_blend_epi32( is_pos, p_neg, p_pos );
+   p = _mm512_mask_mov_epi32( p, is_zero, _mm512_setzero_si512() );
+   p = _mm512_mask_sub_epi32( p, is_neg, _mm512_setzero_si512(), p );
+   return _mm512_and_epi32( p, _mm512_set1_epi32( 0xFF ) );
+}
+
+__m512i PS8_2_LogPS80_avx512( const __m512i p ) {
+/* 16-wide version of PS8_2_LogPS80, the codes are in the low byte of each lane */
+   return _mm512_i32gather_epi32( _mm512_and_epi32( p, _mm512_set1_epi32( 0xFF ) ), PS8_tbl, 4 );
+}
+
+__m512i rnd_2_PS80_sr_avx512( const __m512i x, const __m512i r ) {
+/* 16-wide version of rnd_2_PS80_sr, r holds one random word per lane */
+   __m512i expo, s, y, sign_x;
+   __mmask16 in_range, is_pos;
+
+   expo = _mm512_sub_epi32( _mm512_srli_epi32( _mm512_and_epi32( x, _mm512_set1_epi32( BEXP_MASK ) ), 23 ), _mm512_set1_epi32( 127 ) );
+   in_range = _mm512_cmpgt_epi32_mask( expo, _mm512_set1_epi32( -7 ) ) &
+              _mm512_cmplt_epi32_mask( expo, _mm512_set1_epi32( 6 ) );
+   is_pos = _mm512_cmpge_epi32_mask( expo, _mm512_setzero_si512() );
+   s = _mm512_mask_blend_epi32( is_pos, _mm512_sub_epi32( _mm512_set1_epi32( 17 ), expo ), 
+                                        _mm512_add_epi32( _mm512_set1_epi32( 18 ), expo ) );
+
+   sign_x = _mm512_and_epi32( x, _mm512_set1_epi32( SIGN_MASK ) );
+   y = _mm512_and_epi32( x, _mm512_set1_epi32( CLEAR_SIGN ) );
+   y = _mm512_add_epi32( y, _mm512_srlv_epi32( r, _mm512_sub_epi32( _mm512_set1_epi32( 32 ), s ) ) );
+   y = _mm512_andnot_epi32( _mm512_sub_epi32( _mm512_sllv_epi32( _mm512_set1_epi32( 1 ), s ), _mm512_set1_epi32( 1 ) ), y );
+   y = _mm512_or_epi32( y, sign_x );
+
+   return _mm512_mask_blend_epi32( in_range, rnd_2_PS80_avx512( x ), y );
+}
+
+__m512i philox4x32_10_avx512( const __m512i ctr0, const __m512i ctr1, const __m512i ctr2, const __m512i ctr3, const unsigned int key[2] ) {
+/*
+16 independent Philox4x32-10 evaluations, one per lane, returning the first output word.
+The high halves of the 32x32-bit products are formed from _mm512_mul_epu32 on the 
+even and on the odd lanes.
+*/
+   __m512i c0 = ctr0, c1 = ctr1, c2 = ctr2, c3 = ctr3;
+   __m512i k0 = _mm512_set1_epi32( key[0] );
+   __m512i k1 = _mm512_set1_epi32( key[1] );
+   __m512i M0 = _mm512_set1_epi32( 0xD2511F53 );
+   __m512i M1 = _mm512_set1_epi32( 0xCD9E8D57 );
+   __m512i lo0, hi0, lo1, hi1;
+   int r;
+
+   for (r=0; r<10; ++r) {
+      lo0 = _mm512_mullo_epi32( c0, M0 );
+      hi0 = _mm512_mask_blend_epi32( 0xAAAA, _mm512_srli_epi64( _mm512_mul_epu32( c0, M0 ), 32 ),
+                                             _mm512_mul_epu32( _mm512_srli_epi64( c0, 32 ), M0 ) );
+      lo1 = _mm512_mullo_epi32( c2, M1 );
+      hi1 = _mm512_mask_blend_epi32( 0xAAAA, _mm512_srli_epi64( _mm512_mul_epu32( c2, M1 ), 32 ),
+                                             _mm512_mul_epu32( _mm512_srli_epi64( c2, 32 ), M1 ) );
+      c0 = _mm512_xor_epi32( _mm512_xor_epi32( hi1, c1 ), k0 );
+      c1 = lo1;
+      c2 = _mm512_xor_epi32( _mm512_xor_epi32( hi0, c3 ), k1 );
+      c3 = lo0;
+      k0 = _mm512_add_epi32( k0, _mm512_set1_epi32( 0x9E3779B9 ) );
+      k1 = _mm512_add_epi32( k1, _mm512_set1_epi32( 0xBB67AE85 ) );
+   }
+   return c0;
+}
+
+__m512i rnd_2_L_frac_avx512( const __m512i x, const int L ) {
+/*
+16-wide version of rnd_2_L_frac. Big is 2^(23-L) times the 
+power of two obtained by clearing the fraction of each lane.
+*/
+   __m512 Big, y;
+
+   assert (L >= 0 & L <= 10);
+   Big = _mm512_castsi512_ps( _mm512_and_epi32( x, _mm512_set1_epi32( CLEAR_FRAC ) ) );
+   Big = _mm512_mul_ps( Big, _mm512_set1_ps( two_2_k( 23-L ).F ) );
+
+   y = _mm512_add_ps( _mm512_castsi512_ps( x ), Big );
+   y = _mm512_sub_ps( y, Big );
+   return _mm512_castps_si512( y );
+}
+
+__m512i rnd_2_PS80_avx512( const __m512i x ) {
+/*
+16-wide version of rnd_2_PS80. The opMask of the scalar code
+becomes a lane mask: lanes with exponent <= -7 or >= 6 are
+replaced by their Big value, all others are rounded with
+(Big + (x & 0x7FFFFFFF)) - Big.
+*/
+   __m512i sign_x, ind, expo, Big, y;
+   __mmask16 in_range;
+
+   sign_x = _mm512_and_epi32( x, _mm512_set1_epi32( SIGN_MASK ) );
+   ind = _mm512_srli_epi32( _mm512_and_epi32( x, _mm512_set1_epi32( BEXP_MASK ) ), 23 );
+   expo = _mm512_sub_epi32( ind, _mm512_set1_epi32( 127 ) );
+   in_range = _mm512_cmpgt_epi32_mask( expo, _mm512_set1_epi32( -7 ) ) &
+              _mm512_cmplt_epi32_mask( expo, _mm512_set1_epi32( 6 ) );
+   Big = _mm512_i32gather_epi32( ind, Big_tbl, 4 );
+
+   y = _mm512_maskz_and_epi32( in_range, x, _mm512_set1_epi32( CLEAR_SIGN ) );
+   y = _mm512_castps_si512( _mm512_add_ps( _mm512_castsi512_ps( y ), _mm512_castsi512_ps( Big ) ) );
+   Big = _mm512_maskz_mov_epi32( in_range, Big );
+   y = _mm512_castps_si512( _mm512_sub_ps( _mm512_castsi512_ps( y ), _mm512_castsi512_ps( Big ) ) );
+   y = _mm512_or_epi32( y, sign_x );
+   return y;
+}
+#endif
+
+unsigned char LogPS80_2_PS8( UniJAR x ) {
+/*
+Returns the 8-bit Posit(8,0) code of a LogPS80 value, that is, of a value already
+rounded by rnd_2_PS80. With m the exponent and g5 the top 5 fraction bits,
+the 7-bit magnitude of the code is
+    m >= 0 :  128 - 2^(6-m) + (g5 >> m)      (regime of m+1 ones, 5-m fraction bits)
+    m <  0 :  2^(6+m) + (g5 >> (-1-m))      (regime of -m zeros, 6+m fraction bits)
+and JAR_ZERO (or anything below 2^-6) has code 0. Negative values are the two's
+complement. PS8_tbl is the inverse map.
+*/
+   int m, g, p;
+
+   m = (int)((x.I & BEXP_MASK) >> 23) - 127;
+   g = (x.I & FRAC_MASK) >> 18;
+   if (m < -6) {
+      p = 0;
+   }
+   else if (m >= 0) {
+      m = (m < 6) ? m : 6;
+      p = 128 - (1 << (6-m)) + (g >> m);
+   }
+   else {
+      p = (1 << (6+m)) + (g >> (-1-m));
+   }
+   if (x.I & SIGN_MASK) p = (-p) & 0xFF;
+
+   return (unsigned char) p;
+}
+
+UniJAR PS8_2_LogPS80( unsigned char p ) {
+   return PS8_tbl[p];
+}
+
+void jar_pack_PS8( const size_t n, const UniJAR* x, unsigned char* p ) {
+/* Converts n LogPS80 values to their 8-bit Posit(8,0) codes */
+   size_t i = 0;
+   JAR_TRACE_BEGIN( t );
+
+#if defined(__AVX512F__)
+   for ( ; i<(n/16)*16; i+=16) {
+      __m512i c = LogPS80_2_PS8_avx512( _mm512_loadu_si512( x+i ) );
+      _mm_storeu_si128( (__m128i*)(p+i), _mm512_cvtepi32_epi8( c ) );
+   }
+#endif
+   for ( ; i<n; ++i) {
+      p[i] = LogPS80_2_PS8( x[i] );
+   }
+   JAR_TRACE_END( t, JAR_TK_PS8, JAR_TP_PACK, 5*n, 0 );
+}
+
+void jar_unpack_PS8( const size_t n, const unsigned char* p, UniJAR* x ) {
+/* Converts n 8-bit Posit(8,0) codes to LogPS80 values */
+   size_t i = 0;
+   JAR_TRACE_BEGIN( t );
+
+#if defined(__AVX512F__)
+   for ( ; i<(n/16)*16; i+=16) {
+      __m512i c = _mm512_cvtepu8_epi32( _mm_loadu_si128( (const __m128i*)(p+i) ) );
+      _mm512_storeu_si512( x+i, PS8_2_LogPS80_avx512( c ) );
+   }
+#endif
+   for ( ; i<n; ++i) {
+      x[i] = PS8_2_LogPS80( p[i] );
+   }
+   JAR_TRACE_END( t, JAR_TK_PS8, JAR_TP_PACK, 5*n, 0 );
+}
+
+UniJAR rnd_2_PS80_sr( UniJAR x, unsigned int r ) {
+/*
+Stochastic version of rnd_2_PS80. For an in-range exponent m the fraction keeps 
+5-m (m >= 0) or 6+m (m < 0) bits, i.e. the lowest s = 23 - (number of kept bits) 
+bits are dropped. Adding the top s bits of the random word r before truncating
+rounds up with probability equal to the dropped part of the fraction, measured in
+the logarithmic domain. A carry out of the fraction correctly increments the
+exponent. Out-of-range exponents are handled exactly as in rnd_2_PS80.
+*/
+   UniJAR y;
+   unsigned int sign_x;
+   int expo, s;
+
+   expo = (int)((x.I & BEXP_MASK) >> 23) - 127;
+   if ( expo <= -7 || expo >= 6 ) {
+      return rnd_2_PS80( x );
+   }
+   s = (expo >= 0) ? 18 + expo : 17 - expo;
+
+   sign_x = x.I & SIGN_MASK;
+   y.I  = x.I & CLEAR_SIGN;
+   y.I += r >> (32 - s);
+   y.I &= ~((1u << s) - 1);
+   y.I |= sign_x;
+   return y;
+}
+
+unsigned int philox4x32_10( const unsigned int ctr[4], const unsigned int key[2] ) {
+/*
+Counter-based random number generator Philox4x32-10 (Salmon et al., SC'11). Returns
+the first of the four output words for the given 128-bit counter and 64-bit key.
+*/
+   unsigned int c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+   unsigned int k0 = key[0], k1 = key[1];
+   unsigned long long p0, p1;
+   int r;
+
+   for (r=0; r<10; ++r) {
+      p0 = (unsigned long long)0xD2511F53 * c0;
+      p1 = (unsigned long long)0xCD9E8D57 * c2;
+      c0 = (unsigned int)(p1 >> 32) ^ c1 ^ k0;
+      c1 = (unsigned int)p1;
+      c2 = (unsigned int)(p0 >> 32) ^ c3 ^ k1;
+      c3 = (unsigned int)p0;
+      k0 += 0x9E3779B9;
+      k1 += 0xBB67AE85;
+   }
+   return c0;
+}
+
 float LogPS80_2_Lin_val( UniJAR x ) {
 /*
 Compute the accurate exp2 value of a LogPS80 input number
@@ -156,9 +401,82 @@ Compute the accurate exp2 value of a LogPS80 input number
    b = x.F;
    return b;
 }
+
+float LogPS80_2_Lin_val_tbl( UniJAR x ) {
+/*
+Table version of LogPS80_2_Lin_val with bit-identical results. A LogPS80 value has
+only the top LOG2_IND_BITS fraction bits, so the fraction of exp2(f) is one of the
+32 entries of exp2_val_tbl. Inputs with more fraction bits go through exp2.
+*/
+   if (x.I & ((1 << LOG2_IND_SHIFT) - 1)) return LogPS80_2_Lin_val( x );
+   x.I = (x.I & CLEAR_FRAC) | exp2_val_tbl[(x.I & FRAC_MASK) >> LOG2_IND_SHIFT].I;
+   return x.F;
+}
+
+#if defined(__AVX512F__)
+__m512 LogPS80_2_Lin_val_avx512( const __m512i x ) {
+/*
+16-wide version of LogPS80_2_Lin_val_tbl, the 32-entry table is held in two
+registers. Lanes with more than LOG2_IND_BITS fraction bits go through exp2.
+*/
+   __m512i g, y;
+   __mmask16 k;
+
+   g = _mm512_srli_epi32( _mm512_and_epi32( x, _mm512_set1_epi32( FRAC_MASK ) ), LOG2_IND_SHIFT );
+   y = _mm512_permutex2var_epi32( _mm512_loadu_si512( exp2_val_tbl ), g, _mm512_loadu_si512( exp2_val_tbl+16 ) );
+   y = _mm512_or_epi32( y, _mm512_and_epi32( x, _mm512_set1_epi32( CLEAR_FRAC ) ) );
+   k = _mm512_test_epi32_mask( x, _mm512_set1_epi32( (1 << LOG2_IND_SHIFT) - 1 ) );
+   if (k) {
+      UniJAR in[16], out[16];
+      int i;
+      _mm512_storeu_si512( in, x );
+      _mm512_storeu_si512( out, y );
+      for (i=0; i<16; ++i) {
+         if (k & (1 << i)) out[i].F = LogPS80_2_Lin_val( in[i] );
+      }
+      y = _mm512_loadu_si512( out );
+   }
+   return _mm512_castsi512_ps( y );
+}
+#endif
    
   
 
+void gen_exp2_val_tbl( ) {
+/* Generates and print table of the fraction bits of exp2(g/32), g = 0..31,      */
+/* rounded exactly as in LogPS80_2_Lin_val                                       */
+   int num_entries, num_entries_per_line, num_lines;
+   int i, j;
+   UniJAR x;
+   float  a;
+
+   num_entries = 1 << LOG2_IND_BITS;
+   num_entries_per_line = 4;
+   num_lines = num_entries / num_entries_per_line;
+
+   printf("UniJAR exp2_val_tbl[%d] = {\n", num_entries);
+
+   for ( i=0; i<num_lines; i++ ){
+       for ( j=0; j<num_entries_per_line; j++ ){
+           x.I = 0x3F800000 | ((i*num_entries_per_line + j) << LOG2_IND_SHIFT);
+           a = x.F - 1.0; x.F = exp2(a);
+           x.I &= FRAC_MASK;
+           if (j < num_entries_per_line-1) {
+               printf("0X%08X,", x.I);
+           }
+           else {
+               if (i < num_lines-1) {
+                   printf("0X%08X,\n",x.I);
+              }
+              else {
+                   printf("0X%08X\n",x.I);
+              }
+           }
+       }
+   } 
+   printf("}\n");
+}
+
 void gen_exp2_tbl( ) {
 /* Generates and print table */
    int num_entries, num_entries_per_line, num_lines;
@@ -341,6 +659,67 @@ void gen_Mask_tbl( ) {
    printf("}\n");
 }
 
+void gen_PS8_tbl( ) {
+/* Generates and print table of the LogPS80 values of all 256 Posit(8,0) codes      */
+/* A code is the usual Posit(8,0) bit string: sign, regime run of length r          */
+/* terminated by the opposite bit, and the remaining 6-r bits of fraction. Negative  */
+/* values are two's complement of the positive code. Here the posit encodes the      */
+/* logarithmic value m + g: the regime gives m and the fraction bits give g.         */
+/* Code 0x00 is zero and code 0x80 (NaR) is mapped to zero as well.                  */
+
+   int num_entries, num_entries_per_line, num_lines;
+   int code, p, m, nf, g, b, i, j;
+   UniJAR y;
+
+   num_entries = 256;
+   num_entries_per_line = 4;
+   num_lines = num_entries / num_entries_per_line;
+
+   printf("UniJAR PS8_tbl[%d] = {\n", num_entries);
+
+   for ( i=0; i<num_lines; i++ ){
+       for ( j=0; j<num_entries_per_line; j++ ){
+           code = i*num_entries_per_line + j;
+           p = (code < 128) ? code : 256 - code;
+           if (p == 0 || p == 128) {
+              y.I = JAR_ZERO;
+           }
+           else {
+              if (p >= 64) {
+                 /* regime of ones: m = (length of run) - 1 */
+                 m = 0;
+                 while (m < 6 && (p & (0x20 >> m))) m++;
+                 nf = (m < 6) ? 5 - m : 0;
+                 g  = (p & ((1 << nf) - 1)) << (5 - nf);
+              }
+              else {
+                 /* regime of zeros terminated by the leading one at bit b */
+                 b = 5;
+                 while (!(p & (1 << b))) b--;
+                 m  = b - 6;
+                 nf = b;
+                 g  = (p & ((1 << nf) - 1)) << (5 - nf);
+              }
+              y.I = ((unsigned int)(m + 127) << 23) | ((unsigned int)g << 18);
+              if (code >= 128) y.I |= SIGN_MASK;
+           }
+           /* now prints out y */
+           if (j < num_entries_per_line-1) {
+               printf("0X%08X,", y.I);
+           }
+           else {
+               if (i < num_lines-1) {
+                   printf("0X%08X,\n",y.I);
+              }
+              else {
+                   printf("0X%08X\n",y.I);
+              }
+           }
+       }
+   } 
+   printf("}\n");
+}
+
 UniJAR Big_tbl[256] = {
 0X20000000,0X20000000,0X20000000,0X20000000,
 0X20000000,0X20000000,0X20000000,0X20000000,
@@ -408,3 +787,80 @@ UniJAR Big_tbl[256] = {
 0X42800000,0X42800000,0X42800000,0X42800000
 };
 
+UniJAR PS8_tbl[256] = {
+0X20000000,0X3C800000,0X3D000000,0X3D400000,
+0X3D800000,0X3DA00000,0X3DC00000,0X3DE00000,
+0X3E000000,0X3E100000,0X3E200000,0X3E300000,
+0X3E400000,0X3E500000,0X3E600000,0X3E700000,
+0X3E800000,0X3E880000,0X3E900000,0X3E980000,
+0X3EA00000,0X3EA80000,0X3EB00000,0X3EB80000,
+0X3EC00000,0X3EC80000,0X3ED00000,0X3ED80000,
+0X3EE00000,0X3EE80000,0X3EF00000,0X3EF80000,
+0X3F000000,0X3F040000,0X3F080000,0X3F0C0000,
+0X3F100000,0X3F140000,0X3F180000,0X3F1C0000,
+0X3F200000,0X3F240000,0X3F280000,0X3F2C0000,
+0X3F300000,0X3F340000,0X3F380000,0X3F3C0000,
+0X3F400000,0X3F440000,0X3F480000,0X3F4C0000,
+0X3F500000,0X3F540000,0X3F580000,0X3F5C0000,
+0X3F600000,0X3F640000,0X3F680000,0X3F6C0000,
+0X3F700000,0X3F740000,0X3F780000,0X3F7C0000,
+0X3F800000,0X3F840000,0X3F880000,0X3F8C0000,
+0X3F900000,0X3F940000,0X3F980000,0X3F9C0000,
+0X3FA00000,0X3FA40000,0X3FA80000,0X3FAC0000,
+0X3FB00000,0X3FB40000,0X3FB80000,0X3FBC0000,
+0X3FC00000,0X3FC40000,0X3FC80000,0X3FCC0000,
+0X3FD00000,0X3FD40000,0X3FD80000,0X3FDC0000,
+0X3FE00000,0X3FE40000,0X3FE80000,0X3FEC0000,
+0X3FF00000,0X3FF40000,0X3FF80000,0X3FFC0000,
+0X40000000,0X40080000,0X40100000,0X40180000,
+0X40200000,0X40280000,0X40300000,0X40380000,
+0X40400000,0X40480000,0X40500000,0X40580000,
+0X40600000,0X40680000,0X40700000,0X40780000,
+0X40800000,0X40900000,0X40A00000,0X40B00000,
+0X40C00000,0X40D00000,0X40E00000,0X40F00000,
+0X41000000,0X41200000,0X41400000,0X41600000,
+0X41800000,0X41C00000,0X42000000,0X42800000,
+0X20000000,0XC2800000,0XC2000000,0XC1C00000,
+0XC1800000,0XC1600000,0XC1400000,0XC1200000,
+0XC1000000,0XC0F00000,0XC0E00000,0XC0D00000,
+0XC0C00000,0XC0B00000,0XC0A00000,0XC0900000,
+0XC0800000,0XC0780000,0XC0700000,0XC0680000,
+0XC0600000,0XC0580000,0XC0500000,0XC0480000,
+0XC0400000,0XC0380000,0XC0300000,0XC0280000,
+0XC0200000,0XC0180000,0XC0100000,0XC0080000,
+0XC0000000,0XBFFC0000,0XBFF80000,0XBFF40000,
+0XBFF00000,0XBFEC0000,0XBFE80000,0XBFE40000,
+0XBFE00000,0XBFDC0000,0XBFD80000,0XBFD40000,
+0XBFD00000,0XBFCC0000,0XBFC80000,0XBFC40000,
+0XBFC00000,0XBFBC0000,0XBFB80000,0XBFB40000,
+0XBFB00000,0XBFAC0000,0XBFA80000,0XBFA40000,
+0XBFA00000,0XBF9C0000,0XBF980000,0XBF940000,
+0XBF900000,0XBF8C0000,0XBF880000,0XBF840000,
+0XBF800000,0XBF7C0000,0XBF780000,0XBF740000,
+0XBF700000,0XBF6C0000,0XBF680000,0XBF640000,
+0XBF600000,0XBF5C0000,0XBF580000,0XBF540000,
+0XBF500000,0XBF4C0000,0XBF480000,0XBF440000,
+0XBF400000,0XBF3C0000,0XBF380000,0XBF340000,
+0XBF300000,0XBF2C0000,0XBF280000,0XBF240000,
+0XBF200000,0XBF1C0000,0XBF180000,0XBF140000,
+0XBF100000,0XBF0C0000,0XBF080000,0XBF040000,
+0XBF000000,0XBEF80000,0XBEF00000,0XBEE80000,
+0XBEE00000,0XBED80000,0XBED00000,0XBEC80000,
+0XBEC00000,0XBEB80000,0XBEB00000,0XBEA80000,
+0XBEA00000,0XBE980000,0XBE900000,0XBE880000,
+0XBE800000,0XBE700000,0XBE600000,0XBE500000,
+0XBE400000,0XBE300000,0XBE200000,0XBE100000,
+0XBE000000,0XBDE00000,0XBDC00000,0XBDA00000,
+0XBD800000,0XBD400000,0XBD000000,0XBC800000
+};
+
+UniJAR exp2_val_tbl[32] = {
+0X00000000,0X0002CD87,0X0005AAC3,0X0008980F,
+0X000B95C2,0X000EA43A,0X0011C3D3,0X0014F4F0,
+0X001837F0,0X001B8D3A,0X001EF532,0X00227043,
+0X0025FED7,0X0029A15B,0X002D583F,0X003123F6,
+0X003504F3,0X0038FBAF,0X003D08A4,0X00412C4D,
+0X0045672A,0X0049B9BE,0X004E248C,0X0052A81E,
+0X005744FD,0X005BFBB8,0X0060CCDF,0X0065B907,
+0X006AC0C7,0X006FE4BA,0X0075257D,0X007A83B3
+};
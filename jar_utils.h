@@ -30,6 +30,7 @@
 ******************************************************************************/
 
 #include <assert.h>
+#include <stddef.h>
 #include "jar_type.h"
 
 #ifndef JAR_UTILS
@@ -43,15 +44,37 @@ void show_val_LinFP32( char description[], UniJAR x );
 UniJAR two_2_k( int k );
 UniJAR rnd_2_L_frac( UniJAR x, int L );
 UniJAR rnd_2_PS80( UniJAR x );
+UniJAR rnd_2_PS80_sr( UniJAR x, unsigned int r );
+unsigned int philox4x32_10( const unsigned int ctr[4], const unsigned int key[2] );
 float  LogPS80_2_Lin_val( UniJAR x );
+float  LogPS80_2_Lin_val_tbl( UniJAR x );
+unsigned char LogPS80_2_PS8( UniJAR x );
+UniJAR PS8_2_LogPS80( unsigned char p );
+void   jar_pack_PS8( const size_t n, const UniJAR* x, unsigned char* p );
+void   jar_unpack_PS8( const size_t n, const unsigned char* p, UniJAR* x );
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+__m512i rnd_2_L_frac_avx512( const __m512i x, const int L );
+__m512i rnd_2_PS80_avx512( const __m512i x );
+__m512i rnd_2_PS80_sr_avx512( const __m512i x, const __m512i r );
+__m512i philox4x32_10_avx512( const __m512i ctr0, const __m512i ctr1, const __m512i ctr2, const __m512i ctr3, const unsigned int key[2] );
+__m512i LogPS80_2_PS8_avx512( const __m512i x );
+__m512i PS8_2_LogPS80_avx512( const __m512i p );
+__m512  LogPS80_2_Lin_val_avx512( const __m512i x );
+#endif
 
 
 extern UniJAR Big_tbl[256]; 
+extern UniJAR PS8_tbl[256];
+extern UniJAR exp2_val_tbl[32];
 
 void gen_exp2_tbl( );
 void gen_log2_tbl( );
 void gen_Big_tbl();
 void gen_Mask_tbl();
+void gen_PS8_tbl();
+void gen_exp2_val_tbl();
 
 
 #endif
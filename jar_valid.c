@@ -0,0 +1,275 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "jar_valid.h"
+#include "jar_sim.h"
+#include "jar_mem.h"
+#include "jar_pool.h"
+
+/* elements per task of jar_valid_decode / jar_valid_compare */
+#define JAR_VALID_CHUNK  8192
+/* rows, columns and depth of a block of jar_valid_matmul_ref */
+#define JAR_VALID_MB     256
+#define JAR_VALID_NB     8
+#define JAR_VALID_KB     256
+
+typedef struct{
+   size_t         n;
+   const UniJAR*  x;
+   double*        d;
+} JarValidDecodeArg;
+
+typedef struct{
+   int            M;
+   int            N;
+   int            K;
+   const double*  A;
+   const double*  B;
+   double*        R;
+   int            mt;
+} JarValidRefArg;
+
+typedef struct{
+   size_t         n;
+   const UniJAR*  c;
+   const double*  r;
+   ValidJAR*      part;
+} JarValidCmpArg;
+
+void jar_valid_init( ValidJAR* v ) {
+  memset( v, 0, sizeof(ValidJAR) );
+}
+
+double jar_valid_ulp_bound( const int bin ) {
+/* upper bound of ulp bin, 0.5, 1, 2, ..., HUGE_VAL for the last */
+  return (bin < JAR_VALID_ULP_BINS-1) ? ldexp( 0.5, bin ) : HUGE_VAL;
+}
+
+double jar_valid_rel_bound( const int bin ) {
+/* upper bound (excluded) of relative error bin, 1e-6, 1e-5, ..., HUGE_VAL for the last */
+  return (bin < JAR_VALID_REL_BINS-1) ? pow( 10.0, bin - (JAR_VALID_REL_BINS-2) ) : HUGE_VAL;
+}
+
+static void jar_valid_decode_task( void* arg, const int task ) {
+  const JarValidDecodeArg* a = (const JarValidDecodeArg*)arg;
+  const size_t i  = (size_t)task*JAR_VALID_CHUNK;
+  const size_t i1 = (i+JAR_VALID_CHUNK < a->n) ? i+JAR_VALID_CHUNK : a->n;
+  float  f[JAR_VALID_CHUNK];
+  size_t j;
+
+  /* runs serially inside the task */
+  jar_convert_LogPS80_2_Lin_val( i1-i, a->x+i, f );
+  for (j=i; j<i1; ++j) {
+    a->d[j] = (double)f[j-i];
+  }
+}
+
+void jar_valid_decode( const size_t n, const UniJAR* x, double* d ) {
+/* decodes n LogPS80 values to their exact linear values in FP64 */
+  JarValidDecodeArg a;
+
+  assert (x != NULL && d != NULL);
+  a.n = n; a.x = x; a.d = d;
+  jar_parallel_for( (int)((n + JAR_VALID_CHUNK - 1)/JAR_VALID_CHUNK), jar_valid_decode_task, &a );
+}
+
+static void jar_valid_ref_task( void* arg, const int task ) {
+/* block of JAR_VALID_MB rows by JAR_VALID_NB columns of R, over all of K */
+  const JarValidRefArg* a = (const JarValidRefArg*)arg;
+  const int m0 = (task % a->mt)*JAR_VALID_MB, n0 = (task / a->mt)*JAR_VALID_NB;
+  const int m1 = (m0+JAR_VALID_MB < a->M) ? m0+JAR_VALID_MB : a->M;
+  const int n1 = (n0+JAR_VALID_NB < a->N) ? n0+JAR_VALID_NB : a->N;
+  int m, n, k, k0, k1;
+
+  for (n=n0; n<n1; ++n) {
+    for (m=m0; m<m1; ++m) a->R[(size_t)n*a->M+m] = 0.0;
+  }
+  for (k0=0; k0<a->K; k0+=JAR_VALID_KB) {
+    k1 = (k0+JAR_VALID_KB < a->K) ? k0+JAR_VALID_KB : a->K;
+    for (n=n0; n<n1; ++n) {
+      double* r = a->R + (size_t)n*a->M;
+      for (k=k0; k<k1; ++k) {
+        const double  b  = a->B[(size_t)n*a->K+k];
+        const double* ak = a->A + (size_t)k*a->M;
+        for (m=m0; m<m1; ++m) r[m] += ak[m]*b;
+      }
+    }
+  }
+}
+
+void jar_valid_matmul_ref( const int M, const int N, const int K, const UniJAR* A, const UniJAR* B, double* R ) {
+/*
+FP64 reference R = A*B of col-major LogPS80 matrices A (M x K) and B (K x N); R is
+M x N col-major. The sum of each element runs over k in order, independent of the
+blocking and the number of threads.
+*/
+  JarValidRefArg a;
+  double* dA = (double*) jar_malloc( (size_t)M*K*sizeof(double) );
+  double* dB = (double*) jar_malloc( (size_t)K*N*sizeof(double) );
+
+  assert (M > 0 && N > 0 && K > 0);
+  assert (dA != NULL && dB != NULL);
+  jar_valid_decode( (size_t)M*K, A, dA );
+  jar_valid_decode( (size_t)K*N, B, dB );
+
+  a.M = M; a.N = N; a.K = K; a.A = dA; a.B = dB; a.R = R;
+  a.mt = (M + JAR_VALID_MB - 1)/JAR_VALID_MB;
+  jar_parallel_for( a.mt*((N + JAR_VALID_NB - 1)/JAR_VALID_NB), jar_valid_ref_task, &a );
+
+  jar_free( dB );
+  jar_free( dA );
+}
+
+static void jar_valid_one( ValidJAR* v, const UniJAR c, const double fc, const double r, const size_t i ) {
+/* compares result c (decoded fc) with reference r */
+  const double lr = log2( fabs( r ) );
+  double lc, ulp, rel;
+  int b, m;
+
+  v->n++;
+  if (!isfinite( fc ) || !isfinite( r )) {
+    v->nonfinite++;
+    return;
+  }
+  /* the reference rounds to below 2^-6 or to 2^6 and above */
+  if (lr < -6.0 - 1.0/(2 << LOG2_IND_BITS) || lr >= 6.0 - 1.0/(2 << LOG2_IND_BITS)) {
+    v->range++;
+    return;
+  }
+  if ((c.I & SIGN_MASK) != (r < 0.0 ? SIGN_MASK : 0)) {
+    v->sign++;
+    return;
+  }
+  /* the bits of c are its logarithmic value m + f */
+  lc  = (double)((int)((c.I & BEXP_MASK) >> 23) - 127) + (double)(c.I & FRAC_MASK)/(double)(1 << 23);
+  /* fraction bits of the Posit(8,0) grid at the exponent of the reference */
+  m   = (int)floor( lr + 1.0/(2 << LOG2_IND_BITS) );
+  ulp = ldexp( fabs( lc - lr ), (m >= 0) ? LOG2_IND_BITS - m : ((6 + m < LOG2_IND_BITS) ? 6 + m : LOG2_IND_BITS) );
+  rel = fabs( fc - r )/fabs( r );
+  for (b=0; ulp > jar_valid_ulp_bound( b ); ++b);
+  v->ulp[b]++;
+  for (b=0; rel >= jar_valid_rel_bound( b ); ++b);
+  v->rel[b]++;
+  v->sum_ulp += ulp;
+  if (ulp > v->max_ulp) {
+    v->max_ulp = ulp;
+    v->worst = i;
+  }
+  if (rel > v->max_rel) v->max_rel = rel;
+  if (fabs( fc - r ) > v->max_abs) v->max_abs = fabs( fc - r );
+}
+
+static void jar_valid_cmp_task( void* arg, const int task ) {
+  const JarValidCmpArg* a = (const JarValidCmpArg*)arg;
+  const size_t i0 = (size_t)task*JAR_VALID_CHUNK;
+  const size_t i1 = (i0+JAR_VALID_CHUNK < a->n) ? i0+JAR_VALID_CHUNK : a->n;
+  ValidJAR* v = a->part + task;
+  float  f[JAR_VALID_CHUNK];
+  size_t i;
+
+  jar_valid_init( v );
+  jar_convert_LogPS80_2_Lin_val( i1-i0, a->c+i0, f );
+  for (i=i0; i<i1; ++i) {
+    jar_valid_one( v, a->c[i], (double)f[i-i0], a->r[i], i );
+  }
+}
+
+void jar_valid_merge( ValidJAR* v, const ValidJAR* w, const size_t offset ) {
+/* adds the statistics w, whose indices start at offset, to v */
+  int b;
+
+  v->n += w->n; v->range += w->range; v->sign += w->sign; v->nonfinite += w->nonfinite;
+  for (b=0; b<JAR_VALID_ULP_BINS; ++b) v->ulp[b] += w->ulp[b];
+  for (b=0; b<JAR_VALID_REL_BINS; ++b) v->rel[b] += w->rel[b];
+  v->sum_ulp += w->sum_ulp;
+  if (w->max_ulp > v->max_ulp) {
+    v->max_ulp = w->max_ulp;
+    v->worst = offset + w->worst;
+  }
+  if (w->max_rel > v->max_rel) v->max_rel = w->max_rel;
+  if (w->max_abs > v->max_abs) v->max_abs = w->max_abs;
+}
+
+void jar_valid_compare( const size_t n, const UniJAR* c, const double* r, ValidJAR* v ) {
+/* compares n LogPS80 results c with FP64 references r, v is overwritten */
+  const int ntasks = (int)((n + JAR_VALID_CHUNK - 1)/JAR_VALID_CHUNK);
+  JarValidCmpArg a;
+  int t;
+
+  assert (c != NULL && r != NULL && v != NULL);
+  a.n = n; a.c = c; a.r = r;
+  a.part = (ValidJAR*) malloc( (ntasks > 0 ? ntasks : 1)*sizeof(ValidJAR) );
+  assert (a.part != NULL);
+  jar_parallel_for( ntasks, jar_valid_cmp_task, &a );
+
+  jar_valid_init( v );
+  for (t=0; t<ntasks; ++t) {
+    jar_valid_merge( v, a.part+t, 0 );
+  }
+  free( a.part );
+}
+
+double jar_valid_mean_ulp( const ValidJAR* v ) {
+/* mean ulp error of the values in the histograms */
+  const uint64_t h = v->n - v->range - v->sign - v->nonfinite;
+  return (h > 0) ? v->sum_ulp/(double)h : 0.0;
+}
+
+int jar_valid_failed( const ValidJAR* v, const double max_ulp, const double max_mean_ulp ) {
+/* nonzero if a result is off by more than max_ulp, the mean by more than max_mean_ulp, or a value is not finite */
+  return v->max_ulp > max_ulp || jar_valid_mean_ulp( v ) > max_mean_ulp || v->nonfinite > 0;
+}
+
+void jar_valid_print( FILE* fp, const ValidJAR* v ) {
+/* summary line and the two histograms */
+  const uint64_t h = v->n - v->range - v->sign - v->nonfinite;
+  const double d = (h > 0) ? (double)h : 1.0;
+  int b;
+
+  fprintf( fp, "  values %llu, out of range %llu, wrong sign %llu, not finite %llu\n", (unsigned long long)v->n,
+           (unsigned long long)v->range, (unsigned long long)v->sign, (unsigned long long)v->nonfinite );
+  fprintf( fp, "  ulp: mean %.4f max %.4f (index %zu), relative error max %.4e, absolute error max %.4e\n",
+           jar_valid_mean_ulp( v ), v->max_ulp, v->worst, v->max_rel, v->max_abs );
+  fprintf( fp, "  %-10s", "ulp <=" );
+  for (b=0; b<JAR_VALID_ULP_BINS-1; ++b) fprintf( fp, " %9g", jar_valid_ulp_bound( b ) );
+  fprintf( fp, " %9s\n  %-10s", "more", "%" );
+  for (b=0; b<JAR_VALID_ULP_BINS; ++b) fprintf( fp, " %9.4f", 100.0*(double)v->ulp[b]/d );
+  fprintf( fp, "\n  %-10s", "rel <" );
+  for (b=0; b<JAR_VALID_REL_BINS-1; ++b) fprintf( fp, " %9g", jar_valid_rel_bound( b ) );
+  fprintf( fp, " %9s\n  %-10s", "more", "%" );
+  for (b=0; b<JAR_VALID_REL_BINS; ++b) fprintf( fp, " %9.4f", 100.0*(double)v->rel[b]/d );
+  fprintf( fp, "\n" );
+}
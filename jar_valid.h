@@ -0,0 +1,94 @@
+/******************************************************************************
+** Copyright (c) 2019, Intel Corporation                                     **
+** All rights reserved.                                                      **
+**                                                                           **
+** Redistribution and use in source and binary forms, with or without        **
+** modification, are permitted provided that the following conditions        **
+** are met:                                                                  **
+** 1. Redistributions of source code must retain the above copyright         **
+**    notice, this list of conditions and the following disclaimer.          **
+** 2. Redistributions in binary form must reproduce the above copyright      **
+**    notice, this list of conditions and the following disclaimer in the    **
+**    documentation and/or other materials provided with the distribution.   **
+** 3. Neither the name of the copyright holder nor the names of its          **
+**    contributors may be used to endorse or promote products derived        **
+**    from this software without specific prior written permission.          **
+**                                                                           **
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       **
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         **
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR     **
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT      **
+** HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,    **
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED  **
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR    **
+** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+******************************************************************************/
+/* Ping Tak Peter Tang, Alexander Heinecke (Intel Corp.)
+******************************************************************************/
+
+/****************************************************************************************
+ *  Validation of JAR results against an FP64 reference.
+ *
+ *  jar_valid_decode decodes LogPS80 values to double through the exp2_val_tbl lookup
+ *  (bit-identical to LogPS80_2_Lin_val), jar_valid_matmul_ref computes the FP64 product
+ *  R = A*B of the decoded col-major LogPS80 matrices (products are exact in FP64 and
+ *  the sums run in order of k), and jar_valid_compare compares n LogPS80 results c 
+ *  with their references r. All three run on the JAR thread pool; the comparison is
+ *  split into chunks whose statistics are merged in order, so ValidJAR does not 
+ *  depend on the number of threads.
+ *
+ *  The error of c[i] is measured in ulp of the logarithmic format, i.e. |log2|c[i]| - 
+ *  log2|r[i]|| in units of the spacing of the Posit(8,0) grid at the exponent of r[i]
+ *  (2^-5 for exponents -1 and 0, twice as coarse per step away from them, see 
+ *  LogPS80_2_PS8), so that a correctly rounded result has at most 0.5 ulp, and as the
+ *  relative error |c[i] - r[i]| / |r[i]|. ValidJAR has
+ *  a histogram of each (ulp bins <= 0.5, 1, 2, 4, 8, 16, 32 and above, relative error 
+ *  bins < 1e-6, 1e-5, ..., 1 and above), their maxima and the index of the worst ulp 
+ *  error. References that round outside the LogPS80 range (|r| < 2^-6 or >= 2^6, 
+ *  flushed or saturated by rnd_2_PS80) are counted in range and results of the 
+ *  wrong sign in sign, neither is in the histograms. Wrong signs come from cancellation
+ *  in sums whose result is small against their terms and are not failures by 
+ *  themselves; jar_valid_failed checks the maximum and mean ulp error.
+ *
+ ****************************************************************************************/
+
+#ifndef JAR_VALID
+
+#define JAR_VALID
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "jar_type.h"
+
+#define JAR_VALID_ULP_BINS  8
+#define JAR_VALID_REL_BINS  8
+
+typedef struct{
+   uint64_t   n;
+   uint64_t   range;
+   uint64_t   sign;
+   uint64_t   nonfinite;
+   uint64_t   ulp[JAR_VALID_ULP_BINS];
+   uint64_t   rel[JAR_VALID_REL_BINS];
+   double     sum_ulp;
+   double     max_ulp;
+   double     max_rel;
+   double     max_abs;
+   size_t     worst;
+} ValidJAR;
+
+void jar_valid_init( ValidJAR* v );
+void jar_valid_decode( const size_t n, const UniJAR* x, double* d );
+void jar_valid_matmul_ref( const int M, const int N, const int K, const UniJAR* A, const UniJAR* B, double* R );
+void jar_valid_compare( const size_t n, const UniJAR* c, const double* r, ValidJAR* v );
+void jar_valid_merge( ValidJAR* v, const ValidJAR* w, const size_t offset );
+int  jar_valid_failed( const ValidJAR* v, const double max_ulp, const double max_mean_ulp );
+double jar_valid_mean_ulp( const ValidJAR* v );
+double jar_valid_ulp_bound( const int bin );
+double jar_valid_rel_bound( const int bin );
+void jar_valid_print( FILE* fp, const ValidJAR* v );
+
+#endif